@@ -0,0 +1,451 @@
+// Benchmark suite for the solver's hot paths.
+//
+// Run with no arguments to write results to gto_bench_results.json (Google Benchmark
+// JSON format, tagged with the git commit the binary was built from) so results can be
+// tracked per commit. Any --benchmark_* flag is forwarded to Google Benchmark, e.g.
+//   ./gto_bench --benchmark_filter=Train --benchmark_out=train.json
+#include "benchmark/benchmark.h"
+
+#include "game_state.h"
+#include "info_set.h"
+#include "node.h"
+#include "action_abstraction.h"
+#include "hand_evaluator.h"
+#include "cfr_engine.h"
+#include "regret_kernels.h"
+
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm> // For std::shuffle, std::sort
+#include <mutex>     // For std::mutex, std::lock_guard
+#include <memory>    // For std::make_unique
+#include <thread>    // For std::thread::hardware_concurrency
+
+#include "spdlog/spdlog.h"
+
+#ifndef GTO_BENCH_GIT_SHA
+#define GTO_BENCH_GIT_SHA "unknown"
+#endif
+
+namespace {
+
+using gto_solver::Card;
+
+std::vector<Card> make_deck() {
+    std::vector<Card> deck;
+    const std::string ranks = "23456789TJQKA";
+    const std::string suits = "cdhs";
+    for (char r : ranks) { for (char s : suits) { deck.push_back(std::string(1, r) + s); } }
+    return deck;
+}
+
+// Deals the same kind of state the training loop starts from: hands for every player,
+// sorted as in CFREngine::train.
+gto_solver::GameState make_dealt_state(int num_players, std::mt19937& rng, int button = 0) {
+    gto_solver::GameState state(num_players, 100, 0, button);
+    std::vector<Card> deck = make_deck();
+    std::shuffle(deck.begin(), deck.end(), rng);
+    std::vector<std::vector<Card>> hands(num_players);
+    for (int p = 0; p < num_players; ++p) {
+        hands[p] = {deck[2 * p], deck[2 * p + 1]};
+        std::sort(hands[p].begin(), hands[p].end());
+    }
+    state.deal_hands(hands);
+    return state;
+}
+
+// A small, fixed set of decision points covering preflop RFI, facing a raise and postflop.
+std::vector<gto_solver::GameState> make_decision_states() {
+    std::mt19937 rng(42);
+    std::vector<gto_solver::GameState> states;
+
+    gto_solver::GameState rfi = make_dealt_state(6, rng);
+    states.push_back(rfi); // UTG open
+
+    gto_solver::GameState vs_open = rfi;
+    gto_solver::Action open{gto_solver::Action::Type::RAISE, 5, vs_open.get_current_player()};
+    vs_open.apply_action(open);
+    states.push_back(vs_open); // MP facing an open
+
+    gto_solver::GameState hu = make_dealt_state(2, rng);
+    states.push_back(hu); // HU SB open
+
+    gto_solver::GameState flop = make_dealt_state(2, rng);
+    flop.advance_to_next_street();
+    flop.deal_community_cards({"2c", "7d", "Th"});
+    states.push_back(flop); // Postflop, first to act
+
+    return states;
+}
+
+} // anonymous namespace
+
+
+// --- HandEvaluator::evaluate_7_card_hand throughput ---
+static void BM_Evaluate7CardHand(benchmark::State& state) {
+    gto_solver::HandEvaluator evaluator;
+    std::mt19937 rng(1);
+    std::vector<Card> deck = make_deck();
+    const size_t kBoards = 1024;
+    std::vector<std::vector<Card>> hands(kBoards), boards(kBoards);
+    for (size_t i = 0; i < kBoards; ++i) {
+        std::shuffle(deck.begin(), deck.end(), rng);
+        hands[i] = {deck[0], deck[1]};
+        boards[i] = {deck[2], deck[3], deck[4], deck[5], deck[6]};
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(evaluator.evaluate_7_card_hand(hands[i], boards[i]));
+        i = (i + 1) % kBoards;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Evaluate7CardHand);
+
+
+// --- GameState copy / apply_action cost ---
+static void BM_GameStateCopy(benchmark::State& state) {
+    std::mt19937 rng(2);
+    gto_solver::GameState source = make_dealt_state(static_cast<int>(state.range(0)), rng);
+    for (auto _ : state) {
+        gto_solver::GameState copy = source;
+        benchmark::DoNotOptimize(copy);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GameStateCopy)->Arg(2)->Arg(6);
+
+static void BM_GameStateApplyAction(benchmark::State& state) {
+    std::mt19937 rng(3);
+    gto_solver::GameState source = make_dealt_state(static_cast<int>(state.range(0)), rng);
+    for (auto _ : state) {
+        // Copy + apply is exactly what every cfr_plus_recursive child does.
+        gto_solver::GameState next = source;
+        gto_solver::Action fold{gto_solver::Action::Type::FOLD, 0, next.get_current_player()};
+        next.apply_action(fold);
+        benchmark::DoNotOptimize(next);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GameStateApplyAction)->Arg(2)->Arg(6);
+
+
+// --- InfoSet key generation ---
+// Arg: history encoding (0 chips, 1 actions); key_bytes is the mean key length.
+static void BM_InfoSetKey(benchmark::State& state) {
+    const auto encoding = static_cast<gto_solver::HistoryEncoding>(state.range(0));
+    std::vector<gto_solver::GameState> states = make_decision_states();
+    size_t i = 0;
+    size_t key_bytes = 0;
+    for (auto _ : state) {
+        const gto_solver::GameState& s = states[i];
+        gto_solver::InfoSet info_set(s, s.get_current_player(), encoding);
+        benchmark::DoNotOptimize(info_set.get_key().data());
+        key_bytes += info_set.get_key().size();
+        i = (i + 1) % states.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["key_bytes"] = static_cast<double>(key_bytes) / static_cast<double>(std::max<int64_t>(1, state.iterations()));
+}
+BENCHMARK(BM_InfoSetKey)->Arg(0)->Arg(1)->ArgNames({"encoding"});
+
+
+// --- ActionAbstraction::get_possible_action_specs ---
+static void BM_ActionAbstractionSpecs(benchmark::State& state) {
+    gto_solver::ActionAbstraction abstraction;
+    std::vector<gto_solver::GameState> states = make_decision_states();
+    size_t i = 0;
+    for (auto _ : state) {
+        auto specs = abstraction.get_possible_action_specs(states[i]);
+        benchmark::DoNotOptimize(specs.data());
+        i = (i + 1) % states.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ActionAbstractionSpecs);
+
+
+// --- Regret kernels (regret_kernels.h) per instruction set ---
+// Args: {isa (0 scalar, 1 sse2, 2 avx2, 3 fixed width), num_actions}. Each call forces the
+// kernel set and restores the startup one afterwards (isa 3 only differs up to
+// kMaxFixedKernelActions actions).
+namespace {
+const gto_solver::KernelIsa kBenchIsas[] = {gto_solver::KernelIsa::SCALAR, gto_solver::KernelIsa::SSE2, gto_solver::KernelIsa::AVX2};
+
+bool select_bench_isa(benchmark::State& state) {
+    const bool fixed_width = state.range(0) == 3;
+    gto_solver::set_fixed_width_kernels(fixed_width);
+    if (fixed_width) {
+        state.SetLabel("fixed");
+        return true;
+    }
+    gto_solver::KernelIsa isa = kBenchIsas[state.range(0)];
+    if (!gto_solver::set_kernel_isa(isa)) {
+        gto_solver::set_fixed_width_kernels(true);
+        state.SkipWithError("instruction set not supported by this CPU");
+        return false;
+    }
+    state.SetLabel(gto_solver::kernel_isa_name(isa));
+    return true;
+}
+
+std::vector<double> bench_values(size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    std::vector<double> values(n);
+    for (double& v : values) v = dist(rng);
+    return values;
+}
+
+void KernelArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"isa", "actions"});
+    for (int isa = 0; isa < 4; ++isa) {
+        for (int n : {3, 6, 12, 32}) b->Args({isa, n});
+    }
+}
+} // anonymous namespace
+
+static void BM_RegretMatching(benchmark::State& state) {
+    gto_solver::KernelIsa startup = gto_solver::active_kernel_isa();
+    if (!select_bench_isa(state)) return;
+    const size_t n = static_cast<size_t>(state.range(1));
+    std::vector<double> regrets = bench_values(n, 1), strategy(n);
+    for (auto _ : state) {
+        gto_solver::regret_matching(regrets.data(), strategy.data(), n);
+        benchmark::DoNotOptimize(strategy.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(n));
+    gto_solver::set_kernel_isa(startup);
+    gto_solver::set_fixed_width_kernels(true);
+}
+BENCHMARK(BM_RegretMatching)->Apply(KernelArgs);
+
+static void BM_AccumulateRegrets(benchmark::State& state) {
+    gto_solver::KernelIsa startup = gto_solver::active_kernel_isa();
+    if (!select_bench_isa(state)) return;
+    const size_t n = static_cast<size_t>(state.range(1));
+    std::vector<double> regret_sum = bench_values(n, 2), utilities = bench_values(n, 3);
+    double positive_delta = 0.0;
+    for (auto _ : state) {
+        positive_delta += gto_solver::accumulate_regrets(regret_sum.data(), utilities.data(), 0.1, 1e-3, n, false);
+        benchmark::DoNotOptimize(regret_sum.data());
+        benchmark::ClobberMemory();
+    }
+    benchmark::DoNotOptimize(positive_delta);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(n));
+    gto_solver::set_kernel_isa(startup);
+    gto_solver::set_fixed_width_kernels(true);
+}
+BENCHMARK(BM_AccumulateRegrets)->Apply(KernelArgs);
+
+static void BM_AccumulateStrategy(benchmark::State& state) {
+    gto_solver::KernelIsa startup = gto_solver::active_kernel_isa();
+    if (!select_bench_isa(state)) return;
+    const size_t n = static_cast<size_t>(state.range(1));
+    std::vector<double> strategy_sum(n, 0.0), strategy = bench_values(n, 4);
+    for (auto _ : state) {
+        gto_solver::accumulate_strategy(strategy_sum.data(), strategy.data(), 1e-3, n);
+        benchmark::DoNotOptimize(strategy_sum.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(n));
+    gto_solver::set_kernel_isa(startup);
+    gto_solver::set_fixed_width_kernels(true);
+}
+BENCHMARK(BM_AccumulateStrategy)->Apply(KernelArgs);
+
+
+// --- NodeMap lookup under contention ---
+// Mirrors the lookup in CFREngine::cfr_plus_recursive: one map-wide mutex guarding a
+// NodeMap that every worker thread hits once per visited infoset.
+namespace {
+struct SharedNodeMap {
+    gto_solver::NodeMap map;
+    std::mutex mutex;
+    std::vector<std::string> keys;
+
+    SharedNodeMap() {
+        std::mt19937 rng(4);
+        std::vector<gto_solver::ActionSpec> specs = {
+            {gto_solver::ActionType::FOLD}, {gto_solver::ActionType::CALL},
+            {gto_solver::ActionType::RAISE, 2.5, gto_solver::SizingUnit::BB}};
+        for (int i = 0; i < 50000; ++i) {
+            gto_solver::GameState s = make_dealt_state(6, rng, i % 6);
+            std::string key = gto_solver::InfoSet(s, s.get_current_player()).get_key() + std::to_string(i);
+            keys.push_back(key);
+            map.emplace(key, std::make_unique<gto_solver::Node>(specs));
+        }
+    }
+};
+SharedNodeMap& shared_node_map() {
+    static SharedNodeMap instance; // Built once, thread-safe static init
+    return instance;
+}
+} // anonymous namespace
+
+static void BM_NodeMapLookup(benchmark::State& state) {
+    SharedNodeMap& shared = shared_node_map();
+    std::mt19937 rng(5 + state.thread_index());
+    std::uniform_int_distribution<size_t> pick(0, shared.keys.size() - 1);
+    for (auto _ : state) {
+        const std::string& key = shared.keys[pick(rng)];
+        gto_solver::Node* node_ptr = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(shared.mutex);
+            auto it = shared.map.find(key);
+            if (it != shared.map.end()) node_ptr = it->second.get();
+        }
+        benchmark::DoNotOptimize(node_ptr);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_NodeMapLookup)->ThreadRange(1, 8)->UseRealTime();
+
+
+// --- Full CFREngine::train iterations/sec ---
+// Args: {num_players, num_threads}. The engine is kept across benchmark iterations so
+// later rounds measure a warm tree, like a long-running training job.
+static void BM_Train(benchmark::State& state) {
+    const int num_players = static_cast<int>(state.range(0));
+    const int num_threads = static_cast<int>(state.range(1));
+    const int iterations_per_call = (num_players == 2) ? 2000 : 200;
+    gto_solver::CFREngine engine;
+    for (auto _ : state) {
+        engine.train(iterations_per_call, num_players, 100, 0, num_threads);
+    }
+    state.counters["cfr_iterations_per_sec"] = benchmark::Counter(
+        static_cast<double>(state.iterations()) * iterations_per_call, benchmark::Counter::kIsRate);
+}
+
+static void TrainArgs(benchmark::internal::Benchmark* b) {
+    int max_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    for (int players : {2, 6}) {
+        for (int threads = 1; threads < max_threads; threads *= 2) b->Args({players, threads});
+        b->Args({players, max_threads});
+    }
+}
+BENCHMARK(BM_Train)->Apply(TrainArgs)->ArgNames({"players", "threads"})->UseRealTime()->Unit(benchmark::kMillisecond);
+
+
+// --- NUMA placement: train() throughput plus cross-node page allocations ---
+// Args: {placement (0 none, 1 compact, 2 spread), numa_interleave_depth}, all hardware threads,
+// 6 players. numastat counters are system-wide, so run on an otherwise idle machine; on a
+// single-node machine remote pages are always 0 and only the pinning overhead shows.
+static void BM_TrainNumaPlacement(benchmark::State& state) {
+    const gto_solver::ThreadPlacement placements[] = {gto_solver::ThreadPlacement::NONE, gto_solver::ThreadPlacement::COMPACT, gto_solver::ThreadPlacement::SPREAD};
+    gto_solver::TrainingOptions options;
+    options.metrics_interval_seconds = 0;
+    options.thread_placement = placements[state.range(0)];
+    options.numa_interleave_depth = static_cast<int>(state.range(1));
+    const int num_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    const int iterations_per_call = 200;
+
+    gto_solver::NumaStat before, after;
+    bool has_numastat = gto_solver::read_numastat(before);
+    gto_solver::CFREngine engine;
+    for (auto _ : state) {
+        engine.train(iterations_per_call, 6, 100, 0, num_threads, "", 0, "", options);
+    }
+    if (has_numastat && gto_solver::read_numastat(after)) {
+        state.counters["other_node_pages"] = static_cast<double>(after.other_node - before.other_node);
+        state.counters["numa_miss_pages"] = static_cast<double>(after.numa_miss - before.numa_miss);
+        state.counters["local_node_pages"] = static_cast<double>(after.local_node - before.local_node);
+    }
+    state.counters["cfr_iterations_per_sec"] = benchmark::Counter(
+        static_cast<double>(state.iterations()) * iterations_per_call, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_TrainNumaPlacement)
+    ->Args({0, 0})->Args({1, 0})->Args({2, 0})->Args({2, 3})
+    ->ArgNames({"placement", "interleave_depth"})->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// --- Huge-page node arena (TrainingOptions::huge_pages) ---
+// Args: {policy (0 off, 1 thp, 2 explicit)}, 6 players, one thread. The engine keeps its tree
+// across calls, so later calls walk a tree of hundreds of thousands of nodes and the TLB reach of
+// the node slabs shows. huge_chunks counts the arena chunks that actually got huge pages (0
+// when the kernel fell back to 4 KB pages; explicit needs reserved vm.nr_hugepages).
+static void BM_TrainHugePages(benchmark::State& state) {
+    const gto_solver::HugePagePolicy policies[] = {gto_solver::HugePagePolicy::OFF, gto_solver::HugePagePolicy::TRANSPARENT, gto_solver::HugePagePolicy::EXPLICIT};
+    gto_solver::TrainingOptions options;
+    options.metrics_interval_seconds = 0;
+    options.huge_pages = policies[state.range(0)];
+    const int iterations_per_call = 1000;
+
+    gto_solver::CFREngine engine;
+    for (auto _ : state) {
+        engine.train(iterations_per_call, 6, 100, 0, 1, "", 0, "", options);
+    }
+    long long huge_chunks = 0, chunks = 0;
+    for (const auto& pool : gto_solver::NodeArena::instance().stats()) { huge_chunks += pool.huge_chunks; chunks += pool.chunks; }
+    state.counters["huge_chunks"] = static_cast<double>(huge_chunks);
+    state.counters["chunks"] = static_cast<double>(chunks);
+    state.counters["cfr_iterations_per_sec"] = benchmark::Counter(
+        static_cast<double>(state.iterations()) * iterations_per_call, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_TrainHugePages)->Arg(0)->Arg(1)->Arg(2)->ArgNames({"policy"})->Iterations(10)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// Interleaved coroutine traversals (TrainingOptions::interleaved_traversals): one worker
+// switches between K traversals at every node lookup, so the prefetched node and regret
+// slabs of one strand arrive while the others run. Width 1 is the plain recursive path.
+static void BM_TrainInterleaved(benchmark::State& state) {
+    gto_solver::TrainingOptions options;
+    options.metrics_interval_seconds = 0;
+    options.interleaved_traversals = static_cast<int>(state.range(0));
+    const int iterations_per_call = 200;
+
+    gto_solver::CFREngine engine;
+    for (auto _ : state) {
+        engine.train(iterations_per_call, 6, 100, 0, 1, "", 0, "", options);
+    }
+    state.counters["cfr_iterations_per_sec"] = benchmark::Counter(
+        static_cast<double>(state.iterations()) * iterations_per_call, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_TrainInterleaved)->Arg(1)->Arg(4)->Arg(8)->ArgNames({"interleave"})->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// Infoset trie (TrainingOptions::infoset_trie): a decision whose hand was seen at the same public
+// state before is reached by child pointers, without building its key, searching the map or
+// asking the abstraction for its actions. Every train() call starts a new trie over the
+// engine's (warm) node map.
+static void BM_TrainInfosetTrie(benchmark::State& state) {
+    gto_solver::TrainingOptions options;
+    options.metrics_interval_seconds = 0;
+    options.infoset_trie = state.range(0) != 0;
+    const int iterations_per_call = 1000;
+
+    gto_solver::CFREngine engine;
+    for (auto _ : state) {
+        engine.train(iterations_per_call, 6, 100, 0, 1, "", 0, "", options);
+    }
+    state.counters["cfr_iterations_per_sec"] = benchmark::Counter(
+        static_cast<double>(state.iterations()) * iterations_per_call, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_TrainInfosetTrie)->Arg(0)->Arg(1)->ArgNames({"trie"})->Iterations(10)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+
+int main(int argc, char** argv) {
+    // train() logs every root visit at info level and the abstraction warns on some
+    // sampled lines; keep the benchmark output (and timings) free of log I/O.
+    spdlog::set_level(spdlog::level::err);
+
+    // Default to JSON output so every run leaves a machine-readable record.
+    std::vector<char*> args(argv, argv + argc);
+    bool has_out = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]).rfind("--benchmark_out=", 0) == 0) has_out = true;
+    }
+    std::string out_arg = "--benchmark_out=gto_bench_results.json";
+    std::string format_arg = "--benchmark_out_format=json";
+    if (!has_out) {
+        args.push_back(out_arg.data());
+        args.push_back(format_arg.data());
+    }
+    int bench_argc = static_cast<int>(args.size());
+
+    benchmark::Initialize(&bench_argc, args.data());
+    if (benchmark::ReportUnrecognizedArguments(bench_argc, args.data())) return 1;
+    benchmark::AddCustomContext("git_commit", GTO_BENCH_GIT_SHA);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
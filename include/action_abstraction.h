@@ -4,6 +4,9 @@
 #include <vector>
 #include <string>
 #include <map> // Include map
+#include <cstdint>
+#include <cmath>
+#include <iterator> // For std::size
 
 // Forward declaration
 namespace gto_solver { class GameState; }
@@ -14,10 +17,88 @@ namespace gto_solver {
 enum class ActionType { FOLD, CHECK, CALL, BET, RAISE, ALL_IN };
 enum class SizingUnit { BB, PCT_POT, MULTIPLIER_X, ABSOLUTE }; // ABSOLUTE for all-in amount
 
+// Spots the abstraction builds a menu for (the branch of get_possible_action_specs taken).
+// Together with an AbstractAction this names an action independently of chip amounts, so
+// the same abstract line has the same compact history at any stack depth or ante.
+// Values are stored in checkpoints: append only.
+enum class ActionSetId : uint8_t {
+    UNTAGGED = 0,         // Action not produced by the abstraction (hand-built in tests / tools)
+    PASSIVE,              // No aggressive option (e.g. preflop limp behind)
+    HEADS_UP_OPEN,        // HU small blind, unopened pot
+    SMALL_BLIND_OPEN,     // 3+ handed small blind, unopened pot
+    OPEN,                 // Raise first in
+    HEADS_UP_VS_LIMP,     // HU big blind facing a limp
+    ISOLATE,              // Facing limpers
+    HEADS_UP_VS_OPEN,     // HU big blind facing the small blind's open
+    VS_OPEN,              // Facing one raise
+    VS_FOUR_BET,          // Facing two raises
+    VS_FIVE_BET,          // Facing three or more raises
+    POSTFLOP_UNOPENED,    // Postflop, no bet yet
+    POSTFLOP_FACING_BET,  // Postflop, facing a bet or raise
+    SHORT_STACK           // Stack does not cover the call: fold or all-in
+};
+
+// Catalogue of every abstract action. Sizings that depend on the spot (the open size shrinks
+// with the effective stack, isolation grows with the limpers) share one entry per role.
+// Values are stored in checkpoints: append only.
+enum class AbstractAction : uint8_t {
+    FOLD, CHECK, CALL, ALL_IN,
+    OPEN_SMALL,                      // 2.0 / 2.1 / 2.2bb depending on the effective stack
+    RAISE_2_5BB, RAISE_3BB, RAISE_4BB,
+    ISOLATE_SMALL, ISOLATE_LARGE,    // 3bb / 4bb plus one per limper
+    RAISE_2_2X, RAISE_2_5X, RAISE_3X, RAISE_4X,
+    BET_33_PCT, BET_50_PCT, BET_75_PCT, BET_100_PCT, BET_133_PCT,
+    UNKNOWN = 0xFF
+};
+
+// Compact history byte: action-set id in the high nibble, the action's slot within that set
+// in the low one. Slots 0-3 are fold / check / call / all-in in every set; the set's own
+// sizings follow (kActionSetSizings). Slot 15 marks an action the set does not list.
+constexpr size_t kMaxSetSizings = 5;
+inline constexpr AbstractAction kActionSetSizings[][kMaxSetSizings] = {
+    /* UNTAGGED            */ {AbstractAction::UNKNOWN, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN},
+    /* PASSIVE             */ {AbstractAction::UNKNOWN, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN},
+    /* HEADS_UP_OPEN       */ {AbstractAction::RAISE_3BB, AbstractAction::RAISE_4BB, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN},
+    /* SMALL_BLIND_OPEN    */ {AbstractAction::RAISE_3BB, AbstractAction::RAISE_4BB, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN},
+    /* OPEN                */ {AbstractAction::OPEN_SMALL, AbstractAction::RAISE_2_5BB, AbstractAction::RAISE_3BB, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN},
+    /* HEADS_UP_VS_LIMP    */ {AbstractAction::RAISE_3BB, AbstractAction::RAISE_4BB, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN},
+    /* ISOLATE             */ {AbstractAction::ISOLATE_SMALL, AbstractAction::ISOLATE_LARGE, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN},
+    /* HEADS_UP_VS_OPEN    */ {AbstractAction::RAISE_3X, AbstractAction::RAISE_4X, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN},
+    /* VS_OPEN             */ {AbstractAction::UNKNOWN, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN},
+    /* VS_FOUR_BET         */ {AbstractAction::RAISE_2_5X, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN},
+    /* VS_FIVE_BET         */ {AbstractAction::UNKNOWN, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN},
+    /* POSTFLOP_UNOPENED   */ {AbstractAction::BET_33_PCT, AbstractAction::BET_50_PCT, AbstractAction::BET_75_PCT, AbstractAction::BET_100_PCT, AbstractAction::BET_133_PCT},
+    /* POSTFLOP_FACING_BET */ {AbstractAction::RAISE_2_2X, AbstractAction::RAISE_3X, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN},
+    /* SHORT_STACK         */ {AbstractAction::UNKNOWN, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN, AbstractAction::UNKNOWN},
+};
+static_assert(std::size(kActionSetSizings) == static_cast<size_t>(ActionSetId::SHORT_STACK) + 1, "one row per action set");
+static_assert(std::size(kActionSetSizings) <= 16 && 4 + kMaxSetSizings < 15, "set and slot must each fit a nibble");
+constexpr uint8_t kUnlistedSlot = 0x0F;
+
+constexpr uint8_t compact_history_byte(ActionSetId set, AbstractAction action) {
+    uint8_t slot = kUnlistedSlot;
+    switch (action) {
+        case AbstractAction::FOLD:   slot = 0; break;
+        case AbstractAction::CHECK:  slot = 1; break;
+        case AbstractAction::CALL:   slot = 2; break;
+        case AbstractAction::ALL_IN: slot = 3; break;
+        default:
+            if (static_cast<size_t>(set) < std::size(kActionSetSizings)) {
+                for (size_t i = 0; i < kMaxSetSizings; ++i) {
+                    if (action != AbstractAction::UNKNOWN && kActionSetSizings[static_cast<size_t>(set)][i] == action) slot = static_cast<uint8_t>(4 + i);
+                }
+            }
+    }
+    return static_cast<uint8_t>((static_cast<uint8_t>(set) << 4) | slot);
+}
+
 struct ActionSpec {
     ActionType type;
     double value = 0.0; // e.g., 3.0 for BB/X, 50 for PCT, or absolute amount for ALL_IN
     SizingUnit unit = SizingUnit::BB; // Default unit, relevant for BET/RAISE
+    // Compact-history tag set by get_possible_action_specs (ignored by the comparisons)
+    ActionSetId action_set = ActionSetId::UNTAGGED;
+    AbstractAction abstract_action = AbstractAction::UNKNOWN;
 
     // Helper to convert to string (for compatibility or logging)
     std::string to_string() const;
@@ -37,6 +118,19 @@ struct ActionSpec {
 };
 
 
+// Human-readable names for compact histories, e.g. "open" and "raise_open_small".
+const char* action_set_name(ActionSetId set);
+const char* abstract_action_name(AbstractAction action);
+
+// Inverse of compact_history_byte (UNKNOWN for an unlisted slot or set).
+ActionSetId compact_history_set(uint8_t byte);
+AbstractAction compact_history_action(uint8_t byte);
+
+// Decodes a compact history (GameState::get_compact_history) into "raise_open_small/fold/call/"
+// form, the counterpart of GameState::get_history_string. With with_sets each action is
+// prefixed by its spot ("open:raise_open_small/").
+std::string describe_compact_history(const std::string& compact_history, bool with_sets = false);
+
 class ActionAbstraction {
 public:
     ActionAbstraction();
@@ -0,0 +1,71 @@
+#ifndef GTO_SOLVER_ACTION_BASELINES_H
+#define GTO_SOLVER_ACTION_BASELINES_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "regret_kernels.h" // kMaxFixedKernelActions
+
+namespace gto_solver {
+
+// Learned action values for variance-reduced MCCFR (TrainingOptions::action_baselines).
+// At a sampled opponent decision external sampling only sees the value u(a*) of the action it
+// sampled with probability q(a*) = sigma(a*). With a baseline b(a) per action the decision's value
+// estimate becomes
+//     sum_a sigma(a) * b(a) + sigma(a*) / q(a*) * (u(a*) - b(a*)) = sum_a sigma(a) * b(a) + u(a*) - b(a*)
+// which has the same expectation (b is read before this sample updates it) and a variance that
+// shrinks the better b predicts u. b(a) is the running mean of the values seen for a, shrunk toward
+// the mean over all actions as if that had been seen kPriorVisits times (a value learned from one
+// or two noisy samples predicts worse than the mean). Both means turn into exponential averages
+// after kWarmupVisits updates so they follow the strategies as they move.
+//
+// Direct-mapped table keyed by (infoset key, traversing player), since values are the traversing
+// player's. A key that takes over another's slot starts from zero baselines, i.e. the plain
+// estimate, so collisions cost variance but never bias. Decisions with more than kMaxActions
+// actions keep the plain estimate. Thread-safe: slots are guarded by striped locks.
+class ActionBaselines {
+public:
+    static constexpr size_t kMaxActions = kMaxFixedKernelActions;
+    static constexpr uint32_t kWarmupVisits = 32;
+    static constexpr double kPriorVisits = 4.0; // > 0; 4 beat 16 in fixed-deal variance runs
+
+    // slots is rounded up to a power of two; 0 releases the table.
+    void reset(size_t slots);
+    bool enabled() const { return !slots_.empty(); }
+
+    static uint64_t key_hash(const std::string& info_set_key, int traversing_player);
+
+    // Baseline-corrected value of a decision whose sampled action (drawn from strategy) returned
+    // sampled_value, as above; then folds sampled_value into that action's baseline.
+    double estimate(uint64_t hash, const double* strategy, size_t num_actions, size_t sampled, double sampled_value);
+
+    long long estimates() const { return estimates_.load(std::memory_order_relaxed); }
+    long long corrected() const { return corrected_.load(std::memory_order_relaxed); } // Estimates with a learned baseline
+    size_t memory_bytes() const { return slots_.size() * sizeof(Slot); }
+
+private:
+    struct Slot {
+        uint64_t tag = 0; // key hash | 1 (0 = empty)
+        double mean = 0.0; // Running mean of every sampled value: the baseline of actions not seen yet
+        uint32_t mean_visits = 0;
+        std::array<double, kMaxActions> values{};
+        std::array<uint32_t, kMaxActions> visits{};
+    };
+    static constexpr size_t kStripes = 64;
+
+    std::vector<Slot> slots_;
+    size_t mask_ = 0;
+    std::unique_ptr<std::mutex[]> stripes_;
+    std::atomic<long long> estimates_{0};
+    std::atomic<long long> corrected_{0};
+};
+
+} // namespace gto_solver
+
+#endif // GTO_SOLVER_ACTION_BASELINES_H
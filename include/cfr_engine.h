@@ -4,9 +4,31 @@
 #include "node.h" // Corrected include
 #include "action_abstraction.h" // Corrected include
 #include "hand_evaluator.h" // Corrected include
+#include "info_set.h" // Infoset keys of the decisions a traversal looks up
+#include "infoset_trie.h" // Pointer cache in front of the NodeMap
+#include "action_baselines.h" // Control variates for sampled opponent decisions
+#include "pot_layers.h" // Side pots of terminal states
+#include "training_metrics.h" // Per-thread hot-path counters
+#include "metrics_server.h" // Optional Prometheus endpoint
+#include "convergence_tracker.h" // Regret / strategy-delta telemetry
+#include "memory_budget.h" // Node storage accounting / --max-memory
+#include "cold_node_store.h" // Disk tier for evicted nodes
+#include "numa_topology.h" // Thread pinning / NUMA node pools
+#include "node_arena.h" // Huge-page policy for node slabs
+#include "regret_update_buffer.h" // Buffered update mode
+#include "traversal_arena.h" // Per-worker scratch memory for traversals
+#include "visit_sketch.h" // Deferred node materialisation
+#include "traversal_task.h" // Coroutines for interleaved traversals
+#include "shard_link.h" // Distributed (multi-process) training
+#include "shared_node_store.h" // Multi-process training on one machine
+#include <condition_variable>
+#include <deque>
 #include <string>
 #include <vector>
 #include <map> // For NodeMap
+#include <unordered_map>
+#include <memory_resource> // For std::pmr::vector
+#include <optional>
 #include <thread> // For std::thread
 #include <mutex>  // For std::mutex
 #include <atomic> // For std::atomic
@@ -26,39 +48,313 @@ struct StrategyInfo {
 };
 
 
+// Optional knobs for a training run that are not part of the game definition.
+struct TrainingOptions {
+    // Seconds between periodic "metrics" log lines; <= 0 disables them along with
+    // the per-phase timers (counters are always collected, they are almost free).
+    double metrics_interval_seconds = 30.0;
+    // If set, every metrics report is also appended as a row to this CSV file.
+    std::string metrics_csv_filename;
+    // If > 0, serve Prometheus metrics on http://127.0.0.1:<port>/metrics during training.
+    int metrics_port = 0;
+    // Emit convergence telemetry every N completed iterations (0 disables it).
+    long long convergence_interval = 0;
+    // Infosets whose average strategy is compared between convergence windows.
+    std::vector<std::string> convergence_watch_keys;
+    // Stop training early once the largest watched strategy change (L1) in a window is
+    // below this value (0 disables auto-stop).
+    double convergence_stop_threshold = 0.0;
+    // Upper bound for node + key storage in bytes (0 = unlimited). Once reached, no new
+    // nodes are created and unseen infosets are played with a uniform strategy.
+    size_t max_memory_bytes = 0;
+    // With max_memory_bytes set, evict cold nodes to this scratch file instead of refusing
+    // new nodes; evicted nodes are read back on demand (and prefetched per dealt hand).
+    std::string spill_filename;
+    // Pin worker threads to CPUs (compact: fill one NUMA node first, spread: round-robin over
+    // nodes). Pinned workers allocate their nodes from their own node's memory pool.
+    ThreadPlacement thread_placement = ThreadPlacement::NONE;
+    // Nodes created at depth < this are placed in memory interleaved over all NUMA nodes, since
+    // every worker reads the top of the tree (0 = all nodes local to their creator).
+    int numa_interleave_depth = 0;
+    // Back the node arena with huge pages (thp: madvise(MADV_HUGEPAGE) on 2 MB aligned chunks,
+    // explicit: MAP_HUGETLB, falling back to THP). Enables the arena even without pinning;
+    // falls back to 4 KB pages when the kernel offers neither.
+    HugePagePolicy huge_pages = HugePagePolicy::OFF;
+    // If > 0, workers buffer regret / strategy deltas in a thread-local table and merge them
+    // into the shared nodes every N of their iterations instead of locking each node on every
+    // update. Strategies read during traversal then lag by up to N iterations of the worker's
+    // own updates (0 = update nodes in place).
+    int update_buffer_interval = 0;
+    // If > 1, each worker deals this many hands at once (same button) and traverses them
+    // together: lanes that share a betting history share the action abstraction, one map
+    // lock for all their node lookups and one node lock per distinct infoset (1 = one deal
+    // per traversal).
+    int traversal_batch_size = 1;
+    // Clamp cumulative regrets at zero after every update (CFR+ regret matching). Off by
+    // default so existing checkpoints keep training the same way.
+    bool floor_regrets = false;
+    // If > 1 (and traversal_batch_size is 1), each worker runs this many deals as interleaved
+    // coroutine traversals, switching to another one whenever a traversal waits on a node
+    // prefetch (1 = one traversal at a time).
+    int interleaved_traversals = 1;
+    // If > 0, an infoset reached as a sampled opponent decision only gets a node once it has been
+    // reached this many times (counted in a count-min sketch, see VisitSketch); until then it is
+    // played uniformly, exactly as its fresh node would be. Traverser decisions always create
+    // their node since they are about to be updated. 0 = a node on first sight; at most 255.
+    int materialize_after_visits = 0;
+    // Traverse each deal once for all players instead of once per player (outcome sampling with
+    // simultaneous updates): every decision samples one action from the current strategy mixed
+    // with uniform exploration, the terminal returns every player's importance-weighted payoff,
+    // and each player's regrets are updated at its own nodes on the way back. One node lookup
+    // per decision on the sampled line, against a full subtree per player in external sampling;
+    // the estimates are noisier, so more iterations are needed for the same convergence.
+    // Takes precedence over traversal_batch_size / interleaved_traversals.
+    bool simultaneous_updates = false;
+    // Keep a public-state trie in front of the node map (see InfosetTrie): a decision seen before
+    // is reached by following child pointers from the root and indexing the hand, skipping the key
+    // build, the map search and the action abstraction. Costs the trie's memory on top of the
+    // nodes; applies to the scalar and simultaneous-update traversals and is not combined with
+    // max_memory_bytes.
+    bool infoset_trie = false;
+    // Variance-reduced external sampling: at each sampled opponent decision, correct the sampled
+    // value with learned per-action baselines (see ActionBaselines), so the actions not sampled
+    // count with their expected values instead of zero. Same expectation, lower variance; costs a
+    // fixed table of baselines. Applies to the external-sampling traversals (not batched lanes).
+    bool action_baselines = false;
+    // How infoset keys spell the betting history. ACTIONS keys are shorter and identical for
+    // every stack depth / ante that reaches the same abstract line, so a checkpoint trained at
+    // one depth can warm-start another. A loaded checkpoint (or an existing tree) keeps the
+    // encoding it was built with.
+    HistoryEncoding history_encoding = HistoryEncoding::CHIPS;
+    // Distributed training: one endpoint per shard process (2 or more enable it). Infosets are
+    // hash-partitioned over the shards; each process owns the regrets of its keys, sends the
+    // deltas of other shards' keys to their owners and keeps read-only replicas of them,
+    // refreshed asynchronously. Checkpoints are per shard ("<file>.shard<k>of<n>").
+    std::vector<ShardEndpoint> shard_endpoints;
+    int shard_id = 0;                  // This process's index into shard_endpoints
+    double shard_sync_seconds = 0.1;   // Interval between update / lookup batches sent to peers
+    // Multi-process training on one machine: worker processes forked from one parent all train
+    // against this store. Local nodes mirror their store entry: traversals read the store's
+    // regrets and every merge adds the buffered deltas to it (updates are always buffered).
+    // The caller owns the store and its checkpoints. Not combined with shard_endpoints.
+    SharedNodeStore* shared_store = nullptr;
+};
+
+
 class CFREngine {
 public:
     CFREngine();
     // Modified train signature to accept game parameters and number of threads
-    void train(int iterations, int num_players, int initial_stack, int ante_size = 0, int num_threads = 1, const std::string& save_filename = "", int checkpoint_interval = 0, const std::string& load_filename = "");
+    void train(int iterations, int num_players, int initial_stack, int ante_size = 0, int num_threads = 1, const std::string& save_filename = "", int checkpoint_interval = 0, const std::string& load_filename = "", const TrainingOptions& options = TrainingOptions());
     // std::vector<double> get_strategy(const std::string& info_set_key); // Deprecated, use get_strategy_info
     StrategyInfo get_strategy_info(const std::string& info_set_key) const; // New function
 
     // Checkpointing methods
     bool save_checkpoint(const std::string& filename) const;
     int load_checkpoint(const std::string& filename); // Returns number of iterations loaded, or -1 on error
+    HistoryEncoding history_encoding() const { return history_encoding_; } // Of the keys in the current tree
+
+    // Lock-free view of the training counters; safe to call from any thread while train() runs.
+    TrainingSnapshot get_training_snapshot() const;
+    // Publishes an exploitability estimate (exported by the metrics endpoint once set).
+    void report_exploitability(double value);
 
 private:
+    friend class CFREngineTestPeer; // test/cfr_engine_test.cpp: single traversals of hand-built spots
+
     NodeMap node_map_; // Stores regrets and strategies for each infoset
     std::mutex node_map_mutex_; // Mutex to protect access to node_map_ and Node data
     std::atomic<long long> total_nodes_created_{0};
     std::atomic<int> completed_iterations_{0};
     std::atomic<int> last_logged_percent_{-1};
     std::atomic<int> max_depth_reached_{0}; // Track max recursion depth
+    TrainingMetrics metrics_;                // Throughput / hot-path instrumentation for train()
+    bool timing_enabled_ = false;            // Cached metrics_.timing_enabled() for the hot path
+
+    // --- Run state exported through get_training_snapshot() ---
+    std::atomic<long long> target_iterations_{0};
+    std::atomic<long long> run_start_iteration_{0};
+    std::atomic<long long> run_start_ns_{0};        // steady_clock time of the train() call
+    std::atomic<int> threads_in_use_{0};
+    std::atomic<long long> checkpoints_written_{0};
+    std::atomic<long long> last_checkpoint_ns_{0};
+    std::atomic<long long> total_checkpoint_ns_{0};
+    std::atomic<bool> has_exploitability_{false};
+    std::atomic<double> exploitability_{0.0};
+    std::atomic<long long> scratch_heap_allocations_{0}; // Traversal-arena blocks taken after warm-up (should stay 0)
+    std::atomic<size_t> scratch_peak_bytes_{0};          // Largest traversal-arena high-water mark of any worker
+    MetricsServer metrics_server_;
+
+    ConvergenceTracker convergence_;
+    bool convergence_enabled_ = false;          // Cached convergence_.enabled() for the hot path
+    bool floor_regrets_ = false;                // TrainingOptions::floor_regrets
+    HistoryEncoding history_encoding_ = HistoryEncoding::CHIPS; // Encoding of the keys in node_map_ (saved in checkpoints)
+    std::atomic<bool> stop_requested_{false};  // Set by auto-stop; workers exit at the next iteration
+
+    double total_positive_regret() const;       // Scans the node map (locks it)
+
+    MemoryBudget memory_budget_;                // Bytes used by node / key storage
+    void start_memory_budget(size_t limit_bytes, double report_interval_seconds); // Accounts the existing map
+
+    // --- Tiered store (hot NodeMap + ColdNodeStore on disk) ---
+    mutable ColdNodeStore cold_store_;
+    bool spill_enabled_ = false;                // Pin / fault / prefetch on the hot path
+    std::atomic<uint32_t> touch_sweep_{1};      // Current eviction sweep (stamped on touched nodes)
+    std::string clock_hand_;                    // Key where the next eviction sweep resumes
+    std::thread tier_thread_;                   // Evictor + prefetcher
+    std::atomic<bool> tier_running_{false};
+    std::mutex tier_mutex_;                     // Protects prefetch_queue_
+    std::condition_variable tier_cv_;
+    std::deque<std::string> prefetch_queue_;    // Key prefixes to bring back from disk
+
+    // --- Distributed training (TrainingOptions::shard_endpoints) ---
+    // Nodes of keys owned by another shard are replicas: traversals read their regrets (as of
+    // the owner's last LOOKUP_REPLY) and buffer updates as usual, and merge_update_buffer()
+    // forwards the buffered deltas to the owner. Lock order: node_map_mutex_, then shard_mutex_.
+    struct RemoteReplica {
+        const std::string* key;  // The node_map_ key (stable while the node lives)
+        uint32_t owner;
+        bool lookup_pending;     // Already queued in shard_lookups_
+    };
+    ShardLink shard_link_;
+    int shard_id_ = 0;
+    int num_shards_ = 1;                        // 1 = not distributed
+    std::mutex shard_mutex_;                    // Protects the members below
+    std::unordered_map<const Node*, RemoteReplica> remote_replicas_;
+    std::vector<ShardPayloads> shard_updates_;  // Per owner: node records of regret / strategy deltas
+    std::vector<ShardPayloads> shard_lookups_;  // Per owner: keys to fetch current regrets for
+    std::vector<const Node*> pending_lookups_;  // Replicas whose lookup_pending flag is set
+    bool owns_key(const std::string& key) const { return num_shards_ <= 1 || shard_of(key, num_shards_) == static_cast<size_t>(shard_id_); }
+    void register_remote_replica_locked(const std::string& key, const Node* node); // Caller holds node_map_mutex_
+    void queue_lookup_locked(const Node* node, RemoteReplica& replica);           // Caller holds shard_mutex_
+    void export_remote_deltas(const RegretUpdateBuffer& buffer);
+    ShardLink::Handlers shard_handlers();
+    void apply_shard_updates(const std::string& payload);
+    std::string answer_shard_lookup(const std::string& payload);
+    void install_shard_reply(const std::string& payload);
+
+    SharedNodeStore* shared_store_ = nullptr;   // TrainingOptions::shared_store
+    void export_shared_deltas(const RegretUpdateBuffer& buffer);
+
+    // --- Deferred node materialisation (TrainingOptions::materialize_after_visits) ---
+    int materialize_after_visits_ = 0;          // 0 = off
+    VisitSketch visit_sketch_;                  // Opponent visits of unstored infosets; under node_map_mutex_
+    std::atomic<long long> deferred_lookups_{0}; // Lookups answered with a uniform strategy instead of a new node
+
+    // --- Infoset trie (TrainingOptions::infoset_trie) ---
+    InfosetTrie trie_;                          // Under node_map_mutex_; cleared around every run
+    bool trie_enabled_ = false;
+    std::atomic<bool> has_trie_totals_{false};  // Totals of the last run with the trie, kept after the clear
+    std::atomic<long long> trie_entries_{0};
+    std::atomic<long long> trie_hits_{0};
+    // Where a traversal is in the trie: the vertex of the previous decision and the edge taken
+    // from it (at the root no vertex and the button seat). Inactive: look nodes up by key only.
+    struct TrieLink {
+        bool active = false;
+        InfosetTrie::Vertex* parent = nullptr;
+        uint64_t edge = 0;
+    };
+    // The node of one decision (see lookup_decision). On a trie hit key and actions point into
+    // the NodeMap and the node; otherwise into info_set and the menu the node was looked up with.
+    struct DecisionLookup {
+        Node* node = nullptr;                           // nullptr: unstored, play actions uniformly
+        const std::string* key = nullptr;
+        const std::vector<ActionSpec>* actions = nullptr;
+        InfosetTrie::Vertex* vertex = nullptr;          // Set when actions are the vertex's menu
+        std::optional<InfoSet> info_set;
+        std::vector<ActionSpec> fresh_actions;
+    };
+
+    // --- Variance reduction (TrainingOptions::action_baselines) ---
+    ActionBaselines baselines_;                 // Disabled (empty) unless the option is set
+    std::atomic<bool> has_baseline_totals_{false}; // Counters of the last run with baselines, kept after the reset
+    std::atomic<long long> baseline_estimates_{0};
+    std::atomic<long long> baseline_corrected_{0};
+
+    int numa_interleave_depth_ = 0;             // Cached TrainingOptions::numa_interleave_depth
+    std::vector<int> plan_numa_placement(const TrainingOptions& options, unsigned int threads); // CPU per worker
+    void merge_update_buffer(RegretUpdateBuffer& buffer, ThreadCounters& counters); // Buffered update mode
+
+    void tier_maintenance_loop();
+    size_t evict_cold_nodes();                  // Returns the number of nodes evicted
+    void prefetch_prefix(const std::string& prefix);
+    void request_prefetch(std::string prefix);
+    void stop_tier_thread();
+    void log_tier_summary();
+    void report_convergence(long long iterations);
+
+    // Saves to a temp file and renames it over filename, recording the save duration.
+    void save_checkpoint_atomically(const std::string& filename, const std::string& temp_filename, const char* log_prefix);
 
     ActionAbstraction action_abstraction_;
     HandEvaluator hand_evaluator_;       // To evaluate terminal states
 
+    // One deal of a batched traversal (see cfr_batch_recursive). Lanes and their reach arrays
+    // live in traversal_resource(); build reach with that resource, since copies of a pmr vector
+    // fall back to the heap.
+    struct TraversalLane {
+        GameState state;
+        const std::vector<Card>* deck = nullptr; // The lane's shuffled deck (hands dealt from its front)
+        int card_idx = 0;                  // Next undealt card of deck
+        std::pmr::vector<double> reach;    // Reach probability per player
+    };
+
+    double terminal_payoff(const GameState& state, int traversing_player);
+    double terminal_payoff(const GameState& state, const PotLayers& pots, int traversing_player);
+    void terminal_payoffs(const GameState& state, const PotLayers& pots, double* payoffs); // num_players values
+    bool advance_state(GameState& state, const ActionSpec& action_spec, int current_player, const std::vector<Card>& deck,
+                       int& card_idx, const std::string& info_set_key, ThreadCounters& counters);
+    bool advance_state(GameState& state, const ActionSpec& action_spec, int amount, int current_player, const std::vector<Card>& deck,
+                       int& card_idx);
+    // Finds (or creates) the node of current_player's infoset, through the trie when link is active.
+    // Returns false if the state offers no action.
+    bool lookup_decision(const GameState& state, int current_player, int depth, bool defer_new, const TrieLink& link,
+                         DecisionLookup& decision, ThreadCounters& counters);
+    // advance_state for action slot of a looked-up decision (amount from its trie vertex if it has
+    // one); child becomes the trie link of the resulting state.
+    bool advance_decision(GameState& state, const DecisionLookup& decision, size_t slot, int current_player,
+                          const std::vector<Card>& deck, int& card_idx, TrieLink& child, ThreadCounters& counters);
+    void record_node_visit(Node* node_ptr, ThreadCounters& counters);
+    void current_strategy_of(Node* node_ptr, const std::string& info_set_key, size_t node_num_actions, double* current_strategy, ThreadCounters& counters);
+    void update_traversed_node(Node* node_ptr, const std::string& info_set_key, size_t node_num_actions,
+                               const double* action_utilities, double node_utility, const double* current_strategy,
+                               const std::pmr::vector<double>& reach_probabilities, int current_player, ThreadCounters& counters);
+    Node* find_or_create_node_locked(const std::string& key, const std::vector<ActionSpec>& legal_action_specs, int depth, ThreadCounters& counters,
+                                     bool defer_new = false, const std::string** stored_key = nullptr);
+
     // Recursive CFR+ function - now a private member
     double cfr_plus_recursive(
         GameState current_state,
         int traversing_player,
-        const std::vector<double>& reach_probabilities,
+        const std::pmr::vector<double>& reach_probabilities, // Traversal-arena backed (traversal_arena.h)
         std::vector<Card>& deck,
         int& card_idx,
         std::mt19937& rng,
-        int depth = 0            // Add depth parameter
+        int depth,               // Add depth parameter
+        TrieLink trie_link       // Where current_state is in the infoset trie
     );
+
+    // Simultaneous-update traversal (TrainingOptions::simultaneous_updates). sample_prob is the
+    // probability the sampling policy reached current_state. Writes every player's payoff at the
+    // sampled terminal divided by its sampling probability to utilities (num_players values) and
+    // returns the probability of the rest of the sampled line under the current strategy.
+    double cfr_simultaneous_recursive(GameState current_state, const std::pmr::vector<double>& reach_probabilities,
+                                      double sample_prob, std::vector<Card>& deck, int& card_idx, std::mt19937& rng,
+                                      int depth, double* utilities, TrieLink trie_link);
+
+    // Batched external-sampling traversal. All lanes share the betting history so far (they
+    // differ only in cards); lanes split into groups where opponents sample different actions.
+    // Returns the traversing player's utility per lane.
+    std::pmr::vector<double> cfr_batch_recursive(const std::pmr::vector<TraversalLane>& lanes, int traversing_player, std::mt19937& rng, int depth);
+
+    // Interleaved mode: each worker runs several deals as coroutine strands and switches
+    // strands after prefetching a node, hiding its cache misses behind the other strands' work.
+    // Reference parameters must outlive the returned task (they live in the awaiting frame).
+    TraversalTask cfr_interleaved(TraversalStrand& strand, GameState current_state, int traversing_player,
+                                  const std::pmr::vector<double>& reach_probabilities, const std::vector<Card>& deck,
+                                  int card_idx, std::mt19937& rng, int depth);
+    TraversalTask interleaved_deal(TraversalStrand& strand, GameState root_state, const std::vector<Card>& deck,
+                                   int card_index, std::mt19937& rng, int thread_id);
 };
 
 } // namespace gto_solver
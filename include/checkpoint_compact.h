@@ -0,0 +1,47 @@
+#ifndef GTO_SOLVER_CHECKPOINT_COMPACT_H
+#define GTO_SOLVER_CHECKPOINT_COMPACT_H
+
+#include "game_state.h"         // For HistoryEncoding
+#include "node_serialization.h" // For CheckpointKeyOrder
+#include <cstddef>
+#include <string>
+
+namespace gto_solver {
+
+bool parse_key_order(const std::string& text, CheckpointKeyOrder& order); // "tree" | "sorted"
+
+// Public-tree depth-first order of infoset keys ("P<seat>:<hand>|<street>|<board>|<history>"):
+// by betting history, compared action by action so that a line comes right before the lines
+// that extend it; then by board, street and seat / hand. A traversal walks down the history,
+// so nodes loaded in this order sit next to the nodes of the lines it reaches from them.
+bool compare_tree_order(const std::string& a, const std::string& b, HistoryEncoding encoding);
+
+struct CheckpointCompactOptions {
+    int min_visits = 0;            // Drop infosets visited fewer times (0 = keep all)
+    double min_regret_mass = 0.0;  // Drop infosets whose sum_a max(0, regret) is smaller (0 = keep all)
+    CheckpointKeyOrder key_order = CheckpointKeyOrder::TREE;
+};
+
+struct CheckpointCompactStats {
+    size_t records_read = 0;
+    size_t records_written = 0;
+    size_t pruned_visits = 0;       // Dropped by min_visits
+    size_t pruned_regret = 0;       // Dropped by min_regret_mass (and not by min_visits)
+    size_t bytes_read = 0;
+    size_t bytes_written = 0;
+    double seconds = 0.0;
+};
+
+// Rewrites the checkpoint at input as a current-version checkpoint at output without the
+// infosets below the thresholds, in options.key_order. A dropped infoset is folded into the
+// uniform strategy: training recreates it as a fresh node (which plays uniformly) if it is
+// reached again, and strategy lookups report it as not found. The engine allocates nodes in
+// file order when loading, so a tree-ordered checkpoint also lays the nodes out in memory in
+// traversal order. Reads the input twice (keys first, then records in output order) and keeps
+// only the surviving keys in memory. Logs and returns false on any error.
+bool compact_checkpoint(const std::string& input, const std::string& output, const CheckpointCompactOptions& options,
+                        CheckpointCompactStats* stats = nullptr);
+
+} // namespace gto_solver
+
+#endif // GTO_SOLVER_CHECKPOINT_COMPACT_H
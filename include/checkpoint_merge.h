@@ -0,0 +1,44 @@
+#ifndef GTO_SOLVER_CHECKPOINT_MERGE_H
+#define GTO_SOLVER_CHECKPOINT_MERGE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace gto_solver {
+
+enum class MergeMode {
+    SUM,     // out = sum_i w_i * x_i (replicas trained with different seeds, or shards of one run)
+    AVERAGE  // out = sum_i w_i * x_i / sum_i w_i
+};
+
+bool parse_merge_mode(const std::string& text, MergeMode& mode); // "sum" | "average"
+
+struct CheckpointMergeOptions {
+    std::vector<std::string> inputs;  // Checkpoints of version CHECKPOINT_VERSION_OLDEST or newer
+    std::vector<double> weights;      // One per input (empty = 1 each)
+    MergeMode mode = MergeMode::SUM;
+    int partitions = 1;               // Key ranges merged by parallel threads
+};
+
+struct CheckpointMergeStats {
+    size_t records_read = 0;
+    size_t keys_written = 0;
+    size_t action_mismatches = 0;     // Records skipped: same key, different legal actions
+    size_t bytes_read = 0;
+    size_t bytes_written = 0;
+    double seconds = 0.0;
+};
+
+// Combines checkpoints key by key into a current-version checkpoint at output: regret sums,
+// strategy sums, visit counts and completed iterations are combined per options.mode. Inputs
+// are streamed in a k-way merge over their (sorted) keys, holding one record per input, so
+// memory does not grow with checkpoint size. With partitions > 1, the inputs are first scanned
+// for a sparse key index, the key space is split into ranges of similar record counts, and each
+// range is merged by its own thread into a part file that is then appended to the output.
+// All inputs must use the same history encoding. Logs and returns false on any error.
+bool merge_checkpoints(const CheckpointMergeOptions& options, const std::string& output, CheckpointMergeStats* stats = nullptr);
+
+} // namespace gto_solver
+
+#endif // GTO_SOLVER_CHECKPOINT_MERGE_H
@@ -0,0 +1,98 @@
+#ifndef GTO_SOLVER_COLD_NODE_STORE_H
+#define GTO_SOLVER_COLD_NODE_STORE_H
+
+#include "node.h"
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace gto_solver {
+
+// Counters of the tiered node store (all monotonic over one training run).
+struct ColdStoreStats {
+    long long cold_nodes = 0;      // Nodes currently on disk or staged
+    long long evicted = 0;         // Nodes written out by the evictor
+    long long faults = 0;          // Hot-map misses served from the cold tier
+    long long prefetched = 0;      // Nodes brought back by the prefetcher
+    long long bytes_written = 0;
+    long long bytes_read = 0;
+    long long dead_bytes = 0;      // Log bytes of records that were faulted back in
+};
+
+// Cold tier of the node store: an append-only log file of node records (node_serialization.h)
+// plus a sorted in-memory index key -> (offset, length). Records are never rewritten; a node
+// brought back to RAM simply leaves a dead record behind.
+//
+// Nodes move through a "staged" area while in transit (being evicted, or prefetched but not yet
+// inserted into the hot map), so a key is always findable in exactly one place.
+// All methods are thread-safe (one internal mutex). Lock order: NodeMap mutex before this one.
+class ColdNodeStore {
+public:
+    ColdNodeStore() = default;
+    ~ColdNodeStore();
+    ColdNodeStore(const ColdNodeStore&) = delete;
+    ColdNodeStore& operator=(const ColdNodeStore&) = delete;
+
+    // Creates (truncates) the spill file. Returns false and logs on failure.
+    bool open(const std::string& path);
+    // Closes and deletes the spill file, dropping all cold nodes.
+    void close();
+    bool is_open() const { return fd_ >= 0; }
+
+    // Hands a node evicted from the hot map to the cold tier (kept in memory until flush_staged()).
+    void stage(std::string key, std::unique_ptr<Node> node);
+    // Appends every staged eviction to the log. Returns the number of records written.
+    size_t flush_staged();
+
+    // Removes the node for key from the cold tier and returns it (nullptr if not cold).
+    // count_fault is false when the prefetcher (not a worker miss) brings the node back.
+    std::unique_ptr<Node> take(const std::string& key, bool count_fault = true);
+    // Reads a copy of the node without removing it (nullptr if not cold).
+    std::unique_ptr<Node> peek(const std::string& key);
+
+    // Prefetch: moves up to max_nodes on-disk records whose key starts with prefix into the
+    // staged area and appends their keys to staged_keys. Returns the number staged.
+    size_t stage_prefix(const std::string& prefix, size_t max_nodes, std::vector<std::string>& staged_keys);
+    // Counts nodes the prefetcher moved back into the hot map.
+    void note_prefetched(size_t count) { prefetched_.fetch_add(count, std::memory_order_relaxed); }
+
+    // All cold keys (on disk or staged) in sorted order, for checkpoint merging.
+    std::vector<std::string> sorted_keys() const;
+    size_t size() const;
+
+    ColdStoreStats stats() const;
+
+private:
+    struct Entry {
+        uint64_t offset;
+        uint32_t length;
+    };
+    struct StagedNode {
+        std::unique_ptr<Node> node;
+        bool needs_write;  // true for evictions, false for prefetched records already read back
+    };
+
+    std::unique_ptr<Node> read_entry(const std::string& key, const Entry& entry); // Caller holds mutex_
+
+    mutable std::mutex mutex_;
+    int fd_ = -1;
+    std::string path_;
+    uint64_t end_offset_ = 0;
+    std::map<std::string, Entry> index_;                      // Sorted for prefix scans / merges
+    std::map<std::string, StagedNode> staged_;                 // In transit (see class comment)
+
+    std::atomic<long long> evicted_{0};
+    std::atomic<long long> faults_{0};
+    std::atomic<long long> prefetched_{0};
+    std::atomic<long long> bytes_written_{0};
+    std::atomic<long long> bytes_read_{0};
+    std::atomic<long long> dead_bytes_{0};
+};
+
+} // namespace gto_solver
+
+#endif // GTO_SOLVER_COLD_NODE_STORE_H
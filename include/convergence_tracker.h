@@ -0,0 +1,72 @@
+#ifndef GTO_SOLVER_CONVERGENCE_TRACKER_H
+#define GTO_SOLVER_CONVERGENCE_TRACKER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace gto_solver {
+
+// Result of one convergence window (emitted every `interval` iterations).
+struct ConvergenceReport {
+    long long iterations = 0;
+    double mean_positive_regret = 0.0;  // Sum over nodes of sum_a max(0, regret), divided by node count
+    double mean_strategy_delta = 0.0;   // Mean L1 change of the average strategy over watched infosets
+    double max_strategy_delta = 0.0;    // Largest L1 change over watched infosets
+    int watched_compared = 0;           // Watched infosets present in both this and the previous window
+    double visited_fraction = 0.0;      // Share of nodes visited at least once during the window
+    bool converged = false;             // max_strategy_delta fell below the stop threshold
+};
+
+// Cheap convergence signals for CFREngine::train. The hot path only feeds per-thread
+// counters (see ThreadCounters); everything else runs on one thread once per window.
+class ConvergenceTracker {
+public:
+    // Returns the average strategy for a key, or an empty vector if the infoset does not exist.
+    using StrategyLookup = std::function<std::vector<double>(const std::string&)>;
+
+    // interval_iterations <= 0 disables the tracker. stop_threshold <= 0 disables auto-stop.
+    // initial_positive_regret is the positive regret already in the node map (e.g. from a checkpoint).
+    void start(long long interval_iterations, std::vector<std::string> watch_keys, double stop_threshold,
+               double initial_positive_regret, long long starting_iteration);
+
+    bool enabled() const { return interval_ > 0; }
+
+    // Window id stamped on nodes to count first visits; starts at 1 so fresh nodes (0) count.
+    uint32_t current_window() const { return window_.load(std::memory_order_relaxed); }
+
+    bool report_due(long long iterations) const { return enabled() && iterations - last_report_iteration_ >= interval_; }
+
+    // Closes the current window: computes the signals, logs them, and opens the next window.
+    // positive_regret_delta and first_visits are the run totals summed over all workers.
+    ConvergenceReport report(long long iterations, long long total_nodes, double positive_regret_delta,
+                             uint64_t first_visits, const StrategyLookup& lookup);
+
+    // Latest values, readable from any thread (used by the metrics endpoint).
+    bool has_report() const { return has_report_.load(std::memory_order_acquire); }
+    double last_mean_positive_regret() const { return last_mean_positive_regret_.load(std::memory_order_relaxed); }
+    double last_max_strategy_delta() const { return last_max_strategy_delta_.load(std::memory_order_relaxed); }
+    double last_visited_fraction() const { return last_visited_fraction_.load(std::memory_order_relaxed); }
+
+private:
+    long long interval_ = 0;
+    double stop_threshold_ = 0.0;
+    double initial_positive_regret_ = 0.0;
+    long long last_report_iteration_ = 0;
+    uint64_t last_first_visits_ = 0;
+    std::vector<std::string> watch_keys_;
+    std::map<std::string, std::vector<double>> previous_strategies_; // Watched key -> average strategy
+    std::atomic<uint32_t> window_{1};
+
+    std::atomic<bool> has_report_{false};
+    std::atomic<double> last_mean_positive_regret_{0.0};
+    std::atomic<double> last_max_strategy_delta_{0.0};
+    std::atomic<double> last_visited_fraction_{0.0};
+};
+
+} // namespace gto_solver
+
+#endif // GTO_SOLVER_CONVERGENCE_TRACKER_H
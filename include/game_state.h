@@ -3,7 +3,10 @@
 
 #include <vector>
 #include <string>
-#include <cstdint> // For uint8_t
+#include <cstddef> // For size_t
+#include <cstdint> // For uint8_t, uint16_t
+
+#include "action_abstraction.h" // ActionSetId / AbstractAction tags of the compact history
 
 namespace gto_solver {
 
@@ -26,11 +29,26 @@ struct Action {
     Type type;
     int amount = 0; // Amount for RAISE or BET
     int player_index = -1; // Index of the player who took the action
+    // Abstraction tag copied from the ActionSpec that produced the action (compact history)
+    ActionSetId action_set = ActionSetId::UNTAGGED;
+    AbstractAction abstract_action = AbstractAction::UNKNOWN;
+};
+
+// How infoset keys spell the action history.
+enum class HistoryEncoding : uint8_t {
+    CHIPS,   // get_history_string(): "r5/c/b12/", exact chip amounts
+    ACTIONS  // get_compact_history(): one (action-set id, slot) byte per action
 };
 
+bool parse_history_encoding(const std::string& text, HistoryEncoding& encoding); // "chips" | "actions"
+const char* history_encoding_name(HistoryEncoding encoding);
+
 // Represents the state of the game at a specific point
 class GameState {
 public:
+    static constexpr int kMaxPlayers = 16; // Per-player flags are bits of a uint16_t
+
+
     // Constructor now includes ante size and button position
     // Button position defaults to 0 for HU, otherwise should be specified.
     GameState(int num_players = 2, int initial_stack = 100, int ante_size = 0, int button_position = 0);
@@ -60,11 +78,17 @@ public:
     // --- Modifiers ---
     void deal_hands(const std::vector<std::vector<Card>>& hands);
     void deal_community_cards(const std::vector<Card>& cards);
+    void deal_community_cards(const Card* cards, size_t count); // E.g. straight from a shuffled deck
     void apply_action(const Action& action); // Apply an action and update the state
     void advance_to_next_street(); // Move to the next betting round
 
     // --- Utility ---
     std::string get_history_string() const; // Get a string representation of the action history
+    // One compact_history_byte (action-set id, slot) per action. Independent of stack depth
+    // and ante; describe_compact_history() turns it back into text. Untagged actions keep
+    // their fold / check / call meaning and encode bets and raises as unlisted.
+    std::string get_compact_history() const;
+    std::string get_history(HistoryEncoding encoding) const;
     int get_effective_stack(int player_index) const; // Smallest stack among active players including player_index
     int get_raises_this_street() const; // Count number of raises in the current street's history
     bool is_first_to_act_preflop(int player_index) const; // Check if player is first voluntary actor preflop
@@ -84,18 +108,26 @@ private:
     int last_raise_size_; // Size of the last bet/raise increment in the current street
     int aggressor_this_round_; // Index of last player to bet/raise this street (-1 if none)
     int actions_this_round_;   // Number of actions taken since last aggression or start of street
-    std::vector<bool> player_folded_; // Tracks if a player has folded
-    std::vector<bool> player_all_in_; // Tracks if a player is all-in
+    uint16_t all_players_mask_; // Bit i set for every seat i < num_players_
+    uint16_t player_folded_mask_; // Bit i: player i has folded
+    uint16_t player_all_in_mask_; // Bit i: player i is all-in
     std::vector<int> player_contributions_; // Total contributed by each player this hand
     int ante_size_; // Size of the ante
     int button_position_; // Index of the player on the button
-    std::vector<bool> player_acted_this_sequence_; // Tracks if player acted since last aggression/start of street
+    uint16_t player_acted_mask_; // Bit i: player i acted since last aggression/start of street
 
     // Helper methods
     // Now takes SB/BB indices and amounts
     void post_antes_and_blinds(int sb_index, int bb_index, int sb_amount, int bb_amount);
     void update_next_player();
     void reset_bets_for_new_street();
+    bool betting_round_closed() const; // Every player who can act has matched the top bet and acted (incl. BB option)
+
+    static uint16_t player_bit(int player_index) { return static_cast<uint16_t>(1u << player_index); }
+    uint16_t players_in_hand_mask() const { return all_players_mask_ & ~player_folded_mask_; }
+    uint16_t players_can_act_mask() const { return players_in_hand_mask() & ~player_all_in_mask_; }
+    // First seat in mask at or after from, going round the table (-1 if the mask is empty).
+    int next_player_in(uint16_t mask, int from) const;
 };
 
 } // namespace gto_solver
@@ -8,6 +8,9 @@
 
 namespace gto_solver {
 
+// "As" / "Td" to PokerHandEvaluator's card index (rank * 4 + suit, 0-51), -1 if invalid.
+int convert_string_to_phe_card_index(const std::string& card_str);
+
 class HandEvaluator {
 public:
     HandEvaluator(); // Constructor might not be needed anymore
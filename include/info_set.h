@@ -15,9 +15,10 @@ namespace gto_solver {
 class InfoSet {
 public:
     // Constructor for use during CFR traversal (uses current state)
-    InfoSet(const GameState& current_state, int player_index);
+    InfoSet(const GameState& current_state, int player_index, HistoryEncoding encoding = HistoryEncoding::CHIPS);
 
-    // Constructor for use during extraction (specify hand and history)
+    // Constructor for use during extraction (specify hand and history, already in the
+    // encoding the tree was keyed with)
     InfoSet(const std::vector<Card>& private_hand, const std::string& action_history, const GameState& state_for_context, int player_index);
 
     // Getters
@@ -31,6 +32,10 @@ public:
     // This will regenerate the key based on the new hand.
     void set_hand(const std::vector<Card>& hand);
 
+    // Leading part of every key for this player and hand ("P{player}:{sorted hand}|").
+    // All infosets of one player holding one hand share it (used for prefix prefetching).
+    static std::string key_prefix(int player_index, const std::vector<Card>& private_hand);
+
     // Equality operator for map comparisons (compares keys)
     bool operator==(const InfoSet& other) const;
 
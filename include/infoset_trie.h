@@ -0,0 +1,107 @@
+#ifndef GTO_SOLVER_INFOSET_TRIE_H
+#define GTO_SOLVER_INFOSET_TRIE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "action_abstraction.h" // ActionSpec
+
+namespace gto_solver {
+
+struct Node;
+
+// Open-addressing table from 64-bit codes to small values (linear probing, at most half full).
+// UINT64_MAX is reserved as the empty slot.
+template <typename Value>
+class FlatIndex {
+public:
+    const Value* find(uint64_t key) const;
+    Value& find_or_insert(uint64_t key); // A new slot holds Value{}; references last until the next insert
+    size_t size() const { return size_; }
+    size_t memory_bytes() const { return keys_.capacity() * sizeof(uint64_t) + values_.capacity() * sizeof(Value); }
+
+private:
+    static constexpr uint64_t kEmpty = UINT64_MAX;
+    std::vector<uint64_t> keys_;
+    std::vector<Value> values_;
+    size_t size_ = 0;
+
+    size_t slot_of(uint64_t key) const; // Slot holding key, or the empty slot where it would go
+    void grow();
+};
+
+// Public-state tree of a training run, kept in front of the NodeMap (TrainingOptions::infoset_trie).
+// A vertex is what every player has seen: the button seat, the actions taken and the board cards
+// dealt, so everything hand-independent about a decision is stored once per vertex: the action
+// menu of the abstraction, the chip amount of each of its actions, and one child pointer per
+// (action slot, cards dealt) edge. Infosets are the vertex plus the acting player's hand; each
+// hand looked up at the vertex keeps its node and NodeMap key. A repeat visit therefore follows
+// pointers and indexes the hand: no key string, no map search, no abstraction call.
+//
+// Nodes and keys are borrowed from the NodeMap, which must not erase them while the trie lives
+// (the engine clears it around every training run and never combines it with eviction).
+// Not thread-safe: the engine calls it under the node map lock, where the node lookup it
+// replaces already runs.
+class InfosetTrie {
+public:
+    struct Entry {
+        Node* node = nullptr;
+        const std::string* key = nullptr; // The NodeMap key of node
+    };
+
+    class Vertex {
+    public:
+        bool has_actions() const { return has_actions_; }
+        const std::vector<ActionSpec>& actions() const { return actions_; }
+        const std::vector<int>& amounts() const { return amounts_; } // get_action_amount per action (-1: none)
+
+    private:
+        friend class InfosetTrie;
+        bool has_actions_ = false;
+        std::vector<ActionSpec> actions_;
+        std::vector<int> amounts_;
+        FlatIndex<Vertex*> children_;
+        FlatIndex<Entry> infosets_;
+    };
+
+    // Root of the tree for one button seat; child along an edge. Both create the vertex on
+    // first use.
+    Vertex* root(uint64_t button);
+    Vertex* child(Vertex* parent, uint64_t edge);
+
+    // Action menu of a vertex, set once (later calls are ignored); amounts holds one value per action.
+    void set_actions(Vertex* vertex, std::vector<ActionSpec> actions, std::vector<int> amounts);
+
+    // Node of the hand at the vertex (nullptr if it has not been cached there).
+    const Entry* find(const Vertex* vertex, uint64_t hand);
+    void insert(Vertex* vertex, uint64_t hand, const Entry& entry);
+
+    void clear();
+
+    size_t vertices() const { return vertices_.size(); }
+    size_t entries() const { return entries_; }
+    size_t hits() const { return hits_; }     // find() calls that returned an entry
+    size_t misses() const { return misses_; }
+    size_t memory_bytes() const;              // Approximate heap footprint of the vertices
+
+private:
+    std::deque<Vertex> vertices_; // Stable addresses
+    FlatIndex<Vertex*> roots_;
+    size_t entries_ = 0;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+
+    Vertex* new_vertex();
+};
+
+// Edge and hand codes (cards as convert_string_to_phe_card_index numbers, 0-51).
+// An edge is the action slot plus the board cards its action dealt (in any order).
+uint64_t trie_edge_code(size_t action_slot, const int* dealt_cards, size_t num_dealt);
+uint64_t trie_hand_code(int card_a, int card_b);
+
+} // namespace gto_solver
+
+#endif // GTO_SOLVER_INFOSET_TRIE_H
@@ -0,0 +1,70 @@
+#ifndef GTO_SOLVER_MEMORY_BUDGET_H
+#define GTO_SOLVER_MEMORY_BUDGET_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace gto_solver {
+
+// Parses a byte size such as "512M", "8G", "1.5g" or "1048576" (suffixes K/M/G/T, powers of 1024).
+// Returns false if the string is not a valid size.
+bool parse_memory_size(const std::string& text, size_t& bytes);
+
+// Approximate heap footprint of one NodeMap entry with num_actions actions: the tree node and
+// the Node with its regret / strategy / action vectors (including allocator overhead).
+size_t estimate_node_bytes(size_t num_actions);
+// Heap bytes of a key string beyond the map entry (0 for keys in the inline SSO buffer).
+size_t estimate_key_bytes(const std::string& key);
+
+// Tracks bytes used by node and key storage against an optional budget, and projects when the
+// budget will be reached from the recent growth rate. Charges happen under the NodeMap mutex;
+// readers (reports, metrics endpoint) only load atomics.
+class MemoryBudget {
+public:
+    // limit_bytes == 0 means unlimited (accounting still runs, it is cheap).
+    // Resets the usage to the given totals (e.g. the node map restored from a checkpoint).
+    void start(size_t limit_bytes, size_t node_bytes, size_t key_bytes, double report_interval_seconds);
+
+    bool limited() const { return limit_bytes_ > 0; }
+    size_t limit_bytes() const { return limit_bytes_; }
+    size_t used_bytes() const { return node_bytes_.load(std::memory_order_relaxed) + key_bytes_.load(std::memory_order_relaxed); }
+    size_t node_bytes() const { return node_bytes_.load(std::memory_order_relaxed); }
+    size_t key_bytes() const { return key_bytes_.load(std::memory_order_relaxed); }
+
+    // True if another allocation of `bytes` still fits. Logs once when the budget is first hit.
+    bool can_allocate(size_t bytes);
+    bool exhausted() const { return exhausted_.load(std::memory_order_relaxed); }
+    void charge(size_t node_bytes, size_t key_bytes);
+    void release(size_t node_bytes, size_t key_bytes); // Node left memory (e.g. evicted to disk)
+
+    // Counts lookups that fell back to a uniform strategy because no node could be created.
+    void note_uniform_fallback() { uniform_fallbacks_.fetch_add(1, std::memory_order_relaxed); }
+    long long uniform_fallbacks() const { return uniform_fallbacks_.load(std::memory_order_relaxed); }
+
+    // Seconds until the budget is reached at the recent growth rate (< 0 if unknown / not growing).
+    double seconds_to_limit() const { return seconds_to_limit_.load(std::memory_order_relaxed); }
+
+    // Updates the growth projection and logs it once per interval. Polled by one thread.
+    void maybe_report(long long total_nodes);
+
+    // End-of-run summary including bytes per node.
+    void log_summary(long long total_nodes) const;
+
+private:
+    size_t limit_bytes_ = 0;
+    double report_interval_seconds_ = 0.0;
+    std::atomic<size_t> node_bytes_{0};
+    std::atomic<size_t> key_bytes_{0};
+    std::atomic<bool> exhausted_{false};
+    std::atomic<long long> uniform_fallbacks_{0};
+    std::atomic<double> seconds_to_limit_{-1.0};
+
+    std::chrono::steady_clock::time_point last_report_time_;
+    size_t last_report_bytes_ = 0;
+};
+
+} // namespace gto_solver
+
+#endif // GTO_SOLVER_MEMORY_BUDGET_H
@@ -0,0 +1,82 @@
+#ifndef GTO_SOLVER_METRICS_SERVER_H
+#define GTO_SOLVER_METRICS_SERVER_H
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace gto_solver {
+
+// Point-in-time view of a training run, built only from atomics so it can be taken
+// from any thread without touching the NodeMap or its mutex.
+struct TrainingSnapshot {
+    long long iterations_completed = 0;
+    long long target_iterations = 0;
+    long long nodes = 0;
+    int max_depth = 0;
+    int threads = 0;
+    double elapsed_seconds = 0.0;             // Since the current train() call started
+    double iterations_per_second = 0.0;       // Average over the current train() call
+    size_t resident_memory_bytes = 0;
+    size_t node_store_bytes = 0;              // Estimated node + key storage
+    size_t memory_budget_bytes = 0;           // 0 when --max-memory is not set
+    bool has_cold_tier = false;               // True when nodes are spilled to disk
+    long long cold_nodes = 0;
+    long long cold_evicted = 0;
+    long long cold_faults = 0;
+    long long cold_prefetched = 0;
+    long long checkpoints_written = 0;
+    double last_checkpoint_seconds = 0.0;
+    double total_checkpoint_seconds = 0.0;
+    long long scratch_heap_allocations = 0;   // Traversal-arena heap blocks taken after warm-up (0 in steady state)
+    bool has_trie = false;                    // True once a run with the infoset trie has finished
+    long long trie_entries = 0;               // Infosets that run cached in the trie
+    long long trie_hits = 0;                  // Its lookups that followed trie pointers
+    bool has_baselines = false;               // True once a run with action baselines has finished
+    long long baseline_estimates = 0;         // Sampled opponent decisions that run passed through the baselines
+    long long baseline_corrected = 0;         // Those corrected with a learned baseline
+    bool has_exploitability = false;          // False until an estimate has been reported
+    double exploitability = 0.0;
+    bool has_convergence = false;             // False until the first convergence window closed
+    double mean_positive_regret = 0.0;
+    double max_strategy_delta = 0.0;
+    double visited_fraction = 0.0;
+};
+
+// Renders a snapshot in the Prometheus text exposition format (version 0.0.4).
+std::string format_prometheus_metrics(const TrainingSnapshot& snapshot);
+
+// Minimal HTTP server answering GET /metrics on 127.0.0.1 from one background thread.
+// The thread lowers its own scheduling priority so scrapes never compete with workers.
+class MetricsServer {
+public:
+    using SnapshotProvider = std::function<TrainingSnapshot()>;
+
+    MetricsServer() = default;
+    ~MetricsServer();
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    // Binds to localhost:port (0 picks a free port) and starts serving.
+    // Returns false (and logs) if the socket cannot be set up.
+    bool start(int port, SnapshotProvider provider);
+    void stop();
+
+    bool is_running() const { return running_.load(); }
+    int port() const { return bound_port_; } // Actual port, useful when started with 0
+
+private:
+    void serve_loop();
+    void handle_connection(int client_fd);
+
+    SnapshotProvider provider_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    int listen_fd_ = -1;
+    int bound_port_ = 0;
+};
+
+} // namespace gto_solver
+
+#endif // GTO_SOLVER_METRICS_SERVER_H
@@ -11,6 +11,10 @@
 #include <string> // For std::string
 #include <vector> // For std::vector
 #include "action_abstraction.h" // Include ActionSpec definition
+#include "node_arena.h" // Slab / NUMA-aware storage for Node objects
+#include "regret_kernels.h" // kMaxFixedKernelActions
+#include <algorithm> // For std::copy, std::equal, std::fill
+#include <initializer_list>
 
 #include "spdlog/spdlog.h" // Include spdlog for logging within Node methods
 #include "spdlog/fmt/bundled/format.h" // Include fmt for logging vectors
@@ -18,17 +22,72 @@
 
 namespace gto_solver {
 
+// One double per action of a node (regret_sum, strategy_sum). Nodes up to the fixed-width
+// kernel limit keep the values inside the Node, next to its mutex and counters; wider ones
+// get a heap array. Reads like the std::vector it replaces (size, data, [], iteration, ==).
+class ActionValues {
+public:
+    static constexpr size_t kInlineActions = kMaxFixedKernelActions;
+
+    ActionValues() = default;
+    ActionValues(size_t n, double value) { resize_uninitialized(n); std::fill(begin(), end(), value); }
+    ActionValues(std::initializer_list<double> values) { resize_uninitialized(values.size()); std::copy(values.begin(), values.end(), begin()); }
+    ActionValues(const ActionValues& other) { *this = other; }
+    ActionValues& operator=(const ActionValues& other) {
+        if (this != &other) { resize_uninitialized(other.size_); std::copy(other.begin(), other.end(), begin()); }
+        return *this;
+    }
+    ActionValues& operator=(std::initializer_list<double> values) { return *this = ActionValues(values); }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    double* data() { return heap_ ? heap_.get() : inline_; }
+    const double* data() const { return heap_ ? heap_.get() : inline_; }
+    double& operator[](size_t i) { return data()[i]; }
+    const double& operator[](size_t i) const { return data()[i]; }
+    double* begin() { return data(); }
+    double* end() { return data() + size_; }
+    const double* begin() const { return data(); }
+    const double* end() const { return data() + size_; }
+
+    friend bool operator==(const ActionValues& a, const ActionValues& b) { return std::equal(a.begin(), a.end(), b.begin(), b.end()); }
+    friend bool operator==(const ActionValues& a, const std::vector<double>& b) { return std::equal(a.begin(), a.end(), b.begin(), b.end()); }
+
+private:
+    size_t size_ = 0;
+    double inline_[kInlineActions] = {};
+    std::unique_ptr<double[]> heap_;
+
+    void resize_uninitialized(size_t n) {
+        if (n > kInlineActions && n != size_) heap_ = std::make_unique<double[]>(n);
+        else if (n <= kInlineActions) heap_.reset();
+        size_ = n;
+    }
+};
+
 // Represents a node in the game tree or the storage for CFR data per InfoSet.
 struct Node {
     // Regrets for not taking action 'a' at this infoset. Size = number of possible actions.
-    std::vector<double> regret_sum;
+    ActionValues regret_sum;
 
     // Accumulated strategy profile. Size = number of possible actions.
-    std::vector<double> strategy_sum;
+    ActionValues strategy_sum;
 
     // Number of times this node/infoset has been visited (thread-safe)
     std::atomic<int> visit_count{0}; // Use atomic int, initialize to 0
 
+    // Last convergence window in which this node was visited (see ConvergenceTracker)
+    std::atomic<uint32_t> last_visited_window{0};
+
+    // Tiered store bookkeeping (only maintained when spilling to disk):
+    // traversals currently holding a pointer to this node (never evicted while > 0),
+    // and the eviction sweep during which it was last touched.
+    std::atomic<int> pin_count{0};
+    std::atomic<uint32_t> last_touch_sweep{0};
+
+    // Entry of this infoset in the shared-memory node store (0 = none), see SharedNodeStore
+    uint64_t shared_entry = 0;
+
     // Mutex to protect access to this specific node's data (regret_sum, strategy_sum)
     // Mutable allows locking even in const methods if needed (like get_average_strategy)
     mutable std::mutex node_mutex;
@@ -53,6 +112,10 @@ struct Node {
 
     // Node is non-copyable and non-movable due to the mutex member and potentially large vectors.
 
+    // Nodes live in the NodeArena (plain heap unless NUMA placement is configured).
+    static void* operator new(size_t size) { return NodeArena::instance().allocate(size); }
+    static void operator delete(void* ptr) noexcept { NodeArena::deallocate(ptr); }
+
     // Get the current average strategy based on the accumulated strategy sum.
     // IMPORTANT: Caller must ensure node_mutex is locked before calling this in a multithreaded context.
     std::vector<double> get_average_strategy() const {
@@ -0,0 +1,114 @@
+#ifndef GTO_SOLVER_NODE_ARENA_H
+#define GTO_SOLVER_NODE_ARENA_H
+
+#include "numa_topology.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace gto_solver {
+
+// Where the next Node allocated by the calling thread should live.
+enum class NodePlacement {
+    LOCAL,      // Pool of the NUMA node the thread runs on (first-touch per socket)
+    INTERLEAVED // Pages spread over all nodes (top-of-tree nodes every thread reads)
+};
+
+// Page size requested for the arena's chunks. Huge pages cut the TLB misses of a tree that
+// spans many GB: one 2 MB entry covers what 512 4 KB entries would.
+enum class HugePagePolicy {
+    OFF,         // Plain 4 KB pages in 1 MB chunks (default)
+    TRANSPARENT, // 2 MB aligned chunks marked madvise(MADV_HUGEPAGE) for transparent huge pages
+    EXPLICIT     // mmap(MAP_HUGETLB) from the reserved hugetlbfs pool, else as TRANSPARENT
+};
+
+bool parse_huge_page_policy(const std::string& text, HugePagePolicy& policy); // "off" | "thp" | "explicit"
+
+// What the arena's chunks are actually backed by once a policy is applied.
+enum class PageBacking {
+    SMALL_PAGES,      // Huge pages off or unavailable
+    TRANSPARENT_HUGE, // THP enabled (always / madvise) and madvise accepted
+    EXPLICIT_HUGE     // MAP_HUGETLB mapping succeeded
+};
+
+const char* page_backing_name(PageBacking backing);
+
+// Per-pool counters, for logs and benchmarks.
+struct NodeArenaPoolStats {
+    std::string name;          // "node0", "node1", ..., "interleaved"
+    long long live_slots = 0;
+    long long chunks = 0;
+    long long huge_chunks = 0; // Chunks backed by huge pages (explicit or transparent)
+    size_t chunk_bytes = 0;
+    bool bound = false;        // mbind() accepted the policy (false = plain first-touch)
+};
+
+// Slab allocator behind Node::operator new. While disabled (the default) it forwards to the
+// global heap. Once configured it carves Nodes out of 1 MB mmap chunks kept per NUMA node
+// (bound preferred to that node) plus one interleaved pool, so a worker pinned to a socket
+// creates its nodes in that socket's memory regardless of which page the heap would reuse.
+//
+// With a huge-page policy the chunks are 2 MB and 2 MB aligned, and each one falls back on
+// its own: a chunk that cannot get an explicit huge page (pool exhausted) asks for THP, and
+// one whose madvise fails keeps 4 KB pages.
+//
+// Every slot carries a small header naming its pool, so nodes may be freed by any thread
+// and after the arena is reconfigured. Pools are never destroyed (the arena is a leaked
+// singleton so nodes outliving static destruction can still be freed).
+class NodeArena {
+public:
+    static NodeArena& instance();
+
+    // Enables pooling over the given topology, or disables it (enabled == false).
+    // Safe to call between training runs while nodes from earlier runs are alive.
+    // Returns the backing new chunks will use (probed once per call, see PageBacking).
+    PageBacking configure(const NumaTopology& topology, bool enabled, HugePagePolicy huge_pages = HugePagePolicy::OFF);
+    bool enabled() const { return enabled_.load(std::memory_order_acquire); }
+    PageBacking page_backing() const { return page_backing_.load(std::memory_order_acquire); }
+
+    void* allocate(size_t size);
+    static void deallocate(void* ptr) noexcept;
+
+    // Placement used by the calling thread for its next allocations.
+    static void set_thread_placement(NodePlacement placement);
+    static NodePlacement thread_placement();
+
+    std::vector<NodeArenaPoolStats> stats() const;
+
+private:
+    struct Pool;
+
+    NodeArena() = default;
+    Pool* pool_for_current_thread();
+    Pool* get_or_create_pool(int index); // Caller holds config_mutex_
+
+    static constexpr int kInterleavedPool = 64;   // Pools 0..63 are per NUMA node
+    static constexpr size_t kMaxPools = kInterleavedPool + 1;
+    mutable std::mutex config_mutex_;
+    std::atomic<bool> enabled_{false};
+    std::atomic<bool> multi_node_{false};
+    std::atomic<PageBacking> page_backing_{PageBacking::SMALL_PAGES};
+    std::atomic<Pool*> pools_[kMaxPools] = {};
+    std::atomic<int> pool_of_node_id_[kInterleavedPool] = {}; // Kernel node id -> pool index (-1 = none)
+    NumaTopology topology_;
+};
+
+// Sets the calling thread's node placement for the lifetime of the scope.
+class NodePlacementScope {
+public:
+    explicit NodePlacementScope(NodePlacement placement) : previous_(NodeArena::thread_placement()) {
+        NodeArena::set_thread_placement(placement);
+    }
+    ~NodePlacementScope() { NodeArena::set_thread_placement(previous_); }
+    NodePlacementScope(const NodePlacementScope&) = delete;
+    NodePlacementScope& operator=(const NodePlacementScope&) = delete;
+private:
+    NodePlacement previous_;
+};
+
+} // namespace gto_solver
+
+#endif // GTO_SOLVER_NODE_ARENA_H
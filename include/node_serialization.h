@@ -0,0 +1,68 @@
+#ifndef GTO_SOLVER_NODE_SERIALIZATION_H
+#define GTO_SOLVER_NODE_SERIALIZATION_H
+
+#include "node.h"
+#include "game_state.h" // For HistoryEncoding
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace gto_solver {
+
+// Binary per-node record shared by checkpoints (CHECKPOINT_VERSION_BIN) and the cold node store:
+//   key_len (size_t), key bytes, actions_count (size_t),
+//   actions_count x { type (ActionType), value (double), unit (SizingUnit),
+//                     action_set (ActionSetId), abstract_action (AbstractAction) },
+//   regret_sum (actions_count doubles), strategy_sum (actions_count doubles), visit_count (int)
+
+// Binary checkpoint: header, map_size records in header.key_order, nodes_created (long long).
+// Header fields by version: version (uint32); since v5 the history encoding (HistoryEncoding);
+// since v6 shard id and shard count (2 x uint32); since v7 the key order (CheckpointKeyOrder);
+// then completed iterations (int) and map_size (size_t). v4 records carry no compact-history tags.
+constexpr uint32_t CHECKPOINT_VERSION_BIN = 7;
+constexpr uint32_t CHECKPOINT_VERSION_OLDEST = 4; // Oldest version the readers below accept
+
+enum class CheckpointKeyOrder : uint8_t {
+    SORTED = 0, // Ascending keys (everything but compacted checkpoints; required by merge)
+    TREE = 1    // Public-tree depth-first order, see compare_tree_order() in checkpoint_compact.h
+};
+
+struct CheckpointHeader {
+    uint32_t version = CHECKPOINT_VERSION_BIN;
+    HistoryEncoding history_encoding = HistoryEncoding::CHIPS;
+    uint32_t shard_id = 0;
+    uint32_t num_shards = 1;
+    CheckpointKeyOrder key_order = CheckpointKeyOrder::SORTED;
+    int completed_iterations = 0;
+    size_t map_size = 0;
+};
+
+// Writes a header of the current version (header.version is ignored).
+bool write_checkpoint_header(std::ostream& os, const CheckpointHeader& header);
+// Reads a header of any version from CHECKPOINT_VERSION_OLDEST on; fields the file predates keep
+// their defaults. Logs and returns false on an unknown version or a corrupt header.
+bool read_checkpoint_header(std::istream& is, CheckpointHeader& header);
+// Offset of map_size in a current-version header (to patch it once the record count is known).
+constexpr std::streamoff checkpoint_map_size_offset() {
+    return sizeof(uint32_t) + sizeof(HistoryEncoding) + 2 * sizeof(uint32_t) + sizeof(CheckpointKeyOrder) + sizeof(int);
+}
+
+// Writes one record. The caller must hold node.node_mutex if other threads may update the node.
+bool write_node_record(std::ostream& os, const std::string& key, const Node& node);
+// Same record from loose values (e.g. buffered deltas of a node owned by another shard).
+bool write_node_record(std::ostream& os, const std::string& key, const std::vector<ActionSpec>& legal_actions,
+                       const double* regret_sum, const double* strategy_sum, int visit_count);
+
+// Reads one record into key / node (version: of the checkpoint it comes from). Logs and returns
+// false on a truncated or inconsistent record.
+bool read_node_record(std::istream& is, std::string& key, std::unique_ptr<Node>& node, uint32_t version = CHECKPOINT_VERSION_BIN);
+// Reads only the key of the next record and skips the rest of it (without seeking, so buffered
+// streams keep their buffer). record_bytes receives the record's total size.
+bool skip_node_record(std::istream& is, std::string& key, uint32_t version = CHECKPOINT_VERSION_BIN, size_t* record_bytes = nullptr);
+
+} // namespace gto_solver
+
+#endif // GTO_SOLVER_NODE_SERIALIZATION_H
@@ -0,0 +1,76 @@
+#ifndef GTO_SOLVER_NUMA_TOPOLOGY_H
+#define GTO_SOLVER_NUMA_TOPOLOGY_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace gto_solver {
+
+// CPUs of one NUMA node as reported by /sys/devices/system/node/node<id>/cpulist.
+struct NumaNode {
+    int id = 0;
+    std::vector<int> cpus; // Restricted to the CPUs this process may run on
+};
+
+// Machine layout used for thread placement and node-arena pools (see node_arena.h).
+// Only needs sysfs and plain syscalls; no libnuma dependency.
+struct NumaTopology {
+    std::vector<NumaNode> nodes;
+
+    // Reads the topology from sysfs. Machines without NUMA information (or containers hiding
+    // it) are reported as a single node holding every CPU the process is allowed to use.
+    static NumaTopology detect();
+
+    size_t num_nodes() const { return nodes.size(); }
+    size_t num_cpus() const;
+    // Index into `nodes` of the node owning cpu (-1 if unknown).
+    int node_index_of_cpu(int cpu) const;
+    std::string describe() const; // "2 NUMA nodes: node0 [0-15] node1 [16-31]"
+};
+
+// Parses a kernel cpulist such as "0-3,8-11" (also used for nodelists). Returns false on a malformed list.
+bool parse_cpulist(const std::string& text, std::vector<int>& cpus);
+// Formats CPUs back into the compact "0-3,8-11" form.
+std::string format_cpulist(const std::vector<int>& cpus);
+
+// How train() places its worker threads.
+enum class ThreadPlacement {
+    NONE,    // Let the scheduler move threads freely (default)
+    COMPACT, // Fill the CPUs of one node before using the next (shares caches / local memory)
+    SPREAD   // Round-robin over nodes (uses every socket's memory bandwidth)
+};
+
+bool parse_thread_placement(const std::string& text, ThreadPlacement& placement);
+const char* thread_placement_name(ThreadPlacement placement);
+
+// CPU for each of num_threads workers under the given placement (empty for NONE).
+// When there are more threads than CPUs the plan wraps around.
+std::vector<int> plan_thread_cpus(const NumaTopology& topology, ThreadPlacement placement, size_t num_threads);
+
+// Pins the calling thread to one CPU. Returns false (and leaves it unpinned) on failure.
+bool pin_current_thread(int cpu);
+// NUMA node id the calling thread is currently running on (0 if unknown).
+int current_numa_node();
+
+// Memory policies applied to whole page ranges through mbind(2). Failures (kernels without
+// NUMA support, seccomp filters) return false; the memory is then simply first-touch.
+bool bind_memory_preferred(void* addr, size_t length, int numa_node_id);
+bool bind_memory_interleaved(void* addr, size_t length, const NumaTopology& topology);
+
+// System-wide page allocation counters from /sys/devices/system/node/node*/numastat,
+// summed over all nodes. other_node counts pages a process got from a node other than
+// the one it was running on; comparing it across runs measures remote-allocation traffic.
+struct NumaStat {
+    long long numa_hit = 0;
+    long long numa_miss = 0;
+    long long numa_foreign = 0;
+    long long interleave_hit = 0;
+    long long local_node = 0;
+    long long other_node = 0;
+};
+bool read_numastat(NumaStat& stat);
+
+} // namespace gto_solver
+
+#endif // GTO_SOLVER_NUMA_TOPOLOGY_H
@@ -0,0 +1,47 @@
+#ifndef GTO_SOLVER_POT_LAYERS_H
+#define GTO_SOLVER_POT_LAYERS_H
+
+#include "game_state.h" // For GameState::kMaxPlayers
+#include <array>
+#include <cstdint>
+
+namespace gto_solver {
+
+// Rank given to a player in hand without hole cards: loses to every evaluated hand.
+constexpr int kUnrankedHand = 9999;
+
+// Main and side pots of a terminal state, one layer per distinct contribution level of the
+// players still in hand. A layer holds (level - previous level) chips from each player in hand
+// who reached the level and is contested by exactly those players. Chips of folded players are
+// not in any layer (they are only awarded when a single player is left in hand).
+//
+// The layers depend on contributions and folds alone, i.e. on the public betting line, so deals
+// that end on the same line (the lanes of a batched traversal) share one PotLayers. Fixed-size,
+// no allocation.
+struct PotLayers {
+    struct Layer {
+        double amount = 0.0;   // Chips in the layer
+        uint16_t eligible = 0; // Players in hand whose contribution reaches the layer (bit i = player i)
+    };
+
+    int num_players = 0;
+    int num_layers = 0;
+    uint16_t in_hand = 0; // Players who have not folded
+    double total_pot = 0.0;
+    std::array<double, GameState::kMaxPlayers> contributions{};
+    std::array<Layer, GameState::kMaxPlayers> layers{};
+
+    static PotLayers from_state(const GameState& state);
+    // contributions[i] for num_players players, in_hand bit i set while player i has not folded.
+    static PotLayers from_contributions(const int* contributions, uint16_t in_hand, int num_players);
+};
+
+// Payoff (winnings minus contribution) of every player in one pass: each layer is split evenly
+// between its eligible players with the lowest rank. ranks holds one showdown rank per player
+// (lower wins, only read for players in hand); payoffs receives num_players values. With nobody
+// in hand every player just loses their contribution.
+void resolve_pot_payoffs(const PotLayers& pots, const int* ranks, double* payoffs);
+
+} // namespace gto_solver
+
+#endif // GTO_SOLVER_POT_LAYERS_H
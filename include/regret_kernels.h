@@ -0,0 +1,52 @@
+#ifndef GTO_SOLVER_REGRET_KERNELS_H
+#define GTO_SOLVER_REGRET_KERNELS_H
+
+#include <cstddef>
+
+namespace gto_solver {
+
+// Instruction sets the regret kernels are compiled for. The best one the CPU supports is
+// picked at startup; tests and benchmarks can force another one. Nodes too narrow for the
+// active set (fewer than 8 actions for AVX2) run the next narrower one.
+enum class KernelIsa {
+    SCALAR,
+    SSE2,
+    AVX2
+};
+
+// Widest node the engine keeps on the stack when calling the kernels (the abstraction
+// produces far fewer actions). The kernels themselves accept any n.
+constexpr size_t kMaxKernelActions = 32;
+
+// Regret matching: strategy[i] = max(0, regrets[i]) / sum of positive regrets, or uniform if
+// no regret is positive (or the sum is not finite). Writes n values, allocates nothing, and
+// always produces a finite distribution that sums to 1.
+void regret_matching(const double* regrets, double* strategy, size_t n);
+
+// regret_sum[i] += weight * (action_utilities[i] - node_utility), clamped at 0 when floor_at_zero
+// (CFR+). Returns the change of sum_i max(0, regret_sum[i]) (convergence telemetry).
+double accumulate_regrets(double* regret_sum, const double* action_utilities, double node_utility,
+                          double weight, size_t n, bool floor_at_zero);
+
+// strategy_sum[i] += weight * strategy[i].
+void accumulate_strategy(double* strategy_sum, const double* strategy, double weight, size_t n);
+
+// Nodes with up to kMaxFixedKernelActions actions (nearly all of them) run kernels compiled
+// for their exact width from one template, picked from a table indexed by n: the loops are
+// fully unrolled and keep everything in registers. Wider nodes use the active instruction
+// set. Strategies and sums are bit-identical to the scalar kernels (the returned regret delta
+// may differ in rounding). Enabled by default; tests and benchmarks turn it off to reach the
+// instruction-set kernels at small widths.
+constexpr size_t kMaxFixedKernelActions = 6;
+bool fixed_width_kernels_enabled();
+void set_fixed_width_kernels(bool enabled);
+
+// Kernel set currently in use, and switching it (returns false if the CPU lacks the ISA).
+KernelIsa active_kernel_isa();
+bool set_kernel_isa(KernelIsa isa);
+bool kernel_isa_supported(KernelIsa isa);
+const char* kernel_isa_name(KernelIsa isa);
+
+} // namespace gto_solver
+
+#endif // GTO_SOLVER_REGRET_KERNELS_H
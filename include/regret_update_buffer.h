@@ -0,0 +1,76 @@
+#ifndef GTO_SOLVER_REGRET_UPDATE_BUFFER_H
+#define GTO_SOLVER_REGRET_UPDATE_BUFFER_H
+
+#include "node.h"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace gto_solver {
+
+// Result of merging one buffer into the shared nodes.
+struct BufferMergeStats {
+    size_t nodes = 0;                   // Distinct nodes touched since the last merge
+    size_t updates = 0;                 // Updates folded into them
+    double positive_regret_delta = 0.0; // Change of sum_a max(0, regret) over the merged nodes
+};
+
+// Whether a merge clamps the merged regret sums at zero (CFR+, see TrainingOptions::floor_regrets).
+enum class RegretFloor {
+    OFF,
+    ON
+};
+
+// Per-worker accumulator of regret / strategy-sum deltas (buffered update mode of
+// CFREngine::train). Traversals add to the buffer without touching node mutexes; merge()
+// then applies every delta in one pass, locking each node once however many times the
+// worker updated it. Hot top-of-tree nodes, which every traversal updates, go from one
+// lock per traversal to one lock per merge interval.
+//
+// Owned and used by a single thread. Deltas are stored contiguously (regrets then
+// strategy sums per node) so the merge loop is a plain vectorisable add.
+class RegretUpdateBuffer {
+public:
+    // Adds one update of a node with node->regret_sum.size() actions (or `updates` updates
+    // already summed, e.g. batched lanes sharing an infoset). pin_node keeps the node in memory
+    // until the merge (tiered store: a pinned node is never evicted); the caller must already
+    // hold a pin on it.
+    void add(Node* node, const double* regret_delta, const double* strategy_delta, bool pin_node, uint32_t updates = 1);
+
+    // Applies and clears all buffered deltas. Nodes are merged in address order, which groups
+    // them by arena chunk / NUMA pool and walks memory sequentially.
+    // BufferMergeStats::positive_regret_delta is always filled in.
+    BufferMergeStats merge(RegretFloor floor = RegretFloor::OFF);
+
+    // Visits every buffered entry before a merge: fn(node, regret deltas, strategy deltas, updates).
+    template <typename Fn>
+    void for_each_pending(Fn&& fn) const {
+        for (const Entry& entry : entries_) {
+            const double* regrets = values_.data() + entry.offset;
+            fn(entry.node, regrets, regrets + entry.num_actions, entry.updates);
+        }
+    }
+
+    bool empty() const { return entries_.empty(); }
+    size_t pending_nodes() const { return entries_.size(); }
+    size_t pending_updates() const { return pending_updates_; }
+
+private:
+    struct Entry {
+        Node* node;
+        size_t offset;       // Into values_: num_actions regret deltas, then num_actions strategy deltas
+        uint32_t num_actions;
+        uint32_t updates;    // Also the visit count to add
+        bool pinned;
+    };
+
+    std::unordered_map<Node*, size_t> index_; // Node -> position in entries_
+    std::vector<Entry> entries_;
+    std::vector<double> values_;
+    size_t pending_updates_ = 0;
+};
+
+} // namespace gto_solver
+
+#endif // GTO_SOLVER_REGRET_UPDATE_BUFFER_H
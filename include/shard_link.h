@@ -0,0 +1,102 @@
+#ifndef GTO_SOLVER_SHARD_LINK_H
+#define GTO_SOLVER_SHARD_LINK_H
+
+#include "shard_transport.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gto_solver {
+
+struct ShardLinkStats {
+    long long syncs = 0;          // Sync rounds completed
+    long long bytes_sent = 0;     // UPDATE + LOOKUP payload bytes sent to peers
+    long long bytes_received = 0; // Payload bytes received from peers (all frame kinds)
+    double sync_seconds = 0.0;    // Time spent in sync rounds (send + wait for replies)
+};
+
+// Connections of one shard process to the other shards of a distributed run (see
+// TrainingOptions::shard_endpoints). Every process listens on its own endpoint and opens one
+// connection to each peer; what travels over them is up to the owner of the link:
+//
+//   - a sync thread asks collect() for per-peer UPDATE and LOOKUP payloads every sync
+//     interval, sends them, then waits for each peer's LOOKUP_REPLY and hands it to
+//     install_reply() (workers never wait on the network);
+//   - one serve thread per incoming connection passes UPDATEs to apply_updates() and answers
+//     LOOKUPs with answer_lookup() on the same connection.
+//
+// A peer processes frames in order, so a LOOKUP sent after an UPDATE sees that update.
+// finish() flushes a last UPDATE, sends DONE and waits until every peer did the same: after
+// it returns, all updates for this shard's keys have been applied.
+class ShardLink {
+public:
+    struct Handlers {
+        // Fills the frame payloads for every peer (own entry ignored; empty = nothing to send),
+        // each within kMaxShardFrameBytes (see ShardPayloads)
+        std::function<void(std::vector<std::vector<std::string>>& updates, std::vector<std::vector<std::string>>& lookups)> collect;
+        std::function<void(const std::string& payload)> apply_updates;
+        std::function<std::string(const std::string& payload)> answer_lookup;
+        std::function<void(const std::string& payload)> install_reply;
+    };
+
+    ShardLink() = default;
+    ~ShardLink();
+    ShardLink(const ShardLink&) = delete;
+    ShardLink& operator=(const ShardLink&) = delete;
+
+    // Listens on endpoints[shard_id], connects to every other endpoint (waiting up to
+    // connect_timeout_seconds for peers to come up) and starts the sync thread.
+    bool start(int shard_id, std::vector<ShardEndpoint> endpoints, double sync_interval_seconds, Handlers handlers,
+               double connect_timeout_seconds = 30.0);
+    // Final flush + DONE barrier (see above), then closes everything. Waits at most
+    // timeout_seconds for slower peers; returns false if one never finished.
+    bool finish(double timeout_seconds = 600.0);
+
+    bool active() const { return sync_thread_.joinable(); }
+    int shard_id() const { return shard_id_; }
+    int num_shards() const { return static_cast<int>(endpoints_.size()); }
+    bool owns(const std::string& key) const { return shard_of(key, endpoints_.size()) == static_cast<size_t>(shard_id_); }
+    ShardLinkStats stats() const;
+
+private:
+    void accept_loop();
+    void serve_peer(int fd);
+    void sync_loop();
+    void sync_once(bool with_lookups);
+    void close_all();
+
+    int shard_id_ = 0;
+    std::vector<ShardEndpoint> endpoints_;
+    double sync_interval_seconds_ = 0.1;
+    Handlers handlers_;
+
+    int listen_fd_ = -1;
+    std::vector<int> peer_fds_; // Outgoing connection per shard (-1 for our own)
+    std::mutex serve_mutex_;
+    std::vector<int> incoming_fds_;
+    std::vector<std::thread> serve_threads_;
+    std::thread accept_thread_;
+    std::thread sync_thread_;
+    std::atomic<bool> accepting_{false};
+    std::atomic<bool> syncing_{false};
+    std::mutex sync_wait_mutex_;
+    std::condition_variable sync_wait_cv_; // Wakes the sync thread early on finish()
+
+    std::mutex done_mutex_;
+    std::condition_variable done_cv_;
+    int peers_done_ = 0;
+
+    std::atomic<long long> syncs_{0};
+    std::atomic<long long> bytes_sent_{0};
+    std::atomic<long long> bytes_received_{0};
+    std::atomic<long long> sync_ns_{0};
+};
+
+} // namespace gto_solver
+
+#endif // GTO_SOLVER_SHARD_LINK_H
@@ -0,0 +1,76 @@
+#ifndef GTO_SOLVER_SHARD_TRANSPORT_H
+#define GTO_SOLVER_SHARD_TRANSPORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace gto_solver {
+
+// Address of one shard process ("host:port"; host is an IPv4 address or a resolvable name).
+struct ShardEndpoint {
+    std::string host;
+    int port = 0;
+};
+
+// Parses "host:port,host:port,..." (one entry per shard, in shard order).
+bool parse_shard_endpoints(const std::string& text, std::vector<ShardEndpoint>& endpoints);
+std::string format_shard_endpoint(const ShardEndpoint& endpoint);
+
+// Shard owning an infoset key. Uses stable_key_hash, so every process and host agrees on the
+// partition.
+size_t shard_of(const std::string& key, size_t num_shards);
+
+// File a shard saves / loads its checkpoint to: "<base>.shard<k>of<n>".
+std::string shard_checkpoint_filename(const std::string& base, int shard_id, int num_shards);
+
+// Message kinds exchanged between shard processes.
+enum class ShardFrame : uint8_t {
+    UPDATE = 1,   // Node records whose sums are deltas and visit count is the update count
+    LOOKUP,       // Keys whose current regret sums the sender wants
+    LOOKUP_REPLY, // (key, regret sums) for the keys of a LOOKUP the receiver owns
+    DONE          // Sender finished training and flushed its last UPDATE
+};
+
+// Blocking framed I/O on a connected socket: type (1 byte), payload length (8 bytes), payload.
+// Both return false on a closed or broken connection. Both also refuse (and log) a frame
+// longer than kMaxShardFrameBytes: recv_frame so a corrupt header cannot make it allocate,
+// send_frame before writing anything, so the connection stays usable.
+constexpr uint64_t kMaxShardFrameBytes = uint64_t{256} << 20;
+bool send_frame(int fd, ShardFrame type, const std::string& payload);
+bool recv_frame(int fd, ShardFrame& type, std::string& payload);
+
+// Outgoing payloads of one frame kind for one peer, split at record boundaries so that no
+// frame exceeds max_bytes. add() charges a record's cost (by default its size) to the current
+// payload and starts a new payload when it would not fit. A LOOKUP record is charged the size
+// of the answer it asks for, since that answer must fit one LOOKUP_REPLY. A single record
+// costing more than max_bytes gets a payload of its own, which send_frame refuses.
+class ShardPayloads {
+public:
+    explicit ShardPayloads(size_t max_bytes = kMaxShardFrameBytes) : max_bytes_(max_bytes) {}
+
+    void add(std::string_view record, size_t cost);
+    void add(std::string_view record) { add(record, record.size()); }
+    bool empty() const { return payloads_.empty(); }
+    // Hands the payloads over, one per frame, and starts afresh.
+    std::vector<std::string> take();
+
+private:
+    size_t max_bytes_;
+    std::vector<std::string> payloads_;
+    size_t last_cost_ = 0; // Charged to payloads_.back()
+};
+
+// TCP helpers. listen_tcp binds all interfaces (0 picks a free port; bound_port receives the
+// actual one). connect_tcp retries until timeout_seconds elapse so peers can start in any
+// order. Both return a socket or -1 (logged).
+int listen_tcp(int port, int backlog, int* bound_port = nullptr);
+int connect_tcp(const ShardEndpoint& endpoint, double timeout_seconds);
+// Waits up to timeout_ms for a connection on listen_fd; -1 if none arrived.
+int accept_tcp(int listen_fd, int timeout_ms);
+
+} // namespace gto_solver
+
+#endif // GTO_SOLVER_SHARD_TRANSPORT_H
@@ -0,0 +1,91 @@
+#ifndef GTO_SOLVER_SHARED_NODE_STORE_H
+#define GTO_SOLVER_SHARED_NODE_STORE_H
+
+#include "action_abstraction.h"
+#include "game_state.h" // For HistoryEncoding
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sys/types.h> // For pid_t
+#include <vector>
+
+namespace gto_solver {
+
+struct SharedStoreStats {
+    long long entries = 0;
+    long long slots = 0;
+    size_t used_bytes = 0;      // Header + slot table + allocated entries
+    size_t capacity_bytes = 0;
+    long long refused = 0;      // Inserts refused because the table or arena was full
+    size_t wasted_bytes = 0;    // Entries built by a process that lost the insert race
+};
+
+// Node store in POSIX shared memory (shm_open + mmap) for multi-process training: forked worker
+// processes all read and update the same regret / strategy sums, and the parent can checkpoint
+// straight from the mapping while they run.
+//
+// The mapping holds a header, an open-addressing table of entry offsets and a bump-allocated
+// arena of entries (key, legal actions, regret sums, strategy sums, visit count). Everything is
+// addressed by offsets from the mapping base, so processes may map it at different addresses.
+// There are no locks: entries are fully written before a compare-and-swap publishes them, sums
+// are updated with atomic adds, and a process that dies at any point leaves the store usable
+// (at worst an unpublished entry leaks). Entries are never removed.
+class SharedNodeStore {
+public:
+    SharedNodeStore() = default;
+    ~SharedNodeStore();
+    SharedNodeStore(const SharedNodeStore&) = delete;
+    SharedNodeStore& operator=(const SharedNodeStore&) = delete;
+
+    // Creates the shared-memory object name ("/..." as for shm_open) of size bytes and maps it.
+    // The creating process unlinks the name again when it closes or destroys the store.
+    bool create(const std::string& name, size_t bytes);
+    // Maps an existing store created by another process.
+    bool attach(const std::string& name);
+    void close();
+    bool is_open() const { return base_ != nullptr; }
+    const std::string& name() const { return name_; }
+
+    // Entry offsets (0 = none). find_or_insert returns 0 when the store is full.
+    uint64_t find(const std::string& key) const;
+    uint64_t find_or_insert(const std::string& key, const std::vector<ActionSpec>& legal_actions);
+
+    size_t num_actions(uint64_t entry) const;
+    void load_regrets(uint64_t entry, double* regrets) const;
+    // Adds buffered deltas (updates = visits to add). With floor_regrets the regret sums are
+    // clamped at zero (CFR+). Returns the change of sum_a max(0, regret).
+    double add_deltas(uint64_t entry, const double* regret_delta, const double* strategy_delta, int updates, bool floor_regrets);
+
+    // Iterations finished by all workers (including those of a loaded checkpoint).
+    void add_completed_iterations(long long iterations);
+    long long completed_iterations() const;
+    HistoryEncoding history_encoding() const;
+    void set_history_encoding(HistoryEncoding encoding);
+
+    // Checkpoints in the engine's format (node_serialization.h), written in sorted key order.
+    // Saving while workers run gives every sum as of some moment during the save.
+    bool save_checkpoint(const std::string& filename) const;
+    // Loads a checkpoint into an empty store. Returns its iteration count or -1 on error.
+    int load_checkpoint(const std::string& filename);
+
+    SharedStoreStats stats() const;
+
+private:
+    struct Header;
+    struct EntryHeader;
+
+    Header* header() const;
+    std::atomic<uint64_t>* slots() const;
+    EntryHeader* entry_at(uint64_t offset) const;
+    bool map(int fd, size_t bytes);
+
+    char* base_ = nullptr;
+    size_t size_ = 0;
+    std::string name_;
+    pid_t owner_pid_ = 0; // Creator; only it unlinks the name (forked children share the object)
+};
+
+} // namespace gto_solver
+
+#endif // GTO_SOLVER_SHARED_NODE_STORE_H
@@ -0,0 +1,22 @@
+#ifndef GTO_SOLVER_STABLE_HASH_H
+#define GTO_SOLVER_STABLE_HASH_H
+
+#include <cstdint>
+#include <string_view>
+
+namespace gto_solver {
+
+// FNV-1a of an infoset key. Unlike std::hash it is the same in every process, build and host,
+// so it can place keys in shared memory (SharedNodeStore) and partition them across shards.
+inline uint64_t stable_key_hash(std::string_view key) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+} // namespace gto_solver
+
+#endif // GTO_SOLVER_STABLE_HASH_H
@@ -0,0 +1,149 @@
+#ifndef GTO_SOLVER_TRAINING_METRICS_H
+#define GTO_SOLVER_TRAINING_METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gto_solver {
+
+// Counter written by exactly one thread and read by the reporter.
+// add() is a relaxed load + store (no locked RMW), so it costs about as much as a plain
+// increment while still being race-free to read from another thread.
+class RelaxedCounter {
+public:
+    void add(uint64_t amount) { value_.store(value_.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed); }
+    uint64_t load() const { return value_.load(std::memory_order_relaxed); }
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+// Floating-point counterpart of RelaxedCounter (same single-writer contract).
+class RelaxedDouble {
+public:
+    void add(double amount) { value_.store(value_.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed); }
+    double load() const { return value_.load(std::memory_order_relaxed); }
+private:
+    std::atomic<double> value_{0.0};
+};
+
+// Per-worker hot-path counters. Aligned to a cache line so workers never share one.
+struct alignas(64) ThreadCounters {
+    RelaxedCounter node_visits;       // Decision nodes visited by cfr_plus_recursive
+    RelaxedCounter nodes_created;     // Nodes inserted into the NodeMap
+    RelaxedCounter traversals;        // Completed root traversals (one per player per deal)
+    RelaxedCounter traversal_depth;   // Sum of the max depth reached by each traversal
+
+    // Nanoseconds, only collected when timing is enabled (see TrainingMetrics::timing_enabled)
+    RelaxedCounter map_lock_wait_ns;  // Waiting for the NodeMap mutex
+    RelaxedCounter node_lock_wait_ns; // Waiting for per-node mutexes
+    RelaxedCounter eval_ns;           // Terminal payoff / hand evaluation
+    RelaxedCounter abstraction_ns;    // Action abstraction (specs + amounts)
+    RelaxedCounter key_ns;            // InfoSet key building
+    RelaxedCounter update_ns;         // Regret / strategy sum updates
+
+    // Convergence telemetry, only collected when a ConvergenceTracker is enabled
+    RelaxedDouble positive_regret_delta;  // Change in sum over nodes of sum_a max(0, regret)
+    RelaxedCounter window_first_visits;   // Nodes visited for the first time in the current window
+
+    int current_traversal_max_depth = 0; // Owner-thread only scratch value
+};
+
+// Returns the counters registered for the calling thread, or a thread-local scratch
+// instance if the thread was never registered (e.g. cfr_plus_recursive called from a test).
+ThreadCounters& thread_counters();
+
+// RAII timer adding the elapsed nanoseconds to a counter; a no-op when disabled so the
+// clock is never read on untimed runs.
+class ScopedPhaseTimer {
+public:
+    ScopedPhaseTimer(RelaxedCounter& counter, bool enabled)
+        : counter_(enabled ? &counter : nullptr),
+          start_(enabled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point()) {}
+    ~ScopedPhaseTimer() {
+        if (counter_) {
+            counter_->add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count());
+        }
+    }
+    ScopedPhaseTimer(const ScopedPhaseTimer&) = delete;
+    ScopedPhaseTimer& operator=(const ScopedPhaseTimer&) = delete;
+private:
+    RelaxedCounter* counter_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Acquires `lock`, charging the time spent waiting to `wait_ns` when timing is enabled.
+template <typename Lock>
+void lock_timed(Lock& lock, RelaxedCounter& wait_ns, bool enabled) {
+    ScopedPhaseTimer timer(wait_ns, enabled);
+    lock.lock();
+}
+
+// Sum of all worker counters at one point in time.
+struct MetricsSnapshot {
+    std::chrono::steady_clock::time_point time;
+    long long iterations = 0;
+    long long total_nodes = 0;
+    uint64_t node_visits = 0;
+    uint64_t nodes_created = 0;
+    uint64_t traversals = 0;
+    uint64_t traversal_depth = 0;
+    uint64_t map_lock_wait_ns = 0;
+    uint64_t node_lock_wait_ns = 0;
+    uint64_t eval_ns = 0;
+    uint64_t abstraction_ns = 0;
+    uint64_t key_ns = 0;
+    uint64_t update_ns = 0;
+    double positive_regret_delta = 0.0;
+    uint64_t window_first_visits = 0;
+};
+
+// Collects per-thread counters during CFREngine::train and periodically emits one
+// structured log line (and optionally one CSV row) with the rates for the last interval.
+class TrainingMetrics {
+public:
+    // interval_seconds <= 0 disables periodic reports and phase timing.
+    // starting_iteration is the count restored from a checkpoint (0 for a fresh run).
+    void start(double interval_seconds, const std::string& csv_filename, int num_threads, long long starting_iteration);
+
+    // Registers the calling worker thread; must be called once per worker before it
+    // touches thread_counters().
+    void register_current_thread();
+
+    bool timing_enabled() const { return timing_enabled_; }
+
+    // Emits a report if the interval has elapsed. Cheap when it has not; meant to be
+    // polled by a single thread at iteration boundaries.
+    void maybe_report(long long iterations, long long total_nodes);
+
+    // Emits the final report for the whole run and closes the CSV file.
+    void finish(long long iterations, long long total_nodes);
+
+    // Resident set size of this process in bytes (0 if unavailable).
+    static size_t resident_memory_bytes();
+
+    // Sum of all registered worker counters right now.
+    MetricsSnapshot take_snapshot(long long iterations, long long total_nodes) const;
+
+private:
+    void emit(const MetricsSnapshot& from, const MetricsSnapshot& to, const char* label);
+
+    // Sized once in start(), so workers can claim slots and the reporter can read them
+    // without locking.
+    std::vector<std::unique_ptr<ThreadCounters>> counters_;
+    std::atomic<int> next_slot_{0};
+    bool timing_enabled_ = false;
+    double interval_seconds_ = 0.0;
+    int num_threads_ = 1;
+    MetricsSnapshot run_start_;
+    MetricsSnapshot last_report_;
+    std::ofstream csv_;
+};
+
+} // namespace gto_solver
+
+#endif // GTO_SOLVER_TRAINING_METRICS_H
@@ -0,0 +1,72 @@
+#ifndef GTO_SOLVER_TRAVERSAL_ARENA_H
+#define GTO_SOLVER_TRAVERSAL_ARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+namespace gto_solver {
+
+// Per-worker bump allocator for the scratch vectors of a CFR traversal (strategies, action
+// utilities, reach probabilities, payoff bookkeeping), used through std::pmr containers.
+//
+// Allocation bumps a pointer inside the current block. Freeing the most recent allocation
+// rewinds the pointer, so a recursion whose frames free in LIFO order only ever needs
+// depth x frame size; anything else is reclaimed by reset(). Unlike
+// std::pmr::monotonic_buffer_resource, reset() keeps every block, so once the first
+// traversals have sized the arena (warm-up) a worker never touches the global heap for
+// these temporaries again; heap_blocks() counts the blocks taken so far to check that.
+//
+// Owned and used by a single thread.
+class TraversalArena : public std::pmr::memory_resource {
+public:
+    explicit TraversalArena(size_t first_block_bytes = 64 * 1024);
+    ~TraversalArena() override;
+    TraversalArena(const TraversalArena&) = delete;
+    TraversalArena& operator=(const TraversalArena&) = delete;
+
+    // Rewinds to the start of the first block. Every container allocated from the arena
+    // must be gone (call between iterations).
+    void reset();
+
+    size_t heap_blocks() const { return blocks_.size(); }  // Blocks taken from the global heap
+    size_t reserved_bytes() const { return reserved_bytes_; }
+    size_t high_water_bytes() const { return high_water_bytes_; } // Most bytes in use at once since construction
+
+private:
+    struct Block {
+        std::byte* data;
+        size_t size;
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    std::vector<Block> blocks_;
+    size_t next_block_bytes_;
+    size_t current_ = 0;          // Block being bumped
+    size_t offset_ = 0;           // Into blocks_[current_]
+    size_t used_before_current_ = 0; // Capacity of the blocks before current_ (high-water accounting)
+    size_t reserved_bytes_ = 0;
+    size_t high_water_bytes_ = 0;
+};
+
+// Memory resource for traversal temporaries on the calling thread: its installed arena, or
+// the global heap (std::pmr::new_delete_resource) when none is installed.
+std::pmr::memory_resource* traversal_resource();
+
+// Installs an arena as the calling thread's traversal_resource() for the guard's lifetime.
+class TraversalArenaScope {
+public:
+    explicit TraversalArenaScope(TraversalArena* arena);
+    ~TraversalArenaScope();
+    TraversalArenaScope(const TraversalArenaScope&) = delete;
+    TraversalArenaScope& operator=(const TraversalArenaScope&) = delete;
+private:
+    std::pmr::memory_resource* previous_;
+};
+
+} // namespace gto_solver
+
+#endif // GTO_SOLVER_TRAVERSAL_ARENA_H
@@ -0,0 +1,149 @@
+#ifndef GTO_SOLVER_TRAVERSAL_TASK_H
+#define GTO_SOLVER_TRAVERSAL_TASK_H
+
+#include "traversal_arena.h"
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <utility>
+
+namespace gto_solver {
+
+// Coroutine for one frame of an interleaved traversal (CFREngine::cfr_interleaved).
+//
+// A frame co_awaits its children like a function call: the child starts immediately and
+// hands control back to the parent when it returns (symmetric transfer, no scheduler round
+// trip). A frame that has just issued prefetches co_awaits TraversalStrand::yield(), which
+// parks the whole chain and returns to the worker's scheduler so another traversal runs
+// while the cache lines arrive. Frames are allocated from the calling thread's
+// traversal_resource(), i.e. the strand's arena, where they are freed in LIFO order.
+class TraversalTask {
+public:
+    struct promise_type {
+        double value = 0.0;
+        std::coroutine_handle<> continuation; // Awaiting parent frame (null for a strand's root)
+        std::exception_ptr exception;
+
+        TraversalTask get_return_object() { return TraversalTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        auto final_suspend() noexcept {
+            struct FinalAwaiter {
+                bool await_ready() noexcept { return false; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> frame) noexcept {
+                    std::coroutine_handle<> parent = frame.promise().continuation;
+                    return parent ? parent : std::noop_coroutine();
+                }
+                void await_resume() noexcept {}
+            };
+            return FinalAwaiter{};
+        }
+        void return_value(double result) { value = result; }
+        void unhandled_exception() { exception = std::current_exception(); }
+
+        static void* operator new(size_t size) {
+            std::pmr::memory_resource* resource = traversal_resource();
+            void* raw = resource->allocate(size + kHeaderBytes, alignof(std::max_align_t));
+            *static_cast<std::pmr::memory_resource**>(raw) = resource; // Frames may be destroyed under another scope
+            return static_cast<std::byte*>(raw) + kHeaderBytes;
+        }
+        static void operator delete(void* frame, size_t size) {
+            void* raw = static_cast<std::byte*>(frame) - kHeaderBytes;
+            (*static_cast<std::pmr::memory_resource**>(raw))->deallocate(raw, size + kHeaderBytes, alignof(std::max_align_t));
+        }
+    };
+
+    TraversalTask() = default;
+    TraversalTask(TraversalTask&& other) noexcept : frame_(std::exchange(other.frame_, nullptr)) {}
+    TraversalTask& operator=(TraversalTask&& other) noexcept {
+        if (this != &other) { reset(); frame_ = std::exchange(other.frame_, nullptr); }
+        return *this;
+    }
+    ~TraversalTask() { reset(); }
+
+    bool valid() const { return static_cast<bool>(frame_); }
+    bool done() const { return frame_.done(); }
+    std::coroutine_handle<> handle() const { return frame_; }
+    void reset() { if (frame_) { frame_.destroy(); frame_ = nullptr; } }
+
+    // Result of a finished task (rethrows what the coroutine threw)
+    double result() const {
+        if (frame_.promise().exception) std::rethrow_exception(frame_.promise().exception);
+        return frame_.promise().value;
+    }
+
+    // co_await child: runs it as a nested frame and resumes the awaiting frame with its value
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> parent) noexcept {
+        frame_.promise().continuation = parent;
+        return frame_;
+    }
+    double await_resume() const { return result(); }
+
+private:
+    static constexpr size_t kHeaderBytes = alignof(std::max_align_t); // Holds the allocating resource
+    static_assert(sizeof(std::pmr::memory_resource*) <= kHeaderBytes);
+
+    explicit TraversalTask(std::coroutine_handle<promise_type> frame) : frame_(frame) {}
+    std::coroutine_handle<promise_type> frame_;
+};
+
+// One of the traversals a worker interleaves: its root task, the frame to resume next, and
+// the arena its frames and temporaries live in (one per strand keeps each arena LIFO).
+class TraversalStrand {
+public:
+    // Coroutine frames hold a GameState copy each, so a deep traversal needs far more than the
+    // scalar path's scratch; sized so that warmed-up strands never take another block.
+    static constexpr size_t kArenaBytes = 512 * 1024;
+
+    TraversalStrand() : arena_(kArenaBytes) {}
+
+    // Parks the running chain until the scheduler calls resume() again.
+    auto yield() {
+        struct YieldAwaiter {
+            TraversalStrand* strand;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> frame) noexcept { strand->resume_point_ = frame; }
+            void await_resume() const noexcept {}
+        };
+        return YieldAwaiter{this};
+    }
+
+    // Starts a root task; make_root is called with the strand's arena installed so the
+    // root frame is allocated there too.
+    template <typename MakeRoot>
+    void start(MakeRoot&& make_root) {
+        TraversalArenaScope scope(&arena_);
+        root_ = make_root();
+        resume_point_ = root_.handle();
+    }
+
+    bool done() const { return !root_.valid() || root_.done(); }
+
+    // Runs the strand until its next yield() or until the root task finishes.
+    void resume() {
+        TraversalArenaScope scope(&arena_);
+        std::coroutine_handle<> next = std::exchange(resume_point_, nullptr);
+        next.resume();
+    }
+
+    // Destroys the finished root and rewinds the arena for the next traversal.
+    void finish() {
+        root_.reset();
+        resume_point_ = nullptr;
+        arena_.reset();
+    }
+
+    const TraversalArena& arena() const { return arena_; }
+
+    int max_depth = 0; // Deepest frame of the current traversal (ThreadCounters::traversal_depth)
+
+private:
+    TraversalArena arena_;
+    TraversalTask root_;
+    std::coroutine_handle<> resume_point_;
+};
+
+} // namespace gto_solver
+
+#endif // GTO_SOLVER_TRAVERSAL_TASK_H
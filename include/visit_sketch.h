@@ -0,0 +1,42 @@
+#ifndef GTO_SOLVER_VISIT_SKETCH_H
+#define GTO_SOLVER_VISIT_SKETCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gto_solver {
+
+// Count-min sketch of infoset visits, used to defer creating a Node until an infoset has been
+// reached a few times (TrainingOptions::materialize_after_visits). Counts never undercount: a
+// key's estimate is at least its true count and saturates at 255. Hash collisions can only make
+// a node materialise early, which costs memory but never changes training.
+//
+// Rows of one-byte counters with conservative update (only the smallest counters of a key are
+// raised), which keeps the overcount of rare keys low. Not thread-safe: the engine calls it
+// under the node map lock, where the node lookup it replaces already runs.
+class VisitSketch {
+public:
+    // counters_per_row is rounded up to a power of two; 0 releases the sketch.
+    void reset(size_t counters_per_row, size_t rows = 4);
+    bool enabled() const { return !counters_.empty(); }
+
+    // Counts one visit of key and returns its estimated visit count including this one.
+    uint32_t add(const std::string& key);
+    // Estimated visit count of key (0 for a key never added, barring collisions).
+    uint32_t estimate(const std::string& key) const;
+
+    size_t memory_bytes() const { return counters_.size(); }
+
+private:
+    std::vector<uint8_t> counters_; // rows_ x (mask_ + 1)
+    size_t rows_ = 0;
+    size_t mask_ = 0;
+
+    size_t index(uint64_t hash, size_t row) const;
+};
+
+} // namespace gto_solver
+
+#endif // GTO_SOLVER_VISIT_SKETCH_H
@@ -47,6 +47,126 @@ std::string ActionSpec::to_string() const {
     return ss.str();
 }
 
+// --- Compact history ---
+namespace {
+
+struct CatalogueEntry {
+    ActionType type;
+    SizingUnit unit;
+    double value;
+    AbstractAction action;
+};
+
+// Fixed sizings; OPEN_SMALL and ISOLATE_* are resolved from the spot in classify_abstract_action
+constexpr CatalogueEntry kFixedSizings[] = {
+    {ActionType::RAISE, SizingUnit::BB, 2.5, AbstractAction::RAISE_2_5BB},
+    {ActionType::RAISE, SizingUnit::BB, 3.0, AbstractAction::RAISE_3BB},
+    {ActionType::RAISE, SizingUnit::BB, 4.0, AbstractAction::RAISE_4BB},
+    {ActionType::RAISE, SizingUnit::MULTIPLIER_X, 2.2, AbstractAction::RAISE_2_2X},
+    {ActionType::RAISE, SizingUnit::MULTIPLIER_X, 2.5, AbstractAction::RAISE_2_5X},
+    {ActionType::RAISE, SizingUnit::MULTIPLIER_X, 3.0, AbstractAction::RAISE_3X},
+    {ActionType::RAISE, SizingUnit::MULTIPLIER_X, 4.0, AbstractAction::RAISE_4X},
+    {ActionType::BET, SizingUnit::PCT_POT, 33, AbstractAction::BET_33_PCT},
+    {ActionType::BET, SizingUnit::PCT_POT, 50, AbstractAction::BET_50_PCT},
+    {ActionType::BET, SizingUnit::PCT_POT, 75, AbstractAction::BET_75_PCT},
+    {ActionType::BET, SizingUnit::PCT_POT, 100, AbstractAction::BET_100_PCT},
+    {ActionType::BET, SizingUnit::PCT_POT, 133, AbstractAction::BET_133_PCT},
+};
+
+AbstractAction classify_abstract_action(const ActionSpec& spec, ActionSetId action_set, int num_limpers) {
+    switch (spec.type) {
+        case ActionType::FOLD:   return AbstractAction::FOLD;
+        case ActionType::CHECK:  return AbstractAction::CHECK;
+        case ActionType::CALL:   return AbstractAction::CALL;
+        case ActionType::ALL_IN: return AbstractAction::ALL_IN;
+        default: break;
+    }
+    if (spec.unit == SizingUnit::BB) {
+        if (action_set == ActionSetId::OPEN && spec.value < 2.5 - 1e-5) return AbstractAction::OPEN_SMALL;
+        if (action_set == ActionSetId::ISOLATE) {
+            return (spec.value - num_limpers < 3.5) ? AbstractAction::ISOLATE_SMALL : AbstractAction::ISOLATE_LARGE;
+        }
+    }
+    for (const CatalogueEntry& entry : kFixedSizings) {
+        if (entry.type == spec.type && entry.unit == spec.unit && std::abs(entry.value - spec.value) < 1e-5) return entry.action;
+    }
+    spdlog::warn("No abstract action for spec {}; its compact history entry is ambiguous", spec.to_string());
+    return AbstractAction::UNKNOWN;
+}
+
+} // namespace
+
+const char* action_set_name(ActionSetId set) {
+    switch (set) {
+        case ActionSetId::UNTAGGED:            return "untagged";
+        case ActionSetId::PASSIVE:             return "passive";
+        case ActionSetId::HEADS_UP_OPEN:       return "hu_open";
+        case ActionSetId::SMALL_BLIND_OPEN:    return "sb_open";
+        case ActionSetId::OPEN:                return "open";
+        case ActionSetId::HEADS_UP_VS_LIMP:    return "hu_vs_limp";
+        case ActionSetId::ISOLATE:             return "isolate";
+        case ActionSetId::HEADS_UP_VS_OPEN:    return "hu_vs_open";
+        case ActionSetId::VS_OPEN:             return "vs_open";
+        case ActionSetId::VS_FOUR_BET:         return "vs_4bet";
+        case ActionSetId::VS_FIVE_BET:         return "vs_5bet";
+        case ActionSetId::POSTFLOP_UNOPENED:   return "postflop_unopened";
+        case ActionSetId::POSTFLOP_FACING_BET: return "postflop_facing_bet";
+        case ActionSetId::SHORT_STACK:         return "short_stack";
+    }
+    return "unknown";
+}
+
+const char* abstract_action_name(AbstractAction action) {
+    switch (action) {
+        case AbstractAction::FOLD:          return "fold";
+        case AbstractAction::CHECK:         return "check";
+        case AbstractAction::CALL:          return "call";
+        case AbstractAction::ALL_IN:        return "all_in";
+        case AbstractAction::OPEN_SMALL:    return "raise_open_small";
+        case AbstractAction::RAISE_2_5BB:   return "raise_2.5bb";
+        case AbstractAction::RAISE_3BB:     return "raise_3bb";
+        case AbstractAction::RAISE_4BB:     return "raise_4bb";
+        case AbstractAction::ISOLATE_SMALL: return "raise_iso_small";
+        case AbstractAction::ISOLATE_LARGE: return "raise_iso_large";
+        case AbstractAction::RAISE_2_2X:    return "raise_2.2x";
+        case AbstractAction::RAISE_2_5X:    return "raise_2.5x";
+        case AbstractAction::RAISE_3X:      return "raise_3x";
+        case AbstractAction::RAISE_4X:      return "raise_4x";
+        case AbstractAction::BET_33_PCT:    return "bet_33pct";
+        case AbstractAction::BET_50_PCT:    return "bet_50pct";
+        case AbstractAction::BET_75_PCT:    return "bet_75pct";
+        case AbstractAction::BET_100_PCT:   return "bet_100pct";
+        case AbstractAction::BET_133_PCT:   return "bet_133pct";
+        case AbstractAction::UNKNOWN:       break;
+    }
+    return "unknown";
+}
+
+ActionSetId compact_history_set(uint8_t byte) {
+    return static_cast<ActionSetId>(byte >> 4);
+}
+
+AbstractAction compact_history_action(uint8_t byte) {
+    static constexpr AbstractAction kCommonSlots[] = {AbstractAction::FOLD, AbstractAction::CHECK, AbstractAction::CALL, AbstractAction::ALL_IN};
+    size_t set = byte >> 4;
+    size_t slot = byte & 0x0F;
+    if (slot < std::size(kCommonSlots)) return kCommonSlots[slot];
+    slot -= std::size(kCommonSlots);
+    if (set >= std::size(kActionSetSizings) || slot >= kMaxSetSizings) return AbstractAction::UNKNOWN;
+    return kActionSetSizings[set][slot];
+}
+
+std::string describe_compact_history(const std::string& compact_history, bool with_sets) {
+    std::string out;
+    for (char c : compact_history) {
+        auto byte = static_cast<uint8_t>(c);
+        if (with_sets) { out += action_set_name(compact_history_set(byte)); out += ':'; }
+        out += abstract_action_name(compact_history_action(byte));
+        out += '/';
+    }
+    return out;
+}
+
 // --- ActionAbstraction Implementation ---
 
 ActionAbstraction::ActionAbstraction() {
@@ -66,6 +186,8 @@ std::vector<ActionSpec> ActionAbstraction::get_possible_action_specs(const GameS
     const int EFFECTIVE_STACK_BB = (BIG_BLIND_SIZE > 0) ? (effective_stack / BIG_BLIND_SIZE) : effective_stack; // Avoid division by zero
 
     if (player_stack <= 0) return {};
+    ActionSetId action_set = ActionSetId::PASSIVE; // Refined by the sizing branch taken below
+    int num_limpers = 0;
 
     // 1. Fold Action (Revisiting - add only if CALL is possible but player chooses not to)
     if (amount_to_call > 0 && player_stack > 0) { // If facing a bet and not already all-in
@@ -86,7 +208,7 @@ std::vector<ActionSpec> ActionAbstraction::get_possible_action_specs(const GameS
     if (player_stack > 0 && amount_to_call <= player_stack) {
         bool facing_bet_or_raise = amount_to_call > 0;
         int num_raises = current_state.get_raises_this_street();
-        int num_limpers = current_state.get_num_limpers();
+        num_limpers = current_state.get_num_limpers();
 
         // --- Preflop Abstraction ---
         if (street == Street::PREFLOP) {
@@ -99,6 +221,7 @@ std::vector<ActionSpec> ActionAbstraction::get_possible_action_specs(const GameS
 
             // Specific Check for HU SB Opening Spot
             if (current_state.get_num_players() == 2 && current_player == sb_index && num_raises == 0) {
+                action_set = ActionSetId::HEADS_UP_OPEN;
                 candidate_specs_set.insert({ActionType::RAISE, 3.0, SizingUnit::BB});
                 candidate_specs_set.insert({ActionType::RAISE, 4.0, SizingUnit::BB});
                 // Note: CALL/FOLD are added by general logic
@@ -110,11 +233,13 @@ std::vector<ActionSpec> ActionAbstraction::get_possible_action_specs(const GameS
                 if (is_rfi_situation) {
                     // Handle 6-max+ SB RFI
                     if (current_player == sb_index && current_state.get_num_players() > 2) {
+                        action_set = ActionSetId::SMALL_BLIND_OPEN;
                         candidate_specs_set.insert({ActionType::RAISE, 3.0, SizingUnit::BB});
                         candidate_specs_set.insert({ActionType::RAISE, 4.0, SizingUnit::BB});
                     }
                     // Handle other positions RFI
                     else if (current_state.is_first_to_act_preflop(current_player)) {
+                        action_set = ActionSetId::OPEN;
                         double open_size_bb_small = 2.2;
                         if (EFFECTIVE_STACK_BB < 25) open_size_bb_small = 2.0;
                         else if (EFFECTIVE_STACK_BB < 35) open_size_bb_small = 2.1;
@@ -125,9 +250,11 @@ std::vector<ActionSpec> ActionAbstraction::get_possible_action_specs(const GameS
                 } else if (!facing_bet_or_raise && num_limpers > 0) {
                     // Specific HU BB vs Limp case?
                     if(current_state.get_num_players() == 2 && current_player == bb_index) {
+                        action_set = ActionSetId::HEADS_UP_VS_LIMP;
                         candidate_specs_set.insert({ActionType::RAISE, 3.0, SizingUnit::BB}); // Same sizes as SB RFI for simplicity?
                         candidate_specs_set.insert({ActionType::RAISE, 4.0, SizingUnit::BB});
                     } else { // Multiway isolation sizing
+                        action_set = ActionSetId::ISOLATE;
                         double iso_size_bb1 = 3.0 + num_limpers;
                         double iso_size_bb2 = 4.0 + num_limpers;
                         candidate_specs_set.insert({ActionType::RAISE, iso_size_bb1, SizingUnit::BB});
@@ -137,18 +264,22 @@ std::vector<ActionSpec> ActionAbstraction::get_possible_action_specs(const GameS
                     if (num_raises == 1) {
                         bool is_bb_vs_sb_open_hu = (current_state.get_num_players() == 2 && current_player == bb_index && current_state.get_last_raiser() == sb_index);
                         if (is_bb_vs_sb_open_hu) {
+                            action_set = ActionSetId::HEADS_UP_VS_OPEN;
                             candidate_specs_set.insert({ActionType::RAISE, 3.0, SizingUnit::MULTIPLIER_X}); // 3bet 3x
                             candidate_specs_set.insert({ActionType::RAISE, 4.0, SizingUnit::MULTIPLIER_X}); // 3bet 4x
                             candidate_specs_set.insert({ActionType::ALL_IN}); // Always add ALL_IN vs SB open HU?
                         } else { // Facing RFI from other positions (multiway)
+                            action_set = ActionSetId::VS_OPEN;
                             // Add different 3bet sizings if needed
                             // Maybe add ALL_IN here too based on stack?
                             if (EFFECTIVE_STACK_BB <= 40) { candidate_specs_set.insert({ActionType::ALL_IN}); }
                         }
                     } else if (num_raises == 2) { // Facing 4bet
+                        action_set = ActionSetId::VS_FOUR_BET;
                         candidate_specs_set.insert({ActionType::RAISE, 2.5, SizingUnit::MULTIPLIER_X}); // 5bet sizing?
                         candidate_specs_set.insert({ActionType::ALL_IN}); // Usually only call/fold/all-in vs 4bet
                     } else { // Facing 5bet+
+                        action_set = ActionSetId::VS_FIVE_BET;
                         candidate_specs_set.insert({ActionType::ALL_IN}); // Only call/fold/all-in reasonable
                     }
                 }
@@ -157,12 +288,14 @@ std::vector<ActionSpec> ActionAbstraction::get_possible_action_specs(const GameS
         // --- Postflop Abstraction ---
         else {
              if (!facing_bet_or_raise) {
+                  action_set = ActionSetId::POSTFLOP_UNOPENED;
                   candidate_specs_set.insert({ActionType::BET, 33, SizingUnit::PCT_POT});
                   candidate_specs_set.insert({ActionType::BET, 50, SizingUnit::PCT_POT});
                   candidate_specs_set.insert({ActionType::BET, 75, SizingUnit::PCT_POT});
                   candidate_specs_set.insert({ActionType::BET, 100, SizingUnit::PCT_POT});
                   candidate_specs_set.insert({ActionType::BET, 133, SizingUnit::PCT_POT});
              } else {
+                  action_set = ActionSetId::POSTFLOP_FACING_BET;
                   candidate_specs_set.insert({ActionType::RAISE, 2.2, SizingUnit::MULTIPLIER_X});
                   candidate_specs_set.insert({ActionType::RAISE, 3.0, SizingUnit::MULTIPLIER_X});
              }
@@ -170,6 +303,7 @@ std::vector<ActionSpec> ActionAbstraction::get_possible_action_specs(const GameS
         }
     } else if (player_stack > 0 && amount_to_call > 0 && player_stack <= amount_to_call) {
          candidate_specs_set.clear();
+         action_set = ActionSetId::SHORT_STACK;
          candidate_specs_set.insert({ActionType::FOLD});
          candidate_specs_set.insert({ActionType::ALL_IN});
     }
@@ -308,6 +442,9 @@ std::vector<ActionSpec> ActionAbstraction::get_possible_action_specs(const GameS
     std::vector<ActionSpec> final_sorted_specs;
     for (const auto& pair : final_spec_amount_pairs) {
         final_sorted_specs.push_back(pair.first);
+        ActionSpec& tagged = final_sorted_specs.back();
+        tagged.action_set = action_set;
+        tagged.abstract_action = classify_abstract_action(tagged, action_set, num_limpers);
     }
 
     spdlog::debug("Final filtered specs for player {}:", current_player); // Log final specs
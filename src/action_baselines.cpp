@@ -0,0 +1,61 @@
+#include "action_baselines.h"
+
+#include <algorithm> // For std::min
+#include <functional> // For std::hash
+
+namespace gto_solver {
+
+void ActionBaselines::reset(size_t slots) {
+    estimates_ = 0;
+    corrected_ = 0;
+    if (slots == 0) {
+        slots_.clear();
+        slots_.shrink_to_fit();
+        stripes_.reset();
+        mask_ = 0;
+        return;
+    }
+    size_t width = 1;
+    while (width < slots) width <<= 1;
+    mask_ = width - 1;
+    slots_.assign(width, Slot{});
+    if (!stripes_) stripes_ = std::make_unique<std::mutex[]>(kStripes);
+}
+
+uint64_t ActionBaselines::key_hash(const std::string& info_set_key, int traversing_player) {
+    uint64_t hash = std::hash<std::string>{}(info_set_key);
+    return hash ^ (static_cast<uint64_t>(traversing_player + 1) * 0x9E3779B97F4A7C15ull);
+}
+
+double ActionBaselines::estimate(uint64_t hash, const double* strategy, size_t num_actions, size_t sampled, double sampled_value) {
+    if (!enabled() || num_actions > kMaxActions || sampled >= num_actions) return sampled_value;
+    estimates_.fetch_add(1, std::memory_order_relaxed);
+    const size_t index = static_cast<size_t>((hash * 0x9E3779B97F4A7C15ull) >> 20) & mask_;
+    const uint64_t tag = hash | 1;
+    std::lock_guard<std::mutex> lock(stripes_[index % kStripes]);
+    Slot& slot = slots_[index];
+    if (slot.tag != tag) slot = Slot{tag, 0.0, 0, {}, {}}; // Evict the previous key
+
+    // Action values shrunk toward the decision's mean value: an action not sampled yet is predicted
+    // by the mean, so before anything action-specific is known the estimate is the plain one
+    auto baseline = [&](size_t a) {
+        double visits = slot.visits[a];
+        return (visits * slot.values[a] + kPriorVisits * slot.mean) / (visits + kPriorVisits);
+    };
+    double value = sampled_value - baseline(sampled);
+    bool learned = false;
+    for (size_t a = 0; a < num_actions; ++a) {
+        value += strategy[a] * baseline(a);
+        learned = learned || slot.visits[a] > 0;
+    }
+    if (learned) corrected_.fetch_add(1, std::memory_order_relaxed);
+
+    uint32_t& visits = slot.visits[sampled];
+    visits = std::min(visits + 1, kWarmupVisits);
+    slot.values[sampled] += (sampled_value - slot.values[sampled]) / visits;
+    slot.mean_visits = std::min(slot.mean_visits + 1, kWarmupVisits);
+    slot.mean += (sampled_value - slot.mean) / slot.mean_visits;
+    return value;
+}
+
+} // namespace gto_solver
@@ -4,6 +4,10 @@
 #include "node.h" // Corrected include
 #include "action_abstraction.h" // Corrected include
 #include "hand_evaluator.h"   // Corrected include
+#include "node_serialization.h" // Shared checkpoint / spill record format
+#include "shared_node_store.h" // Multi-process training on one machine
+#include "regret_update_buffer.h" // Buffered update mode
+#include "regret_kernels.h" // SIMD regret matching / accumulation
 
 #include <iostream>
 #include <vector>
@@ -23,45 +27,99 @@
 #include <filesystem> // For renaming files atomically (C++17)
 #include <cmath>     // For std::isnan, std::isinf
 #include <memory>    // For std::unique_ptr, std::make_unique
+#include <unordered_map> // For grouping batched lanes by node
+#include <array>     // Fixed-size per-player scratch at terminals
+#include <bit>       // For std::popcount, std::countr_zero
+#include <sstream>   // For shard update payloads
+#include <cstring>   // For std::memcpy
 
 #include "spdlog/spdlog.h" // Include spdlog
 #include "spdlog/fmt/bundled/format.h" // Include fmt for logging vectors
 
-// Define a simple version number for the BINARY checkpoint format
-const uint32_t CHECKPOINT_VERSION_BIN = 4; // Incremented version due to ActionSpec change
+// The binary checkpoint format (CHECKPOINT_VERSION_BIN) is defined in node_serialization.h
 
 namespace gto_solver {
 
 // --- Helper Function: Regret Matching (Free function) ---
 std::vector<double> get_strategy_from_regrets(const std::vector<double>& regrets) {
-    size_t num_actions = regrets.size();
-    std::vector<double> strategy(num_actions);
-    double positive_regret_sum = 0.0;
-    for (double regret : regrets) {
-        positive_regret_sum += std::max(0.0, regret);
-    }
-    if (positive_regret_sum > 0) {
-        for (size_t i = 0; i < num_actions; ++i) {
-            strategy[i] = std::max(0.0, regrets[i]) / positive_regret_sum;
-        }
-    } else {
-        if (num_actions > 0) {
-             double uniform_prob = 1.0 / num_actions;
-             std::fill(strategy.begin(), strategy.end(), uniform_prob);
-        }
-    }
-    // Normalize strategy
-    double sum_strategy = std::accumulate(strategy.begin(), strategy.end(), 0.0);
-    if (sum_strategy > 1e-9) {
-        for (double& prob : strategy) { prob /= sum_strategy; }
-    } else if (num_actions > 0) {
-         double uniform_prob = 1.0 / num_actions;
-         std::fill(strategy.begin(), strategy.end(), uniform_prob);
-    }
+    std::vector<double> strategy(regrets.size());
+    regret_matching(regrets.data(), strategy.data(), regrets.size()); // Uniform if no regret is positive
     return strategy;
 }
 
 
+// Releases a tiered-store pin when a cfr_plus_recursive frame is done with its node.
+struct NodeUnpinGuard {
+    Node* node;
+    explicit NodeUnpinGuard(Node* pinned) : node(pinned) {}
+    ~NodeUnpinGuard() { if (node) node->pin_count.fetch_sub(1, std::memory_order_release); }
+    NodeUnpinGuard(const NodeUnpinGuard&) = delete;
+    NodeUnpinGuard& operator=(const NodeUnpinGuard&) = delete;
+};
+
+// Update buffer of the calling worker in buffered update mode (nullptr: update nodes in place).
+thread_local RegretUpdateBuffer* tls_update_buffer = nullptr;
+
+// Worker iterations after which its traversal arena should have reached its final size.
+constexpr int kScratchWarmupIterations = 16;
+
+// Counters per row of the deferred-materialisation visit sketch (4 rows of one byte: 4 MB).
+constexpr size_t kVisitSketchCountersPerRow = size_t(1) << 20;
+
+// Slots of the action-baseline table (96 bytes each: 24 MB).
+constexpr size_t kActionBaselineSlots = size_t(1) << 18;
+
+// Merge interval forced on multi-process runs that did not ask for buffered updates.
+constexpr int kMultiProcessBufferInterval = 16;
+
+// Share of uniform exploration in the simultaneous-update sampling policy (keeps every
+// action's sampling probability, and so the importance weights, bounded).
+constexpr double kOutcomeSamplingExploration = 0.6;
+
+// Releases the pins of every lane's node when a cfr_batch_recursive frame is done.
+struct BatchUnpinGuard {
+    std::pmr::vector<Node*> nodes{traversal_resource()};
+    ~BatchUnpinGuard() { for (Node* node : nodes) if (node) node->pin_count.fetch_sub(1, std::memory_order_release); }
+};
+
+// Samples an action from a regret-matched strategy (uniform if it is degenerate) and stores
+// the probability it was sampled with.
+static size_t sample_action(const double* strategy, size_t num_actions, std::mt19937& rng, double& sampling_prob) {
+    bool all_zero = true;
+    double sum_probs = 0.0;
+    for (size_t i = 0; i < num_actions; ++i) { sum_probs += strategy[i]; if (strategy[i] > 1e-9) all_zero = false; }
+    if (!all_zero && std::abs(sum_probs - 1.0) <= 1e-6) {
+        // Inverse CDF over the strategy itself (std::discrete_distribution would allocate its own copy)
+        double target = std::uniform_real_distribution<double>(0.0, sum_probs)(rng);
+        size_t sampled = 0;
+        double cumulative = strategy[0];
+        while (cumulative <= target && sampled + 1 < num_actions) cumulative += strategy[++sampled];
+        while (strategy[sampled] <= 0.0 && sampled > 0) --sampled; // Never land on a zero-probability action
+        sampling_prob = strategy[sampled];
+        return sampled;
+    }
+    std::uniform_int_distribution<size_t> uniform_dist(0, num_actions - 1);
+    sampling_prob = 1.0 / num_actions;
+    return uniform_dist(rng);
+}
+
+// Deals the flop / turn / river from deck when an action moved next_state to a new street.
+// Returns false if the deck ran out.
+static bool deal_street_cards(GameState& next_state, Street entry_street, const std::vector<Card>& deck, int& card_idx) {
+    Street next_street = next_state.get_current_street();
+    if (next_street == entry_street || next_street == Street::SHOWDOWN) return true;
+    int num_cards_to_deal = 0;
+    if (next_street == Street::FLOP && entry_street == Street::PREFLOP) num_cards_to_deal = 3;
+    else if (next_street == Street::TURN && entry_street == Street::FLOP) num_cards_to_deal = 1;
+    else if (next_street == Street::RIVER && entry_street == Street::TURN) num_cards_to_deal = 1;
+    if (num_cards_to_deal == 0) return true;
+    if (card_idx + num_cards_to_deal > static_cast<int>(deck.size())) return false;
+    next_state.deal_community_cards(deck.data() + card_idx, static_cast<size_t>(num_cards_to_deal));
+    card_idx += num_cards_to_deal;
+    return true;
+}
+
+
 // --- CFREngine Implementation ---
 
 CFREngine::CFREngine()
@@ -72,91 +130,327 @@ CFREngine::CFREngine()
     spdlog::debug("CFREngine created");
 }
 
+// Payoff of every player at a terminal state whose side pots are pots (see PotLayers).
+// Each hand in the showdown is ranked once, however many layers it contests.
+void CFREngine::terminal_payoffs(const GameState& state, const PotLayers& pots, double* payoffs) {
+    std::array<int, GameState::kMaxPlayers> ranks;
+    ranks.fill(kUnrankedHand);
+    if (pots.in_hand == 0) {
+        spdlog::error("Terminal state reached with 0 showdown players. History: {}", state.get_history_string());
+    } else if (std::popcount(pots.in_hand) > 1) {
+        const auto& community_cards = state.get_community_cards();
+        bool board_complete = (community_cards.size() == 5);
+        for (uint16_t in_hand = pots.in_hand; in_hand != 0; in_hand &= in_hand - 1) {
+            int player = std::countr_zero(in_hand);
+            const auto& hand = state.get_player_hand(player);
+            // Before the river every pot is split between its players
+            if (!board_complete) ranks[player] = 0;
+            else if (hand.size() == 2) ranks[player] = hand_evaluator_.evaluate_7_card_hand(hand, community_cards);
+        }
+    }
+    resolve_pot_payoffs(pots, ranks.data(), payoffs);
+}
+
+double CFREngine::terminal_payoff(const GameState& state, const PotLayers& pots, int traversing_player) {
+    if (!(pots.in_hand & (1u << traversing_player))) return -pots.contributions[traversing_player]; // Folded: nothing to rank
+    std::array<double, GameState::kMaxPlayers> payoffs;
+    terminal_payoffs(state, pots, payoffs.data());
+    return payoffs[traversing_player];
+}
+
+double CFREngine::terminal_payoff(const GameState& state, int traversing_player) {
+    return terminal_payoff(state, PotLayers::from_state(state), traversing_player);
+}
+
+// Finds the node for key, faulting it in from the cold tier or creating it as needed.
+// Caller holds node_map_mutex_. Returns nullptr when the memory budget refuses a new node or,
+// with defer_new, while a new infoset has not yet been seen often enough to get one;
+// with spilling enabled the returned node is pinned (release it with NodeUnpinGuard).
+// stored_key, if given, receives the node's key in the map.
+Node* CFREngine::find_or_create_node_locked(const std::string& key, const std::vector<ActionSpec>& legal_action_specs, int depth, ThreadCounters& counters,
+                                            bool defer_new, const std::string** stored_key) {
+    Node* node_ptr = nullptr;
+    auto it = node_map_.find(key);
+    std::unique_ptr<Node> cold_node = (it == node_map_.end() && spill_enabled_) ? cold_store_.take(key) : nullptr;
+    if (cold_node) {
+        // Fault the node back in from the disk tier
+        size_t node_bytes = estimate_node_bytes(cold_node->legal_actions.size());
+        it = node_map_.emplace(key, std::move(cold_node)).first;
+        node_ptr = it->second.get();
+        memory_budget_.charge(node_bytes, estimate_key_bytes(key));
+    } else if (it == node_map_.end() && defer_new && visit_sketch_.add(key) < static_cast<uint32_t>(materialize_after_visits_) &&
+               !(shared_store_ && shared_store_->find(key))) {
+        // Rarely reached so far: play it uniformly without a node (node_ptr stays null).
+        // An entry other workers already trained in the shared store is always mirrored.
+        deferred_lookups_.fetch_add(1, std::memory_order_relaxed);
+    } else if (it == node_map_.end()) {
+        size_t new_node_bytes = estimate_node_bytes(legal_action_specs.size());
+        size_t new_key_bytes = estimate_key_bytes(key);
+        if (!memory_budget_.can_allocate(new_node_bytes + new_key_bytes)) {
+            // Over budget: play this infoset uniformly without storing it (node_ptr stays null)
+            memory_budget_.note_uniform_fallback();
+        } else {
+            // Pass the vector of ActionSpec to the Node constructor
+            NodePlacementScope placement(depth < numa_interleave_depth_ ? NodePlacement::INTERLEAVED : NodePlacement::LOCAL);
+            auto emplace_result = node_map_.emplace(key, std::make_unique<Node>(legal_action_specs));
+            it = emplace_result.first;
+            node_ptr = it->second.get();
+            memory_budget_.charge(new_node_bytes, new_key_bytes);
+            total_nodes_created_++; // Increment is safe under map lock
+            counters.nodes_created.add(1);
+            if (num_shards_ > 1 && !owns_key(key)) register_remote_replica_locked(emplace_result.first->first, node_ptr);
+            if (shared_store_) {
+                // A full store leaves the node local to this process
+                node_ptr->shared_entry = shared_store_->find_or_insert(key, legal_action_specs);
+                if (node_ptr->shared_entry && shared_store_->num_actions(node_ptr->shared_entry) != legal_action_specs.size()) {
+                    spdlog::error("Shared store entry for {} has {} actions, expected {}.", key, shared_store_->num_actions(node_ptr->shared_entry), legal_action_specs.size());
+                    node_ptr->shared_entry = 0;
+                }
+            }
+
+            // --- DEBUG: Log Node Creation at Root ---
+            if (depth == 0) {
+                 std::stringstream ss_actions;
+                 for(const auto& spec : legal_action_specs) { ss_actions << spec.to_string() << " "; }
+                 // Revert to trace level
+                 spdlog::trace("Root Node CREATED: Key={}, Actions=[{}]", key, ss_actions.str());
+            }
+            // --- END DEBUG ---
+        }
+
+    } else {
+        node_ptr = it->second.get();
+        // TODO: Check consistency between node_ptr->legal_actions and legal_action_specs?
+    }
+    if (stored_key && node_ptr) *stored_key = &it->first;
+    if (spill_enabled_ && node_ptr) {
+        // Pinned under the map lock, so the evictor (which also holds it) never sees a stale 0
+        node_ptr->pin_count.fetch_add(1, std::memory_order_relaxed);
+        node_ptr->last_touch_sweep.store(touch_sweep_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    return node_ptr;
+}
+
+// Visit counters of a decision node reached by the scalar / interleaved traversal.
+void CFREngine::record_node_visit(Node* node_ptr, ThreadCounters& counters) {
+    counters.node_visits.add(1);
+    if (convergence_enabled_ && node_ptr) {
+        uint32_t window = convergence_.current_window();
+        if (node_ptr->last_visited_window.load(std::memory_order_relaxed) != window &&
+            node_ptr->last_visited_window.exchange(window, std::memory_order_relaxed) != window) {
+            counters.window_first_visits.add(1);
+        }
+    }
+}
+
+// Regret-matching strategy of a node (uniform for an unstored infoset).
+void CFREngine::current_strategy_of(Node* node_ptr, const std::string& info_set_key, size_t node_num_actions, double* current_strategy, ThreadCounters& counters) {
+    std::fill(current_strategy, current_strategy + node_num_actions, node_num_actions > 0 ? 1.0 / node_num_actions : 0.0); // Unstored infoset: uniform strategy
+    if (node_ptr && node_ptr->shared_entry) {
+        // Shared store: the regrets of all worker processes, read without a lock
+        std::pmr::vector<double> regrets(node_num_actions, traversal_resource());
+        shared_store_->load_regrets(node_ptr->shared_entry, regrets.data());
+        regret_matching(regrets.data(), current_strategy, node_num_actions);
+    } else if (node_ptr) { // Stored node: regret matching under the node lock
+        std::unique_lock<std::mutex> node_lock(node_ptr->node_mutex, std::defer_lock);
+        lock_timed(node_lock, counters.node_lock_wait_ns, timing_enabled_);
+        // --- DEBUG: Check vector sizes before access ---
+        if (node_ptr->regret_sum.size() != node_num_actions || node_ptr->strategy_sum.size() != node_num_actions) {
+             spdlog::error("CRITICAL: Vector size mismatch for node {} BEFORE get strategy! Regret={}, StrategySum={}, Expected={}",
+                           info_set_key, node_ptr->regret_sum.size(), node_ptr->strategy_sum.size(), node_num_actions);
+             // Potentially throw or return error state here
+             // For now, just log and attempt to continue carefully
+             // Resize might hide underlying issues, avoid it for now.
+        } else { // On a mismatch the strategy stays uniform
+            regret_matching(node_ptr->regret_sum.data(), current_strategy, node_num_actions);
+        }
+        // --- END DEBUG ---
+    }
+}
+
+// Step 5 of the traversal at the traversing player's node: regret and strategy-sum updates,
+// in place or through the worker's update buffer.
+void CFREngine::update_traversed_node(Node* node_ptr, const std::string& info_set_key, size_t node_num_actions,
+                                      const double* action_utilities, double node_utility, const double* current_strategy,
+                                      const std::pmr::vector<double>& reach_probabilities, int current_player, ThreadCounters& counters) {
+    double counterfactual_reach_prob = 1.0;
+    for (size_t p = 0; p < reach_probabilities.size(); ++p) {
+        if (static_cast<int>(p) != current_player) {
+            counterfactual_reach_prob *= reach_probabilities[p];
+        }
+    }
+
+    if (tls_update_buffer) {
+        // Buffered mode: record the deltas; merge_update_buffer() applies them under the node lock later
+        ScopedPhaseTimer update_timer(counters.update_ns, timing_enabled_);
+        if (node_ptr->regret_sum.size() != node_num_actions || node_ptr->strategy_sum.size() != node_num_actions) {
+             spdlog::error("Vector size mismatch during update for node {}", info_set_key);
+             throw std::runtime_error("Vector size mismatch during update for node " + info_set_key);
+        }
+        std::pmr::vector<double> regret_delta(node_num_actions, 0.0, traversal_resource());
+        std::pmr::vector<double> strategy_delta(node_num_actions, 0.0, traversal_resource());
+        if (counterfactual_reach_prob > 1e-9) {
+            accumulate_regrets(regret_delta.data(), action_utilities, node_utility, counterfactual_reach_prob, node_num_actions, false);
+        }
+        double player_reach_prob = reach_probabilities[current_player];
+        if (player_reach_prob > 1e-9) {
+            accumulate_strategy(strategy_delta.data(), current_strategy, player_reach_prob, node_num_actions);
+        }
+        tls_update_buffer->add(node_ptr, regret_delta.data(), strategy_delta.data(), spill_enabled_);
+        return; // visit_count is advanced by the merge
+    }
+
+    {
+        ScopedPhaseTimer update_timer(counters.update_ns, timing_enabled_); // Includes the node lock wait below
+        std::unique_lock<std::mutex> node_lock(node_ptr->node_mutex, std::defer_lock);
+        lock_timed(node_lock, counters.node_lock_wait_ns, timing_enabled_);
+        if (node_ptr->regret_sum.size() != node_num_actions || node_ptr->strategy_sum.size() != node_num_actions) {
+             spdlog::error("Vector size mismatch during update for node {}", info_set_key);
+             throw std::runtime_error("Vector size mismatch during update for node " + info_set_key);
+        }
+
+        // Apply reach probability of opponents for regret update
+        if (counterfactual_reach_prob > 1e-9) {
+            double positive_delta = accumulate_regrets(node_ptr->regret_sum.data(), action_utilities, node_utility,
+                                                       counterfactual_reach_prob, node_num_actions, floor_regrets_);
+            if (convergence_enabled_) counters.positive_regret_delta.add(positive_delta);
+        }
+        // Apply reach probability of current player for strategy sum update
+        double player_reach_prob = reach_probabilities[current_player];
+        if (player_reach_prob > 1e-9) {
+            accumulate_strategy(node_ptr->strategy_sum.data(), current_strategy, player_reach_prob, node_num_actions);
+        }
+    } // Node mutex released
+
+    node_ptr->visit_count++; // Atomic increment
+}
+
+// Applies an abstract action to state (a copy of the parent's) and deals the next street from
+// deck when the action closed the current one. Returns false if the action has no valid
+// amount, cannot be applied, or the deck ran out (card_idx is then left unchanged).
+bool CFREngine::advance_state(GameState& state, const ActionSpec& action_spec, int current_player,
+                              const std::vector<Card>& deck, int& card_idx, const std::string& info_set_key, ThreadCounters& counters) {
+    int amount;
+    {
+        ScopedPhaseTimer abstraction_timer(counters.abstraction_ns, timing_enabled_);
+        amount = action_abstraction_.get_action_amount(action_spec, state);
+    }
+    if (amount == -1 && action_spec.type != ActionType::FOLD && action_spec.type != ActionType::CHECK && action_spec.type != ActionType::CALL) {
+         spdlog::warn("Could not calculate amount for action spec: {} for node {}", action_spec.to_string(), info_set_key);
+         return false;
+    }
+    return advance_state(state, action_spec, amount, current_player, deck, card_idx);
+}
+
+// Same with the amount get_action_amount returned for action_spec in state.
+bool CFREngine::advance_state(GameState& state, const ActionSpec& action_spec, int amount, int current_player,
+                              const std::vector<Card>& deck, int& card_idx) {
+    if (amount == -1 && action_spec.type != ActionType::FOLD && action_spec.type != ActionType::CHECK && action_spec.type != ActionType::CALL) return false;
+    Street entry_street = state.get_current_street();
+    Action game_action;
+    game_action.player_index = current_player;
+    game_action.type = static_cast<Action::Type>(action_spec.type);
+    game_action.action_set = action_spec.action_set;
+    game_action.abstract_action = action_spec.abstract_action;
+    game_action.amount = amount;
+    try { state.apply_action(game_action); } catch (...) { return false; }
+    return deal_street_cards(state, entry_street, deck, card_idx);
+}
+
+// With an active link, a hand already cached at the trie vertex costs one map-lock section and
+// no key. Otherwise the key is built and the node found or created as before; it is cached at
+// the vertex when its actions are the vertex's menu (a node loaded from a tree built with other
+// action sizes keeps the key path, and so does the subtree below it).
+bool CFREngine::lookup_decision(const GameState& state, int current_player, int depth, bool defer_new, const TrieLink& link,
+                                DecisionLookup& decision, ThreadCounters& counters) {
+    InfosetTrie::Vertex* vertex = nullptr;
+    bool vertex_has_actions = false;
+    uint64_t hand = 0;
+    const std::vector<Card>& cards = state.get_player_hand(current_player);
+    if (link.active && cards.size() == 2) {
+        hand = trie_hand_code(convert_string_to_phe_card_index(cards[0]), convert_string_to_phe_card_index(cards[1]));
+        std::unique_lock<std::mutex> lock(node_map_mutex_, std::defer_lock);
+        lock_timed(lock, counters.map_lock_wait_ns, timing_enabled_);
+        vertex = link.parent ? trie_.child(link.parent, link.edge) : trie_.root(link.edge);
+        if (const InfosetTrie::Entry* entry = trie_.find(vertex, hand)) {
+            decision.node = entry->node;
+            decision.key = entry->key;
+            decision.actions = &entry->node->legal_actions;
+            decision.vertex = vertex;
+            return true;
+        }
+        vertex_has_actions = vertex->has_actions(); // Set once, so readable after the lock
+    }
+
+    {
+        ScopedPhaseTimer key_timer(counters.key_ns, timing_enabled_);
+        decision.info_set.emplace(state, current_player, history_encoding_);
+    }
+    decision.key = &decision.info_set->get_key();
+    std::vector<int> amounts;
+    if (!vertex_has_actions) {
+        ScopedPhaseTimer abstraction_timer(counters.abstraction_ns, timing_enabled_);
+        decision.fresh_actions = action_abstraction_.get_possible_action_specs(state);
+        if (vertex) {
+            amounts.reserve(decision.fresh_actions.size());
+            for (const ActionSpec& spec : decision.fresh_actions) amounts.push_back(action_abstraction_.get_action_amount(spec, state));
+        }
+    }
+    if ((vertex_has_actions ? vertex->actions() : decision.fresh_actions).empty()) return false;
+
+    std::unique_lock<std::mutex> lock(node_map_mutex_, std::defer_lock);
+    lock_timed(lock, counters.map_lock_wait_ns, timing_enabled_);
+    if (vertex && !vertex_has_actions) trie_.set_actions(vertex, std::move(decision.fresh_actions), std::move(amounts)); // Unless another worker was first
+    const std::vector<ActionSpec>& menu = vertex ? vertex->actions() : decision.fresh_actions;
+    const std::string* stored_key = nullptr;
+    decision.node = find_or_create_node_locked(*decision.key, menu, depth, counters, defer_new, &stored_key);
+    if (vertex && (!decision.node || decision.node->legal_actions == menu)) {
+        decision.vertex = vertex;
+        if (decision.node) trie_.insert(vertex, hand, {decision.node, stored_key});
+    }
+    decision.actions = decision.node ? &decision.node->legal_actions : &menu;
+    return true;
+}
+
+bool CFREngine::advance_decision(GameState& state, const DecisionLookup& decision, size_t slot, int current_player,
+                                 const std::vector<Card>& deck, int& card_idx, TrieLink& child, ThreadCounters& counters) {
+    const ActionSpec& action_spec = (*decision.actions)[slot];
+    const int first_dealt = card_idx;
+    bool advanced = decision.vertex ? advance_state(state, action_spec, decision.vertex->amounts()[slot], current_player, deck, card_idx)
+                                    : advance_state(state, action_spec, current_player, deck, card_idx, *decision.key, counters);
+    child = TrieLink{};
+    if (advanced && decision.vertex) {
+        std::array<int, 5> dealt{};
+        size_t num_dealt = std::min(static_cast<size_t>(card_idx - first_dealt), dealt.size());
+        for (size_t i = 0; i < num_dealt; ++i) dealt[i] = convert_string_to_phe_card_index(deck[first_dealt + i]);
+        child = TrieLink{true, decision.vertex, trie_edge_code(slot, dealt.data(), num_dealt)};
+    }
+    return advanced;
+}
+
 // Recursive MCCFR function (External Sampling) - Takes RNG reference and depth
 double CFREngine::cfr_plus_recursive(
     GameState current_state,
     int traversing_player,
-    const std::vector<double>& reach_probabilities,
+    const std::pmr::vector<double>& reach_probabilities,
     std::vector<Card>& deck,
     int& card_idx,
     std::mt19937& rng,
-    int depth // Added depth parameter
+    int depth, // Added depth parameter
+    TrieLink trie_link
 ) {
     // --- Update Max Depth Reached ---
     int current_max_depth = max_depth_reached_.load(std::memory_order_relaxed);
     if (depth > current_max_depth) {
         max_depth_reached_.compare_exchange_strong(current_max_depth, depth, std::memory_order_relaxed);
     }
+    ThreadCounters& counters = thread_counters();
+    if (depth > counters.current_traversal_max_depth) counters.current_traversal_max_depth = depth;
 
     // --- 1. Check for Terminal State ---
-     Street entry_street = current_state.get_current_street();
     if (current_state.is_terminal()) {
-        // ... (payoff calculation logic is unchanged) ...
-        double final_payoff = 0.0;
-        int num_players = current_state.get_num_players();
-        std::vector<double> contributions(num_players);
-        std::vector<bool> is_folded(num_players);
-        std::vector<int> showdown_players_indices;
-        double total_pot_size = 0.0;
-        for (int i = 0; i < num_players; ++i) {
-            contributions[i] = static_cast<double>(current_state.get_player_contribution(i));
-            is_folded[i] = current_state.has_player_folded(i);
-            total_pot_size += contributions[i];
-            if (!is_folded[i]) showdown_players_indices.push_back(i);
-        }
-        if (is_folded[traversing_player]) final_payoff = -contributions[traversing_player];
-        else if (showdown_players_indices.size() == 1) final_payoff = total_pot_size - contributions[traversing_player];
-        else if (showdown_players_indices.size() > 1) {
-            double total_winnings = 0.0;
-            std::vector<std::pair<double, int>> sorted_players;
-            for (int index : showdown_players_indices) sorted_players.push_back({contributions[index], index});
-            std::sort(sorted_players.begin(), sorted_players.end());
-            double last_contribution_level = 0.0;
-            std::vector<int> current_pot_eligible_players = showdown_players_indices;
-            for (const auto& p : sorted_players) {
-                double current_contribution_level = p.first;
-                int player_at_this_level = p.second;
-                if (current_contribution_level > last_contribution_level && !current_pot_eligible_players.empty()) {
-                    double pot_increment_per_player = current_contribution_level - last_contribution_level;
-                    double current_pot_size = pot_increment_per_player * current_pot_eligible_players.size();
-                    std::vector<int> current_winners;
-                    int best_rank = 9999;
-                    const auto& community_cards = current_state.get_community_cards();
-                    bool board_complete = (community_cards.size() == 5);
-                    if (board_complete) {
-                        std::vector<int> current_ranks(num_players, 9999);
-                        for (int eligible_player_index : current_pot_eligible_players) {
-                             const auto& hand = current_state.get_player_hand(eligible_player_index);
-                             if (hand.size() == 2) {
-                                 current_ranks[eligible_player_index] = hand_evaluator_.evaluate_7_card_hand(hand, community_cards);
-                                 best_rank = std::min(best_rank, current_ranks[eligible_player_index]);
-                             } else {
-                                 current_ranks[eligible_player_index] = 9999;
-                             }
-                        }
-                        for (int eligible_player_index : current_pot_eligible_players) {
-                            if (current_ranks[eligible_player_index] == best_rank) current_winners.push_back(eligible_player_index);
-                        }
-                    } else {
-                         current_winners = current_pot_eligible_players;
-                    }
-                    if (!current_winners.empty()) {
-                        double share = current_pot_size / current_winners.size();
-                        for (int winner_index : current_winners) {
-                            if (winner_index == traversing_player) total_winnings += share;
-                        }
-                    }
-                    last_contribution_level = current_contribution_level;
-                }
-                 auto it = std::remove(current_pot_eligible_players.begin(), current_pot_eligible_players.end(), player_at_this_level);
-                 if (it != current_pot_eligible_players.end()) current_pot_eligible_players.erase(it, current_pot_eligible_players.end());
-            }
-            final_payoff = total_winnings - contributions[traversing_player];
-        } else {
-             spdlog::error("Terminal state reached with 0 showdown players. History: {}", current_state.get_history_string());
-             final_payoff = -contributions[traversing_player];
-        }
-        return final_payoff;
+        ScopedPhaseTimer eval_timer(counters.eval_ns, timing_enabled_);
+        return terminal_payoff(current_state, traversing_player);
     }
 
     // --- 2. Get InfoSet and Node ---
@@ -164,8 +458,14 @@ double CFREngine::cfr_plus_recursive(
      if (current_state.get_player_hand(current_player).empty()) {
          return 0.0;
      }
-    InfoSet info_set(current_state, current_player);
-    const std::string& info_set_key = info_set.get_key();
+    // Key, legal actions and thread-safe node lookup / creation (through the trie when active)
+    const bool defer_new = materialize_after_visits_ > 0 && current_player != traversing_player;
+    DecisionLookup decision;
+    if (!lookup_decision(current_state, current_player, depth, defer_new, trie_link, decision, counters)) {
+         return 0.0;
+    }
+    Node* node_ptr = decision.node;
+    const std::string& info_set_key = *decision.key;
 
     // --- DEBUG: Log Root Infoset Key ---
     // Log only at depth 0, regardless of player match for now, to ensure we see *some* root key
@@ -174,107 +474,36 @@ double CFREngine::cfr_plus_recursive(
         spdlog::info("Root Key Log: Depth=0, CurrentPlayer={}, TraversingPlayer={}, Key={}", current_player, traversing_player, info_set_key);
     }
     // --- END DEBUG ---
+    NodeUnpinGuard unpin_guard(spill_enabled_ ? node_ptr : nullptr);
 
-    // Get legal actions using the new spec-based method
-    std::vector<ActionSpec> legal_action_specs = action_abstraction_.get_possible_action_specs(current_state);
-    size_t num_actions = legal_action_specs.size();
-
-    if (num_actions == 0) {
-         return 0.0;
-    }
-
-    Node* node_ptr = nullptr;
-    // --- Thread-safe Node Lookup/Creation ---
-    {
-        std::lock_guard<std::mutex> lock(node_map_mutex_); // Lock the map
-        auto it = node_map_.find(info_set_key);
-        if (it == node_map_.end()) {
-            // Pass the vector of ActionSpec to the Node constructor
-            auto emplace_result = node_map_.emplace(info_set_key, std::make_unique<Node>(legal_action_specs));
-            node_ptr = emplace_result.first->second.get();
-            total_nodes_created_++; // Increment is safe under map lock
-
-            // --- DEBUG: Log Node Creation at Root ---
-            if (depth == 0) {
-                 std::stringstream ss_actions;
-                 for(const auto& spec : legal_action_specs) { ss_actions << spec.to_string() << " "; }
-                 // Revert to trace level
-                 spdlog::trace("Root Node CREATED: Key={}, Actions=[{}]", info_set_key, ss_actions.str());
-            }
-            // --- END DEBUG ---
-
-        } else {
-            node_ptr = it->second.get();
-            // TODO: Check consistency between node_ptr->legal_actions and legal_action_specs?
-        }
-    } // Map mutex released
-
-    if (!node_ptr) {
+    if (!node_ptr && !defer_new && !memory_budget_.exhausted()) {
          spdlog::error("Failed to get or create node pointer for key: {}", info_set_key);
          throw std::runtime_error("Failed to get or create node pointer for key: " + info_set_key);
     }
-    // --- Use the actions stored IN THE NODE from this point forward --- 
-    const std::vector<ActionSpec>& node_legal_actions = node_ptr->legal_actions;
+    // --- Use the actions stored IN THE NODE from this point forward ---
+    // (or the freshly computed ones when the node could not be stored)
+    const std::vector<ActionSpec>& node_legal_actions = *decision.actions;
     size_t node_num_actions = node_legal_actions.size();
     if (node_num_actions == 0) {
         // If node exists but has 0 actions, should log warning/error potentially?
         spdlog::warn("Node {} found but has 0 legal actions.", info_set_key);
         return 0.0;
     }
+    record_node_visit(node_ptr, counters);
 
     // --- 3. Calculate Current Strategy (Regret Matching) ---
-    std::vector<double> current_regrets;
-    std::vector<double> current_strategy_sum;
-    {
-        std::lock_guard<std::mutex> node_lock(node_ptr->node_mutex);
-        // --- DEBUG: Check vector sizes before access ---
-        if (node_ptr->regret_sum.size() != node_num_actions || node_ptr->strategy_sum.size() != node_num_actions) {
-             spdlog::error("CRITICAL: Vector size mismatch for node {} BEFORE get strategy! Regret={}, StrategySum={}, Expected={}",
-                           info_set_key, node_ptr->regret_sum.size(), node_ptr->strategy_sum.size(), node_num_actions);
-             // Potentially throw or return error state here
-             // For now, just log and attempt to continue carefully
-             // Resize might hide underlying issues, avoid it for now.
-        }
-        // --- END DEBUG ---
-        current_regrets = node_ptr->regret_sum;
-        current_strategy_sum = node_ptr->strategy_sum;
-    }
-    // Call the free function
-    std::vector<double> current_strategy = get_strategy_from_regrets(current_regrets);
+    std::pmr::memory_resource* scratch = traversal_resource();
+    std::pmr::vector<double> current_strategy(node_num_actions, scratch);
+    current_strategy_of(node_ptr, info_set_key, node_num_actions, current_strategy.data(), counters);
 
     // --- 4. MCCFR Logic: Sample Opponent Actions, Explore Own Actions ---
     double node_utility = 0.0;
-    std::vector<double> action_utilities(node_num_actions, 0.0);
+    std::pmr::vector<double> action_utilities(node_num_actions, 0.0, scratch);
 
     if (current_player != traversing_player) {
         // --- Opponent's Turn: Sample one action ---
-        size_t sampled_action_idx = 0;
         double sampling_prob = 1.0;
-        if (!current_strategy.empty()) {
-             bool all_zero = true;
-             double sum_probs = 0.0;
-             for(double p : current_strategy) { sum_probs += p; if (p > 1e-9) { all_zero = false; } }
-
-             if (all_zero || std::abs(sum_probs - 1.0) > 1e-6) {
-                  std::uniform_int_distribution<size_t> uniform_dist(0, current_strategy.size() - 1);
-                  sampled_action_idx = uniform_dist(rng);
-                  sampling_prob = (current_strategy.size() > 0) ? (1.0 / current_strategy.size()) : 1.0;
-             } else {
-                  try {
-                       std::discrete_distribution<size_t> dist(current_strategy.begin(), current_strategy.end());
-                       sampled_action_idx = dist(rng);
-                       sampling_prob = current_strategy[sampled_action_idx];
-                  } catch (const std::exception& e) {
-                       spdlog::error("Error creating discrete_distribution for node {}: {}. Strategy: [{}]", info_set_key, e.what(), fmt::join(current_strategy, ", "));
-                       std::uniform_int_distribution<size_t> uniform_dist(0, current_strategy.size() - 1);
-                       sampled_action_idx = uniform_dist(rng);
-                       sampling_prob = (current_strategy.size() > 0) ? (1.0 / current_strategy.size()) : 1.0;
-                  }
-             }
-        } else {
-             spdlog::error("Empty strategy for opponent node: {}", info_set_key);
-             return 0.0; // Should not happen if strategy is valid
-        }
+        size_t sampled_action_idx = sample_action(current_strategy.data(), current_strategy.size(), rng, sampling_prob);
 
         // Importance weight calculation (inverse sampling probability)
         double importance_weight = (sampling_prob > 1e-9) ? (1.0 / sampling_prob) : 0.0;
@@ -287,39 +516,13 @@ double CFREngine::cfr_plus_recursive(
         }
 
         // Prepare for recursive call
-        const ActionSpec& action_spec = node_legal_actions[sampled_action_idx]; // Use ActionSpec
-        Action game_action;
-        game_action.player_index = current_player;
-        game_action.type = static_cast<Action::Type>(action_spec.type);
-        game_action.amount = action_abstraction_.get_action_amount(action_spec, current_state);
-
-        if (game_action.amount == -1 && action_spec.type != ActionType::FOLD && action_spec.type != ActionType::CHECK && action_spec.type != ActionType::CALL) {
-             spdlog::warn("Could not calculate amount for sampled action spec: {} for node {}", action_spec.to_string(), info_set_key);
-             return 0.0;
-        }
-
         GameState next_state = current_state;
-        try { next_state.apply_action(game_action); } catch (...) { return 0.0; }
-
-        // (Community card dealing logic...)
-        Street next_street = next_state.get_current_street();
         int current_card_idx = card_idx;
-        if (next_street != entry_street && next_street != Street::SHOWDOWN) {
-             std::vector<Card> cards_to_deal;
-            int num_cards_to_deal = 0;
-            if (next_street == Street::FLOP && entry_street == Street::PREFLOP) num_cards_to_deal = 3;
-            else if (next_street == Street::TURN && entry_street == Street::FLOP) num_cards_to_deal = 1;
-            else if (next_street == Street::RIVER && entry_street == Street::TURN) num_cards_to_deal = 1;
-            if (num_cards_to_deal > 0) {
-                if (card_idx + num_cards_to_deal <= deck.size()) {
-                    for(int k=0; k<num_cards_to_deal; ++k) cards_to_deal.push_back(deck[card_idx++]);
-                    next_state.deal_community_cards(cards_to_deal);
-                } else { card_idx = current_card_idx; return 0.0; }
-            }
-        }
+        TrieLink child_link;
+        if (!advance_decision(next_state, decision, sampled_action_idx, current_player, deck, card_idx, child_link, counters)) return 0.0;
 
         // --- Correction: Apply importance weight to reach probabilities ---
-        std::vector<double> next_reach_probabilities = reach_probabilities;
+        std::pmr::vector<double> next_reach_probabilities(reach_probabilities, scratch);
         // Update current player's reach probability (standard CFR)
         if (sampled_action_idx < current_strategy.size()) {
              next_reach_probabilities[current_player] *= current_strategy[sampled_action_idx];
@@ -338,101 +541,508 @@ double CFREngine::cfr_plus_recursive(
 
         // Recursive call - DO NOT multiply result by importance_weight here anymore
         // Store result in temporary variable, then assign (avoids direct negation)
-        double temp_utility = cfr_plus_recursive(next_state, traversing_player, next_reach_probabilities, deck, card_idx, rng, depth + 1);
+        double temp_utility = cfr_plus_recursive(next_state, traversing_player, next_reach_probabilities, deck, card_idx, rng, depth + 1, child_link);
         node_utility = -temp_utility;
         card_idx = current_card_idx; // Restore card index
+        if (baselines_.enabled()) {
+            // Control variate: the actions not sampled count with their learned values
+            node_utility = baselines_.estimate(ActionBaselines::key_hash(info_set_key, traversing_player), current_strategy.data(),
+                                               node_num_actions, sampled_action_idx, node_utility);
+        }
 
     } else { // current_player == traversing_player
         // --- Traversing Player's Turn: Explore all actions ---
         for (size_t i = 0; i < node_num_actions; ++i) {
-            const ActionSpec& action_spec = node_legal_actions[i]; // Use ActionSpec
-            Action game_action;
-            game_action.player_index = current_player;
-            game_action.type = static_cast<Action::Type>(action_spec.type);
-            game_action.amount = action_abstraction_.get_action_amount(action_spec, current_state);
-
-            if (game_action.amount == -1 && action_spec.type != ActionType::FOLD && action_spec.type != ActionType::CHECK && action_spec.type != ActionType::CALL) {
-                 spdlog::warn("Could not calculate amount for action spec: {} for node {}", action_spec.to_string(), info_set_key);
-                 action_utilities[i] = -1e18;
-                 continue;
-            }
-
             GameState next_state = current_state;
-             try { next_state.apply_action(game_action); } catch (...) { action_utilities[i] = -1e18; continue; }
-
-            // (Community card dealing logic...)
-             Street next_street = next_state.get_current_street();
-             int current_card_idx = card_idx;
-             if (next_street != entry_street && next_street != Street::SHOWDOWN) {
-                 std::vector<Card> cards_to_deal;
-                 int num_cards_to_deal = 0;
-                 if (next_street == Street::FLOP && entry_street == Street::PREFLOP) num_cards_to_deal = 3;
-                 else if (next_street == Street::TURN && entry_street == Street::FLOP) num_cards_to_deal = 1;
-                 else if (next_street == Street::RIVER && entry_street == Street::TURN) num_cards_to_deal = 1;
-                 if (num_cards_to_deal > 0) {
-                     if (card_idx + num_cards_to_deal <= deck.size()) {
-                         for(int k=0; k<num_cards_to_deal; ++k) cards_to_deal.push_back(deck[card_idx++]);
-                         next_state.deal_community_cards(cards_to_deal);
-                     } else { card_idx = current_card_idx; action_utilities[i] = -1e18; continue; }
-                 }
-             }
+            int current_card_idx = card_idx;
+            TrieLink child_link;
+            if (!advance_decision(next_state, decision, i, current_player, deck, card_idx, child_link, counters)) {
+                action_utilities[i] = -1e18;
+                continue;
+            }
 
-            action_utilities[i] = -cfr_plus_recursive(next_state, traversing_player, reach_probabilities, deck, card_idx, rng, depth + 1);
+            action_utilities[i] = -cfr_plus_recursive(next_state, traversing_player, reach_probabilities, deck, card_idx, rng, depth + 1, child_link);
             card_idx = current_card_idx;
             node_utility += current_strategy[i] * action_utilities[i];
         }
 
         // --- 5. Update Regrets & Strategy Sum (Traversing Player Only) ---
-        double counterfactual_reach_prob = 1.0;
-        for(int p = 0; p < current_state.get_num_players(); ++p) {
-            if (p != current_player) {
-                counterfactual_reach_prob *= reach_probabilities[p];
+        if (!node_ptr) return node_utility; // Nothing stored to update (memory budget reached)
+        update_traversed_node(node_ptr, info_set_key, node_num_actions, action_utilities.data(), node_utility,
+                              current_strategy.data(), reach_probabilities, current_player, counters);
+    }
+
+    return node_utility;
+}
+
+// Outcome-sampling traversal with simultaneous updates. With q the sampling probability of the
+// terminal z and t the probability of the rest of the line under the current strategy sigma,
+// the acting player p's sampled counterfactual value is pi_-p * u_p(z) * t(ha) / q for the
+// sampled action a (0 for the others) and sigma(a) times that for the node, so its regret
+// update is the usual one with those action utilities.
+double CFREngine::cfr_simultaneous_recursive(GameState current_state, const std::pmr::vector<double>& reach_probabilities,
+                                             double sample_prob, std::vector<Card>& deck, int& card_idx, std::mt19937& rng,
+                                             int depth, double* utilities, TrieLink trie_link) {
+    int current_max_depth = max_depth_reached_.load(std::memory_order_relaxed);
+    if (depth > current_max_depth) {
+        max_depth_reached_.compare_exchange_strong(current_max_depth, depth, std::memory_order_relaxed);
+    }
+    ThreadCounters& counters = thread_counters();
+    if (depth > counters.current_traversal_max_depth) counters.current_traversal_max_depth = depth;
+    const int num_players = current_state.get_num_players();
+    std::fill(utilities, utilities + num_players, 0.0);
+
+    if (current_state.is_terminal()) {
+        ScopedPhaseTimer eval_timer(counters.eval_ns, timing_enabled_);
+        terminal_payoffs(current_state, PotLayers::from_state(current_state), utilities);
+        for (int p = 0; p < num_players; ++p) utilities[p] /= sample_prob;
+        return 1.0;
+    }
+
+    int current_player = current_state.get_current_player();
+    // Dead ends pay zero, as in cfr_plus_recursive, and still count as a completed line
+    if (current_state.get_player_hand(current_player).empty()) return 1.0;
+    DecisionLookup decision; // Every node on the line is updated, so none is deferred
+    if (!lookup_decision(current_state, current_player, depth, false, trie_link, decision, counters)) return 1.0;
+    Node* node_ptr = decision.node;
+    const std::string& info_set_key = *decision.key;
+    NodeUnpinGuard unpin_guard(spill_enabled_ ? node_ptr : nullptr);
+    if (!node_ptr && !memory_budget_.exhausted()) {
+         spdlog::error("Failed to get or create node pointer for key: {}", info_set_key);
+         throw std::runtime_error("Failed to get or create node pointer for key: " + info_set_key);
+    }
+    const std::vector<ActionSpec>& node_legal_actions = *decision.actions;
+    const size_t node_num_actions = node_legal_actions.size();
+    if (node_num_actions == 0) return 1.0;
+    record_node_visit(node_ptr, counters);
+
+    std::pmr::memory_resource* scratch = traversal_resource();
+    std::pmr::vector<double> current_strategy(node_num_actions, scratch);
+    current_strategy_of(node_ptr, info_set_key, node_num_actions, current_strategy.data(), counters);
+    std::pmr::vector<double> sampling_policy(node_num_actions, scratch);
+    for (size_t a = 0; a < node_num_actions; ++a) {
+        sampling_policy[a] = kOutcomeSamplingExploration / node_num_actions + (1.0 - kOutcomeSamplingExploration) * current_strategy[a];
+    }
+    double sampling_prob = 1.0;
+    size_t sampled = sample_action(sampling_policy.data(), node_num_actions, rng, sampling_prob);
+
+    GameState next_state = current_state;
+    int current_card_idx = card_idx;
+    double tail_prob = 1.0; // An action the state rejects is a zero-payoff leaf
+    TrieLink child_link;
+    if (advance_decision(next_state, decision, sampled, current_player, deck, card_idx, child_link, counters)) {
+        std::pmr::vector<double> next_reach_probabilities(reach_probabilities, scratch);
+        next_reach_probabilities[current_player] *= current_strategy[sampled];
+        tail_prob = cfr_simultaneous_recursive(std::move(next_state), next_reach_probabilities, sample_prob * sampling_prob,
+                                               deck, card_idx, rng, depth + 1, utilities, child_link);
+    }
+    card_idx = current_card_idx;
+
+    if (node_ptr && tail_prob > 0.0) {
+        std::pmr::vector<double> action_utilities(node_num_actions, 0.0, scratch);
+        action_utilities[sampled] = utilities[current_player] * tail_prob;
+        double node_utility = current_strategy[sampled] * action_utilities[sampled];
+        // Strategy sums are weighted by the player's own reach over the probability of sampling
+        // this node (stochastically weighted averaging)
+        std::pmr::vector<double> update_reach(reach_probabilities, scratch);
+        update_reach[current_player] /= sample_prob;
+        update_traversed_node(node_ptr, info_set_key, node_num_actions, action_utilities.data(), node_utility,
+                              current_strategy.data(), update_reach, current_player, counters);
+    }
+    return tail_prob * current_strategy[sampled];
+}
+
+// Coroutine counterpart of cfr_plus_recursive for the interleaved mode: same sampling and
+// updates, but after the node lookup it prefetches the node, yields, prefetches the regret /
+// strategy slabs the node points to, and yields again, so the strand's other traversals run
+// while the cache lines are in flight.
+TraversalTask CFREngine::cfr_interleaved(TraversalStrand& strand, GameState current_state, int traversing_player,
+                                         const std::pmr::vector<double>& reach_probabilities, const std::vector<Card>& deck,
+                                         int card_idx, std::mt19937& rng, int depth) {
+    int current_max_depth = max_depth_reached_.load(std::memory_order_relaxed);
+    if (depth > current_max_depth) {
+        max_depth_reached_.compare_exchange_strong(current_max_depth, depth, std::memory_order_relaxed);
+    }
+    if (depth > strand.max_depth) strand.max_depth = depth;
+    ThreadCounters& counters = thread_counters();
+
+    if (current_state.is_terminal()) {
+        ScopedPhaseTimer eval_timer(counters.eval_ns, timing_enabled_);
+        co_return terminal_payoff(current_state, traversing_player);
+    }
+    int current_player = current_state.get_current_player();
+    if (current_state.get_player_hand(current_player).empty()) co_return 0.0;
+    std::string info_set_key = [&] {
+        ScopedPhaseTimer key_timer(counters.key_ns, timing_enabled_);
+        return InfoSet(current_state, current_player, history_encoding_).get_key();
+    }();
+    std::vector<ActionSpec> legal_action_specs = [&] {
+        ScopedPhaseTimer abstraction_timer(counters.abstraction_ns, timing_enabled_);
+        return action_abstraction_.get_possible_action_specs(current_state);
+    }();
+    if (legal_action_specs.empty()) co_return 0.0;
+
+    Node* node_ptr = nullptr;
+    const bool defer_new = materialize_after_visits_ > 0 && current_player != traversing_player;
+    {
+        std::unique_lock<std::mutex> lock(node_map_mutex_, std::defer_lock);
+        lock_timed(lock, counters.map_lock_wait_ns, timing_enabled_);
+        node_ptr = find_or_create_node_locked(info_set_key, legal_action_specs, depth, counters, defer_new);
+    }
+    NodeUnpinGuard unpin_guard(spill_enabled_ ? node_ptr : nullptr); // Also keeps the node resident while parked
+    if (!node_ptr && !defer_new && !memory_budget_.exhausted()) {
+         throw std::runtime_error("Failed to get or create node pointer for key: " + info_set_key);
+    }
+    if (node_ptr) {
+        __builtin_prefetch(node_ptr, 1);
+        co_await strand.yield();
+        __builtin_prefetch(node_ptr->regret_sum.data(), 1);
+        __builtin_prefetch(node_ptr->strategy_sum.data(), 1);
+        co_await strand.yield();
+    }
+    const std::vector<ActionSpec>& node_legal_actions = node_ptr ? node_ptr->legal_actions : legal_action_specs;
+    size_t node_num_actions = node_legal_actions.size();
+    if (node_num_actions == 0) co_return 0.0;
+    record_node_visit(node_ptr, counters);
+
+    std::pmr::vector<double> current_strategy(node_num_actions, traversal_resource());
+    current_strategy_of(node_ptr, info_set_key, node_num_actions, current_strategy.data(), counters);
+    double node_utility = 0.0;
+
+    if (current_player != traversing_player) {
+        double sampling_prob = 1.0;
+        size_t sampled_action_idx = sample_action(current_strategy.data(), node_num_actions, rng, sampling_prob);
+        double importance_weight = (sampling_prob > 1e-9) ? (1.0 / sampling_prob) : 0.0;
+        if (importance_weight == 0.0) co_return 0.0;
+        GameState next_state = current_state;
+        int next_card_idx = card_idx;
+        if (!advance_state(next_state, node_legal_actions[sampled_action_idx], current_player, deck, next_card_idx, info_set_key, counters)) co_return 0.0;
+        std::pmr::vector<double> next_reach_probabilities(reach_probabilities, traversal_resource());
+        next_reach_probabilities[current_player] *= current_strategy[sampled_action_idx];
+        for (size_t p = 0; p < next_reach_probabilities.size(); ++p) {
+            if (static_cast<int>(p) != current_player) next_reach_probabilities[p] *= importance_weight;
+        }
+        node_utility = -co_await cfr_interleaved(strand, std::move(next_state), traversing_player, next_reach_probabilities, deck, next_card_idx, rng, depth + 1);
+        if (baselines_.enabled()) {
+            node_utility = baselines_.estimate(ActionBaselines::key_hash(info_set_key, traversing_player), current_strategy.data(),
+                                               node_num_actions, sampled_action_idx, node_utility);
+        }
+        co_return node_utility;
+    }
+
+    std::pmr::vector<double> action_utilities(node_num_actions, 0.0, traversal_resource());
+    for (size_t i = 0; i < node_num_actions; ++i) {
+        GameState next_state = current_state;
+        int next_card_idx = card_idx;
+        if (!advance_state(next_state, node_legal_actions[i], current_player, deck, next_card_idx, info_set_key, counters)) {
+            action_utilities[i] = -1e18;
+            continue;
+        }
+        action_utilities[i] = -co_await cfr_interleaved(strand, std::move(next_state), traversing_player, reach_probabilities, deck, next_card_idx, rng, depth + 1);
+        node_utility += current_strategy[i] * action_utilities[i];
+    }
+    if (node_ptr) {
+        update_traversed_node(node_ptr, info_set_key, node_num_actions, action_utilities.data(), node_utility,
+                              current_strategy.data(), reach_probabilities, current_player, counters);
+    }
+    co_return node_utility;
+}
+
+// Root of one strand: the traversals of every player for one deal.
+TraversalTask CFREngine::interleaved_deal(TraversalStrand& strand, GameState root_state, const std::vector<Card>& deck,
+                                          int card_index, std::mt19937& rng, int thread_id) {
+    ThreadCounters& counters = thread_counters();
+    const int num_players = root_state.get_num_players();
+    std::pmr::vector<double> initial_reach_probs(num_players, 1.0, traversal_resource());
+    for (int player = 0; player < num_players; ++player) {
+        strand.max_depth = 0;
+        try {
+            co_await cfr_interleaved(strand, root_state, player, initial_reach_probs, deck, card_index, rng, 0);
+        } catch (const std::exception& e) { spdlog::error("[Thread {}] Exception in cfr_interleaved: {}", thread_id, e.what()); }
+        counters.traversals.add(1);
+        counters.traversal_depth.add(strand.max_depth);
+    }
+    co_return 0.0;
+}
+
+
+std::pmr::vector<double> CFREngine::cfr_batch_recursive(const std::pmr::vector<TraversalLane>& lanes, int traversing_player, std::mt19937& rng, int depth) {
+    const size_t num_lanes = lanes.size();
+    std::pmr::memory_resource* scratch = traversal_resource();
+    std::pmr::vector<double> utilities(num_lanes, 0.0, scratch);
+    if (num_lanes == 0) return utilities;
+    int current_max_depth = max_depth_reached_.load(std::memory_order_relaxed);
+    if (depth > current_max_depth) {
+        max_depth_reached_.compare_exchange_strong(current_max_depth, depth, std::memory_order_relaxed);
+    }
+    ThreadCounters& counters = thread_counters();
+    if (depth > counters.current_traversal_max_depth) counters.current_traversal_max_depth = depth;
+
+    // Lanes share the betting history, so the first lane stands in for all of them wherever
+    // only public state matters (terminality, player to act, action abstraction).
+    const GameState& lead_state = lanes[0].state;
+    Street entry_street = lead_state.get_current_street();
+    if (lead_state.is_terminal()) {
+        ScopedPhaseTimer eval_timer(counters.eval_ns, timing_enabled_);
+        const PotLayers pots = PotLayers::from_state(lead_state); // Same betting line, same pots
+        for (size_t b = 0; b < num_lanes; ++b) utilities[b] = terminal_payoff(lanes[b].state, pots, traversing_player);
+        return utilities;
+    }
+    int current_player = lead_state.get_current_player();
+    if (lead_state.get_player_hand(current_player).empty()) return utilities;
+
+    std::pmr::vector<std::string> keys(num_lanes, scratch); // The key strings themselves stay on the heap
+    {
+        ScopedPhaseTimer key_timer(counters.key_ns, timing_enabled_);
+        for (size_t b = 0; b < num_lanes; ++b) keys[b] = InfoSet(lanes[b].state, current_player, history_encoding_).get_key();
+    }
+    std::vector<ActionSpec> legal_action_specs = [&] {
+        ScopedPhaseTimer abstraction_timer(counters.abstraction_ns, timing_enabled_);
+        return action_abstraction_.get_possible_action_specs(lead_state);
+    }();
+    const size_t num_actions = legal_action_specs.size();
+    if (num_actions == 0) return utilities;
+
+    // --- Grouped lookup: one map lock for every lane ---
+    std::pmr::vector<Node*> nodes(num_lanes, nullptr, scratch);
+    const bool defer_new = materialize_after_visits_ > 0 && current_player != traversing_player;
+    {
+        std::unique_lock<std::mutex> lock(node_map_mutex_, std::defer_lock);
+        lock_timed(lock, counters.map_lock_wait_ns, timing_enabled_);
+        for (size_t b = 0; b < num_lanes; ++b) nodes[b] = find_or_create_node_locked(keys[b], legal_action_specs, depth, counters, defer_new);
+    }
+    BatchUnpinGuard unpin_guard;
+    if (spill_enabled_) unpin_guard.nodes = nodes;
+    for (size_t b = 0; b < num_lanes; ++b) {
+        if (!nodes[b] && !defer_new && !memory_budget_.exhausted()) {
+            throw std::runtime_error("Failed to get or create node pointer for key: " + keys[b]);
+        }
+        if (nodes[b] && nodes[b]->legal_actions != legal_action_specs) {
+            // Stored with another abstraction (e.g. an old checkpoint): play it uniformly, leave it untouched
+            spdlog::debug("Batched traversal: node {} has another action menu ({} actions, expected {}); not updating it.",
+                          keys[b], nodes[b]->legal_actions.size(), num_actions);
+            nodes[b] = nullptr;
+        }
+    }
+    counters.node_visits.add(num_lanes);
+    if (convergence_enabled_) {
+        uint32_t window = convergence_.current_window();
+        for (Node* node : nodes) {
+            if (node && node->last_visited_window.load(std::memory_order_relaxed) != window &&
+                node->last_visited_window.exchange(window, std::memory_order_relaxed) != window) {
+                counters.window_first_visits.add(1);
             }
         }
+    }
 
-        {
-            std::lock_guard<std::mutex> node_lock(node_ptr->node_mutex);
-            if (node_ptr->regret_sum.size() != node_num_actions || node_ptr->strategy_sum.size() != node_num_actions) {
-                 spdlog::error("Vector size mismatch during update for node {}", info_set_key);
-                 throw std::runtime_error("Vector size mismatch during update for node " + info_set_key);
+    // --- Regret matching: one node lock per distinct infoset, strategies as a lanes x actions array ---
+    std::pmr::vector<double> strategies(num_lanes * num_actions, scratch);
+    std::pmr::vector<size_t> owner(num_lanes, scratch); // First lane holding the same node (lanes with equal keys share it)
+    {
+        std::pmr::unordered_map<Node*, size_t> first_lane(scratch);
+        for (size_t b = 0; b < num_lanes; ++b) {
+            double* row = &strategies[b * num_actions];
+            owner[b] = b;
+            if (!nodes[b]) { std::fill(row, row + num_actions, 1.0 / num_actions); continue; }
+            auto [it, inserted] = first_lane.emplace(nodes[b], b);
+            if (!inserted) {
+                owner[b] = it->second;
+                std::copy_n(&strategies[it->second * num_actions], num_actions, row);
+                continue;
+            }
+            if (nodes[b]->shared_entry) {
+                std::pmr::vector<double> regrets(num_actions, scratch);
+                shared_store_->load_regrets(nodes[b]->shared_entry, regrets.data());
+                regret_matching(regrets.data(), row, num_actions);
+                continue;
             }
+            std::unique_lock<std::mutex> node_lock(nodes[b]->node_mutex, std::defer_lock);
+            lock_timed(node_lock, counters.node_lock_wait_ns, timing_enabled_);
+            regret_matching(nodes[b]->regret_sum.data(), row, num_actions);
+        }
+    }
 
-            // Apply reach probability of opponents for regret update
-            if (counterfactual_reach_prob > 1e-9) {
-                for (size_t i = 0; i < node_num_actions; ++i) {
-                    node_ptr->regret_sum[i] += counterfactual_reach_prob * (action_utilities[i] - node_utility);
+    if (current_player != traversing_player) {
+        // --- Opponent's turn: every lane samples its own action; lanes that agree stay batched ---
+        std::pmr::vector<size_t> sampled(num_lanes, scratch);
+        std::pmr::vector<double> importance_weights(num_lanes, scratch);
+        std::pmr::vector<size_t> group(scratch);
+        group.reserve(num_lanes);
+        for (size_t b = 0; b < num_lanes; ++b) {
+            double sampling_prob = 1.0;
+            sampled[b] = sample_action(&strategies[b * num_actions], num_actions, rng, sampling_prob);
+            importance_weights[b] = (sampling_prob > 1e-9) ? (1.0 / sampling_prob) : 0.0;
+        }
+        for (size_t a = 0; a < num_actions; ++a) {
+            group.clear();
+            for (size_t b = 0; b < num_lanes; ++b) {
+                if (sampled[b] == a && importance_weights[b] != 0.0) group.push_back(b);
+            }
+            if (group.empty()) continue;
+            const ActionSpec& action_spec = legal_action_specs[a];
+            Action game_action;
+            game_action.player_index = current_player;
+            game_action.type = static_cast<Action::Type>(action_spec.type);
+            game_action.action_set = action_spec.action_set;
+            game_action.abstract_action = action_spec.abstract_action;
+            {
+                ScopedPhaseTimer abstraction_timer(counters.abstraction_ns, timing_enabled_);
+                game_action.amount = action_abstraction_.get_action_amount(action_spec, lead_state);
+            }
+            if (game_action.amount == -1 && action_spec.type != ActionType::FOLD && action_spec.type != ActionType::CHECK && action_spec.type != ActionType::CALL) {
+                spdlog::warn("Could not calculate amount for sampled action spec: {} for node {}", action_spec.to_string(), keys[group[0]]);
+                continue; // Utility 0 for these lanes
+            }
+            std::pmr::vector<TraversalLane> children(scratch);
+            std::pmr::vector<size_t> child_lanes(scratch);
+            children.reserve(group.size());
+            child_lanes.reserve(group.size());
+            for (size_t b : group) {
+                TraversalLane child{lanes[b].state, lanes[b].deck, lanes[b].card_idx, std::pmr::vector<double>(lanes[b].reach, scratch)};
+                try { child.state.apply_action(game_action); } catch (...) { continue; }
+                if (!deal_street_cards(child.state, entry_street, *child.deck, child.card_idx)) continue;
+                child.reach[current_player] *= strategies[b * num_actions + a];
+                for (size_t p = 0; p < child.reach.size(); ++p) {
+                    if (static_cast<int>(p) != current_player) child.reach[p] *= importance_weights[b];
                 }
+                children.push_back(std::move(child));
+                child_lanes.push_back(b);
             }
-            // Apply reach probability of current player for strategy sum update
-            double player_reach_prob = reach_probabilities[current_player];
-             if (player_reach_prob > 1e-9) {
-                 for (size_t i = 0; i < node_num_actions; ++i) {
-                     if (!std::isnan(current_strategy[i]) && !std::isinf(current_strategy[i])) {
-                        node_ptr->strategy_sum[i] += player_reach_prob * current_strategy[i];
-                     }
-                 }
-             } // Closing brace for if (player_reach_prob > 1e-9)
-            // This brace closes the node_lock scope is now correctly placed below
-        } // Node mutex released
+            std::pmr::vector<double> child_utilities = cfr_batch_recursive(children, traversing_player, rng, depth + 1);
+            for (size_t k = 0; k < child_lanes.size(); ++k) utilities[child_lanes[k]] = -child_utilities[k];
+        }
+        return utilities;
+    }
 
-        node_ptr->visit_count++; // Atomic increment
+    // --- Traversing player's turn: explore every action with the whole batch ---
+    std::pmr::vector<double> action_utilities(num_lanes * num_actions, 0.0, scratch);
+    for (size_t a = 0; a < num_actions; ++a) {
+        const ActionSpec& action_spec = legal_action_specs[a];
+        Action game_action;
+        game_action.player_index = current_player;
+        game_action.type = static_cast<Action::Type>(action_spec.type);
+        game_action.action_set = action_spec.action_set;
+        game_action.abstract_action = action_spec.abstract_action;
+        {
+            ScopedPhaseTimer abstraction_timer(counters.abstraction_ns, timing_enabled_);
+            game_action.amount = action_abstraction_.get_action_amount(action_spec, lead_state);
+        }
+        if (game_action.amount == -1 && action_spec.type != ActionType::FOLD && action_spec.type != ActionType::CHECK && action_spec.type != ActionType::CALL) {
+            spdlog::warn("Could not calculate amount for action spec: {} for node {}", action_spec.to_string(), keys[0]);
+            for (size_t b = 0; b < num_lanes; ++b) action_utilities[b * num_actions + a] = -1e18;
+            continue;
+        }
+        std::pmr::vector<TraversalLane> children(scratch);
+        std::pmr::vector<size_t> child_lanes(scratch);
+        children.reserve(num_lanes);
+        child_lanes.reserve(num_lanes);
+        for (size_t b = 0; b < num_lanes; ++b) {
+            TraversalLane child{lanes[b].state, lanes[b].deck, lanes[b].card_idx, std::pmr::vector<double>(lanes[b].reach, scratch)};
+            bool ok = true;
+            try { child.state.apply_action(game_action); } catch (...) { ok = false; }
+            if (!ok || !deal_street_cards(child.state, entry_street, *child.deck, child.card_idx)) {
+                action_utilities[b * num_actions + a] = -1e18;
+                continue;
+            }
+            children.push_back(std::move(child));
+            child_lanes.push_back(b);
+        }
+        std::pmr::vector<double> child_utilities = cfr_batch_recursive(children, traversing_player, rng, depth + 1);
+        for (size_t k = 0; k < child_lanes.size(); ++k) {
+            size_t b = child_lanes[k];
+            action_utilities[b * num_actions + a] = -child_utilities[k];
+            utilities[b] += strategies[b * num_actions + a] * action_utilities[b * num_actions + a];
+        }
     }
 
-    return node_utility;
+    // --- Update: per-lane deltas, summed into the first lane of each distinct node ---
+    ScopedPhaseTimer update_timer(counters.update_ns, timing_enabled_);
+    std::pmr::vector<double> regret_deltas(num_lanes * num_actions, 0.0, scratch);
+    std::pmr::vector<double> strategy_deltas(num_lanes * num_actions, 0.0, scratch);
+    std::pmr::vector<uint32_t> lane_updates(num_lanes, 0, scratch);
+    for (size_t b = 0; b < num_lanes; ++b) {
+        if (!nodes[b]) continue;
+        const std::pmr::vector<double>& reach = lanes[b].reach;
+        double counterfactual_reach_prob = 1.0;
+        for (size_t p = 0; p < reach.size(); ++p) {
+            if (static_cast<int>(p) != current_player) counterfactual_reach_prob *= reach[p];
+        }
+        const double* lane_utilities = &action_utilities[b * num_actions];
+        const double* lane_strategy = &strategies[b * num_actions];
+        double* regret_row = &regret_deltas[owner[b] * num_actions];
+        double* strategy_row = &strategy_deltas[owner[b] * num_actions];
+        if (counterfactual_reach_prob > 1e-9) {
+            accumulate_regrets(regret_row, lane_utilities, utilities[b], counterfactual_reach_prob, num_actions, false);
+        }
+        double player_reach_prob = reach[current_player];
+        if (player_reach_prob > 1e-9) {
+            accumulate_strategy(strategy_row, lane_strategy, player_reach_prob, num_actions);
+        }
+        ++lane_updates[owner[b]];
+    }
+    for (size_t b = 0; b < num_lanes; ++b) {
+        if (lane_updates[b] == 0) continue;
+        Node* node = nodes[b];
+        const double* regret_row = &regret_deltas[b * num_actions];
+        const double* strategy_row = &strategy_deltas[b * num_actions];
+        if (tls_update_buffer) {
+            tls_update_buffer->add(node, regret_row, strategy_row, spill_enabled_, lane_updates[b]);
+            continue;
+        }
+        {
+            std::unique_lock<std::mutex> node_lock(node->node_mutex, std::defer_lock);
+            lock_timed(node_lock, counters.node_lock_wait_ns, timing_enabled_);
+            double positive_delta = accumulate_regrets(node->regret_sum.data(), regret_row, 0.0, 1.0, num_actions, floor_regrets_);
+            if (convergence_enabled_) counters.positive_regret_delta.add(positive_delta);
+            accumulate_strategy(node->strategy_sum.data(), strategy_row, 1.0, num_actions);
+        }
+        node->visit_count.fetch_add(static_cast<int>(lane_updates[b]), std::memory_order_relaxed);
+    }
+    return utilities;
 }
 
-
 // --- Public Methods ---
 // (Train function remains the same, calling the modified cfr_plus_recursive)
-void CFREngine::train(int iterations, int num_players, int initial_stack, int ante_size, int num_threads, const std::string& save_filename, int checkpoint_interval, const std::string& load_filename)
+void CFREngine::train(int iterations, int num_players, int initial_stack, int ante_size, int num_threads, const std::string& save_filename, int checkpoint_interval, const std::string& load_filename, const TrainingOptions& options)
 { // Function body starts here
+    // Distributed mode: this process trains one shard and reads / writes that shard's checkpoint
+    const bool distributed = options.shard_endpoints.size() > 1;
+    if (distributed && (options.shard_id < 0 || static_cast<size_t>(options.shard_id) >= options.shard_endpoints.size())) {
+        spdlog::error("Shard id {} is outside the {} shard endpoints. Training aborted.", options.shard_id, options.shard_endpoints.size());
+        return;
+    }
+    if (distributed && options.shared_store) {
+        spdlog::error("A shared node store cannot be combined with distributed training. Training aborted.");
+        return;
+    }
+    shared_store_ = options.shared_store;
+    shard_id_ = distributed ? options.shard_id : 0;
+    num_shards_ = distributed ? static_cast<int>(options.shard_endpoints.size()) : 1;
+    const std::string save_path = distributed && !save_filename.empty() ? shard_checkpoint_filename(save_filename, shard_id_, num_shards_) : save_filename;
+    const std::string load_path = distributed && !load_filename.empty() ? shard_checkpoint_filename(load_filename, shard_id_, num_shards_) : load_filename;
     int starting_iteration = 0;
-    if (!load_filename.empty()) {
-        spdlog::info("Attempting to load checkpoint from: {}", load_filename);
-        int loaded_iters = load_checkpoint(load_filename);
+    if (!load_path.empty()) {
+        spdlog::info("Attempting to load checkpoint from: {}", load_path);
+        int loaded_iters = load_checkpoint(load_path);
         if (loaded_iters >= 0) { starting_iteration = loaded_iters; spdlog::info("Checkpoint loaded successfully. Resuming from iteration {}.", starting_iteration); }
-        else { spdlog::warn("Failed to load checkpoint from {}. Starting training from scratch.", load_filename); }
+        else { spdlog::warn("Failed to load checkpoint from {}. Starting training from scratch.", load_path); }
+    }
+    {
+        std::lock_guard<std::mutex> lock(shard_mutex_);
+        remote_replicas_.clear();
+        pending_lookups_.clear();
+        shard_updates_.assign(num_shards_, ShardPayloads());
+        shard_lookups_.assign(num_shards_, ShardPayloads());
+    }
+    // The keys already in the tree (loaded or from an earlier train() call) fix the history encoding
+    bool has_tree = cold_store_.size() > 0;
+    { std::lock_guard<std::mutex> lock(node_map_mutex_); has_tree = has_tree || !node_map_.empty(); }
+    if (!has_tree) history_encoding_ = shared_store_ ? shared_store_->history_encoding() : options.history_encoding;
+    else if (history_encoding_ != options.history_encoding) {
+        spdlog::warn("The existing tree is keyed by {} histories; continuing with them instead of {}.",
+                     history_encoding_name(history_encoding_), history_encoding_name(options.history_encoding));
     }
+    spdlog::info("Infoset keys: {} history encoding.", history_encoding_name(history_encoding_));
     int iterations_to_run = iterations - starting_iteration;
     if (iterations_to_run <= 0) { spdlog::info("Target iterations ({}) already reached or exceeded by checkpoint ({}). No training needed.", iterations, starting_iteration); return; }
     spdlog::info("Need to run {} more iterations.", iterations_to_run);
@@ -444,63 +1054,285 @@ void CFREngine::train(int iterations, int num_players, int initial_stack, int an
     unsigned int threads_to_use = (num_threads <= 0) ? hardware_threads : std::min((unsigned int)num_threads, hardware_threads);
     if (threads_to_use == 0) threads_to_use = 1;
     spdlog::info("Using {} threads for training.", threads_to_use);
+    std::vector<int> thread_cpus = plan_numa_placement(options, threads_to_use);
+    metrics_.start(options.metrics_interval_seconds, options.metrics_csv_filename, threads_to_use, starting_iteration);
+    timing_enabled_ = metrics_.timing_enabled();
+    target_iterations_ = iterations;
+    run_start_iteration_ = starting_iteration;
+    threads_in_use_ = static_cast<int>(threads_to_use);
+    run_start_ns_ = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    checkpoints_written_ = 0;
+    last_checkpoint_ns_ = 0;
+    total_checkpoint_ns_ = 0;
+    start_memory_budget(options.max_memory_bytes, options.metrics_interval_seconds);
+    spill_enabled_ = false;
+    if ((distributed || shared_store_) && (!options.spill_filename.empty() || cold_store_.is_open())) {
+        spdlog::warn("The disk tier is not supported in multi-process training; spilling is disabled.");
+    } else if (!options.spill_filename.empty()) {
+        if (!memory_budget_.limited()) spdlog::warn("--spill-file requires --max-memory; spilling to disk is disabled.");
+        else spill_enabled_ = cold_store_.open(options.spill_filename);
+    } else if (cold_store_.is_open()) {
+        spdlog::info("Continuing with the existing cold node tier ({} nodes on disk).", cold_store_.size());
+        spill_enabled_ = true;
+    }
+    if (spill_enabled_) {
+        tier_running_ = true;
+        tier_thread_ = std::thread(&CFREngine::tier_maintenance_loop, this);
+    }
+    stop_requested_ = false;
+    convergence_.start(options.convergence_interval, options.convergence_watch_keys, options.convergence_stop_threshold,
+                       options.convergence_interval > 0 ? total_positive_regret() : 0.0, starting_iteration);
+    convergence_enabled_ = convergence_.enabled();
+    if (options.metrics_port > 0) {
+        if (!metrics_server_.start(options.metrics_port, [this]() { return get_training_snapshot(); })) {
+            spdlog::warn("Metrics endpoint disabled: could not listen on port {}.", options.metrics_port);
+        }
+    }
     std::vector<Card> master_deck;
     const std::vector<char> ranks = {'2', '3', '4', '5', '6', '7', '8', '9', 'T', 'J', 'Q', 'K', 'A'};
     const std::vector<char> suits = {'c', 'd', 'h', 's'};
     for (char r : ranks) { for (char s : suits) { master_deck.push_back(std::string(1, r) + s); } }
 
+    // Multi-process runs always buffer: the merge is where deltas leave this process
+    const int buffer_interval = (distributed || shared_store_) && options.update_buffer_interval <= 0 ? kMultiProcessBufferInterval : std::max(0, options.update_buffer_interval);
+    if (buffer_interval > 0) spdlog::info("Buffered updates: regret / strategy deltas are merged into the nodes every {} iterations per thread.", buffer_interval);
+
+    const bool simultaneous = options.simultaneous_updates;
+    if (simultaneous) {
+        spdlog::info("Simultaneous updates: one outcome-sampled traversal per deal for all players ({:.0f}% exploration).", kOutcomeSamplingExploration * 100.0);
+        if (options.traversal_batch_size > 1 || options.interleaved_traversals > 1) spdlog::warn("Batched and interleaved traversals are ignored with simultaneous updates.");
+    }
+    const int batch_size = simultaneous ? 1 : std::max(1, options.traversal_batch_size);
+    if (batch_size > 1) spdlog::info("Batched traversal: {} deals per traversal.", batch_size);
+    const int interleave_width = batch_size > 1 || simultaneous ? 1 : std::max(1, options.interleaved_traversals);
+    if (batch_size > 1 && options.interleaved_traversals > 1) spdlog::warn("Interleaved traversals are ignored in batched mode.");
+    if (interleave_width > 1) spdlog::info("Interleaved traversal: {} coroutine traversals per worker.", interleave_width);
+    const int deals_per_step = std::max(batch_size, interleave_width);
+
+    floor_regrets_ = options.floor_regrets;
+    materialize_after_visits_ = std::clamp(options.materialize_after_visits, 0, 255);
+    if (materialize_after_visits_ > 0 && distributed) {
+        // A remote key's regrets live at its owner; without a replica node we would play it uniformly
+        spdlog::warn("Deferred node materialisation is not supported in distributed training; disabled.");
+        materialize_after_visits_ = 0;
+    }
+    if (materialize_after_visits_ > 0 && simultaneous) {
+        // Every node on a simultaneous-update line is updated by the player acting there
+        spdlog::warn("Deferred node materialisation has no effect with simultaneous updates; disabled.");
+        materialize_after_visits_ = 0;
+    }
+    trie_enabled_ = options.infoset_trie;
+    if (trie_enabled_ && memory_budget_.limited()) {
+        // Neither budgeted nor safe with eviction, which erases nodes the trie points to
+        spdlog::warn("The infoset trie is not supported with --max-memory; disabled.");
+        trie_enabled_ = false;
+    }
+    if (trie_enabled_ && deals_per_step > 1) {
+        spdlog::warn("The infoset trie is ignored in batched and interleaved modes.");
+        trie_enabled_ = false;
+    }
+    { std::lock_guard<std::mutex> lock(node_map_mutex_); trie_.clear(); }
+    has_trie_totals_ = false;
+    trie_entries_ = 0;
+    trie_hits_ = 0;
+    if (trie_enabled_) spdlog::info("Infoset trie: repeat decisions are reached through child pointers from one root per button seat.");
+    bool use_baselines = options.action_baselines;
+    if (use_baselines && simultaneous) {
+        spdlog::warn("Action baselines apply to external sampling; ignored with simultaneous updates.");
+        use_baselines = false;
+    }
+    if (use_baselines && batch_size > 1) {
+        spdlog::warn("Action baselines are not supported with batched traversals; disabled.");
+        use_baselines = false;
+    }
+    baselines_.reset(use_baselines ? kActionBaselineSlots : 0);
+    has_baseline_totals_ = false;
+    baseline_estimates_ = 0;
+    baseline_corrected_ = 0;
+    if (use_baselines) {
+        spdlog::info("Action baselines: sampled opponent decisions are corrected with learned action values ({:.1f} MB table).",
+                     baselines_.memory_bytes() / (1024.0 * 1024.0));
+    }
+    visit_sketch_.reset(materialize_after_visits_ > 0 ? kVisitSketchCountersPerRow : 0);
+    deferred_lookups_ = 0;
+    if (materialize_after_visits_ > 0) {
+        spdlog::info("Deferred nodes: opponent-only infosets get a node after {} visits ({} KB visit sketch).",
+                     materialize_after_visits_, visit_sketch_.memory_bytes() / 1024);
+    }
+    spdlog::info("Regret kernels: {}{}.", kernel_isa_name(active_kernel_isa()), floor_regrets_ ? ", regrets floored at zero (CFR+)" : "");
+    if (distributed && !shard_link_.start(shard_id_, options.shard_endpoints, options.shard_sync_seconds, shard_handlers())) {
+        spdlog::error("Shard {} of {}: could not reach its peers. Training aborted.", shard_id_, num_shards_);
+        stop_tier_thread();
+        metrics_server_.stop();
+        return;
+    }
+
     auto worker_task = [&](int thread_id, int iterations_for_thread) {
+        if (!thread_cpus.empty()) pin_current_thread(thread_cpus[thread_id]); // Before any node is allocated
+        metrics_.register_current_thread();
+        ThreadCounters& counters = thread_counters();
         unsigned seed = std::chrono::system_clock::now().time_since_epoch().count() + thread_id + starting_iteration;
         std::mt19937 rng(seed);
         std::vector<Card> deck = master_deck;
+        std::vector<std::vector<Card>> lane_decks(deals_per_step > 1 ? deals_per_step : 0, master_deck);
+        std::vector<std::unique_ptr<TraversalStrand>> strands;
+        for (int b = 0; b < (interleave_width > 1 ? interleave_width : 0); ++b) strands.push_back(std::make_unique<TraversalStrand>());
+        RegretUpdateBuffer update_buffer;
+        tls_update_buffer = buffer_interval > 0 ? &update_buffer : nullptr;
+        TraversalArena scratch_arena;
+        TraversalArenaScope scratch_scope(&scratch_arena);
+        size_t warm_heap_blocks = 0;
+        auto arena_heap_blocks = [&] {
+            size_t blocks = scratch_arena.heap_blocks();
+            for (const auto& strand : strands) blocks += strand->arena().heap_blocks();
+            return blocks;
+        };
         int last_checkpoint_iter_count = (checkpoint_interval > 0 && checkpoint_interval != 0) ? starting_iteration / checkpoint_interval : 0;
-        for (int i = 0; i < iterations_for_thread; ++i) {
+        for (int i = 0; i < iterations_for_thread;) {
+            if (stop_requested_.load(std::memory_order_relaxed)) break; // Converged (auto-stop)
             int global_iteration_approx = starting_iteration + completed_iterations_.load(std::memory_order_relaxed);
             int button_pos = global_iteration_approx % num_players;
-            GameState root_state(num_players, initial_stack, ante_size, button_pos);
-            std::shuffle(deck.begin(), deck.end(), rng);
-            std::vector<std::vector<Card>> hands(num_players);
-            int card_index = 0;
-            bool deal_ok = true;
-            for (int p = 0; p < num_players; ++p) {
-                 if (card_index + 1 >= deck.size()) { deal_ok = false; break; }
-                 hands[p].push_back(deck[card_index++]);
-                 hands[p].push_back(deck[card_index++]);
-                 std::sort(hands[p].begin(), hands[p].end());
-            }
-            if (!deal_ok) { spdlog::error("[Thread {}] Deal error.", thread_id); continue; }
-            root_state.deal_hands(hands);
-            for (int player = 0; player < num_players; ++player) {
-                std::vector<double> initial_reach_probs(num_players, 1.0);
-                int current_card_idx = card_index;
-                try {
-                    cfr_plus_recursive(root_state, player, initial_reach_probs, deck, current_card_idx, rng, 0);
-                } catch (const std::exception& e) { spdlog::error("[Thread {}] Exception in cfr_plus_recursive: {}", thread_id, e.what()); }
+            int batch = std::min(deals_per_step, iterations_for_thread - i);
+            scratch_arena.reset(); // No traversal temporaries outlive an iteration
+            if (i <= kScratchWarmupIterations) warm_heap_blocks = arena_heap_blocks();
+            if (batch_size > 1) {
+                // Batched mode: `batch` deals with the same button share one traversal per player
+                std::pmr::vector<TraversalLane> lanes(traversal_resource());
+                lanes.reserve(batch);
+                for (int b = 0; b < batch; ++b) {
+                    std::vector<Card>& lane_deck = lane_decks[b];
+                    std::shuffle(lane_deck.begin(), lane_deck.end(), rng);
+                    std::vector<std::vector<Card>> hands(num_players);
+                    int card_index = 0;
+                    for (int p = 0; p < num_players; ++p) {
+                        hands[p] = {lane_deck[card_index], lane_deck[card_index + 1]};
+                        card_index += 2;
+                        std::sort(hands[p].begin(), hands[p].end());
+                    }
+                    lanes.push_back(TraversalLane{GameState(num_players, initial_stack, ante_size, button_pos), &lane_deck, card_index,
+                                                  std::pmr::vector<double>(num_players, 1.0, traversal_resource())});
+                    lanes.back().state.deal_hands(hands);
+                    if (spill_enabled_) {
+                        for (int p = 0; p < num_players; ++p) request_prefetch(InfoSet::key_prefix(p, hands[p]));
+                    }
+                }
+                for (int player = 0; player < num_players; ++player) {
+                    counters.current_traversal_max_depth = 0;
+                    try {
+                        cfr_batch_recursive(lanes, player, rng, 0);
+                    } catch (const std::exception& e) { spdlog::error("[Thread {}] Exception in cfr_batch_recursive: {}", thread_id, e.what()); }
+                    counters.traversals.add(batch);
+                    counters.traversal_depth.add(static_cast<uint64_t>(counters.current_traversal_max_depth) * batch);
+                }
+            } else if (interleave_width > 1) {
+                // Interleaved mode: one coroutine strand per deal, resumed round-robin until all finish
+                for (int b = 0; b < batch; ++b) {
+                    std::vector<Card>& lane_deck = lane_decks[b];
+                    std::shuffle(lane_deck.begin(), lane_deck.end(), rng);
+                    std::vector<std::vector<Card>> hands(num_players);
+                    int card_index = 0;
+                    for (int p = 0; p < num_players; ++p) {
+                        hands[p] = {lane_deck[card_index], lane_deck[card_index + 1]};
+                        card_index += 2;
+                        std::sort(hands[p].begin(), hands[p].end());
+                    }
+                    GameState root_state(num_players, initial_stack, ante_size, button_pos);
+                    root_state.deal_hands(hands);
+                    if (spill_enabled_) {
+                        for (int p = 0; p < num_players; ++p) request_prefetch(InfoSet::key_prefix(p, hands[p]));
+                    }
+                    TraversalStrand& strand = *strands[b];
+                    strand.start([&] { return interleaved_deal(strand, std::move(root_state), lane_deck, card_index, rng, thread_id); });
+                }
+                for (bool active = true; active;) {
+                    active = false;
+                    for (int b = 0; b < batch; ++b) {
+                        if (strands[b]->done()) continue;
+                        strands[b]->resume();
+                        active = true;
+                    }
+                }
+                for (int b = 0; b < batch; ++b) strands[b]->finish();
+            } else {
+                GameState root_state(num_players, initial_stack, ante_size, button_pos);
+                std::shuffle(deck.begin(), deck.end(), rng);
+                std::vector<std::vector<Card>> hands(num_players);
+                int card_index = 0;
+                bool deal_ok = true;
+                for (int p = 0; p < num_players; ++p) {
+                     if (card_index + 1 >= deck.size()) { deal_ok = false; break; }
+                     hands[p].push_back(deck[card_index++]);
+                     hands[p].push_back(deck[card_index++]);
+                     std::sort(hands[p].begin(), hands[p].end());
+                }
+                if (!deal_ok) { spdlog::error("[Thread {}] Deal error.", thread_id); ++i; continue; }
+                root_state.deal_hands(hands);
+                if (spill_enabled_) {
+                    for (int p = 0; p < num_players; ++p) request_prefetch(InfoSet::key_prefix(p, hands[p]));
+                }
+                const TrieLink root_link{trie_enabled_, nullptr, static_cast<uint64_t>(button_pos)};
+                if (simultaneous) {
+                    std::pmr::vector<double> initial_reach_probs(num_players, 1.0, traversal_resource());
+                    std::array<double, GameState::kMaxPlayers> utilities;
+                    int current_card_idx = card_index;
+                    counters.current_traversal_max_depth = 0;
+                    try {
+                        cfr_simultaneous_recursive(root_state, initial_reach_probs, 1.0, deck, current_card_idx, rng, 0, utilities.data(), root_link);
+                    } catch (const std::exception& e) { spdlog::error("[Thread {}] Exception in cfr_simultaneous_recursive: {}", thread_id, e.what()); }
+                    counters.traversals.add(1);
+                    counters.traversal_depth.add(counters.current_traversal_max_depth);
+                }
+                for (int player = 0; player < (simultaneous ? 0 : num_players); ++player) {
+                    std::pmr::vector<double> initial_reach_probs(num_players, 1.0, traversal_resource());
+                    int current_card_idx = card_index;
+                    counters.current_traversal_max_depth = 0;
+                    try {
+                        cfr_plus_recursive(root_state, player, initial_reach_probs, deck, current_card_idx, rng, 0, root_link);
+                    } catch (const std::exception& e) { spdlog::error("[Thread {}] Exception in cfr_plus_recursive: {}", thread_id, e.what()); }
+                    counters.traversals.add(1);
+                    counters.traversal_depth.add(counters.current_traversal_max_depth);
+                }
             }
-            int current_completed = completed_iterations_++;
-            if (thread_id == 0) {
-                 int current_percent = static_cast<int>((static_cast<double>(current_completed + 1) / iterations) * 100.0);
-                 int last_logged = last_logged_percent_.load(std::memory_order_relaxed);
-                 if (current_percent >= last_logged + 5) {
-                     int target_percent = current_percent - (current_percent % 5);
-                     if (target_percent > last_logged) {
-                          if (last_logged_percent_.compare_exchange_strong(last_logged, target_percent)) { spdlog::info("Training progress: {}%", target_percent); }
+            for (int done = 0; done < batch; ++done, ++i) {
+                if (buffer_interval > 0 && (i + 1) % buffer_interval == 0) merge_update_buffer(update_buffer, counters);
+                int current_completed = completed_iterations_++;
+                if (shared_store_) shared_store_->add_completed_iterations(1);
+                if (thread_id == 0) {
+                     int current_percent = static_cast<int>((static_cast<double>(current_completed + 1) / iterations) * 100.0);
+                     int last_logged = last_logged_percent_.load(std::memory_order_relaxed);
+                     if (current_percent >= last_logged + 5) {
+                         int target_percent = current_percent - (current_percent % 5);
+                         if (target_percent > last_logged) {
+                              if (last_logged_percent_.compare_exchange_strong(last_logged, target_percent)) { spdlog::info("Training progress: {}%", target_percent); }
+                         }
                      }
+                     metrics_.maybe_report(current_completed + 1, total_nodes_created_.load(std::memory_order_relaxed));
+                     if (convergence_.report_due(current_completed + 1)) report_convergence(current_completed + 1);
+                     memory_budget_.maybe_report(total_nodes_created_.load(std::memory_order_relaxed));
+                }
+                 if (thread_id == 0 && !save_path.empty() && checkpoint_interval > 0) {
+                      int completed_count = current_completed + 1;
+                      if (completed_count / checkpoint_interval > last_checkpoint_iter_count) {
+                          last_checkpoint_iter_count = completed_count / checkpoint_interval;
+                          spdlog::info("[Thread 0] Reached checkpoint interval (around iteration {}). Saving state...", completed_count);
+                          merge_update_buffer(update_buffer, counters); // Other workers' buffers lag by < one merge interval
+                          save_checkpoint_atomically(save_path, save_path + ".tmp", "[Thread 0] ");
+                      }
                  }
             }
-             if (thread_id == 0 && !save_filename.empty() && checkpoint_interval > 0) {
-                  int completed_count = current_completed + 1;
-                  if (completed_count / checkpoint_interval > last_checkpoint_iter_count) {
-                      last_checkpoint_iter_count = completed_count / checkpoint_interval;
-                      spdlog::info("[Thread 0] Reached checkpoint interval (around iteration {}). Saving state...", completed_count);
-                      std::string temp_filename = save_filename + ".tmp";
-                      if (save_checkpoint(temp_filename)) {
-                          try { std::filesystem::rename(temp_filename, save_filename); spdlog::info("[Thread 0] Checkpoint saved successfully to {}", save_filename); }
-                          catch (const std::filesystem::filesystem_error& fs_err) { spdlog::error("[Thread 0] Failed to rename temporary checkpoint file: {}", fs_err.what()); try { std::filesystem::remove(temp_filename); } catch(...) {} }
-                      } else { spdlog::error("[Thread 0] Failed to save checkpoint to temporary file {}", temp_filename); }
-                  }
-             }
         }
+        if (buffer_interval > 0) merge_update_buffer(update_buffer, counters);
+        tls_update_buffer = nullptr;
+        // Debug counter: after warm-up the arenas must serve every traversal temporary themselves
+        size_t peak = scratch_arena.high_water_bytes();
+        for (const auto& strand : strands) peak = std::max(peak, strand->arena().high_water_bytes());
+        size_t late_heap_blocks = arena_heap_blocks() - std::min(warm_heap_blocks, arena_heap_blocks());
+        if (iterations_for_thread > kScratchWarmupIterations && late_heap_blocks > 0) {
+            spdlog::warn("[Thread {}] Traversal arena grew by {} heap blocks after warm-up (peak {} KB).", thread_id, late_heap_blocks, peak / 1024);
+            scratch_heap_allocations_.fetch_add(static_cast<long long>(late_heap_blocks), std::memory_order_relaxed);
+        }
+        size_t seen = scratch_peak_bytes_.load(std::memory_order_relaxed);
+        while (peak > seen && !scratch_peak_bytes_.compare_exchange_weak(seen, peak, std::memory_order_relaxed)) {}
     };
     std::vector<std::thread> threads;
     int iterations_per_thread = iterations_to_run / threads_to_use;
@@ -510,16 +1342,442 @@ void CFREngine::train(int iterations, int num_players, int initial_stack, int an
         if (iters > 0) threads.emplace_back(worker_task, i, iters);
     }
     for (auto& t : threads) { if (t.joinable()) t.join(); }
+    stop_tier_thread();
+    if (distributed) {
+        // Barrier: once every peer has flushed its deltas for our keys, this shard is final
+        shard_link_.finish();
+        ShardLinkStats link = shard_link_.stats();
+        size_t replicas;
+        { std::lock_guard<std::mutex> lock(shard_mutex_); replicas = remote_replicas_.size(); }
+        spdlog::info("Shard {}/{}: {} sync rounds ({:.2f} s), {} KB sent, {} KB received, {} replicas of remote infosets.", shard_id_, num_shards_,
+                     link.syncs, link.sync_seconds, link.bytes_sent / 1024, link.bytes_received / 1024, replicas);
+    }
     if (last_logged_percent_.load() < 100 && completed_iterations_.load() >= iterations) { spdlog::info("Training progress: 100%"); }
-    spdlog::info("Training complete. Total iterations run: {}. Final iteration count: {}. Nodes created: {}. Max depth reached: {}", iterations_to_run, completed_iterations_.load(), total_nodes_created_.load(), max_depth_reached_.load());
-    if (!save_filename.empty()) {
-        spdlog::info("Performing final save to checkpoint file: {}", save_filename);
-        std::string temp_filename = save_filename + ".final.tmp";
-         if (save_checkpoint(temp_filename)) {
-             try { std::filesystem::rename(temp_filename, save_filename); spdlog::info("Final checkpoint saved successfully to {}", save_filename); }
-             catch (const std::filesystem::filesystem_error& fs_err) { spdlog::error("Failed to rename final temporary checkpoint file: {}", fs_err.what()); try { std::filesystem::remove(temp_filename); } catch(...) {} }
-         } else { spdlog::error("Failed to save final checkpoint to temporary file {}", temp_filename); }
+    spdlog::info("Training complete. Total iterations run: {}. Final iteration count: {}. Nodes created: {}. Max depth reached: {}", completed_iterations_.load() - starting_iteration, completed_iterations_.load(), total_nodes_created_.load(), max_depth_reached_.load());
+    metrics_.finish(completed_iterations_.load(), total_nodes_created_.load());
+    {
+        std::lock_guard<std::mutex> map_lock(node_map_mutex_);
+        memory_budget_.log_summary(static_cast<long long>(node_map_.size()));
+        if (trie_enabled_) {
+            size_t lookups = trie_.hits() + trie_.misses();
+            spdlog::info("Infoset trie: {} vertices ({:.1f} MB), {} cached infosets, {:.1f}% of lookups followed pointers.",
+                         trie_.vertices(), trie_.memory_bytes() / (1024.0 * 1024.0), trie_.entries(),
+                         lookups > 0 ? 100.0 * trie_.hits() / lookups : 0.0);
+            trie_entries_ = static_cast<long long>(trie_.entries());
+            trie_hits_ = static_cast<long long>(trie_.hits());
+            has_trie_totals_ = true;
+        }
+        trie_.clear(); // Its pointers are only valid while this run owns the map
+    }
+    if (spill_enabled_) log_tier_summary();
+    if (materialize_after_visits_ > 0) spdlog::info("Deferred nodes: {} lookups of rarely reached infosets were played without a node.", deferred_lookups_.load());
+    if (baselines_.enabled()) {
+        long long estimates = baselines_.estimates();
+        spdlog::info("Action baselines: {} of {} sampled opponent decisions ({:.1f}%) were corrected by a learned baseline.", baselines_.corrected(),
+                     estimates, estimates > 0 ? 100.0 * baselines_.corrected() / estimates : 0.0);
+        baseline_estimates_ = estimates;
+        baseline_corrected_ = baselines_.corrected();
+        has_baseline_totals_ = true;
+        baselines_.reset(0);
+    }
+    spdlog::info("Traversal arenas: peak {} KB per thread, {} heap blocks taken after warm-up.",
+                 scratch_peak_bytes_.load() / 1024, scratch_heap_allocations_.load());
+    if (NodeArena::instance().enabled()) {
+        for (const auto& pool : NodeArena::instance().stats()) {
+            spdlog::info("Node pool {}: {} nodes in {} x {} MB chunks ({} on huge pages){}", pool.name, pool.live_slots, pool.chunks,
+                         pool.chunk_bytes >> 20, pool.huge_chunks, pool.bound ? "" : " (mbind unavailable, first-touch)");
+        }
+    }
+    if (!save_path.empty()) {
+        spdlog::info("Performing final save to checkpoint file: {}", save_path);
+        save_checkpoint_atomically(save_path, save_path + ".final.tmp", "Final ");
      }
+    metrics_server_.stop();
+}
+
+void CFREngine::start_memory_budget(size_t limit_bytes, double report_interval_seconds) {
+    size_t node_bytes = 0, key_bytes = 0;
+    {
+        std::lock_guard<std::mutex> map_lock(node_map_mutex_);
+        for (const auto& pair : node_map_) {
+            if (!pair.second) continue;
+            node_bytes += estimate_node_bytes(pair.second->legal_actions.size());
+            key_bytes += estimate_key_bytes(pair.first);
+        }
+    }
+    memory_budget_.start(limit_bytes, node_bytes, key_bytes, report_interval_seconds);
+}
+
+void CFREngine::merge_update_buffer(RegretUpdateBuffer& buffer, ThreadCounters& counters) {
+    if (buffer.empty()) return;
+    ScopedPhaseTimer update_timer(counters.update_ns, timing_enabled_);
+    if (num_shards_ > 1) export_remote_deltas(buffer); // Replicas are merged locally too, until the owner's next reply
+    if (shared_store_) export_shared_deltas(buffer);   // Local sums keep only this process's share
+    BufferMergeStats merged = buffer.merge(floor_regrets_ ? RegretFloor::ON : RegretFloor::OFF);
+    if (convergence_enabled_) counters.positive_regret_delta.add(merged.positive_regret_delta);
+}
+
+void CFREngine::export_shared_deltas(const RegretUpdateBuffer& buffer) {
+    buffer.for_each_pending([&](Node* node, const double* regrets, const double* strategy, uint32_t updates) {
+        if (node->shared_entry) shared_store_->add_deltas(node->shared_entry, regrets, strategy, static_cast<int>(updates), floor_regrets_);
+    });
+}
+
+// --- Distributed training ---
+void CFREngine::register_remote_replica_locked(const std::string& key, const Node* node) {
+    std::lock_guard<std::mutex> lock(shard_mutex_);
+    RemoteReplica& replica = remote_replicas_[node];
+    replica = RemoteReplica{&key, static_cast<uint32_t>(shard_of(key, num_shards_)), false};
+    queue_lookup_locked(node, replica); // Start from the owner's regrets rather than zeros
+}
+
+void CFREngine::queue_lookup_locked(const Node* node, RemoteReplica& replica) {
+    if (replica.lookup_pending) return;
+    replica.lookup_pending = true;
+    pending_lookups_.push_back(node);
+    size_t key_len = replica.key->size();
+    std::string record(reinterpret_cast<const char*>(&key_len), sizeof(key_len));
+    record.append(*replica.key);
+    // Charged the size of its answer (key_len, key, actions_count, regret sums), which is what must fit one LOOKUP_REPLY
+    size_t answer_bytes = 2 * sizeof(size_t) + key_len + node->legal_actions.size() * sizeof(double);
+    shard_lookups_[replica.owner].add(record, answer_bytes);
+}
+
+// Forwards the buffered deltas of replicas to their owners as node records (visit count =
+// number of updates) and asks for the replicas' refreshed regrets in the same sync round.
+void CFREngine::export_remote_deltas(const RegretUpdateBuffer& buffer) {
+    std::lock_guard<std::mutex> lock(shard_mutex_);
+    std::ostringstream record;
+    buffer.for_each_pending([&](Node* node, const double* regrets, const double* strategy, uint32_t updates) {
+        auto found = remote_replicas_.find(node);
+        if (found == remote_replicas_.end()) return;
+        RemoteReplica& replica = found->second;
+        // legal_actions never changes after creation, so no node lock is needed to read it
+        record.str(std::string());
+        write_node_record(record, *replica.key, node->legal_actions, regrets, strategy, static_cast<int>(updates));
+        shard_updates_[replica.owner].add(record.str()); // Whole records per UPDATE frame
+        queue_lookup_locked(node, replica);
+    });
+}
+
+ShardLink::Handlers CFREngine::shard_handlers() {
+    ShardLink::Handlers handlers;
+    handlers.collect = [this](std::vector<std::vector<std::string>>& updates, std::vector<std::vector<std::string>>& lookups) {
+        std::lock_guard<std::mutex> lock(shard_mutex_);
+        for (int shard = 0; shard < num_shards_; ++shard) {
+            updates[shard] = shard_updates_[shard].take();
+            lookups[shard] = shard_lookups_[shard].take();
+        }
+        for (const Node* node : pending_lookups_) remote_replicas_[node].lookup_pending = false;
+        pending_lookups_.clear();
+    };
+    handlers.apply_updates = [this](const std::string& payload) { apply_shard_updates(payload); };
+    handlers.answer_lookup = [this](const std::string& payload) { return answer_shard_lookup(payload); };
+    handlers.install_reply = [this](const std::string& payload) { install_shard_reply(payload); };
+    return handlers;
+}
+
+// UPDATE from a peer: adds the delta records to our nodes, creating the ones we never reached.
+void CFREngine::apply_shard_updates(const std::string& payload) {
+    std::istringstream is(payload);
+    while (is.peek() != std::char_traits<char>::eof()) {
+        std::string key;
+        std::unique_ptr<Node> delta;
+        if (!read_node_record(is, key, delta)) { spdlog::error("Shard {}: malformed UPDATE from a peer.", shard_id_); return; }
+        if (!owns_key(key)) { spdlog::warn("Shard {}: received an update for key {} owned by shard {}.", shard_id_, key, shard_of(key, num_shards_)); continue; }
+        Node* node = nullptr;
+        {
+            std::lock_guard<std::mutex> map_lock(node_map_mutex_);
+            auto it = node_map_.find(key);
+            if (it != node_map_.end()) {
+                node = it->second.get();
+            } else {
+                size_t node_bytes = estimate_node_bytes(delta->legal_actions.size());
+                size_t key_bytes = estimate_key_bytes(key);
+                if (!memory_budget_.can_allocate(node_bytes + key_bytes)) { memory_budget_.note_uniform_fallback(); continue; }
+                node = node_map_.emplace(key, std::make_unique<Node>(delta->legal_actions)).first->second.get();
+                memory_budget_.charge(node_bytes, key_bytes);
+                total_nodes_created_++;
+            }
+        }
+        size_t n = delta->regret_sum.size();
+        if (node->regret_sum.size() != n) { spdlog::error("Shard {}: action count mismatch in update for key {}.", shard_id_, key); continue; }
+        {
+            std::lock_guard<std::mutex> node_lock(node->node_mutex);
+            accumulate_regrets(node->regret_sum.data(), delta->regret_sum.data(), 0.0, 1.0, n, floor_regrets_);
+            accumulate_strategy(node->strategy_sum.data(), delta->strategy_sum.data(), 1.0, n);
+        }
+        node->visit_count.fetch_add(delta->visit_count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+// LOOKUP from a peer: (key_len, key, actions_count, regret sums) for each requested key we
+// have. Unknown keys are left out; the replica keeps its value until we learn the key.
+std::string CFREngine::answer_shard_lookup(const std::string& payload) {
+    std::string reply;
+    std::lock_guard<std::mutex> map_lock(node_map_mutex_);
+    size_t pos = 0;
+    while (pos + sizeof(size_t) <= payload.size()) {
+        size_t key_len;
+        std::memcpy(&key_len, payload.data() + pos, sizeof(key_len));
+        pos += sizeof(key_len);
+        if (key_len > payload.size() - pos) break; // Written so a bogus key_len cannot wrap around
+        std::string key = payload.substr(pos, key_len);
+        pos += key_len;
+        auto it = node_map_.find(key);
+        if (it == node_map_.end() || !it->second) continue;
+        Node& node = *it->second;
+        std::lock_guard<std::mutex> node_lock(node.node_mutex);
+        size_t n = node.regret_sum.size();
+        if (2 * sizeof(size_t) + key_len + n * sizeof(double) > kMaxShardFrameBytes - reply.size()) {
+            // Only if our menus differ from the requester's, which sized the LOOKUP by its own
+            spdlog::warn("Shard {}: LOOKUP_REPLY would exceed the frame limit; the remaining keys are left out.", shard_id_);
+            break;
+        }
+        reply.append(reinterpret_cast<const char*>(&key_len), sizeof(key_len));
+        reply.append(key);
+        reply.append(reinterpret_cast<const char*>(&n), sizeof(n));
+        reply.append(reinterpret_cast<const char*>(node.regret_sum.data()), n * sizeof(double));
+    }
+    return reply;
+}
+
+// LOOKUP_REPLY: overwrites the replicas' regrets with the owner's current sums.
+void CFREngine::install_shard_reply(const std::string& payload) {
+    std::lock_guard<std::mutex> map_lock(node_map_mutex_);
+    size_t pos = 0;
+    while (pos + sizeof(size_t) <= payload.size()) {
+        size_t key_len, n;
+        std::memcpy(&key_len, payload.data() + pos, sizeof(key_len));
+        pos += sizeof(key_len);
+        if (key_len > payload.size() - pos || sizeof(n) > payload.size() - pos - key_len) break;
+        std::string key = payload.substr(pos, key_len);
+        pos += key_len;
+        std::memcpy(&n, payload.data() + pos, sizeof(n));
+        pos += sizeof(n);
+        if (n > (payload.size() - pos) / sizeof(double)) break;
+        const char* regrets = payload.data() + pos;
+        pos += n * sizeof(double);
+        auto it = node_map_.find(key);
+        if (it == node_map_.end() || !it->second || it->second->regret_sum.size() != n) continue;
+        std::lock_guard<std::mutex> node_lock(it->second->node_mutex);
+        std::memcpy(it->second->regret_sum.data(), regrets, n * sizeof(double));
+    }
+}
+
+std::vector<int> CFREngine::plan_numa_placement(const TrainingOptions& options, unsigned int threads) {
+    numa_interleave_depth_ = std::max(0, options.numa_interleave_depth);
+    bool numa_aware = options.thread_placement != ThreadPlacement::NONE || numa_interleave_depth_ > 0;
+    if (!numa_aware && options.huge_pages == HugePagePolicy::OFF) {
+        NodeArena::instance().configure(NumaTopology(), false);
+        return {};
+    }
+    NumaTopology topology = NumaTopology::detect();
+    PageBacking backing = NodeArena::instance().configure(topology, true, options.huge_pages);
+    spdlog::info("Node arena: {}.", page_backing_name(backing));
+    if (!numa_aware) return {};
+    std::vector<int> plan = plan_thread_cpus(topology, options.thread_placement, threads);
+    spdlog::info("NUMA topology: {}. Thread placement: {}{}.", topology.describe(), thread_placement_name(options.thread_placement),
+                 plan.empty() ? "" : " (CPUs " + fmt::format("{}", fmt::join(plan, ",")) + ")");
+    if (numa_interleave_depth_ > 0) spdlog::info("Nodes above depth {} are interleaved across NUMA nodes.", numa_interleave_depth_);
+    return plan;
+}
+
+// --- Tiered Store ---
+namespace {
+constexpr size_t kMaxEvictionScanPerSweep = 65536; // Bounds how long one sweep holds the map lock
+constexpr size_t kMaxPrefetchNodes = 4096;          // Per requested key prefix
+constexpr size_t kMaxQueuedPrefetches = 256;
+}
+
+void CFREngine::tier_maintenance_loop() {
+    while (tier_running_.load()) {
+        std::string prefix;
+        {
+            std::unique_lock<std::mutex> lock(tier_mutex_);
+            tier_cv_.wait_for(lock, std::chrono::milliseconds(20), [&] { return !prefetch_queue_.empty() || !tier_running_.load(); });
+            if (!prefetch_queue_.empty()) { prefix = std::move(prefetch_queue_.front()); prefetch_queue_.pop_front(); }
+        }
+        if (!prefix.empty()) prefetch_prefix(prefix);
+        evict_cold_nodes();
+    }
+}
+
+void CFREngine::stop_tier_thread() {
+    if (!tier_thread_.joinable()) return;
+    tier_running_ = false;
+    tier_cv_.notify_all();
+    tier_thread_.join();
+    std::lock_guard<std::mutex> lock(tier_mutex_);
+    prefetch_queue_.clear();
+}
+
+void CFREngine::request_prefetch(std::string prefix) {
+    {
+        std::lock_guard<std::mutex> lock(tier_mutex_);
+        if (prefetch_queue_.size() >= kMaxQueuedPrefetches) return; // Prefetch is best effort
+        prefetch_queue_.push_back(std::move(prefix));
+    }
+    tier_cv_.notify_one();
+}
+
+void CFREngine::prefetch_prefix(const std::string& prefix) {
+    std::vector<std::string> keys;
+    if (cold_store_.stage_prefix(prefix, kMaxPrefetchNodes, keys) == 0) return;
+    size_t inserted = 0;
+    std::lock_guard<std::mutex> lock(node_map_mutex_);
+    uint32_t sweep = touch_sweep_.load(std::memory_order_relaxed);
+    for (const std::string& key : keys) {
+        std::unique_ptr<Node> node = cold_store_.take(key, false);
+        if (!node) continue; // A worker faulted it in first
+        size_t node_bytes = estimate_node_bytes(node->legal_actions.size());
+        node->last_touch_sweep.store(sweep, std::memory_order_relaxed); // Not an immediate eviction candidate
+        if (!node_map_.try_emplace(key, std::move(node)).second) continue;
+        memory_budget_.charge(node_bytes, estimate_key_bytes(key));
+        ++inserted;
+    }
+    cold_store_.note_prefetched(inserted);
+}
+
+size_t CFREngine::evict_cold_nodes() {
+    // Keep usage between 80% and 90% of the budget so workers rarely hit the hard limit
+    size_t limit = memory_budget_.limit_bytes();
+    size_t high_watermark = limit / 10 * 9;
+    size_t low_watermark = limit / 10 * 8;
+    if (limit == 0 || memory_budget_.used_bytes() < high_watermark) return 0;
+
+    // Nodes stamped with an older sweep were not touched since the previous sweep (CLOCK-style)
+    uint32_t sweep = touch_sweep_.fetch_add(1, std::memory_order_relaxed);
+    size_t evicted = 0;
+    {
+        std::lock_guard<std::mutex> lock(node_map_mutex_);
+        auto it = node_map_.lower_bound(clock_hand_);
+        size_t scan_budget = std::min(node_map_.size(), kMaxEvictionScanPerSweep);
+        // Pass 0 only takes untouched nodes; pass 1 falls back to any unpinned node
+        for (int pass = 0; pass < 2 && memory_budget_.used_bytes() > low_watermark; ++pass) {
+            for (size_t scanned = 0; scanned < scan_budget && memory_budget_.used_bytes() > low_watermark; ++scanned) {
+                if (it == node_map_.end()) it = node_map_.begin();
+                Node* node = it->second.get();
+                if (!node || node->pin_count.load(std::memory_order_acquire) != 0 ||
+                    (pass == 0 && node->last_touch_sweep.load(std::memory_order_relaxed) >= sweep)) {
+                    ++it;
+                    continue;
+                }
+                size_t node_bytes = estimate_node_bytes(node->legal_actions.size());
+                size_t key_bytes = estimate_key_bytes(it->first);
+                auto handle = node_map_.extract(it++);
+                cold_store_.stage(std::move(handle.key()), std::move(handle.mapped()));
+                memory_budget_.release(node_bytes, key_bytes);
+                ++evicted;
+            }
+        }
+        clock_hand_ = (it == node_map_.end()) ? std::string() : it->first;
+    }
+    cold_store_.flush_staged(); // Disk writes happen without the map lock
+    return evicted;
+}
+
+void CFREngine::log_tier_summary() {
+    ColdStoreStats stats = cold_store_.stats();
+    uint64_t visits = metrics_.take_snapshot(0, 0).node_visits;
+    double hit_rate = visits > 0 ? 100.0 * (1.0 - static_cast<double>(stats.faults) / visits) : 100.0;
+    spdlog::info("Tiered store: cold nodes {}, evicted {}, faults {} (hot hit rate {:.2f}%), prefetched {}, "
+                 "written {:.1f} MB, read {:.1f} MB, dead log bytes {:.1f} MB",
+                 stats.cold_nodes, stats.evicted, stats.faults, hit_rate, stats.prefetched,
+                 stats.bytes_written / (1024.0 * 1024.0), stats.bytes_read / (1024.0 * 1024.0), stats.dead_bytes / (1024.0 * 1024.0));
+}
+
+double CFREngine::total_positive_regret() const {
+    std::lock_guard<std::mutex> map_lock(const_cast<std::mutex&>(node_map_mutex_));
+    double total = 0.0;
+    for (const auto& pair : node_map_) {
+        if (!pair.second) continue;
+        std::lock_guard<std::mutex> node_lock(pair.second->node_mutex);
+        for (double regret : pair.second->regret_sum) total += std::max(0.0, regret);
+    }
+    return total;
+}
+
+void CFREngine::report_convergence(long long iterations) {
+    MetricsSnapshot totals = metrics_.take_snapshot(iterations, total_nodes_created_.load(std::memory_order_relaxed));
+    ConvergenceReport report = convergence_.report(iterations, totals.total_nodes, totals.positive_regret_delta, totals.window_first_visits,
+        [this](const std::string& key) {
+            StrategyInfo info = get_strategy_info(key);
+            return info.found ? info.strategy : std::vector<double>();
+        });
+    if (report.converged && !stop_requested_.exchange(true)) {
+        spdlog::info("Convergence auto-stop: max watched strategy delta {:.6f} is below the threshold. Stopping after iteration {}.",
+                     report.max_strategy_delta, iterations);
+    }
+}
+
+void CFREngine::save_checkpoint_atomically(const std::string& filename, const std::string& temp_filename, const char* log_prefix) {
+    auto save_start = std::chrono::steady_clock::now();
+    if (save_checkpoint(temp_filename)) {
+        try { std::filesystem::rename(temp_filename, filename); spdlog::info("{}Checkpoint saved successfully to {}", log_prefix, filename); }
+        catch (const std::filesystem::filesystem_error& fs_err) { spdlog::error("{}Failed to rename temporary checkpoint file: {}", log_prefix, fs_err.what()); try { std::filesystem::remove(temp_filename); } catch(...) {} }
+    } else { spdlog::error("{}Failed to save checkpoint to temporary file {}", log_prefix, temp_filename); }
+    long long save_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - save_start).count();
+    last_checkpoint_ns_.store(save_ns, std::memory_order_relaxed);
+    total_checkpoint_ns_.fetch_add(save_ns, std::memory_order_relaxed);
+    checkpoints_written_.fetch_add(1, std::memory_order_relaxed);
+}
+
+TrainingSnapshot CFREngine::get_training_snapshot() const {
+    // Only atomics are read here: the node map and its mutex are never touched, so a
+    // scrape cannot stall the workers.
+    TrainingSnapshot s;
+    s.iterations_completed = completed_iterations_.load(std::memory_order_relaxed);
+    s.target_iterations = target_iterations_.load(std::memory_order_relaxed);
+    s.nodes = total_nodes_created_.load(std::memory_order_relaxed);
+    s.max_depth = max_depth_reached_.load(std::memory_order_relaxed);
+    s.threads = threads_in_use_.load(std::memory_order_relaxed);
+    long long start_ns = run_start_ns_.load(std::memory_order_relaxed);
+    if (start_ns > 0) {
+        long long now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        s.elapsed_seconds = (now_ns - start_ns) / 1e9;
+        long long run_iterations = s.iterations_completed - run_start_iteration_.load(std::memory_order_relaxed);
+        if (s.elapsed_seconds > 0.0) s.iterations_per_second = run_iterations / s.elapsed_seconds;
+    }
+    s.resident_memory_bytes = TrainingMetrics::resident_memory_bytes();
+    s.checkpoints_written = checkpoints_written_.load(std::memory_order_relaxed);
+    s.last_checkpoint_seconds = last_checkpoint_ns_.load(std::memory_order_relaxed) / 1e9;
+    s.total_checkpoint_seconds = total_checkpoint_ns_.load(std::memory_order_relaxed) / 1e9;
+    s.has_exploitability = has_exploitability_.load(std::memory_order_acquire);
+    if (s.has_exploitability) s.exploitability = exploitability_.load(std::memory_order_relaxed);
+    s.node_store_bytes = memory_budget_.used_bytes();
+    s.memory_budget_bytes = memory_budget_.limit_bytes();
+    if (cold_store_.is_open()) {
+        ColdStoreStats cold = cold_store_.stats();
+        s.has_cold_tier = true;
+        s.cold_nodes = cold.cold_nodes;
+        s.cold_evicted = cold.evicted;
+        s.cold_faults = cold.faults;
+        s.cold_prefetched = cold.prefetched;
+    }
+    s.scratch_heap_allocations = scratch_heap_allocations_.load(std::memory_order_relaxed);
+    s.has_trie = has_trie_totals_.load(std::memory_order_relaxed);
+    if (s.has_trie) {
+        s.trie_entries = trie_entries_.load(std::memory_order_relaxed);
+        s.trie_hits = trie_hits_.load(std::memory_order_relaxed);
+    }
+    s.has_baselines = has_baseline_totals_.load(std::memory_order_relaxed);
+    if (s.has_baselines) {
+        s.baseline_estimates = baseline_estimates_.load(std::memory_order_relaxed);
+        s.baseline_corrected = baseline_corrected_.load(std::memory_order_relaxed);
+    }
+    s.has_convergence = convergence_.has_report();
+    if (s.has_convergence) {
+        s.mean_positive_regret = convergence_.last_mean_positive_regret();
+        s.max_strategy_delta = convergence_.last_max_strategy_delta();
+        s.visited_fraction = convergence_.last_visited_fraction();
+    }
+    return s;
+}
+
+void CFREngine::report_exploitability(double value) {
+    exploitability_.store(value, std::memory_order_relaxed);
+    has_exploitability_.store(true, std::memory_order_release);
 }
 
 // --- Checkpointing Methods ---
@@ -529,51 +1787,37 @@ bool CFREngine::save_checkpoint(const std::string& filename) const {
     std::ofstream ofs(filename, std::ios::binary | std::ios::trunc);
     if (!ofs) { spdlog::error("Failed to open checkpoint file for writing: {}", filename); return false; }
     try {
-        uint32_t version = CHECKPOINT_VERSION_BIN;
-        ofs.write(reinterpret_cast<const char*>(&version), sizeof(version)); if (!ofs) return false;
-        int completed = completed_iterations_.load();
-        ofs.write(reinterpret_cast<const char*>(&completed), sizeof(completed)); if (!ofs) return false;
-        size_t map_size = node_map_.size();
-        ofs.write(reinterpret_cast<const char*>(&map_size), sizeof(map_size)); if (!ofs) return false;
-
-        for (const auto& pair : node_map_) {
-            const std::string& key = pair.first;
-            const std::unique_ptr<Node>& node_ptr = pair.second;
-            if (!node_ptr) continue;
-
-            std::lock_guard<std::mutex> node_lock(node_ptr->node_mutex); // Lock individual node
-
-            // Write key
-            size_t key_len = key.length();
-            ofs.write(reinterpret_cast<const char*>(&key_len), sizeof(key_len)); if (!ofs) return false;
-            ofs.write(key.c_str(), key_len); if (!ofs) return false;
-
-            // Write legal actions (ActionSpec)
-            size_t actions_count = node_ptr->legal_actions.size();
-            ofs.write(reinterpret_cast<const char*>(&actions_count), sizeof(actions_count)); if (!ofs) return false;
-            for(const auto& action_spec : node_ptr->legal_actions) {
-                 // Serialize ActionSpec: type, value, unit
-                 ActionType type = action_spec.type;
-                 double value = action_spec.value;
-                 SizingUnit unit = action_spec.unit;
-                 ofs.write(reinterpret_cast<const char*>(&type), sizeof(type)); if (!ofs) return false;
-                 ofs.write(reinterpret_cast<const char*>(&value), sizeof(value)); if (!ofs) return false;
-                 ofs.write(reinterpret_cast<const char*>(&unit), sizeof(unit)); if (!ofs) return false;
+        CheckpointHeader header;
+        header.history_encoding = history_encoding_;
+        header.shard_id = static_cast<uint32_t>(shard_id_);
+        header.num_shards = static_cast<uint32_t>(num_shards_);
+        header.completed_iterations = completed_iterations_.load();
+        // A shard saves only the keys it owns; its replicas of other shards' nodes are not state
+        header.map_size = node_map_.size() + cold_store_.size();
+        if (num_shards_ > 1) {
+            header.map_size = 0;
+            for (const auto& pair : node_map_) header.map_size += (pair.second && owns_key(pair.first)) ? 1 : 0;
+        }
+        if (!write_checkpoint_header(ofs, header)) return false;
+
+        // Merge the hot map with the cold tier so the file stays in sorted key order
+        std::vector<std::string> cold_keys = cold_store_.sorted_keys();
+        auto hot_it = node_map_.begin();
+        auto cold_it = cold_keys.begin();
+        while (hot_it != node_map_.end() || cold_it != cold_keys.end()) {
+            if (cold_it == cold_keys.end() || (hot_it != node_map_.end() && hot_it->first < *cold_it)) {
+                const std::string& key = hot_it->first;
+                const std::unique_ptr<Node>& node_ptr = hot_it->second;
+                ++hot_it;
+                if (!node_ptr || !owns_key(key)) continue;
+                std::lock_guard<std::mutex> node_lock(node_ptr->node_mutex); // Lock individual node
+                if (!write_node_record(ofs, key, *node_ptr)) return false;
+            } else {
+                const std::string& key = *cold_it++;
+                std::unique_ptr<Node> cold_node = cold_store_.peek(key);
+                if (!cold_node) { spdlog::error("Cold node {} vanished during checkpoint save", key); return false; }
+                if (!write_node_record(ofs, key, *cold_node)) return false;
             }
-
-            // Write regret_sum
-            size_t regret_size = node_ptr->regret_sum.size();
-            if (regret_size != actions_count) { spdlog::error("Regret size mismatch for key '{}'", key); return false; }
-            ofs.write(reinterpret_cast<const char*>(node_ptr->regret_sum.data()), regret_size * sizeof(double)); if (!ofs) return false;
-
-            // Write strategy_sum
-            size_t strategy_size = node_ptr->strategy_sum.size();
-             if (strategy_size != actions_count) { spdlog::error("Strategy size mismatch for key '{}'", key); return false; }
-            ofs.write(reinterpret_cast<const char*>(node_ptr->strategy_sum.data()), strategy_size * sizeof(double)); if (!ofs) return false;
-
-            // Write visit_count
-            int visits = node_ptr->visit_count.load();
-            ofs.write(reinterpret_cast<const char*>(&visits), sizeof(visits)); if (!ofs) return false;
         }
 
         long long nodes_created = total_nodes_created_.load();
@@ -589,52 +1833,30 @@ int CFREngine::load_checkpoint(const std::string& filename) {
     if (!ifs) { spdlog::error("Failed to open checkpoint file for reading: {}", filename); return -1; }
     int loaded_iterations = -1;
     long long loaded_nodes_created = 0;
+    HistoryEncoding loaded_encoding = HistoryEncoding::CHIPS;
     NodeMap temp_node_map;
     try {
-        uint32_t version;
-        ifs.read(reinterpret_cast<char*>(&version), sizeof(version));
-        if (!ifs || version != CHECKPOINT_VERSION_BIN) { spdlog::error("Checkpoint version mismatch. Expected: {}, Found: {}", CHECKPOINT_VERSION_BIN, version); ifs.close(); return -1; }
-        ifs.read(reinterpret_cast<char*>(&loaded_iterations), sizeof(loaded_iterations));
-        if (!ifs || loaded_iterations < 0) { spdlog::error("Invalid iteration count in checkpoint."); ifs.close(); return -1; }
-        size_t map_size;
-        ifs.read(reinterpret_cast<char*>(&map_size), sizeof(map_size)); if (!ifs) { spdlog::error("Failed to read map size."); ifs.close(); return -1; }
+        CheckpointHeader header;
+        if (!read_checkpoint_header(ifs, header)) { ifs.close(); return -1; }
+        if (header.version != CHECKPOINT_VERSION_BIN) {
+            spdlog::error("Checkpoint version mismatch. Expected: {}, Found: {} (upgrade it with the merge command).", CHECKPOINT_VERSION_BIN, header.version);
+            ifs.close(); return -1;
+        }
+        if (header.num_shards > 1 && num_shards_ > 1 && (header.shard_id != static_cast<uint32_t>(shard_id_) || header.num_shards != static_cast<uint32_t>(num_shards_))) {
+            spdlog::error("Checkpoint holds shard {} of {}, but this process is shard {} of {}.", header.shard_id, header.num_shards, shard_id_, num_shards_);
+            ifs.close(); return -1;
+        }
+        if (header.num_shards > 1 && num_shards_ <= 1) {
+            spdlog::warn("Checkpoint holds only the infosets of shard {} of {}; merge the shards for the full tree.", header.shard_id, header.num_shards);
+        }
+        loaded_encoding = header.history_encoding;
+        loaded_iterations = header.completed_iterations;
+        size_t map_size = header.map_size;
 
         for (size_t i = 0; i < map_size; ++i) {
-            // Read key
-            size_t key_len;
-            ifs.read(reinterpret_cast<char*>(&key_len), sizeof(key_len)); if (!ifs) { spdlog::error("Failed reading key length at entry {}", i); ifs.close(); return -1; }
-            std::string key(key_len, '\0');
-            ifs.read(&key[0], key_len); if (!ifs) { spdlog::error("Failed reading key data at entry {}", i); ifs.close(); return -1; }
-
-            // Read legal actions (ActionSpec)
-            size_t actions_count;
-            ifs.read(reinterpret_cast<char*>(&actions_count), sizeof(actions_count)); if (!ifs) { spdlog::error("Failed reading actions count for key '{}'", key); ifs.close(); return -1; }
-            std::vector<ActionSpec> legal_actions;
-            legal_actions.reserve(actions_count);
-            for (size_t j = 0; j < actions_count; ++j) {
-                ActionSpec spec;
-                ifs.read(reinterpret_cast<char*>(&spec.type), sizeof(spec.type));     if (!ifs) { spdlog::error("Failed reading action type for key '{}', action {}", key, j); ifs.close(); return -1; }
-                ifs.read(reinterpret_cast<char*>(&spec.value), sizeof(spec.value));   if (!ifs) { spdlog::error("Failed reading action value for key '{}', action {}", key, j); ifs.close(); return -1; }
-                ifs.read(reinterpret_cast<char*>(&spec.unit), sizeof(spec.unit));     if (!ifs) { spdlog::error("Failed reading action unit for key '{}', action {}", key, j); ifs.close(); return -1; }
-                legal_actions.push_back(spec);
-            }
-
-            // Create Node using loaded actions
-            auto node_ptr = std::make_unique<Node>(legal_actions);
-
-            // Read regret_sum data
-            if (node_ptr->regret_sum.size() != actions_count) { spdlog::error("Loaded regret size mismatch for key '{}'", key); ifs.close(); return -1; }
-            ifs.read(reinterpret_cast<char*>(node_ptr->regret_sum.data()), actions_count * sizeof(double)); if (!ifs) { spdlog::error("Failed reading regret_sum for key '{}'", key); ifs.close(); return -1; }
-
-            // Read strategy_sum data
-            if (node_ptr->strategy_sum.size() != actions_count) { spdlog::error("Loaded strategy size mismatch for key '{}'", key); ifs.close(); return -1; }
-            ifs.read(reinterpret_cast<char*>(node_ptr->strategy_sum.data()), actions_count * sizeof(double)); if (!ifs) { spdlog::error("Failed reading strategy_sum for key '{}'", key); ifs.close(); return -1; }
-
-            // Read visit_count
-            int visits;
-            ifs.read(reinterpret_cast<char*>(&visits), sizeof(visits)); if (!ifs) { spdlog::error("Failed reading visit_count for key '{}'", key); ifs.close(); return -1; }
-            node_ptr->visit_count.store(visits, std::memory_order_relaxed);
-
+            std::string key;
+            std::unique_ptr<Node> node_ptr;
+            if (!read_node_record(ifs, key, node_ptr)) { spdlog::error("Failed reading checkpoint entry {}", i); ifs.close(); return -1; }
             // Emplace the loaded node into the temporary map
             temp_node_map.try_emplace(key, std::move(node_ptr));
         }
@@ -647,6 +1869,13 @@ int CFREngine::load_checkpoint(const std::string& filename) {
 
     // Atomically swap maps and update counters outside the try-catch
     { std::lock_guard<std::mutex> lock(node_map_mutex_); node_map_ = std::move(temp_node_map); }
+    cold_store_.close(); // Any spilled nodes belonged to the replaced tree
+    {
+        std::lock_guard<std::mutex> lock(shard_mutex_);
+        remote_replicas_.clear(); // They pointed into the replaced map
+        pending_lookups_.clear();
+    }
+    history_encoding_ = loaded_encoding;
     completed_iterations_.store(loaded_iterations);
     total_nodes_created_.store(loaded_nodes_created);
     return loaded_iterations;
@@ -682,6 +1911,11 @@ StrategyInfo CFREngine::get_strategy_info(const std::string& info_set_key) const
              spdlog::error("Null pointer found in NodeMap for key: {}", info_set_key);
              result.found = false;
         }
+    } else if (std::unique_ptr<Node> cold_node = cold_store_.peek(info_set_key)) {
+        // Not in RAM: read a copy from the disk tier
+        result.found = true;
+        result.strategy = cold_node->get_average_strategy();
+        for (const auto& spec : cold_node->legal_actions) result.actions.push_back(spec.to_string());
     } else {
         result.found = false;
     }
@@ -0,0 +1,165 @@
+#include "checkpoint_compact.h"
+
+#include <algorithm> // For std::sort, std::max
+#include <chrono>
+#include <cstdio>    // For std::remove
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+
+namespace gto_solver {
+
+namespace {
+constexpr size_t kStreamBufferBytes = 1 << 20; // Input / output stream buffers
+
+// Splits a key into its seat / hand, street, board and history fields. The history is
+// everything after the third '|' (compact histories may contain '|' bytes themselves).
+struct KeyFields {
+    std::string_view seat_hand, street, board, history;
+};
+
+KeyFields split_key(std::string_view key) {
+    KeyFields fields;
+    std::string_view* parts[3] = {&fields.seat_hand, &fields.street, &fields.board};
+    size_t start = 0;
+    for (std::string_view* part : parts) {
+        size_t bar = key.find('|', start);
+        if (bar == std::string_view::npos) { // Not an infoset key: order it by its history alone
+            fields = KeyFields();
+            fields.history = key;
+            return fields;
+        }
+        *part = key.substr(start, bar - start);
+        start = bar + 1;
+    }
+    fields.history = key.substr(start);
+    return fields;
+}
+
+// Next action of a history: "r20/" style tokens for chip histories, one byte for compact ones.
+std::string_view next_action(std::string_view& history, HistoryEncoding encoding) {
+    size_t length = 1;
+    if (encoding == HistoryEncoding::CHIPS) {
+        size_t slash = history.find('/');
+        length = slash == std::string_view::npos ? history.size() : slash + 1;
+    }
+    std::string_view action = history.substr(0, length);
+    history.remove_prefix(length);
+    return action;
+}
+
+// < 0, 0, > 0 as a comes before, with or after b in depth-first order of the betting tree.
+int compare_histories(std::string_view a, std::string_view b, HistoryEncoding encoding) {
+    while (!a.empty() && !b.empty()) {
+        int order = next_action(a, encoding).compare(next_action(b, encoding));
+        if (order != 0) return order;
+    }
+    return a.empty() ? (b.empty() ? 0 : -1) : 1; // A line comes before its extensions
+}
+
+struct SurvivingRecord {
+    std::string key;
+    std::streamoff offset; // Start of the record in the input
+};
+} // anonymous namespace
+
+bool parse_key_order(const std::string& text, CheckpointKeyOrder& order) {
+    if (text == "tree") order = CheckpointKeyOrder::TREE;
+    else if (text == "sorted") order = CheckpointKeyOrder::SORTED;
+    else return false;
+    return true;
+}
+
+bool compare_tree_order(const std::string& a, const std::string& b, HistoryEncoding encoding) {
+    KeyFields fa = split_key(a), fb = split_key(b);
+    if (int order = compare_histories(fa.history, fb.history, encoding); order != 0) return order < 0;
+    if (int order = fa.board.compare(fb.board); order != 0) return order < 0;
+    if (int order = fa.street.compare(fb.street); order != 0) return order < 0;
+    return fa.seat_hand < fb.seat_hand;
+}
+
+bool compact_checkpoint(const std::string& input, const std::string& output, const CheckpointCompactOptions& options,
+                        CheckpointCompactStats* stats) {
+    auto start = std::chrono::steady_clock::now();
+    if (input == output) { spdlog::error("Compact: the output must not be the input file."); return false; }
+    std::vector<char> in_buffer(kStreamBufferBytes), out_buffer(kStreamBufferBytes);
+    std::ifstream in;
+    in.rdbuf()->pubsetbuf(in_buffer.data(), static_cast<std::streamsize>(in_buffer.size()));
+    in.open(input, std::ios::binary);
+    if (!in) { spdlog::error("Compact: cannot open {}", input); return false; }
+    CheckpointHeader header;
+    if (!read_checkpoint_header(in, header)) { spdlog::error("Compact: bad header in {}", input); return false; }
+
+    // Pass 1: decide which records survive, remembering where they start
+    CheckpointCompactStats result;
+    std::vector<SurvivingRecord> survivors;
+    survivors.reserve(header.map_size);
+    for (size_t i = 0; i < header.map_size; ++i) {
+        std::streamoff offset = in.tellg();
+        std::string key;
+        std::unique_ptr<Node> node;
+        if (!read_node_record(in, key, node, header.version)) { spdlog::error("Compact: bad record {} in {}", i, input); return false; }
+        ++result.records_read;
+        if (options.min_visits > 0 && node->visit_count.load(std::memory_order_relaxed) < options.min_visits) { ++result.pruned_visits; continue; }
+        if (options.min_regret_mass > 0.0) {
+            double mass = 0.0;
+            for (double regret : node->regret_sum) mass += std::max(0.0, regret);
+            if (mass < options.min_regret_mass) { ++result.pruned_regret; continue; }
+        }
+        survivors.push_back({std::move(key), offset});
+    }
+    if (options.key_order == CheckpointKeyOrder::TREE) {
+        const HistoryEncoding encoding = header.history_encoding;
+        std::sort(survivors.begin(), survivors.end(),
+                  [encoding](const SurvivingRecord& a, const SurvivingRecord& b) { return compare_tree_order(a.key, b.key, encoding); });
+    } else if (header.key_order != CheckpointKeyOrder::SORTED) {
+        std::sort(survivors.begin(), survivors.end(), [](const SurvivingRecord& a, const SurvivingRecord& b) { return a.key < b.key; });
+    }
+
+    // Pass 2: copy the survivors in output order (sequential reads when the order is unchanged)
+    std::ofstream out;
+    out.rdbuf()->pubsetbuf(out_buffer.data(), static_cast<std::streamsize>(out_buffer.size()));
+    out.open(output, std::ios::binary | std::ios::trunc);
+    if (!out) { spdlog::error("Compact: cannot open {} for writing", output); return false; }
+    CheckpointHeader out_header = header;
+    out_header.key_order = options.key_order;
+    out_header.map_size = survivors.size();
+    bool ok = write_checkpoint_header(out, out_header);
+    in.clear();
+    std::streamoff position = -1; // Input position after the last record read
+    for (size_t i = 0; ok && i < survivors.size(); ++i) {
+        const SurvivingRecord& record = survivors[i];
+        if (record.offset != position) in.seekg(record.offset);
+        std::string key;
+        std::unique_ptr<Node> node;
+        ok = read_node_record(in, key, node, header.version) && key == record.key && write_node_record(out, key, *node);
+        position = in.tellg();
+    }
+    long long nodes_created = static_cast<long long>(survivors.size());
+    out.write(reinterpret_cast<const char*>(&nodes_created), sizeof(nodes_created));
+    out.close();
+    if (!ok || !out) {
+        spdlog::error("Compaction of {} into {} failed.", input, output);
+        std::remove(output.c_str());
+        return false;
+    }
+
+    result.records_written = survivors.size();
+    std::error_code ec;
+    result.bytes_read = std::filesystem::file_size(input, ec);
+    result.bytes_written = std::filesystem::file_size(output, ec);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double saved = result.bytes_read > 0 ? 100.0 * (1.0 - static_cast<double>(result.bytes_written) / result.bytes_read) : 0.0;
+    spdlog::info("Compacted {} -> {} infosets ({} below {} visits, {} below regret mass {}) in {:.2f} s: {:.1f} MB -> {:.1f} MB ({:.1f}% smaller), {} order.",
+                 result.records_read, result.records_written, result.pruned_visits, options.min_visits, result.pruned_regret, options.min_regret_mass,
+                 result.seconds, result.bytes_read / 1e6, result.bytes_written / 1e6, saved,
+                 options.key_order == CheckpointKeyOrder::TREE ? "tree" : "sorted");
+    if (stats) *stats = result;
+    return true;
+}
+
+} // namespace gto_solver
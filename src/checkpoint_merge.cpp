@@ -0,0 +1,339 @@
+#include "checkpoint_merge.h"
+#include "node_serialization.h"
+
+#include <algorithm> // For std::sort, std::unique, std::upper_bound
+#include <atomic>
+#include <chrono>
+#include <cmath>     // For std::llround
+#include <cstdio>    // For std::remove
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <thread>
+
+#include "spdlog/spdlog.h"
+
+namespace gto_solver {
+
+namespace {
+constexpr size_t kIndexStride = 4096;          // Records between two sparse index entries
+constexpr size_t kStreamBufferBytes = 1 << 20; // Per input / output stream: large sequential I/O
+
+struct IndexEntry {
+    std::string key;
+    std::streamoff offset; // Start of the record
+    size_t record;         // Its position in the file
+};
+
+struct InputFile {
+    std::string path;
+    double weight = 1.0;
+    CheckpointHeader header;
+    std::streamoff records_offset = 0;
+    std::vector<IndexEntry> index; // Every kIndexStride-th record (partitioned merges only)
+};
+
+struct RangeCounts {
+    size_t records = 0;
+    size_t keys = 0;
+    size_t mismatches = 0;
+};
+
+// Sequential reader of one input's records with keys in [begin_key, end_key) (empty = unbounded).
+class RangeCursor {
+public:
+    bool open(const InputFile& file, const std::string& begin_key, const std::string& end_key) {
+        file_ = &file;
+        end_key_ = end_key;
+        buffer_.resize(kStreamBufferBytes);
+        is_.rdbuf()->pubsetbuf(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        is_.open(file.path, std::ios::binary);
+        if (!is_) { spdlog::error("Merge: cannot open {}", file.path); return false; }
+        std::streamoff start = file.records_offset;
+        next_record_ = 0;
+        if (!begin_key.empty() && !file.index.empty()) {
+            // Last indexed record before begin_key, then scan forward to the range's first record
+            auto after = std::upper_bound(file.index.begin(), file.index.end(), begin_key,
+                                          [](const std::string& k, const IndexEntry& e) { return k <= e.key; });
+            if (after != file.index.begin()) {
+                start = std::prev(after)->offset;
+                next_record_ = std::prev(after)->record;
+            }
+        }
+        is_.seekg(start);
+        if (!begin_key.empty()) {
+            std::string key;
+            std::streamoff first = start;
+            size_t record_bytes = 0;
+            while (next_record_ < file.header.map_size) {
+                if (!skip_node_record(is_, key, file.header.version, &record_bytes)) { spdlog::error("Merge: truncated record in {}", file.path); return false; }
+                if (key >= begin_key) break;
+                first += static_cast<std::streamoff>(record_bytes);
+                ++next_record_;
+            }
+            is_.clear();
+            is_.seekg(first); // Back to the range's first record
+        }
+        return advance();
+    }
+
+    // Moves to the next record of the range; false only on an error (valid() tells whether one is left).
+    bool advance() {
+        valid_ = false;
+        if (next_record_ >= file_->header.map_size) return true;
+        std::string previous = std::move(key_);
+        if (!read_node_record(is_, key_, node_, file_->header.version)) { spdlog::error("Merge: bad record {} in {}", next_record_, file_->path); return false; }
+        if (next_record_ > 0 && !previous.empty() && key_ <= previous) {
+            spdlog::error("Merge: {} is not sorted by key (record {}); only checkpoints written by this solver can be merged.", file_->path, next_record_);
+            return false;
+        }
+        ++next_record_;
+        valid_ = end_key_.empty() || key_ < end_key_;
+        return true;
+    }
+
+    bool valid() const { return valid_; }
+    const std::string& key() const { return key_; }
+    const Node& node() const { return *node_; }
+    double weight() const { return file_->weight; }
+
+private:
+    const InputFile* file_ = nullptr;
+    std::string end_key_;
+    std::vector<char> buffer_;
+    std::ifstream is_;
+    size_t next_record_ = 0;
+    std::string key_;
+    std::unique_ptr<Node> node_;
+    bool valid_ = false;
+};
+
+bool same_actions(const std::vector<ActionSpec>& a, const std::vector<ActionSpec>& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+// k-way merge of every input's records in [begin_key, end_key) into out.
+bool merge_range(const std::vector<InputFile>& files, MergeMode mode, double total_weight, const std::string& begin_key,
+                 const std::string& end_key, std::ostream& out, RangeCounts& counts) {
+    std::vector<std::unique_ptr<RangeCursor>> cursors;
+    for (const InputFile& file : files) {
+        cursors.push_back(std::make_unique<RangeCursor>());
+        if (!cursors.back()->open(file, begin_key, end_key)) return false;
+    }
+    const double scale = mode == MergeMode::AVERAGE ? 1.0 / total_weight : 1.0;
+    std::vector<ActionSpec> actions;
+    std::vector<double> regrets, strategy;
+    std::string key;
+    while (true) {
+        const std::string* smallest = nullptr;
+        for (const auto& cursor : cursors) {
+            if (cursor->valid() && (!smallest || cursor->key() < *smallest)) smallest = &cursor->key();
+        }
+        if (!smallest) break;
+        key = *smallest;
+        bool first = true;
+        double visits = 0.0;
+        for (const auto& cursor : cursors) {
+            if (!cursor->valid() || cursor->key() != key) continue;
+            const Node& node = cursor->node();
+            ++counts.records;
+            if (first) {
+                actions = node.legal_actions;
+                regrets.assign(actions.size(), 0.0);
+                strategy.assign(actions.size(), 0.0);
+                first = false;
+            } else if (!same_actions(actions, node.legal_actions)) {
+                ++counts.mismatches;
+                spdlog::warn("Merge: legal actions of {} differ between inputs; keeping the first.", key);
+                if (!cursor->advance()) return false;
+                continue;
+            }
+            // Prefer tagged specs when older (untagged) and newer checkpoints are mixed
+            if (!actions.empty() && actions[0].action_set == ActionSetId::UNTAGGED) actions = node.legal_actions;
+            double w = cursor->weight() * scale;
+            for (size_t a = 0; a < actions.size(); ++a) {
+                regrets[a] += w * node.regret_sum[a];
+                strategy[a] += w * node.strategy_sum[a];
+            }
+            visits += w * node.visit_count.load(std::memory_order_relaxed);
+            if (!cursor->advance()) return false;
+        }
+        if (!write_node_record(out, key, actions, regrets.data(), strategy.data(), static_cast<int>(std::llround(visits)))) {
+            spdlog::error("Merge: write failed at key {}", key);
+            return false;
+        }
+        ++counts.keys;
+    }
+    return true;
+}
+
+// Reads every record key of file once (bodies are skipped) and keeps each kIndexStride-th.
+bool build_sparse_index(InputFile& file) {
+    std::vector<char> buffer(kStreamBufferBytes);
+    std::ifstream is;
+    is.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    is.open(file.path, std::ios::binary);
+    is.seekg(file.records_offset);
+    std::string key;
+    std::streamoff offset = file.records_offset;
+    size_t record_bytes = 0;
+    for (size_t record = 0; record < file.header.map_size; ++record) {
+        if (!skip_node_record(is, key, file.header.version, &record_bytes)) { spdlog::error("Merge: truncated record {} in {}", record, file.path); return false; }
+        if (record % kIndexStride == 0) file.index.push_back(IndexEntry{key, offset, record});
+        offset += static_cast<std::streamoff>(record_bytes);
+    }
+    return true;
+}
+
+bool append_file(std::ostream& out, const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::vector<char> buffer(kStreamBufferBytes);
+    while (in) {
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        out.write(buffer.data(), in.gcount());
+        if (!out) return false;
+    }
+    return in.eof();
+}
+} // anonymous namespace
+
+bool parse_merge_mode(const std::string& text, MergeMode& mode) {
+    if (text == "sum") { mode = MergeMode::SUM; return true; }
+    if (text == "average") { mode = MergeMode::AVERAGE; return true; }
+    return false;
+}
+
+bool merge_checkpoints(const CheckpointMergeOptions& options, const std::string& output, CheckpointMergeStats* stats) {
+    auto start = std::chrono::steady_clock::now();
+    if (options.inputs.empty()) { spdlog::error("Merge: no input checkpoints."); return false; }
+    if (!options.weights.empty() && options.weights.size() != options.inputs.size()) {
+        spdlog::error("Merge: {} weights given for {} inputs.", options.weights.size(), options.inputs.size());
+        return false;
+    }
+
+    // Headers: same key format everywhere; the output header combines the iteration counts
+    std::vector<InputFile> files(options.inputs.size());
+    double total_weight = 0.0, weighted_iterations = 0.0;
+    size_t total_records = 0;
+    for (size_t i = 0; i < files.size(); ++i) {
+        InputFile& file = files[i];
+        file.path = options.inputs[i];
+        file.weight = options.weights.empty() ? 1.0 : options.weights[i];
+        if (!(file.weight >= 0.0)) { spdlog::error("Merge: invalid weight {} for {}", file.weight, file.path); return false; }
+        std::ifstream is(file.path, std::ios::binary);
+        if (!is) { spdlog::error("Merge: cannot open {}", file.path); return false; }
+        if (!read_checkpoint_header(is, file.header)) { spdlog::error("Merge: bad header in {}", file.path); return false; }
+        file.records_offset = is.tellg();
+        if (file.header.key_order != CheckpointKeyOrder::SORTED) {
+            spdlog::error("Merge: {} is in tree order (compacted); re-sort it with `compact --key-order sorted` first.", file.path);
+            return false;
+        }
+        if (file.header.history_encoding != files[0].header.history_encoding) {
+            spdlog::error("Merge: {} uses {} history keys but {} uses {}; keys would never match.", file.path,
+                          history_encoding_name(file.header.history_encoding), files[0].path, history_encoding_name(files[0].header.history_encoding));
+            return false;
+        }
+        spdlog::info("Merge input {}: v{}, {} records, {} iterations{}, weight {}", file.path, file.header.version, file.header.map_size,
+                     file.header.completed_iterations,
+                     file.header.num_shards > 1 ? fmt::format(", shard {} of {}", file.header.shard_id, file.header.num_shards) : "", file.weight);
+        total_weight += file.weight;
+        weighted_iterations += file.weight * file.header.completed_iterations;
+        total_records += file.header.map_size;
+    }
+    if (total_weight <= 0.0) { spdlog::error("Merge: the input weights sum to zero."); return false; }
+
+    // Key-range partitions of similar size, from the union of the inputs' sparse indexes
+    int partitions = std::max(1, options.partitions);
+    std::vector<std::string> bounds; // Partition k covers [bounds[k-1], bounds[k]) ("" = open end)
+    if (partitions > 1 && total_records > kIndexStride) {
+        std::vector<std::thread> scanners;
+        std::atomic<bool> scan_ok{true};
+        for (InputFile& file : files) scanners.emplace_back([&file, &scan_ok] { if (!build_sparse_index(file)) scan_ok = false; });
+        for (auto& scanner : scanners) scanner.join();
+        if (!scan_ok) return false;
+        std::vector<std::string> samples;
+        for (const InputFile& file : files) {
+            for (const IndexEntry& entry : file.index) samples.push_back(entry.key);
+        }
+        std::sort(samples.begin(), samples.end());
+        for (int k = 1; k < partitions; ++k) {
+            const std::string& split = samples[samples.size() * k / partitions];
+            if (!split.empty() && (bounds.empty() || split > bounds.back())) bounds.push_back(split);
+        }
+    }
+    size_t ranges = bounds.size() + 1;
+
+    CheckpointHeader header;
+    header.history_encoding = files[0].header.history_encoding;
+    header.completed_iterations = static_cast<int>(std::llround(options.mode == MergeMode::AVERAGE ? weighted_iterations / total_weight : weighted_iterations));
+    std::vector<RangeCounts> counts(ranges);
+    std::vector<char> out_buffer(kStreamBufferBytes);
+    std::ofstream out;
+    out.rdbuf()->pubsetbuf(out_buffer.data(), static_cast<std::streamsize>(out_buffer.size()));
+    out.open(output, std::ios::binary | std::ios::trunc);
+    if (!out) { spdlog::error("Merge: cannot create {}", output); return false; }
+
+    bool ok = true;
+    if (ranges == 1) {
+        // Stream straight into the output; the record count is patched in at the end
+        ok = write_checkpoint_header(out, header) && merge_range(files, options.mode, total_weight, "", "", out, counts[0]);
+        header.map_size = counts[0].keys;
+    } else {
+        spdlog::info("Merge: {} key ranges in parallel.", ranges);
+        std::vector<std::string> part_paths(ranges);
+        std::vector<std::thread> workers;
+        std::atomic<bool> workers_ok{true};
+        for (size_t r = 0; r < ranges; ++r) {
+            part_paths[r] = output + ".part" + std::to_string(r);
+            workers.emplace_back([&, r] {
+                std::vector<char> buffer(kStreamBufferBytes);
+                std::ofstream part;
+                part.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                part.open(part_paths[r], std::ios::binary | std::ios::trunc);
+                const std::string begin_key = r == 0 ? std::string() : bounds[r - 1];
+                const std::string end_key = r + 1 == ranges ? std::string() : bounds[r];
+                if (!part || !merge_range(files, options.mode, total_weight, begin_key, end_key, part, counts[r])) workers_ok = false;
+                part.close();
+                if (!part) workers_ok = false;
+            });
+        }
+        for (auto& worker : workers) worker.join();
+        ok = workers_ok.load();
+        for (const RangeCounts& c : counts) header.map_size += c.keys;
+        if (ok) ok = write_checkpoint_header(out, header);
+        for (size_t r = 0; r < ranges; ++r) {
+            if (ok) ok = append_file(out, part_paths[r]);
+            std::remove(part_paths[r].c_str());
+        }
+    }
+    long long nodes_created = static_cast<long long>(header.map_size);
+    out.write(reinterpret_cast<const char*>(&nodes_created), sizeof(nodes_created));
+    if (ok && ranges == 1) {
+        out.seekp(checkpoint_map_size_offset());
+        out.write(reinterpret_cast<const char*>(&header.map_size), sizeof(header.map_size));
+    }
+    out.close();
+    if (!ok || !out) {
+        spdlog::error("Merge into {} failed.", output);
+        std::remove(output.c_str());
+        return false;
+    }
+
+    CheckpointMergeStats result;
+    for (const RangeCounts& c : counts) {
+        result.records_read += c.records;
+        result.action_mismatches += c.mismatches;
+    }
+    result.keys_written = header.map_size;
+    std::error_code ec;
+    for (const InputFile& file : files) result.bytes_read += std::filesystem::file_size(file.path, ec);
+    result.bytes_written = std::filesystem::file_size(output, ec);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    spdlog::info("Merged {} records into {} keys ({} iterations) in {:.2f} s: {:.1f} MB read, {:.1f} MB written{}.", result.records_read,
+                 result.keys_written, header.completed_iterations, result.seconds, result.bytes_read / 1e6, result.bytes_written / 1e6,
+                 result.action_mismatches > 0 ? fmt::format(", {} records skipped for mismatched actions", result.action_mismatches) : "");
+    if (stats) *stats = result;
+    return true;
+}
+
+} // namespace gto_solver
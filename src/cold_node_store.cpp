@@ -0,0 +1,193 @@
+#include "cold_node_store.h"
+#include "node_serialization.h"
+
+#include <cerrno>
+#include <cstring>   // For std::strerror
+#include <sstream>
+#include <fcntl.h>   // For open
+#include <unistd.h>  // For pread, pwrite, close, unlink
+
+#include "spdlog/spdlog.h"
+
+namespace gto_solver {
+
+ColdNodeStore::~ColdNodeStore() {
+    close();
+}
+
+bool ColdNodeStore::open(const std::string& path) {
+    close();
+    std::lock_guard<std::mutex> lock(mutex_);
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        spdlog::error("ColdNodeStore: cannot open spill file {}: {}", path, std::strerror(errno));
+        return false;
+    }
+    path_ = path;
+    end_offset_ = 0;
+    evicted_ = 0; faults_ = 0; prefetched_ = 0;
+    bytes_written_ = 0; bytes_read_ = 0; dead_bytes_ = 0;
+    spdlog::info("Cold node tier: spilling evicted nodes to {}", path);
+    return true;
+}
+
+void ColdNodeStore::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ >= 0) {
+        ::close(fd_);
+        ::unlink(path_.c_str()); // Scratch file; checkpoints hold the durable copy
+        fd_ = -1;
+    }
+    index_.clear();
+    staged_.clear();
+    end_offset_ = 0;
+}
+
+void ColdNodeStore::stage(std::string key, std::unique_ptr<Node> node) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    staged_[std::move(key)] = StagedNode{std::move(node), true};
+}
+
+size_t ColdNodeStore::flush_staged() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ < 0) return 0;
+    size_t written = 0;
+    std::ostringstream batch; // One pwrite per flush instead of one per record
+    std::vector<std::pair<std::string, Entry>> new_entries;
+    for (auto it = staged_.begin(); it != staged_.end();) {
+        if (!it->second.needs_write) { ++it; continue; }
+        uint64_t record_start = static_cast<uint64_t>(batch.tellp());
+        if (!write_node_record(batch, it->first, *it->second.node)) {
+            spdlog::error("ColdNodeStore: failed to serialize node {}; keeping it staged.", it->first);
+            ++it;
+            continue;
+        }
+        uint32_t length = static_cast<uint32_t>(static_cast<uint64_t>(batch.tellp()) - record_start);
+        new_entries.push_back({it->first, Entry{end_offset_ + record_start, length}});
+        ++it;
+        ++written;
+    }
+    if (written == 0) return 0;
+
+    const std::string data = batch.str();
+    size_t done = 0;
+    while (done < data.size()) {
+        ssize_t n = ::pwrite(fd_, data.data() + done, data.size() - done, static_cast<off_t>(end_offset_ + done));
+        if (n <= 0) {
+            // Disk full or I/O error: keep the nodes staged (in memory) rather than losing them.
+            spdlog::error("ColdNodeStore: write to {} failed: {}", path_, std::strerror(errno));
+            return 0;
+        }
+        done += static_cast<size_t>(n);
+    }
+    end_offset_ += data.size();
+    for (auto& entry : new_entries) {
+        staged_.erase(entry.first);
+        index_[std::move(entry.first)] = entry.second;
+    }
+    evicted_.fetch_add(written, std::memory_order_relaxed);
+    bytes_written_.fetch_add(data.size(), std::memory_order_relaxed);
+    return written;
+}
+
+std::unique_ptr<Node> ColdNodeStore::read_entry(const std::string& key, const Entry& entry) {
+    std::string buffer(entry.length, '\0');
+    size_t done = 0;
+    while (done < entry.length) {
+        ssize_t n = ::pread(fd_, &buffer[done], entry.length - done, static_cast<off_t>(entry.offset + done));
+        if (n <= 0) { spdlog::error("ColdNodeStore: read of {} failed: {}", key, std::strerror(errno)); return nullptr; }
+        done += static_cast<size_t>(n);
+    }
+    bytes_read_.fetch_add(entry.length, std::memory_order_relaxed);
+    std::istringstream record(buffer);
+    std::string record_key;
+    std::unique_ptr<Node> node;
+    if (!read_node_record(record, record_key, node) || record_key != key) {
+        spdlog::error("ColdNodeStore: corrupt record for {}", key);
+        return nullptr;
+    }
+    return node;
+}
+
+std::unique_ptr<Node> ColdNodeStore::take(const std::string& key, bool count_fault) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto staged_it = staged_.find(key);
+    if (staged_it != staged_.end()) {
+        std::unique_ptr<Node> node = std::move(staged_it->second.node);
+        staged_.erase(staged_it);
+        if (count_fault) faults_.fetch_add(1, std::memory_order_relaxed);
+        return node;
+    }
+    auto it = index_.find(key);
+    if (it == index_.end()) return nullptr;
+    std::unique_ptr<Node> node = read_entry(key, it->second);
+    if (!node) return nullptr; // Keep the index entry; the error is already logged
+    dead_bytes_.fetch_add(it->second.length, std::memory_order_relaxed);
+    index_.erase(it);
+    if (count_fault) faults_.fetch_add(1, std::memory_order_relaxed);
+    return node;
+}
+
+std::unique_ptr<Node> ColdNodeStore::peek(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto staged_it = staged_.find(key);
+    if (staged_it != staged_.end()) {
+        const Node& src = *staged_it->second.node;
+        auto copy = std::make_unique<Node>(src.legal_actions);
+        copy->regret_sum = src.regret_sum;
+        copy->strategy_sum = src.strategy_sum;
+        copy->visit_count.store(src.visit_count.load());
+        return copy;
+    }
+    auto it = index_.find(key);
+    if (it == index_.end()) return nullptr;
+    return read_entry(key, it->second);
+}
+
+size_t ColdNodeStore::stage_prefix(const std::string& prefix, size_t max_nodes, std::vector<std::string>& staged_keys) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t staged = 0;
+    auto it = index_.lower_bound(prefix);
+    while (it != index_.end() && staged < max_nodes && it->first.compare(0, prefix.size(), prefix) == 0) {
+        std::unique_ptr<Node> node = read_entry(it->first, it->second);
+        if (!node) { ++it; continue; }
+        dead_bytes_.fetch_add(it->second.length, std::memory_order_relaxed);
+        staged_keys.push_back(it->first);
+        staged_[it->first] = StagedNode{std::move(node), false};
+        it = index_.erase(it);
+        ++staged;
+    }
+    return staged;
+}
+
+std::vector<std::string> ColdNodeStore::sorted_keys() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> keys;
+    keys.reserve(index_.size() + staged_.size());
+    auto a = index_.begin();
+    auto b = staged_.begin();
+    while (a != index_.end() || b != staged_.end()) {
+        if (b == staged_.end() || (a != index_.end() && a->first < b->first)) keys.push_back((a++)->first);
+        else keys.push_back((b++)->first);
+    }
+    return keys;
+}
+
+size_t ColdNodeStore::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return index_.size() + staged_.size();
+}
+
+ColdStoreStats ColdNodeStore::stats() const {
+    ColdStoreStats s;
+    s.cold_nodes = static_cast<long long>(size());
+    s.evicted = evicted_.load(std::memory_order_relaxed);
+    s.faults = faults_.load(std::memory_order_relaxed);
+    s.prefetched = prefetched_.load(std::memory_order_relaxed);
+    s.bytes_written = bytes_written_.load(std::memory_order_relaxed);
+    s.bytes_read = bytes_read_.load(std::memory_order_relaxed);
+    s.dead_bytes = dead_bytes_.load(std::memory_order_relaxed);
+    return s;
+}
+
+} // namespace gto_solver
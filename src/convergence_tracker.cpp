@@ -0,0 +1,66 @@
+#include "convergence_tracker.h"
+
+#include <algorithm> // For std::max
+#include <cmath>     // For std::abs
+#include <utility>   // For std::move
+
+#include "spdlog/spdlog.h"
+
+namespace gto_solver {
+
+void ConvergenceTracker::start(long long interval_iterations, std::vector<std::string> watch_keys, double stop_threshold,
+                               double initial_positive_regret, long long starting_iteration) {
+    interval_ = std::max(0LL, interval_iterations);
+    watch_keys_ = std::move(watch_keys);
+    stop_threshold_ = stop_threshold;
+    initial_positive_regret_ = initial_positive_regret;
+    last_report_iteration_ = starting_iteration;
+    last_first_visits_ = 0;
+    previous_strategies_.clear();
+    window_ = 1;
+    has_report_ = false;
+}
+
+ConvergenceReport ConvergenceTracker::report(long long iterations, long long total_nodes, double positive_regret_delta,
+                                             uint64_t first_visits, const StrategyLookup& lookup) {
+    ConvergenceReport r;
+    r.iterations = iterations;
+    if (total_nodes > 0) {
+        r.mean_positive_regret = (initial_positive_regret_ + positive_regret_delta) / total_nodes;
+        r.visited_fraction = static_cast<double>(first_visits - last_first_visits_) / total_nodes;
+    }
+
+    // L1 change of the average strategy at each watched infoset since the previous window
+    double delta_sum = 0.0;
+    for (const std::string& key : watch_keys_) {
+        std::vector<double> strategy = lookup(key);
+        if (strategy.empty()) continue;
+        auto prev = previous_strategies_.find(key);
+        if (prev != previous_strategies_.end() && prev->second.size() == strategy.size()) {
+            double l1 = 0.0;
+            for (size_t i = 0; i < strategy.size(); ++i) l1 += std::abs(strategy[i] - prev->second[i]);
+            delta_sum += l1;
+            r.max_strategy_delta = std::max(r.max_strategy_delta, l1);
+            r.watched_compared++;
+        }
+        previous_strategies_[key] = std::move(strategy);
+    }
+    if (r.watched_compared > 0) r.mean_strategy_delta = delta_sum / r.watched_compared;
+    r.converged = stop_threshold_ > 0.0 && r.watched_compared > 0 && r.max_strategy_delta < stop_threshold_;
+
+    spdlog::info("convergence iterations={} mean_positive_regret={:.6f} mean_strategy_delta={:.6f} max_strategy_delta={:.6f} "
+                 "watched_compared={}/{} visited_fraction={:.4f}{}",
+                 iterations, r.mean_positive_regret, r.mean_strategy_delta, r.max_strategy_delta,
+                 r.watched_compared, watch_keys_.size(), r.visited_fraction, r.converged ? " converged=1" : "");
+
+    last_report_iteration_ = iterations;
+    last_first_visits_ = first_visits;
+    last_mean_positive_regret_.store(r.mean_positive_regret, std::memory_order_relaxed);
+    last_max_strategy_delta_.store(r.max_strategy_delta, std::memory_order_relaxed);
+    last_visited_fraction_.store(r.visited_fraction, std::memory_order_relaxed);
+    has_report_.store(true, std::memory_order_release);
+    window_.fetch_add(1, std::memory_order_relaxed); // Nodes must be visited again to count in the next window
+    return r;
+}
+
+} // namespace gto_solver
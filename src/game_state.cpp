@@ -1,6 +1,6 @@
 #include "game_state.h" // Corrected include
-#include <numeric>   // For std::accumulate
 #include <algorithm> // For std::max, std::min, std::find
+#include <bit>       // For std::popcount, std::countr_zero
 #include <stdexcept> // For std::runtime_error
 #include <sstream>   // For history string
 
@@ -28,16 +28,21 @@ GameState::GameState(int num_players, int initial_stack, int ante_size, int butt
       last_raise_size_(0), // Initialized properly after blinds
       aggressor_this_round_(-1),
       actions_this_round_(0),
-      player_folded_(num_players, false),
-      player_all_in_(num_players, false),
+      all_players_mask_(0),
+      player_folded_mask_(0),
+      player_all_in_mask_(0),
       player_contributions_(num_players, 0),
       ante_size_(ante_size),
       button_position_(button_position),
-      player_acted_this_sequence_(num_players, false)
+      player_acted_mask_(0)
 {
     if (num_players < 2) {
         throw std::invalid_argument("GameState requires at least 2 players.");
     }
+    if (num_players > kMaxPlayers) {
+        throw std::invalid_argument("GameState supports at most 16 players.");
+    }
+    all_players_mask_ = static_cast<uint16_t>((1u << num_players) - 1);
     if (button_position < 0 || button_position >= num_players) {
          throw std::invalid_argument("Invalid button position.");
     }
@@ -50,7 +55,7 @@ GameState::GameState(int num_players, int initial_stack, int ante_size, int butt
             player_contributions_[i] += post_amount;
             pot_size_ += post_amount;
             if (player_stacks_[i] == 0) {
-                 player_all_in_[i] = true;
+                 player_all_in_mask_ |= player_bit(i);
             }
         }
          spdlog::trace("Ante posted. Pot: {}", pot_size_);
@@ -78,10 +83,9 @@ GameState::GameState(int num_players, int initial_stack, int ante_size, int butt
         current_player_index_ = sb_index; // SB acts first HU preflop
     }
      // Skip players who are already all-in from antes/blinds
-     int initial_actor = current_player_index_;
-     while(player_all_in_[current_player_index_] && std::accumulate(player_all_in_.begin(), player_all_in_.end(), 0) < num_players_) {
-          current_player_index_ = (current_player_index_ + 1) % num_players_;
-          if (current_player_index_ == initial_actor) break; // Avoid infinite loop if everyone is all-in
+     uint16_t not_all_in = all_players_mask_ & ~player_all_in_mask_;
+     if ((player_all_in_mask_ & player_bit(current_player_index_)) && not_all_in != 0) { // Everyone all-in: keep the seat
+          current_player_index_ = next_player_in(not_all_in, current_player_index_);
      }
 
 
@@ -128,11 +132,11 @@ const std::vector<int>& GameState::get_current_bets() const {
 int GameState::get_last_raise_size() const { return last_raise_size_; }
 bool GameState::has_player_folded(int player_index) const {
      if (player_index < 0 || player_index >= num_players_) return true;
-     return player_folded_[player_index];
+     return (player_folded_mask_ & player_bit(player_index)) != 0;
 }
 bool GameState::is_player_all_in(int player_index) const {
      if (player_index < 0 || player_index >= num_players_) return false;
-     return player_all_in_[player_index];
+     return (player_all_in_mask_ & player_bit(player_index)) != 0;
 }
 int GameState::get_player_contribution(int player_index) const {
      if (player_index < 0 || player_index >= num_players_) return 0;
@@ -143,13 +147,7 @@ int GameState::get_last_raiser() const {
 }
 int GameState::get_num_active_players() const {
      // Correction: Count players who haven't folded
-     int count = 0;
-      for(int i=0; i<num_players_; ++i) {
-          if (!player_folded_[i]) {
-               count++;
-          }
-     }
-     return count;
+     return std::popcount(players_in_hand_mask());
 }
 int GameState::get_num_limpers() const {
      if (current_street_ != Street::PREFLOP || get_raises_this_street() > 0) {
@@ -159,11 +157,12 @@ int GameState::get_num_limpers() const {
      int bb_index = (button_position_ + 2) % num_players_;
      if (num_players_ == 2) bb_index = (button_position_ + 1) % num_players_;
 
-     for(int i=0; i < num_players_; ++i) {
-          if (!player_folded_[i] && !player_all_in_[i] && bets_this_round_[i] == BIG_BLIND_SIZE_GS && i != bb_index) {
+     for (uint16_t can_act = players_can_act_mask(); can_act != 0; can_act &= can_act - 1) {
+          int i = std::countr_zero(can_act);
+          if (bets_this_round_[i] == BIG_BLIND_SIZE_GS && i != bb_index) {
                limper_count++;
           }
-          else if (!player_folded_[i] && !player_all_in_[i] && bets_this_round_[i] == BIG_BLIND_SIZE_GS / 2 && i == (button_position_ + 1) % num_players_ && num_players_ > 2) {
+          else if (bets_this_round_[i] == BIG_BLIND_SIZE_GS / 2 && i == (button_position_ + 1) % num_players_ && num_players_ > 2) {
                limper_count++;
           }
      }
@@ -188,7 +187,11 @@ void GameState::deal_hands(const std::vector<std::vector<Card>>& hands) {
 }
 
 void GameState::deal_community_cards(const std::vector<Card>& cards) {
-    community_cards_.insert(community_cards_.end(), cards.begin(), cards.end());
+    deal_community_cards(cards.data(), cards.size());
+}
+
+void GameState::deal_community_cards(const Card* cards, size_t count) {
+    community_cards_.insert(community_cards_.end(), cards, cards + count);
      spdlog::trace("Community cards dealt. Board: {}", fmt::join(community_cards_, " "));
 }
 
@@ -200,7 +203,7 @@ void GameState::apply_action(const Action& action) {
     if (action.player_index != current_player_index_) {
         throw std::runtime_error("Action applied by wrong player.");
     }
-    if (player_folded_[current_player_index_] || player_all_in_[current_player_index_]) {
+    if (!(players_can_act_mask() & player_bit(current_player_index_))) {
          spdlog::warn("Player {} cannot act (folded or all-in). Skipping action.", current_player_index_);
          update_next_player();
          return;
@@ -212,11 +215,11 @@ void GameState::apply_action(const Action& action) {
     int amount_committed = 0;
 
     action_history_.push_back(action);
-    player_acted_this_sequence_[current_player_index_] = true;
+    player_acted_mask_ |= player_bit(current_player_index_);
 
     switch (action.type) {
         case Action::Type::FOLD:
-            player_folded_[current_player_index_] = true;
+            player_folded_mask_ |= player_bit(current_player_index_);
             spdlog::trace("Player {} folds.", current_player_index_);
             break;
 
@@ -247,7 +250,7 @@ void GameState::apply_action(const Action& action) {
             player_contributions_[current_player_index_] += amount_committed;
             pot_size_ += amount_committed;
             if (player_stacks_[current_player_index_] == 0) {
-                player_all_in_[current_player_index_] = true;
+                player_all_in_mask_ |= player_bit(current_player_index_);
             }
             actions_this_round_++;
             break;
@@ -276,7 +279,7 @@ void GameState::apply_action(const Action& action) {
                  spdlog::warn("Player {} bet/raise amount {} capped by stack {}. Going all-in.", current_player_index_, bet_increment, player_stack);
                  bet_increment = player_stack;
                  total_bet_amount = current_bet + player_stack;
-                 player_all_in_[current_player_index_] = true;
+                 player_all_in_mask_ |= player_bit(current_player_index_);
             }
 
             // Check min-raise rule
@@ -287,7 +290,7 @@ void GameState::apply_action(const Action& action) {
              }
             int actual_raise_increment = total_bet_amount - (current_bet + call_amount);
 
-            if (action.type == Action::Type::RAISE && actual_raise_increment < min_raise_increment && !player_all_in_[current_player_index_]) {
+            if (action.type == Action::Type::RAISE && actual_raise_increment < min_raise_increment && !(player_all_in_mask_ & player_bit(current_player_index_))) {
                  int min_legal_total_bet = current_bet + call_amount + min_raise_increment;
                  if (player_stack + current_bet >= min_legal_total_bet) {
                       spdlog::warn("Player {} raise amount {} (increment {}) too small (min inc {}), forcing min-raise to {}.",
@@ -304,53 +307,27 @@ void GameState::apply_action(const Action& action) {
             bets_this_round_[current_player_index_] += bet_increment;
             player_contributions_[current_player_index_] += bet_increment;
             pot_size_ += bet_increment;
-            if (player_stacks_[current_player_index_] == 0 && !player_all_in_[current_player_index_]) {
-                player_all_in_[current_player_index_] = true;
+            if (player_stacks_[current_player_index_] == 0) {
+                player_all_in_mask_ |= player_bit(current_player_index_);
             }
 
             last_raise_size_ = actual_raise_increment;
             aggressor_this_round_ = current_player_index_;
             actions_this_round_ = 1;
-            std::fill(player_acted_this_sequence_.begin(), player_acted_this_sequence_.end(), false);
-            player_acted_this_sequence_[current_player_index_] = true;
+            player_acted_mask_ = player_bit(current_player_index_);
 
             break;
     }
 
     // --- Check for End of Round / Street / Hand ---
-    int active_players_remaining = 0;
-    int players_can_still_act = 0;
-    for(int i=0; i<num_players_; ++i) {
-        if (!player_folded_[i]) {
-            active_players_remaining++;
-            if (!player_all_in_[i]) {
-                 players_can_still_act++;
-            }
-        }
-    }
+    int active_players_remaining = std::popcount(players_in_hand_mask());
+    int players_can_still_act = std::popcount(players_can_act_mask());
 
     if (active_players_remaining <= 1) {
         is_game_over_ = true;
         spdlog::trace("Hand over - only one player remaining.");
     } else {
-        bool betting_round_over = true;
-        int max_bet = 0;
-        for(int bet : bets_this_round_) max_bet = std::max(max_bet, bet);
-
-        for(int i=0; i<num_players_; ++i) {
-            if (!player_folded_[i] && !player_all_in_[i]) {
-                if (bets_this_round_[i] < max_bet || !player_acted_this_sequence_[i]) {
-                    betting_round_over = false;
-                    break;
-                }
-            }
-        }
-         int bb_index = (button_position_ + 2) % num_players_;
-         if (num_players_ == 2) bb_index = (button_position_ + 1) % num_players_;
-         if (current_street_ == Street::PREFLOP && aggressor_this_round_ == -1 && !player_acted_this_sequence_[bb_index] && !player_all_in_[bb_index] && !player_folded_[bb_index]) {
-              betting_round_over = false;
-         }
-
+        bool betting_round_over = betting_round_closed();
 
         if (betting_round_over) {
             spdlog::trace("Betting round over for street {}.", static_cast<int>(current_street_));
@@ -388,17 +365,12 @@ void GameState::advance_to_next_street() {
         current_player_index_ = (button_position_ + 1) % num_players_;
     }
 
-    int initial_actor = current_player_index_;
     // Skip players who are folded or all-in
-    while(player_folded_[current_player_index_] || player_all_in_[current_player_index_]) {
-         current_player_index_ = (current_player_index_ + 1) % num_players_;
-         if (current_player_index_ == initial_actor) {
-              spdlog::warn("No player can act postflop, forcing showdown/end.");
-              is_game_over_ = true;
-              current_street_ = Street::SHOWDOWN;
-              current_player_index_ = -1;
-              break;
-         }
+    current_player_index_ = next_player_in(players_can_act_mask(), current_player_index_);
+    if (current_player_index_ == -1) {
+         spdlog::warn("No player can act postflop, forcing showdown/end.");
+         is_game_over_ = true;
+         current_street_ = Street::SHOWDOWN;
     }
      if (!is_game_over_) {
           spdlog::trace("First player to act on new street: {}", current_player_index_);
@@ -422,13 +394,44 @@ std::string GameState::get_history_string() const {
     return ss.str();
 }
 
+std::string GameState::get_compact_history() const {
+    std::string history;
+    history.reserve(action_history_.size());
+    for (const auto& action : action_history_) {
+        AbstractAction abstract_action = action.abstract_action;
+        if (action.action_set == ActionSetId::UNTAGGED) {
+            switch (action.type) {
+                case Action::Type::FOLD:  abstract_action = AbstractAction::FOLD; break;
+                case Action::Type::CHECK: abstract_action = AbstractAction::CHECK; break;
+                case Action::Type::CALL:  abstract_action = AbstractAction::CALL; break;
+                default:                  abstract_action = AbstractAction::UNKNOWN; break;
+            }
+        }
+        history.push_back(static_cast<char>(compact_history_byte(action.action_set, abstract_action)));
+    }
+    return history;
+}
+
+bool parse_history_encoding(const std::string& text, HistoryEncoding& encoding) {
+    if (text == "chips") encoding = HistoryEncoding::CHIPS;
+    else if (text == "actions") encoding = HistoryEncoding::ACTIONS;
+    else return false;
+    return true;
+}
+
+const char* history_encoding_name(HistoryEncoding encoding) {
+    return encoding == HistoryEncoding::ACTIONS ? "actions" : "chips";
+}
+
+std::string GameState::get_history(HistoryEncoding encoding) const {
+    return encoding == HistoryEncoding::ACTIONS ? get_compact_history() : get_history_string();
+}
+
 int GameState::get_effective_stack(int player_index) const {
      if (player_index < 0 || player_index >= num_players_) return 0;
      int min_stack = player_stacks_[player_index];
-     for(int i=0; i<num_players_; ++i) {
-          if (i != player_index && !player_folded_[i]) {
-               min_stack = std::min(min_stack, player_stacks_[i]);
-          }
+     for (uint16_t others = players_in_hand_mask() & ~player_bit(player_index); others != 0; others &= others - 1) {
+          min_stack = std::min(min_stack, player_stacks_[std::countr_zero(others)]);
      }
      // Effective stack should not include current player's bet this round
      return min_stack;
@@ -457,7 +460,7 @@ void GameState::post_antes_and_blinds(int sb_index, int bb_index, int sb_amount,
           bets_this_round_[sb_index] = post_amount;
           player_contributions_[sb_index] += post_amount;
           pot_size_ += post_amount;
-          if (player_stacks_[sb_index] == 0) player_all_in_[sb_index] = true;
+          if (player_stacks_[sb_index] == 0) player_all_in_mask_ |= player_bit(sb_index);
           spdlog::trace("Player {} posts SB {}", sb_index, post_amount);
      }
      if (bb_index >= 0 && bb_index < num_players_) {
@@ -466,13 +469,13 @@ void GameState::post_antes_and_blinds(int sb_index, int bb_index, int sb_amount,
           bets_this_round_[bb_index] = post_amount;
           player_contributions_[bb_index] += post_amount;
           pot_size_ += post_amount;
-          if (player_stacks_[bb_index] == 0) player_all_in_[bb_index] = true;
+          if (player_stacks_[bb_index] == 0) player_all_in_mask_ |= player_bit(bb_index);
           spdlog::trace("Player {} posts BB {}", bb_index, post_amount);
      }
      last_raise_size_ = bb_amount; // Initial "raise" size is the BB
      aggressor_this_round_ = bb_index;
      actions_this_round_ = 0;
-     std::fill(player_acted_this_sequence_.begin(), player_acted_this_sequence_.end(), false);
+     player_acted_mask_ = 0;
 }
 
 void GameState::update_next_player() {
@@ -481,20 +484,12 @@ void GameState::update_next_player() {
         return;
     }
     int start_index = current_player_index_;
-    do {
-        current_player_index_ = (current_player_index_ + 1) % num_players_;
-        if (current_player_index_ == start_index) break;
-        if (!player_folded_[current_player_index_] && !player_all_in_[current_player_index_]) break;
-    } while (true);
-
-     if (current_player_index_ == start_index && (player_folded_[current_player_index_] || player_all_in_[current_player_index_])) {
-          bool can_anyone_act = false;
-          for(int i=0; i<num_players_; ++i) {
-               if (!player_folded_[i] && !player_all_in_[i]) {
-                    can_anyone_act = true;
-                    break;
-               }
-          }
+    uint16_t can_act = players_can_act_mask();
+    int next_index = next_player_in(can_act & ~player_bit(start_index), (start_index + 1) % num_players_);
+    current_player_index_ = next_index >= 0 ? next_index : start_index; // Nobody else can act: stay put
+
+     if (current_player_index_ == start_index && !(can_act & player_bit(start_index))) {
+          bool can_anyone_act = can_act != 0;
           if (!can_anyone_act) {
                spdlog::trace("No player can act, advancing street/ending hand.");
                if (current_street_ == Street::RIVER) {
@@ -524,19 +519,35 @@ void GameState::reset_bets_for_new_street() {
     last_raise_size_ = 0;
     aggressor_this_round_ = -1;
     actions_this_round_ = 0;
-    std::fill(player_acted_this_sequence_.begin(), player_acted_this_sequence_.end(), false);
+    player_acted_mask_ = 0;
+}
+
+bool GameState::betting_round_closed() const {
+    int max_bet = 0;
+    for(int bet : bets_this_round_) max_bet = std::max(max_bet, bet);
+    uint16_t can_act = players_can_act_mask();
+    if (can_act & ~player_acted_mask_) return false;
+    for (uint16_t pending = can_act; pending != 0; pending &= pending - 1) {
+        if (bets_this_round_[std::countr_zero(pending)] < max_bet) return false;
+    }
+    int bb_index = (button_position_ + 2) % num_players_;
+    if (num_players_ == 2) bb_index = (button_position_ + 1) % num_players_;
+    // Preflop limps: the BB still has its option
+    if (current_street_ == Street::PREFLOP && aggressor_this_round_ == -1 && (can_act & ~player_acted_mask_ & player_bit(bb_index))) return false;
+    return true;
+}
+
+int GameState::next_player_in(uint16_t mask, int from) const {
+    if (mask == 0) return -1;
+    // Rotate the num_players_-bit mask right by from, so seat from lands on bit 0
+    uint32_t rotated = ((static_cast<uint32_t>(mask) >> from) | (static_cast<uint32_t>(mask) << (num_players_ - from))) & all_players_mask_;
+    return (from + std::countr_zero(rotated)) % num_players_;
 }
 
 bool GameState::is_terminal() const {
      if (is_game_over_) return true;
 
-     int active_count = 0;
-     for(int i=0; i<num_players_; ++i) {
-          if (!player_folded_[i]) {
-               active_count++;
-          }
-     }
-     if (active_count <= 1) {
+     if (std::popcount(players_in_hand_mask()) <= 1) {
           return true;
      }
 
@@ -544,31 +555,8 @@ bool GameState::is_terminal() const {
           return true;
      }
 
-     int players_can_bet = 0;
-      for(int i=0; i<num_players_; ++i) {
-          if (!player_folded_[i] && !player_all_in_[i]) {
-               players_can_bet++;
-          }
-     }
-      if (players_can_bet <= 1) {
-           bool betting_closed = true;
-           int max_bet = 0;
-           for(int bet : bets_this_round_) max_bet = std::max(max_bet, bet);
-           for(int i=0; i<num_players_; ++i) {
-                if (!player_folded_[i] && !player_all_in_[i]) {
-                     if (bets_this_round_[i] < max_bet || !player_acted_this_sequence_[i]) {
-                          betting_closed = false;
-                          break;
-                     }
-                }
-           }
-            int bb_index = (button_position_ + 2) % num_players_;
-            if (num_players_ == 2) bb_index = (button_position_ + 1) % num_players_;
-            if (current_street_ == Street::PREFLOP && aggressor_this_round_ == -1 && !player_acted_this_sequence_[bb_index] && !player_all_in_[bb_index] && !player_folded_[bb_index]) {
-                 betting_closed = false;
-            }
-
-           if (betting_closed && current_street_ == Street::RIVER) {
+      if (std::popcount(players_can_act_mask()) <= 1) {
+           if (betting_round_closed() && current_street_ == Street::RIVER) {
                 return true;
            }
       }
@@ -6,16 +6,20 @@
 
 namespace gto_solver {
 
+std::string InfoSet::key_prefix(int player_index, const std::vector<Card>& private_hand) {
+    std::string prefix = "P" + std::to_string(player_index) + ":";
+    std::vector<Card> sorted_hand = private_hand; // Copy to sort
+    std::sort(sorted_hand.begin(), sorted_hand.end());
+    for (const auto& card : sorted_hand) { prefix += card; }
+    prefix += "|";
+    return prefix;
+}
+
 // Private helper to generate the key string
 void InfoSet::generate_key() {
     std::stringstream ss;
-    // 1. Player Index
-    ss << "P" << player_index_ << ":";
-    // 2. Private Hand (Sorted)
-    std::vector<Card> sorted_hand = private_hand_; // Copy to sort
-    std::sort(sorted_hand.begin(), sorted_hand.end());
-    for (const auto& card : sorted_hand) { ss << card; }
-    ss << "|";
+    // 1. Player Index + 2. Private Hand (Sorted)
+    ss << key_prefix(player_index_, private_hand_);
     // 3. Street
     ss << static_cast<int>(street_) << "|";
     // 4. Community Cards (Board - Size + Sorted, with placeholders)
@@ -54,10 +58,10 @@ void InfoSet::generate_key() {
 
 
 // Constructor for CFR traversal (uses current state)
-InfoSet::InfoSet(const GameState& current_state, int player_index)
+InfoSet::InfoSet(const GameState& current_state, int player_index, HistoryEncoding encoding)
     : player_index_(player_index),
       private_hand_(current_state.get_player_hand(player_index)),
-      action_history_(current_state.get_history_string()),
+      action_history_(current_state.get_history(encoding)),
       street_(current_state.get_current_street()),
       board_(current_state.get_community_cards())
 {
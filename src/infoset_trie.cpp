@@ -0,0 +1,120 @@
+#include "infoset_trie.h"
+
+#include <algorithm> // For std::sort, std::min
+#include <array>
+#include <utility>   // For std::move
+
+namespace gto_solver {
+
+template <typename Value>
+size_t FlatIndex<Value>::slot_of(uint64_t key) const {
+    const size_t mask = keys_.size() - 1;
+    size_t slot = static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & mask; // Fibonacci hashing
+    while (keys_[slot] != key && keys_[slot] != kEmpty) slot = (slot + 1) & mask;
+    return slot;
+}
+
+template <typename Value>
+const Value* FlatIndex<Value>::find(uint64_t key) const {
+    if (size_ == 0) return nullptr;
+    size_t slot = slot_of(key);
+    return keys_[slot] == key ? &values_[slot] : nullptr;
+}
+
+template <typename Value>
+Value& FlatIndex<Value>::find_or_insert(uint64_t key) {
+    if ((size_ + 1) * 2 > keys_.size()) grow();
+    size_t slot = slot_of(key);
+    if (keys_[slot] != key) {
+        keys_[slot] = key;
+        values_[slot] = Value{};
+        ++size_;
+    }
+    return values_[slot];
+}
+
+template <typename Value>
+void FlatIndex<Value>::grow() {
+    std::vector<uint64_t> old_keys = std::move(keys_);
+    std::vector<Value> old_values = std::move(values_);
+    keys_.assign(old_keys.empty() ? 4 : old_keys.size() * 2, kEmpty);
+    values_.assign(keys_.size(), Value{});
+    for (size_t i = 0; i < old_keys.size(); ++i) {
+        if (old_keys[i] == kEmpty) continue;
+        size_t slot = slot_of(old_keys[i]);
+        keys_[slot] = old_keys[i];
+        values_[slot] = std::move(old_values[i]);
+    }
+}
+
+template class FlatIndex<InfosetTrie::Vertex*>;
+template class FlatIndex<InfosetTrie::Entry>;
+
+InfosetTrie::Vertex* InfosetTrie::new_vertex() {
+    return &vertices_.emplace_back();
+}
+
+InfosetTrie::Vertex* InfosetTrie::root(uint64_t button) {
+    Vertex*& vertex = roots_.find_or_insert(button);
+    if (!vertex) vertex = new_vertex();
+    return vertex;
+}
+
+InfosetTrie::Vertex* InfosetTrie::child(Vertex* parent, uint64_t edge) {
+    Vertex*& vertex = parent->children_.find_or_insert(edge);
+    if (!vertex) vertex = new_vertex();
+    return vertex;
+}
+
+void InfosetTrie::set_actions(Vertex* vertex, std::vector<ActionSpec> actions, std::vector<int> amounts) {
+    if (vertex->has_actions_) return;
+    vertex->actions_ = std::move(actions);
+    vertex->amounts_ = std::move(amounts);
+    vertex->amounts_.resize(vertex->actions_.size(), -1);
+    vertex->has_actions_ = true;
+}
+
+const InfosetTrie::Entry* InfosetTrie::find(const Vertex* vertex, uint64_t hand) {
+    const Entry* entry = vertex->infosets_.find(hand);
+    ++(entry ? hits_ : misses_);
+    return entry;
+}
+
+void InfosetTrie::insert(Vertex* vertex, uint64_t hand, const Entry& entry) {
+    Entry& slot = vertex->infosets_.find_or_insert(hand);
+    if (!slot.node) ++entries_;
+    slot = entry;
+}
+
+void InfosetTrie::clear() {
+    vertices_.clear();
+    roots_ = FlatIndex<Vertex*>();
+    entries_ = 0;
+    hits_ = 0;
+    misses_ = 0;
+}
+
+size_t InfosetTrie::memory_bytes() const {
+    size_t bytes = roots_.memory_bytes();
+    for (const Vertex& vertex : vertices_) {
+        bytes += sizeof(Vertex) + vertex.actions_.capacity() * sizeof(ActionSpec) + vertex.amounts_.capacity() * sizeof(int) +
+                 vertex.children_.memory_bytes() + vertex.infosets_.memory_bytes();
+    }
+    return bytes;
+}
+
+uint64_t trie_edge_code(size_t action_slot, const int* dealt_cards, size_t num_dealt) {
+    std::array<int, 5> cards{};
+    num_dealt = std::min(num_dealt, cards.size());
+    std::copy(dealt_cards, dealt_cards + num_dealt, cards.begin());
+    std::sort(cards.begin(), cards.begin() + num_dealt); // The board is a set
+    uint64_t code = static_cast<uint64_t>(action_slot & 0xFF) | (static_cast<uint64_t>(num_dealt) << 8);
+    for (size_t i = 0; i < num_dealt; ++i) code |= static_cast<uint64_t>(cards[i] & 0x3F) << (11 + 6 * i);
+    return code;
+}
+
+uint64_t trie_hand_code(int card_a, int card_b) {
+    return static_cast<uint64_t>(std::min(card_a, card_b)) * 52 + std::max(card_a, card_b);
+}
+
+} // namespace gto_solver
@@ -12,6 +12,9 @@
 #include "monte_carlo.h"
 #include "info_set.h"
 #include "node.h" // Include Node definition
+#include "checkpoint_merge.h" // `merge` command
+#include "checkpoint_compact.h" // `compact` command
+#include "shared_node_store.h" // --shm-workers
 
 #include "spdlog/spdlog.h" // Include spdlog
 #include "spdlog/sinks/stdout_color_sinks.h" // For console logging
@@ -22,10 +25,16 @@
 #include <algorithm> // For std::sort, std::max_element
 #include <iterator>  // For std::distance
 #include <map>       // For storing strategies
+#include <set>       // For de-duplicating watch-list hands
 #include <vector>    // Used extensively
 #include <array>     // For grid structure
 #include <sstream>   // For stringstream
 #include <fstream>   // For std::ofstream (JSON export)
+#include <thread>    // For std::thread::hardware_concurrency
+#include <chrono>    // For polling --shm-workers
+#include <cstdio>    // For std::remove, std::rename
+#include <sys/wait.h> // For waitpid (--local-shards, --shm-workers)
+#include <unistd.h>   // For fork, getpid
 
 #include <nlohmann/json.hpp> // Include JSON library
 using json = nlohmann::json;
@@ -196,9 +205,49 @@ void export_strategies_to_json(
 }
 
 
+// RFI positions extracted after training, as player indices relative to BTN=0.
+// Empty if extraction is not implemented for this table size.
+std::map<std::string, int> rfi_position_map(int num_players) {
+    if (num_players == 6) {
+        // Corrected 6-max positions relative to BTN=0: SB=1, BB=2, UTG=3, MP=4, CO=5
+        return {{"UTG", 3}, {"MP", 4}, {"CO", 5}, {"BTN", 0}, {"SB", 1}};
+    } else if (num_players == 2) {
+        return {{"SB", 0}}; // BTN=SB=0, BB=1
+    }
+    return {};
+}
+
+// InfoSet key of an RFI spot for one hand, exactly as queried by the strategy extraction.
+std::string rfi_infoset_key(const std::vector<gto_solver::Card>& hand, const std::string& history,
+                            const gto_solver::GameState& context_state, int player_index) {
+    std::vector<gto_solver::Card> sorted_hand_for_key = hand;
+    std::sort(sorted_hand_for_key.begin(), sorted_hand_for_key.end());
+    // Create the InfoSet using the constructor that takes the specific components
+    gto_solver::InfoSet infoset(sorted_hand_for_key, history, context_state, player_index);
+    return infoset.get_key();
+}
+
+// Convergence watch-list: the RFI key of one combo per canonical hand for every extracted position.
+std::vector<std::string> build_rfi_watch_keys(int num_players, int initial_stack, int ante_size, gto_solver::HandGenerator& hand_generator) {
+    std::vector<std::string> keys;
+    gto_solver::GameState context_state(num_players, initial_stack, ante_size, 0);
+    const auto all_hands_str = hand_generator.generate_hands();
+    for (const auto& pos_pair : rfi_position_map(num_players)) {
+        std::set<std::string> seen_canonical_hands;
+        for (const std::string& hand_str_internal : all_hands_str) {
+            if (hand_str_internal.length() != 4) continue;
+            std::vector<gto_solver::Card> hand_vec = {hand_str_internal.substr(0, 2), hand_str_internal.substr(2, 2)};
+            if (!seen_canonical_hands.insert(format_hand_string(hand_vec)).second) continue;
+            keys.push_back(rfi_infoset_key(hand_vec, "", context_state, pos_pair.second));
+        }
+    }
+    return keys;
+}
+
+
 // Function to parse command line arguments (simple version)
 // Note: This version COMPLETELY IGNORES --loglevel. It's handled manually before logging setup.
-void parse_args(int argc, char* argv[], int& iterations, int& num_players, int& initial_stack, int& ante_size, int& num_threads, std::string& save_file, int& checkpoint_interval, std::string& load_file, std::string& json_export_file) {
+void parse_args(int argc, char* argv[], int& iterations, int& num_players, int& initial_stack, int& ante_size, int& num_threads, std::string& save_file, int& checkpoint_interval, std::string& load_file, std::string& json_export_file, gto_solver::TrainingOptions& training_options, int& local_shards, int& shard_base_port, int& shm_workers, size_t& shm_size) {
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
         if ((arg == "-i" || arg == "--iterations") && i + 1 < argc) {
@@ -219,6 +268,64 @@ void parse_args(int argc, char* argv[], int& iterations, int& num_players, int&
             load_file = argv[++i];
         } else if ((arg == "--json") && i + 1 < argc) { // Added JSON export argument
             json_export_file = argv[++i];
+        } else if ((arg == "--metrics-interval") && i + 1 < argc) { // Seconds between metrics log lines (0 = off)
+             try { training_options.metrics_interval_seconds = std::stod(argv[++i]); } catch (...) { /* Ignored */ }
+        } else if ((arg == "--metrics-csv") && i + 1 < argc) {
+            training_options.metrics_csv_filename = argv[++i];
+        } else if ((arg == "--metrics-port") && i + 1 < argc) { // Prometheus endpoint on localhost (0 = off)
+             try { training_options.metrics_port = std::stoi(argv[++i]); if (training_options.metrics_port < 0) training_options.metrics_port = 0; } catch (...) { training_options.metrics_port = 0; /* Ignored */ }
+        } else if ((arg == "--convergence-interval") && i + 1 < argc) { // Iterations between convergence reports (0 = off)
+             try { training_options.convergence_interval = std::stoll(argv[++i]); if (training_options.convergence_interval < 0) training_options.convergence_interval = 0; } catch (...) { training_options.convergence_interval = 0; /* Ignored */ }
+        } else if ((arg == "--convergence-stop") && i + 1 < argc) { // Auto-stop when the max watched strategy delta drops below this
+             try { training_options.convergence_stop_threshold = std::stod(argv[++i]); } catch (...) { /* Ignored */ }
+        } else if ((arg == "--max-memory") && i + 1 < argc) { // Node storage budget, e.g. 512M, 8G
+             std::string size_arg = argv[++i];
+             if (!gto_solver::parse_memory_size(size_arg, training_options.max_memory_bytes)) { spdlog::warn("Invalid --max-memory value: {}", size_arg); training_options.max_memory_bytes = 0; }
+        } else if ((arg == "--spill-file") && i + 1 < argc) { // Disk tier for nodes evicted under --max-memory
+            training_options.spill_filename = argv[++i];
+        } else if ((arg == "--pin-threads") && i + 1 < argc) { // none | compact | spread
+             std::string placement_arg = argv[++i];
+             if (!gto_solver::parse_thread_placement(placement_arg, training_options.thread_placement)) { spdlog::warn("Invalid --pin-threads value: {} (expected none, compact or spread)", placement_arg); }
+        } else if ((arg == "--huge-pages") && i + 1 < argc) { // off | thp | explicit
+             std::string pages_arg = argv[++i];
+             if (!gto_solver::parse_huge_page_policy(pages_arg, training_options.huge_pages)) { spdlog::warn("Invalid --huge-pages value: {} (expected off, thp or explicit)", pages_arg); }
+        } else if ((arg == "--numa-interleave-depth") && i + 1 < argc) { // Interleave nodes above this depth across NUMA nodes
+             try { training_options.numa_interleave_depth = std::stoi(argv[++i]); if (training_options.numa_interleave_depth < 0) training_options.numa_interleave_depth = 0; } catch (...) { training_options.numa_interleave_depth = 0; /* Ignored */ }
+        } else if ((arg == "--buffered-updates") && i + 1 < argc) { // Merge thread-local regret deltas every N iterations (0 = off)
+             try { training_options.update_buffer_interval = std::stoi(argv[++i]); if (training_options.update_buffer_interval < 0) training_options.update_buffer_interval = 0; } catch (...) { training_options.update_buffer_interval = 0; /* Ignored */ }
+        } else if ((arg == "--batch-deals") && i + 1 < argc) { // Deals traversed together per worker (1 = off)
+             try { training_options.traversal_batch_size = std::stoi(argv[++i]); if (training_options.traversal_batch_size < 1) training_options.traversal_batch_size = 1; } catch (...) { training_options.traversal_batch_size = 1; /* Ignored */ }
+        } else if ((arg == "--interleave") && i + 1 < argc) { // Coroutine traversals interleaved per worker (1 = off)
+             try { training_options.interleaved_traversals = std::stoi(argv[++i]); if (training_options.interleaved_traversals < 1) training_options.interleaved_traversals = 1; } catch (...) { training_options.interleaved_traversals = 1; /* Ignored */ }
+        } else if ((arg == "--defer-nodes") && i + 1 < argc) { // Opponent-only infosets get a node after K visits (0 = always)
+             try { training_options.materialize_after_visits = std::stoi(argv[++i]); if (training_options.materialize_after_visits < 0) training_options.materialize_after_visits = 0; } catch (...) { training_options.materialize_after_visits = 0; /* Ignored */ }
+        } else if ((arg == "--history-encoding") && i + 1 < argc) { // chips | actions (infoset key format)
+             std::string encoding_arg = argv[++i];
+             if (!gto_solver::parse_history_encoding(encoding_arg, training_options.history_encoding)) { spdlog::warn("Invalid --history-encoding value: {} (expected chips or actions)", encoding_arg); }
+        } else if ((arg == "--shard-endpoints") && i + 1 < argc) { // host:port,... one per shard process (distributed training)
+             std::string endpoints_arg = argv[++i];
+             if (!gto_solver::parse_shard_endpoints(endpoints_arg, training_options.shard_endpoints)) { spdlog::warn("Invalid --shard-endpoints value: {} (expected host:port,host:port,...)", endpoints_arg); }
+        } else if ((arg == "--shard-id") && i + 1 < argc) { // This process's index into --shard-endpoints
+             try { training_options.shard_id = std::stoi(argv[++i]); } catch (...) { training_options.shard_id = 0; /* Ignored */ }
+        } else if ((arg == "--shard-sync-ms") && i + 1 < argc) { // Interval between update / lookup batches to peers
+             try { training_options.shard_sync_seconds = std::stod(argv[++i]) / 1000.0; } catch (...) { /* Ignored */ }
+        } else if ((arg == "--local-shards") && i + 1 < argc) { // Fork N shard processes on loopback
+             try { local_shards = std::stoi(argv[++i]); if (local_shards < 0) local_shards = 0; } catch (...) { local_shards = 0; /* Ignored */ }
+        } else if ((arg == "--shard-base-port") && i + 1 < argc) { // First loopback port for --local-shards
+             try { shard_base_port = std::stoi(argv[++i]); } catch (...) { /* Ignored */ }
+        } else if ((arg == "--shm-workers") && i + 1 < argc) { // Fork N worker processes sharing one node store
+             try { shm_workers = std::stoi(argv[++i]); if (shm_workers < 0) shm_workers = 0; } catch (...) { shm_workers = 0; /* Ignored */ }
+        } else if ((arg == "--shm-size") && i + 1 < argc) { // Size of the shared node store, e.g. 512M, 8G
+             std::string size_arg = argv[++i];
+             if (!gto_solver::parse_memory_size(size_arg, shm_size) || shm_size == 0) { spdlog::warn("Invalid --shm-size value: {}", size_arg); shm_size = size_t(1) << 30; }
+        } else if (arg == "--floor-regrets") { // CFR+: clamp cumulative regrets at zero
+             training_options.floor_regrets = true;
+        } else if (arg == "--simultaneous-updates") { // One outcome-sampled traversal per deal updates every player
+             training_options.simultaneous_updates = true;
+        } else if (arg == "--infoset-trie") { // Reach repeat decisions by child pointers instead of key lookups
+             training_options.infoset_trie = true;
+        } else if (arg == "--baselines") { // Variance-reduced external sampling (learned action baselines)
+             training_options.action_baselines = true;
         } else if (arg == "--loglevel" && i + 1 < argc) {
              // Skip --loglevel and its value if encountered
              i++;
@@ -237,6 +344,116 @@ void parse_args(int argc, char* argv[], int& iterations, int& num_players, int&
 }
 
 
+// `gto_solver merge -o OUT [--mode sum|average] [--weights w1,w2,...] [-t N] IN...`
+// Combines independently trained checkpoints (or the shards of a distributed run).
+int run_merge_command(int argc, char* argv[]) {
+    gto_solver::CheckpointMergeOptions merge_options;
+    merge_options.partitions = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::string output;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "-o" || arg == "--output") && i + 1 < argc) {
+            output = argv[++i];
+        } else if ((arg == "--mode") && i + 1 < argc) { // sum | average
+             std::string mode_arg = argv[++i];
+             if (!gto_solver::parse_merge_mode(mode_arg, merge_options.mode)) { spdlog::error("Invalid --mode value: {} (expected sum or average)", mode_arg); return 1; }
+        } else if ((arg == "--weights") && i + 1 < argc) { // One per input, comma separated
+             std::stringstream weights_stream(argv[++i]);
+             std::string weight;
+             while (std::getline(weights_stream, weight, ',')) {
+                 try { merge_options.weights.push_back(std::stod(weight)); } catch (...) { spdlog::error("Invalid weight: {}", weight); return 1; }
+             }
+        } else if ((arg == "-t" || arg == "--threads") && i + 1 < argc) { // Key ranges merged in parallel
+             try { merge_options.partitions = std::max(1, std::stoi(argv[++i])); } catch (...) { /* Ignored */ }
+        } else if (arg == "--loglevel" && i + 1 < argc) {
+             i++;
+        } else if (!arg.empty() && arg[0] == '-') {
+             spdlog::warn("Unknown or incomplete merge argument: {}", arg);
+        } else {
+             merge_options.inputs.push_back(arg);
+        }
+    }
+    if (output.empty() || merge_options.inputs.empty()) {
+        spdlog::error("Usage: gto_solver merge -o OUT [--mode sum|average] [--weights w1,w2,...] [-t N] IN...");
+        return 1;
+    }
+    return gto_solver::merge_checkpoints(merge_options, output) ? 0 : 1;
+}
+
+
+// Iterations per second of `iterations` more training iterations from a checkpoint (0 on error).
+double measure_resumed_training(const std::string& checkpoint, int iterations, int num_players, int initial_stack, int ante_size, int num_threads) {
+    std::ifstream is(checkpoint, std::ios::binary);
+    gto_solver::CheckpointHeader header;
+    if (!is || !gto_solver::read_checkpoint_header(is, header) || header.version != gto_solver::CHECKPOINT_VERSION_BIN) {
+        spdlog::warn("Benchmark: {} cannot be loaded by the engine; skipped.", checkpoint);
+        return 0.0;
+    }
+    is.close();
+    gto_solver::CFREngine engine;
+    gto_solver::TrainingOptions options;
+    options.metrics_interval_seconds = 0.0;
+    engine.train(header.completed_iterations + iterations, num_players, initial_stack, ante_size, num_threads, "", 0, checkpoint, options);
+    return engine.get_training_snapshot().iterations_per_second;
+}
+
+// `gto_solver compact -o OUT [--min-visits N] [--min-regret X] [--key-order tree|sorted]
+//                     [--bench N [-n P] [-s S] [-a A] [-t T]] IN`
+// Prunes rarely visited infosets and lays the survivors out in tree order; --bench then trains
+// N iterations from the input and from the output and compares their speed.
+int run_compact_command(int argc, char* argv[]) {
+    gto_solver::CheckpointCompactOptions compact_options;
+    std::string input, output;
+    int bench_iterations = 0, num_players = 6, initial_stack = 100, ante_size = 0, num_threads = 1;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "-o" || arg == "--output") && i + 1 < argc) {
+            output = argv[++i];
+        } else if ((arg == "--min-visits") && i + 1 < argc) {
+             try { compact_options.min_visits = std::max(0, std::stoi(argv[++i])); } catch (...) { spdlog::error("Invalid --min-visits value."); return 1; }
+        } else if ((arg == "--min-regret") && i + 1 < argc) { // Positive regret mass sum_a max(0, regret)
+             try { compact_options.min_regret_mass = std::max(0.0, std::stod(argv[++i])); } catch (...) { spdlog::error("Invalid --min-regret value."); return 1; }
+        } else if ((arg == "--key-order") && i + 1 < argc) { // tree | sorted (merge needs sorted inputs)
+             std::string order_arg = argv[++i];
+             if (!gto_solver::parse_key_order(order_arg, compact_options.key_order)) { spdlog::error("Invalid --key-order value: {} (expected tree or sorted)", order_arg); return 1; }
+        } else if ((arg == "--bench") && i + 1 < argc) {
+             try { bench_iterations = std::max(0, std::stoi(argv[++i])); } catch (...) { /* Ignored */ }
+        } else if ((arg == "-n" || arg == "--num_players") && i + 1 < argc) {
+             try { num_players = std::stoi(argv[++i]); } catch (...) { /* Ignored */ }
+        } else if ((arg == "-s" || arg == "--stack") && i + 1 < argc) {
+             try { initial_stack = std::stoi(argv[++i]); } catch (...) { /* Ignored */ }
+        } else if ((arg == "-a" || arg == "--ante") && i + 1 < argc) {
+             try { ante_size = std::stoi(argv[++i]); } catch (...) { /* Ignored */ }
+        } else if ((arg == "-t" || arg == "--threads") && i + 1 < argc) {
+             try { num_threads = std::stoi(argv[++i]); } catch (...) { /* Ignored */ }
+        } else if (arg == "--loglevel" && i + 1 < argc) {
+             i++;
+        } else if (!arg.empty() && arg[0] == '-') {
+             spdlog::warn("Unknown or incomplete compact argument: {}", arg);
+        } else if (input.empty()) {
+             input = arg;
+        } else {
+             spdlog::error("compact takes a single input checkpoint.");
+             return 1;
+        }
+    }
+    if (output.empty() || input.empty()) {
+        spdlog::error("Usage: gto_solver compact -o OUT [--min-visits N] [--min-regret X] [--key-order tree|sorted] [--bench N [-n P] [-s S] [-a A] [-t T]] IN");
+        return 1;
+    }
+    if (!gto_solver::compact_checkpoint(input, output, compact_options)) return 1;
+    if (bench_iterations > 0) {
+        double before = measure_resumed_training(input, bench_iterations, num_players, initial_stack, ante_size, num_threads);
+        double after = measure_resumed_training(output, bench_iterations, num_players, initial_stack, ante_size, num_threads);
+        if (before > 0.0 && after > 0.0) {
+            spdlog::info("Benchmark: {} iterations after loading run at {:.1f} it/s from {} and {:.1f} it/s from {} ({:+.1f}%).",
+                         bench_iterations, before, input, after, output, 100.0 * (after / before - 1.0));
+        }
+    }
+    return 0;
+}
+
+
 int main(int argc, char* argv[]) { // Modified main signature
     // --- Default Parameters ---
     int num_iterations = 10000;
@@ -248,6 +465,11 @@ int main(int argc, char* argv[]) { // Modified main signature
     int checkpoint_interval = 0; // Default: no periodic saving (only final if save_file specified)
     std::string load_file = ""; // Default: no loading
     std::string json_export_file = ""; // Default: no JSON export
+    gto_solver::TrainingOptions training_options; // Metrics interval / CSV etc. (see cfr_engine.h)
+    int local_shards = 0; // > 1: fork this many shard processes on loopback (coordinator mode)
+    int shard_base_port = 7400;
+    int shm_workers = 0; // > 1: fork this many worker processes sharing one node store
+    size_t shm_size = size_t(1) << 30;
     // Log level will be hardcoded to trace below
 
     // --- Setup Logging ---
@@ -273,10 +495,12 @@ int main(int argc, char* argv[]) { // Modified main signature
         return 1;
     }
     spdlog::info("Starting GTO Solver");
+    if (argc > 1 && std::string(argv[1]) == "merge") return run_merge_command(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "compact") return run_compact_command(argc, argv);
 
     // --- Parse All Other Arguments ---
     // This call will now ignore --loglevel and its value
-    parse_args(argc, argv, num_iterations, num_players, initial_stack, ante_size, num_threads, save_file, checkpoint_interval, load_file, json_export_file);
+    parse_args(argc, argv, num_iterations, num_players, initial_stack, ante_size, num_threads, save_file, checkpoint_interval, load_file, json_export_file, training_options, local_shards, shard_base_port, shm_workers, shm_size);
 
     // --- Log Configuration ---
     spdlog::info("Configuration - Iterations: {}, Players: {}, Stack: {}, Ante: {}, Threads: {}",
@@ -284,7 +508,125 @@ int main(int argc, char* argv[]) { // Modified main signature
     if (!load_file.empty()) spdlog::info("Load Checkpoint: {}", load_file);
     if (!save_file.empty()) spdlog::info("Save Checkpoint: {}, Interval: {} iters (0=final only)", save_file, checkpoint_interval);
     if (!json_export_file.empty()) spdlog::info("JSON Export File: {}", json_export_file); // Log JSON export file
+    spdlog::info("Metrics Interval: {}s{}", training_options.metrics_interval_seconds,
+                 training_options.metrics_csv_filename.empty() ? "" : ", CSV: " + training_options.metrics_csv_filename);
+    if (training_options.metrics_port > 0) spdlog::info("Metrics Endpoint: http://127.0.0.1:{}/metrics", training_options.metrics_port);
+    if (training_options.max_memory_bytes > 0) spdlog::info("Max Memory (node storage): {:.1f} MB", training_options.max_memory_bytes / (1024.0 * 1024.0));
+    if (!training_options.spill_filename.empty()) spdlog::info("Spill File (cold nodes): {}", training_options.spill_filename);
+    if (training_options.convergence_interval > 0) spdlog::info("Convergence Interval: {} iters, Auto-stop Threshold: {} (0=off)", training_options.convergence_interval, training_options.convergence_stop_threshold);
+
+
+    if (training_options.shard_endpoints.size() > 1) {
+        spdlog::info("Distributed Training: shard {} of {}, sync every {} ms", training_options.shard_id, training_options.shard_endpoints.size(),
+                     static_cast<int>(training_options.shard_sync_seconds * 1000));
+    }
+
+    // --- Coordinator mode: one shard process per loopback port, each training its share ---
+    if (local_shards > 1) {
+        training_options.shard_endpoints.clear();
+        for (int shard = 0; shard < local_shards; ++shard) training_options.shard_endpoints.push_back({"127.0.0.1", shard_base_port + shard});
+        std::vector<pid_t> children;
+        for (int shard = 0; shard < local_shards; ++shard) {
+            pid_t pid = fork();
+            if (pid < 0) { spdlog::error("fork() failed for shard {}.", shard); break; }
+            if (pid == 0) {
+                training_options.shard_id = shard;
+                int shard_iterations = num_iterations / local_shards + (shard < num_iterations % local_shards ? 1 : 0);
+                try {
+                    gto_solver::CFREngine shard_engine;
+                    shard_engine.train(shard_iterations, num_players, initial_stack, ante_size, num_threads, save_file, checkpoint_interval, load_file, training_options);
+                } catch (const std::exception& e) { spdlog::error("Shard {}: exception during training: {}", shard, e.what()); _exit(1); }
+                _exit(0);
+            }
+            children.push_back(pid);
+        }
+        int failed = local_shards - static_cast<int>(children.size());
+        for (size_t shard = 0; shard < children.size(); ++shard) {
+            int status = 0;
+            if (waitpid(children[shard], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                spdlog::error("Shard {} did not finish cleanly.", shard);
+                ++failed;
+            }
+        }
+        if (failed > 0) { spdlog::error("{} of {} shard processes failed.", failed, local_shards); return 1; }
+        spdlog::info("All {} shards finished{}.", local_shards, save_file.empty() ? "" : "; checkpoints: " + save_file + ".shard<k>of" + std::to_string(local_shards));
+        return 0;
+    }
 
+    // --- Shared-memory mode: worker processes train one node store; this process checkpoints it ---
+    std::string shm_checkpoint; // The workers' result, loaded below instead of training here
+    if (shm_workers > 1) {
+        if (training_options.shard_endpoints.size() > 1) { spdlog::error("--shm-workers cannot be combined with distributed training."); return 1; }
+        gto_solver::SharedNodeStore store;
+        if (!store.create("/gto_solver_" + std::to_string(getpid()), shm_size)) return 1;
+        int starting_iteration = 0;
+        if (!load_file.empty()) {
+            starting_iteration = store.load_checkpoint(load_file);
+            if (starting_iteration < 0) { spdlog::error("Failed to load checkpoint {} into the shared node store.", load_file); return 1; }
+        } else {
+            store.set_history_encoding(training_options.history_encoding);
+        }
+        int iterations_to_run = std::max(0, num_iterations - starting_iteration);
+        spdlog::info("Shared Node Store: {:.1f} MB, {} worker processes for {} iterations.", shm_size / (1024.0 * 1024.0), shm_workers, iterations_to_run);
+        gto_solver::TrainingOptions worker_options = training_options;
+        worker_options.shared_store = &store;
+        worker_options.metrics_port = 0; // One port cannot serve every worker
+        std::vector<pid_t> children;
+        for (int worker = 0; worker < shm_workers; ++worker) {
+            int worker_iterations = iterations_to_run / shm_workers + (worker < iterations_to_run % shm_workers ? 1 : 0);
+            if (worker_iterations == 0) continue;
+            pid_t pid = fork();
+            if (pid < 0) { spdlog::error("fork() failed for worker {}.", worker); break; }
+            if (pid == 0) {
+                try {
+                    gto_solver::CFREngine worker_engine;
+                    worker_engine.train(worker_iterations, num_players, initial_stack, ante_size, num_threads, "", 0, "", worker_options);
+                } catch (const std::exception& e) { spdlog::error("Worker {}: exception during training: {}", worker, e.what()); _exit(1); }
+                _exit(0); // Leaves the store to this process
+            }
+            children.push_back(pid);
+        }
+        auto save_store = [&](const std::string& filename) {
+            std::string temp_filename = filename + ".tmp";
+            if (!store.save_checkpoint(temp_filename) || std::rename(temp_filename.c_str(), filename.c_str()) != 0) {
+                spdlog::error("Failed to save the shared node store to {}.", filename);
+                return false;
+            }
+            gto_solver::SharedStoreStats stats = store.stats();
+            spdlog::info("Saved {} infosets at iteration {} to {}.", stats.entries, store.completed_iterations(), filename);
+            return true;
+        };
+        // A crashed worker only loses its unmerged deltas: the others keep training the store
+        size_t running = children.size();
+        int crashed = 0;
+        long long last_checkpoint = checkpoint_interval > 0 ? starting_iteration / checkpoint_interval : 0;
+        while (running > 0) {
+            int status = 0;
+            pid_t pid = waitpid(-1, &status, WNOHANG);
+            if (pid > 0) {
+                --running;
+                if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                    ++crashed;
+                    spdlog::error("Worker process {} did not finish cleanly; the shared node store is unaffected.", pid);
+                }
+                continue;
+            }
+            if (pid < 0) break;
+            long long completed = store.completed_iterations();
+            if (!save_file.empty() && checkpoint_interval > 0 && completed / checkpoint_interval > last_checkpoint) {
+                last_checkpoint = completed / checkpoint_interval;
+                save_store(save_file);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        gto_solver::SharedStoreStats stats = store.stats();
+        spdlog::info("Workers finished: {} iterations, {} infosets, {:.1f} of {:.1f} MB used{}.", store.completed_iterations(), stats.entries,
+                     stats.used_bytes / (1024.0 * 1024.0), stats.capacity_bytes / (1024.0 * 1024.0),
+                     crashed > 0 ? ", " + std::to_string(crashed) + " worker(s) crashed" : "");
+        if (stats.refused > 0) spdlog::warn("The shared node store was full: {} infosets stayed local to their worker (raise --shm-size).", stats.refused);
+        shm_checkpoint = save_file.empty() ? "gto_solver_shm_" + std::to_string(getpid()) + ".bin" : save_file;
+        if (!save_store(shm_checkpoint)) return 1;
+    }
 
     try { // START MAIN TRY BLOCK
         // --- Initialization ---
@@ -294,21 +636,34 @@ int main(int argc, char* argv[]) { // Modified main signature
         // ActionAbstraction is now only needed inside CFREngine
         spdlog::info("Modules initialized.");
 
+        if (training_options.convergence_interval > 0) {
+            training_options.convergence_watch_keys = build_rfi_watch_keys(num_players, initial_stack, ante_size, hand_generator);
+            spdlog::info("Convergence watch-list: {} RFI infosets.", training_options.convergence_watch_keys.size());
+        }
+
         // --- Training ---
         spdlog::info("Starting training for target {} iterations...", num_iterations);
-        cfr_engine.train(num_iterations, num_players, initial_stack, ante_size, num_threads, save_file, checkpoint_interval, load_file);
+        if (!shm_checkpoint.empty()) {
+            // The workers trained the tree; read it back for the strategy extraction
+            bool loaded = cfr_engine.load_checkpoint(shm_checkpoint) >= 0;
+            if (save_file.empty()) std::remove(shm_checkpoint.c_str());
+            if (!loaded) return 1;
+        } else {
+            cfr_engine.train(num_iterations, num_players, initial_stack, ante_size, num_threads, save_file, checkpoint_interval, load_file, training_options);
+        }
+
+        if (training_options.shard_endpoints.size() > 1) {
+            // Only this shard's infosets are complete here; the average strategy needs every shard
+            spdlog::info("Strategy extraction skipped for a distributed shard.");
+            return 0;
+        }
 
         // --- Strategy Extraction and Display ---
         spdlog::info("--- Strategy Extraction ---");
 
         // Define positions based on num_players
-        std::map<std::string, int> position_map;
-        if (num_players == 6) {
-            // Corrected 6-max positions relative to BTN=0: SB=1, BB=2, UTG=3, MP=4, CO=5
-            position_map = {{"UTG", 3}, {"MP", 4}, {"CO", 5}, {"BTN", 0}, {"SB", 1}};
-        } else if (num_players == 2) {
-             position_map = {{"SB", 0}}; // BTN=SB=0, BB=1
-        } else {
+        std::map<std::string, int> position_map = rfi_position_map(num_players);
+        if (position_map.empty()) {
              spdlog::warn("RFI extraction only implemented for 6-max and HU.");
              // Continue without extraction if not 6-max or HU
         }
@@ -356,13 +711,7 @@ int main(int argc, char* argv[]) { // Modified main signature
                 for (const std::string& hand_str_internal : all_hands_str) {
                      if (hand_str_internal.length() != 4) continue;
                     std::vector<gto_solver::Card> hand_vec = {hand_str_internal.substr(0, 2), hand_str_internal.substr(2, 2)};
-                    std::vector<gto_solver::Card> sorted_hand_for_key = hand_vec;
-                    std::sort(sorted_hand_for_key.begin(), sorted_hand_for_key.end());
-
-                    // Create the InfoSet using the constructor that takes the specific components:
-                    // Use the corrected (empty) history string.
-                    gto_solver::InfoSet infoset(sorted_hand_for_key, rfi_history, context_state, player_index);
-                    const std::string& infoset_key = infoset.get_key();
+                    const std::string infoset_key = rfi_infoset_key(hand_vec, rfi_history, context_state, player_index);
 
                     // Use the function to get strategy and actions
                     gto_solver::StrategyInfo strat_info = cfr_engine.get_strategy_info(infoset_key);
@@ -373,7 +722,7 @@ int main(int argc, char* argv[]) { // Modified main signature
                     // --- DEBUG LOGGING for specific hands ---
                     if (pos_name == "UTG" && (canonical_hand_str == "AA" || canonical_hand_str == "72o" || canonical_hand_str == "KQs")) { // Added KQs
                          // Log the key directly from the object
-                         spdlog::info("  Debug {}: Hand={}, Key={}", pos_name, canonical_hand_str, infoset.get_key()); // Use info level for visibility
+                         spdlog::info("  Debug {}: Hand={}, Key={}", pos_name, canonical_hand_str, infoset_key); // Use info level for visibility
                          if (strat_info.found) {
                               std::stringstream ss;
                               // Correctly associate strategy probabilities with action names
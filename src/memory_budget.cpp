@@ -0,0 +1,131 @@
+#include "memory_budget.h"
+#include "node.h"
+
+#include <cctype>    // For std::toupper
+#include <cmath>     // For std::isfinite
+#include <string>
+
+#include "spdlog/spdlog.h"
+
+namespace gto_solver {
+
+namespace {
+// Per-allocation bookkeeping of a typical malloc (header + rounding).
+constexpr size_t kMallocOverhead = 16;
+// libstdc++ red-black tree node header (color + parent/left/right pointers).
+constexpr size_t kTreeNodeHeader = 32;
+
+size_t heap_block(size_t bytes) {
+    return bytes == 0 ? 0 : bytes + kMallocOverhead;
+}
+
+double to_mb(size_t bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+} // anonymous namespace
+
+bool parse_memory_size(const std::string& text, size_t& bytes) {
+    if (text.empty()) return false;
+    size_t pos = 0;
+    double value = 0.0;
+    try { value = std::stod(text, &pos); } catch (...) { return false; }
+    if (!std::isfinite(value) || value < 0.0) return false;
+    double multiplier = 1.0;
+    if (pos < text.size()) {
+        switch (std::toupper(static_cast<unsigned char>(text[pos]))) {
+            case 'K': multiplier = 1024.0; break;
+            case 'M': multiplier = 1024.0 * 1024.0; break;
+            case 'G': multiplier = 1024.0 * 1024.0 * 1024.0; break;
+            case 'T': multiplier = 1024.0 * 1024.0 * 1024.0 * 1024.0; break;
+            default: return false;
+        }
+        ++pos;
+        // Accept an optional trailing 'B' ("8GB")
+        if (pos < text.size() && std::toupper(static_cast<unsigned char>(text[pos])) == 'B') ++pos;
+        if (pos != text.size()) return false;
+    }
+    bytes = static_cast<size_t>(value * multiplier);
+    return true;
+}
+
+size_t estimate_key_bytes(const std::string& key) {
+    // Short keys live in the string's inline buffer; longer ones get their own heap block.
+    return key.capacity() > 15 ? heap_block(key.capacity() + 1) : 0;
+}
+
+size_t estimate_node_bytes(size_t num_actions) {
+    size_t bytes = heap_block(kTreeNodeHeader + sizeof(std::string) + sizeof(std::unique_ptr<Node>)); // Map entry
+    bytes += heap_block(sizeof(Node));
+    if (num_actions > ActionValues::kInlineActions) bytes += 2 * heap_block(num_actions * sizeof(double)); // regret_sum + strategy_sum
+    bytes += heap_block(num_actions * sizeof(ActionSpec));
+    return bytes;
+}
+
+void MemoryBudget::start(size_t limit_bytes, size_t node_bytes, size_t key_bytes, double report_interval_seconds) {
+    limit_bytes_ = limit_bytes;
+    report_interval_seconds_ = report_interval_seconds;
+    node_bytes_ = node_bytes;
+    key_bytes_ = key_bytes;
+    exhausted_ = false;
+    uniform_fallbacks_ = 0;
+    seconds_to_limit_ = -1.0;
+    last_report_time_ = std::chrono::steady_clock::now();
+    last_report_bytes_ = node_bytes + key_bytes;
+    if (limited()) {
+        spdlog::info("Memory budget: {:.1f} MB for node storage ({:.1f} MB already used).", to_mb(limit_bytes_), to_mb(used_bytes()));
+    }
+}
+
+bool MemoryBudget::can_allocate(size_t bytes) {
+    if (!limited()) return true;
+    if (used_bytes() + bytes <= limit_bytes_) return true;
+    if (!exhausted_.exchange(true, std::memory_order_relaxed)) {
+        spdlog::warn("Memory budget of {:.1f} MB reached ({:.1f} MB used). No new nodes are created while over budget; "
+                     "unseen infosets are played uniformly instead.", to_mb(limit_bytes_), to_mb(used_bytes()));
+    }
+    return false;
+}
+
+void MemoryBudget::charge(size_t node_bytes, size_t key_bytes) {
+    node_bytes_.fetch_add(node_bytes, std::memory_order_relaxed);
+    key_bytes_.fetch_add(key_bytes, std::memory_order_relaxed);
+}
+
+void MemoryBudget::release(size_t node_bytes, size_t key_bytes) {
+    node_bytes_.fetch_sub(node_bytes, std::memory_order_relaxed);
+    key_bytes_.fetch_sub(key_bytes, std::memory_order_relaxed);
+}
+
+void MemoryBudget::maybe_report(long long total_nodes) {
+    if (report_interval_seconds_ <= 0.0) return;
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - last_report_time_).count();
+    if (elapsed < report_interval_seconds_) return;
+
+    size_t used = used_bytes();
+    double growth_per_sec = used > last_report_bytes_ ? (used - last_report_bytes_) / elapsed : 0.0;
+    double eta = -1.0;
+    if (limited() && growth_per_sec > 0.0 && used < limit_bytes_) eta = (limit_bytes_ - used) / growth_per_sec;
+    seconds_to_limit_.store(eta, std::memory_order_relaxed);
+
+    double bytes_per_node = total_nodes > 0 ? static_cast<double>(used) / total_nodes : 0.0;
+    if (limited()) {
+        spdlog::info("memory used_mb={:.1f} limit_mb={:.1f} growth_mb_per_sec={:.2f} bytes_per_node={:.0f} seconds_to_limit={:.0f}",
+                     to_mb(used), to_mb(limit_bytes_), growth_per_sec / (1024.0 * 1024.0), bytes_per_node, eta);
+    } else {
+        spdlog::info("memory used_mb={:.1f} growth_mb_per_sec={:.2f} bytes_per_node={:.0f}",
+                     to_mb(used), growth_per_sec / (1024.0 * 1024.0), bytes_per_node);
+    }
+    last_report_time_ = now;
+    last_report_bytes_ = used;
+}
+
+void MemoryBudget::log_summary(long long total_nodes) const {
+    size_t used = used_bytes();
+    double bytes_per_node = total_nodes > 0 ? static_cast<double>(used) / total_nodes : 0.0;
+    spdlog::info("Node storage: {} nodes, {:.1f} MB (nodes {:.1f} MB, keys {:.1f} MB), {:.0f} bytes/node{}",
+                 total_nodes, to_mb(used), to_mb(node_bytes()), to_mb(key_bytes()), bytes_per_node,
+                 limited() ? fmt::format(", budget {:.1f} MB, uniform fallbacks {}", to_mb(limit_bytes_), uniform_fallbacks()) : "");
+}
+
+} // namespace gto_solver
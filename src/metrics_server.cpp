@@ -0,0 +1,166 @@
+#include "metrics_server.h"
+
+#include <sstream>
+#include <string>
+#include <cerrno>
+#include <cstring>      // For std::strncmp, std::strerror
+#include <arpa/inet.h>  // For htonl, htons, ntohs
+#include <netinet/in.h> // For sockaddr_in
+#include <poll.h>       // For poll
+#include <sys/resource.h> // For setpriority
+#include <sys/socket.h>
+#include <sys/syscall.h> // For SYS_gettid
+#include <unistd.h>     // For close, syscall
+
+#include "spdlog/spdlog.h"
+
+namespace gto_solver {
+
+namespace {
+void write_metric(std::ostringstream& out, const char* name, const char* type, const char* help, double value) {
+    out << "# HELP " << name << ' ' << help << '\n';
+    out << "# TYPE " << name << ' ' << type << '\n';
+    out << name << ' ' << value << '\n';
+}
+
+bool send_all(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+} // anonymous namespace
+
+std::string format_prometheus_metrics(const TrainingSnapshot& s) {
+    std::ostringstream out;
+    out.precision(10);
+    write_metric(out, "gto_training_iterations_completed", "counter", "CFR iterations completed (including iterations restored from a checkpoint).", static_cast<double>(s.iterations_completed));
+    write_metric(out, "gto_training_iterations_target", "gauge", "Target iteration count of the current run.", static_cast<double>(s.target_iterations));
+    write_metric(out, "gto_training_iterations_per_second", "gauge", "Average iterations per second over the current run.", s.iterations_per_second);
+    write_metric(out, "gto_training_elapsed_seconds", "gauge", "Seconds since the current run started.", s.elapsed_seconds);
+    write_metric(out, "gto_training_nodes", "gauge", "Infoset nodes in the node map.", static_cast<double>(s.nodes));
+    write_metric(out, "gto_training_max_depth", "gauge", "Deepest recursion reached in the current run.", s.max_depth);
+    write_metric(out, "gto_training_threads", "gauge", "Worker threads of the current run.", s.threads);
+    write_metric(out, "gto_process_resident_memory_bytes", "gauge", "Resident set size of the solver process.", static_cast<double>(s.resident_memory_bytes));
+    write_metric(out, "gto_node_store_bytes", "gauge", "Estimated bytes used by node and key storage.", static_cast<double>(s.node_store_bytes));
+    if (s.memory_budget_bytes > 0) {
+        write_metric(out, "gto_node_store_budget_bytes", "gauge", "Node storage budget set with --max-memory.", static_cast<double>(s.memory_budget_bytes));
+    }
+    if (s.has_cold_tier) {
+        write_metric(out, "gto_cold_tier_nodes", "gauge", "Nodes currently held in the disk tier.", static_cast<double>(s.cold_nodes));
+        write_metric(out, "gto_cold_tier_evictions_total", "counter", "Nodes evicted from RAM to the disk tier.", static_cast<double>(s.cold_evicted));
+        write_metric(out, "gto_cold_tier_faults_total", "counter", "Node lookups served from the disk tier.", static_cast<double>(s.cold_faults));
+        write_metric(out, "gto_cold_tier_prefetched_total", "counter", "Nodes brought back to RAM by the prefetcher.", static_cast<double>(s.cold_prefetched));
+    }
+    write_metric(out, "gto_checkpoints_written_total", "counter", "Checkpoints written by the current run.", static_cast<double>(s.checkpoints_written));
+    write_metric(out, "gto_checkpoint_last_duration_seconds", "gauge", "Duration of the most recent checkpoint save.", s.last_checkpoint_seconds);
+    write_metric(out, "gto_checkpoint_duration_seconds_total", "counter", "Total time spent saving checkpoints.", s.total_checkpoint_seconds);
+    write_metric(out, "gto_scratch_heap_allocations_total", "counter", "Traversal-arena blocks taken from the heap after warm-up (0 in steady state).", static_cast<double>(s.scratch_heap_allocations));
+    if (s.has_trie) {
+        write_metric(out, "gto_infoset_trie_entries", "gauge", "Infosets cached in the trie by the last run that used it.", static_cast<double>(s.trie_entries));
+        write_metric(out, "gto_infoset_trie_hits_total", "counter", "Lookups of that run that followed trie pointers.", static_cast<double>(s.trie_hits));
+    }
+    if (s.has_baselines) {
+        write_metric(out, "gto_action_baseline_estimates_total", "counter", "Sampled opponent decisions passed through the action baselines by the last run that used them.", static_cast<double>(s.baseline_estimates));
+        write_metric(out, "gto_action_baseline_corrected_total", "counter", "Those estimates corrected with a learned baseline.", static_cast<double>(s.baseline_corrected));
+    }
+    if (s.has_exploitability) {
+        write_metric(out, "gto_exploitability", "gauge", "Most recent exploitability estimate.", s.exploitability);
+    }
+    if (s.has_convergence) {
+        write_metric(out, "gto_convergence_mean_positive_regret", "gauge", "Mean positive regret per infoset at the last convergence window.", s.mean_positive_regret);
+        write_metric(out, "gto_convergence_max_strategy_delta", "gauge", "Largest L1 average-strategy change over watched infosets in the last window.", s.max_strategy_delta);
+        write_metric(out, "gto_convergence_visited_fraction", "gauge", "Fraction of nodes visited during the last convergence window.", s.visited_fraction);
+    }
+    return out.str();
+}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+bool MetricsServer::start(int port, SnapshotProvider provider) {
+    if (running_.load()) return true;
+    provider_ = std::move(provider);
+
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) { spdlog::error("MetricsServer: socket() failed: {}", std::strerror(errno)); return false; }
+    int reuse = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // Localhost only, never exposed externally
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(listen_fd_, 8) < 0) {
+        spdlog::error("MetricsServer: cannot listen on 127.0.0.1:{}: {}", port, std::strerror(errno));
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    socklen_t len = sizeof(addr);
+    ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+    bound_port_ = ntohs(addr.sin_port);
+
+    running_ = true;
+    thread_ = std::thread(&MetricsServer::serve_loop, this);
+    spdlog::info("Metrics endpoint listening on http://127.0.0.1:{}/metrics", bound_port_);
+    return true;
+}
+
+void MetricsServer::stop() {
+    if (!running_.exchange(false)) return;
+    if (thread_.joinable()) thread_.join(); // serve_loop polls with a timeout and sees running_ == false
+    if (listen_fd_ >= 0) { ::close(listen_fd_); listen_fd_ = -1; }
+}
+
+void MetricsServer::serve_loop() {
+    // Lowest priority for this thread only (Linux applies nice values per thread).
+    if (::setpriority(PRIO_PROCESS, static_cast<id_t>(::syscall(SYS_gettid)), 19) != 0) {
+        spdlog::debug("MetricsServer: could not lower thread priority: {}", std::strerror(errno));
+    }
+    while (running_.load()) {
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        int ready = ::poll(&pfd, 1, 200); // Short timeout so stop() is honoured promptly
+        if (ready <= 0 || !(pfd.revents & POLLIN)) continue;
+        int client_fd = ::accept(listen_fd_, nullptr, nullptr);
+        if (client_fd < 0) continue;
+        handle_connection(client_fd);
+        ::close(client_fd);
+    }
+}
+
+void MetricsServer::handle_connection(int client_fd) {
+    // Only the request line matters; scrapers send small requests.
+    char buffer[2048];
+    pollfd pfd{client_fd, POLLIN, 0};
+    if (::poll(&pfd, 1, 1000) <= 0) return;
+    ssize_t n = ::recv(client_fd, buffer, sizeof(buffer) - 1, 0);
+    if (n <= 0) return;
+    buffer[n] = '\0';
+
+    std::string status = "200 OK";
+    std::string content_type = "text/plain; version=0.0.4; charset=utf-8";
+    std::string body;
+    if (std::strncmp(buffer, "GET /metrics", 12) == 0) {
+        body = format_prometheus_metrics(provider_());
+    } else if (std::strncmp(buffer, "GET / ", 6) == 0) {
+        body = "gto_solver metrics: see /metrics\n";
+    } else {
+        status = "404 Not Found";
+        body = "not found\n";
+    }
+
+    std::ostringstream response;
+    response << "HTTP/1.1 " << status << "\r\n"
+             << "Content-Type: " << content_type << "\r\n"
+             << "Content-Length: " << body.size() << "\r\n"
+             << "Connection: close\r\n\r\n"
+             << body;
+    send_all(client_fd, response.str());
+}
+
+} // namespace gto_solver
@@ -0,0 +1,280 @@
+#include "node_arena.h"
+
+#include <cstdlib>   // For std::abort
+#include <fstream>
+#include <new>       // For std::bad_alloc
+#include <sys/mman.h> // For mmap, madvise
+
+#include "spdlog/spdlog.h"
+
+namespace gto_solver {
+
+namespace {
+constexpr size_t kChunkBytes = 1 << 20;
+constexpr size_t kHugeChunkBytes = 2 << 20;     // One x86-64 / arm64 huge page
+constexpr size_t kHeaderBytes = 16;             // Keeps the payload 16-byte aligned
+constexpr uint32_t kHeapPool = 0xFFFFFFFFu;     // Slot came from the global heap
+
+struct SlotHeader {
+    uint32_t pool;
+    uint32_t slot_size; // Payload size (for debugging corrupted frees)
+};
+static_assert(sizeof(SlotHeader) <= kHeaderBytes, "slot header must fit in its reserved bytes");
+
+size_t round_up(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+thread_local NodePlacement tls_placement = NodePlacement::LOCAL;
+
+void* map_small_pages(size_t bytes) {
+    void* chunk = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return chunk == MAP_FAILED ? nullptr : chunk;
+}
+
+// Anonymous mapping aligned to its own size, so THP can back it with whole huge pages:
+// maps twice the size and unmaps the misaligned head and the tail.
+void* map_aligned(size_t bytes) {
+    char* raw = static_cast<char*>(map_small_pages(2 * bytes));
+    if (!raw) return nullptr;
+    char* aligned = reinterpret_cast<char*>(round_up(reinterpret_cast<uintptr_t>(raw), bytes));
+    if (aligned > raw) munmap(raw, static_cast<size_t>(aligned - raw));
+    size_t tail = static_cast<size_t>(raw + 2 * bytes - (aligned + bytes));
+    if (tail > 0) munmap(aligned + bytes, tail);
+    return aligned;
+}
+
+// Fails (ENOMEM) unless the administrator reserved hugetlbfs pages (vm.nr_hugepages).
+void* map_explicit_huge_pages(size_t bytes) {
+#ifdef MAP_HUGETLB
+    void* chunk = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    return chunk == MAP_FAILED ? nullptr : chunk;
+#else
+    (void)bytes;
+    return nullptr;
+#endif
+}
+
+bool advise_huge_pages(void* chunk, size_t bytes) {
+#ifdef MADV_HUGEPAGE
+    return madvise(chunk, bytes, MADV_HUGEPAGE) == 0;
+#else
+    (void)chunk; (void)bytes;
+    return false;
+#endif
+}
+
+// THP honours MADV_HUGEPAGE in the "always" and "madvise" modes (the bracketed entry is active).
+bool transparent_huge_pages_available() {
+    std::ifstream in("/sys/kernel/mm/transparent_hugepage/enabled");
+    std::string modes;
+    if (!std::getline(in, modes)) return false;
+    return modes.find("[always]") != std::string::npos || modes.find("[madvise]") != std::string::npos;
+}
+
+PageBacking probe_page_backing(HugePagePolicy policy) {
+    if (policy == HugePagePolicy::OFF) return PageBacking::SMALL_PAGES;
+    if (policy == HugePagePolicy::EXPLICIT) {
+        if (void* probe = map_explicit_huge_pages(kHugeChunkBytes)) {
+            munmap(probe, kHugeChunkBytes);
+            return PageBacking::EXPLICIT_HUGE;
+        }
+    }
+    return transparent_huge_pages_available() ? PageBacking::TRANSPARENT_HUGE : PageBacking::SMALL_PAGES;
+}
+} // anonymous namespace
+
+bool parse_huge_page_policy(const std::string& text, HugePagePolicy& policy) {
+    if (text == "off") policy = HugePagePolicy::OFF;
+    else if (text == "thp") policy = HugePagePolicy::TRANSPARENT;
+    else if (text == "explicit") policy = HugePagePolicy::EXPLICIT;
+    else return false;
+    return true;
+}
+
+const char* page_backing_name(PageBacking backing) {
+    switch (backing) {
+        case PageBacking::TRANSPARENT_HUGE: return "transparent huge pages (madvise)";
+        case PageBacking::EXPLICIT_HUGE: return "explicit huge pages (MAP_HUGETLB)";
+        default: return "4 KB pages";
+    }
+}
+
+// Fixed-size slot pool. The first allocation fixes the slot size (only Node uses the arena);
+// requests of another size fall back to the heap.
+struct NodeArena::Pool {
+    std::string name;
+    uint32_t index = 0;          // Position in NodeArena::pools_ (recorded in slot headers)
+    int numa_node_id = -1;       // -1 for the interleaved pool
+    const NumaTopology* topology = nullptr;
+    std::mutex mutex;
+    size_t payload_size = 0;
+    char* bump = nullptr;        // Next never-used slot in the current chunk
+    char* bump_end = nullptr;
+    void* free_list = nullptr;   // Freed payloads, linked through their first word
+    long long live_slots = 0;
+    long long chunks = 0;
+    long long huge_chunks = 0;
+    size_t chunk_bytes = 0;      // Size of the latest chunk
+    bool bound = false;
+
+    bool new_chunk(PageBacking backing) {
+        size_t bytes = backing == PageBacking::SMALL_PAGES ? kChunkBytes : kHugeChunkBytes;
+        void* chunk = backing == PageBacking::EXPLICIT_HUGE ? map_explicit_huge_pages(bytes) : nullptr;
+        bool huge = chunk != nullptr;
+        if (!chunk) { // Reserved pool exhausted (or never asked for): fall back to THP, then to 4 KB pages
+            chunk = backing == PageBacking::SMALL_PAGES ? map_small_pages(bytes) : map_aligned(bytes);
+            if (!chunk) return false;
+            huge = backing != PageBacking::SMALL_PAGES && advise_huge_pages(chunk, bytes);
+        }
+        // Set the policy before the first touch so the kernel places the pages accordingly
+        bool ok = numa_node_id >= 0 ? bind_memory_preferred(chunk, bytes, numa_node_id)
+                                    : bind_memory_interleaved(chunk, bytes, *topology);
+        if (chunks == 0) {
+            bound = ok;
+            if (!ok) spdlog::debug("NodeArena: mbind unavailable for pool {}; using first-touch placement.", name);
+        }
+        bump = static_cast<char*>(chunk);
+        bump_end = bump + bytes;
+        chunk_bytes = bytes;
+        ++chunks;
+        if (huge) ++huge_chunks;
+        return true;
+    }
+};
+
+NodeArena& NodeArena::instance() {
+    static NodeArena* arena = new NodeArena(); // Leaked on purpose (see class comment)
+    return *arena;
+}
+
+PageBacking NodeArena::configure(const NumaTopology& topology, bool enabled, HugePagePolicy huge_pages) {
+    std::lock_guard<std::mutex> lock(config_mutex_);
+    if (!enabled) {
+        enabled_.store(false, std::memory_order_release);
+        return PageBacking::SMALL_PAGES;
+    }
+    PageBacking backing = probe_page_backing(huge_pages);
+    if (huge_pages == HugePagePolicy::EXPLICIT && backing != PageBacking::EXPLICIT_HUGE) {
+        spdlog::warn("NodeArena: no reserved huge pages for MAP_HUGETLB (see vm.nr_hugepages); falling back to {}.", page_backing_name(backing));
+    } else if (huge_pages == HugePagePolicy::TRANSPARENT && backing != PageBacking::TRANSPARENT_HUGE) {
+        spdlog::warn("NodeArena: transparent huge pages are disabled; falling back to {}.", page_backing_name(backing));
+    }
+    page_backing_.store(backing, std::memory_order_release);
+    topology_ = topology;
+    for (auto& entry : pool_of_node_id_) entry.store(-1, std::memory_order_relaxed);
+    int next_index = 0;
+    for (const auto& node : topology_.nodes) {
+        if (next_index >= kInterleavedPool || node.id < 0 || node.id >= kInterleavedPool) continue;
+        Pool* pool = get_or_create_pool(next_index);
+        {
+            std::lock_guard<std::mutex> pool_lock(pool->mutex);
+            pool->name = "node" + std::to_string(node.id);
+            pool->numa_node_id = node.id;
+            pool->topology = &topology_;
+        }
+        pool_of_node_id_[node.id].store(next_index, std::memory_order_relaxed);
+        ++next_index;
+    }
+    multi_node_.store(next_index > 1, std::memory_order_relaxed);
+    // The interleaved pool always sits in the last slot so its index survives reconfiguration
+    Pool* interleaved = get_or_create_pool(kInterleavedPool);
+    {
+        std::lock_guard<std::mutex> pool_lock(interleaved->mutex);
+        interleaved->name = "interleaved";
+        interleaved->topology = &topology_;
+    }
+    enabled_.store(true, std::memory_order_release);
+    return backing;
+}
+
+NodeArena::Pool* NodeArena::get_or_create_pool(int index) {
+    Pool* pool = pools_[index].load(std::memory_order_acquire);
+    if (!pool) {
+        pool = new Pool();
+        pool->index = static_cast<uint32_t>(index);
+        pool->topology = &topology_;
+        pools_[index].store(pool, std::memory_order_release);
+    }
+    return pool;
+}
+
+NodeArena::Pool* NodeArena::pool_for_current_thread() {
+    // On a single node there is nothing to interleave or choose between
+    if (!multi_node_.load(std::memory_order_relaxed)) return pools_[0].load(std::memory_order_acquire);
+    if (tls_placement == NodePlacement::INTERLEAVED) return pools_[kInterleavedPool].load(std::memory_order_acquire);
+    int node_id = current_numa_node();
+    int index = (node_id >= 0 && node_id < kInterleavedPool) ? pool_of_node_id_[node_id].load(std::memory_order_relaxed) : -1;
+    return pools_[index >= 0 ? index : 0].load(std::memory_order_acquire);
+}
+
+void* NodeArena::allocate(size_t size) {
+    if (enabled()) {
+        Pool* pool = pool_for_current_thread();
+        if (pool) {
+            std::lock_guard<std::mutex> lock(pool->mutex);
+            if (pool->payload_size == 0) pool->payload_size = round_up(size, kHeaderBytes);
+            if (size <= pool->payload_size) {
+                char* slot = nullptr;
+                if (pool->free_list) {
+                    char* payload = static_cast<char*>(pool->free_list);
+                    pool->free_list = *reinterpret_cast<void**>(payload);
+                    slot = payload - kHeaderBytes;
+                } else {
+                    size_t slot_bytes = kHeaderBytes + pool->payload_size;
+                    if (pool->bump + slot_bytes > pool->bump_end && !pool->new_chunk(page_backing())) throw std::bad_alloc();
+                    slot = pool->bump;
+                    pool->bump += slot_bytes;
+                }
+                SlotHeader* header = reinterpret_cast<SlotHeader*>(slot);
+                header->pool = pool->index;
+                header->slot_size = static_cast<uint32_t>(pool->payload_size);
+                ++pool->live_slots;
+                return slot + kHeaderBytes;
+            }
+        }
+    }
+    char* slot = static_cast<char*>(::operator new(kHeaderBytes + size));
+    SlotHeader* header = reinterpret_cast<SlotHeader*>(slot);
+    header->pool = kHeapPool;
+    header->slot_size = static_cast<uint32_t>(size);
+    return slot + kHeaderBytes;
+}
+
+void NodeArena::deallocate(void* ptr) noexcept {
+    if (!ptr) return;
+    char* slot = static_cast<char*>(ptr) - kHeaderBytes;
+    const SlotHeader* header = reinterpret_cast<const SlotHeader*>(slot);
+    if (header->pool == kHeapPool) {
+        ::operator delete(slot);
+        return;
+    }
+    if (header->pool >= kMaxPools) std::abort(); // Corrupted header: never hand it to a free list
+    Pool* pool = instance().pools_[header->pool].load(std::memory_order_acquire);
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    *reinterpret_cast<void**>(ptr) = pool->free_list;
+    pool->free_list = ptr;
+    --pool->live_slots;
+}
+
+void NodeArena::set_thread_placement(NodePlacement placement) {
+    tls_placement = placement;
+}
+
+NodePlacement NodeArena::thread_placement() {
+    return tls_placement;
+}
+
+std::vector<NodeArenaPoolStats> NodeArena::stats() const {
+    std::vector<NodeArenaPoolStats> out;
+    for (size_t i = 0; i < kMaxPools; ++i) {
+        Pool* pool = pools_[i].load(std::memory_order_acquire);
+        if (!pool) continue;
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        if (pool->chunks == 0) continue;
+        out.push_back(NodeArenaPoolStats{pool->name, pool->live_slots, pool->chunks, pool->huge_chunks, pool->chunk_bytes, pool->bound});
+    }
+    return out;
+}
+
+} // namespace gto_solver
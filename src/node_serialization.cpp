@@ -0,0 +1,153 @@
+#include "node_serialization.h"
+
+#include <vector>
+
+#include "spdlog/spdlog.h"
+
+namespace gto_solver {
+
+bool write_node_record(std::ostream& os, const std::string& key, const Node& node) {
+    size_t actions_count = node.legal_actions.size();
+    if (node.regret_sum.size() != actions_count) { spdlog::error("Regret size mismatch for key '{}'", key); return false; }
+    if (node.strategy_sum.size() != actions_count) { spdlog::error("Strategy size mismatch for key '{}'", key); return false; }
+    return write_node_record(os, key, node.legal_actions, node.regret_sum.data(), node.strategy_sum.data(), node.visit_count.load());
+}
+
+bool write_node_record(std::ostream& os, const std::string& key, const std::vector<ActionSpec>& legal_actions,
+                       const double* regret_sum, const double* strategy_sum, int visit_count) {
+    // Write key
+    size_t key_len = key.length();
+    os.write(reinterpret_cast<const char*>(&key_len), sizeof(key_len)); if (!os) return false;
+    os.write(key.c_str(), key_len); if (!os) return false;
+
+    // Write legal actions (ActionSpec)
+    size_t actions_count = legal_actions.size();
+    os.write(reinterpret_cast<const char*>(&actions_count), sizeof(actions_count)); if (!os) return false;
+    for (const auto& action_spec : legal_actions) {
+        // Serialize ActionSpec: type, value, unit, compact-history tag
+        ActionType type = action_spec.type;
+        double value = action_spec.value;
+        SizingUnit unit = action_spec.unit;
+        os.write(reinterpret_cast<const char*>(&type), sizeof(type)); if (!os) return false;
+        os.write(reinterpret_cast<const char*>(&value), sizeof(value)); if (!os) return false;
+        os.write(reinterpret_cast<const char*>(&unit), sizeof(unit)); if (!os) return false;
+        os.write(reinterpret_cast<const char*>(&action_spec.action_set), sizeof(action_spec.action_set)); if (!os) return false;
+        os.write(reinterpret_cast<const char*>(&action_spec.abstract_action), sizeof(action_spec.abstract_action)); if (!os) return false;
+    }
+
+    // Write regret_sum, then strategy_sum
+    os.write(reinterpret_cast<const char*>(regret_sum), actions_count * sizeof(double)); if (!os) return false;
+    os.write(reinterpret_cast<const char*>(strategy_sum), actions_count * sizeof(double)); if (!os) return false;
+
+    // Write visit_count
+    os.write(reinterpret_cast<const char*>(&visit_count), sizeof(visit_count)); if (!os) return false;
+    return true;
+}
+
+bool write_checkpoint_header(std::ostream& os, const CheckpointHeader& header) {
+    uint32_t version = CHECKPOINT_VERSION_BIN;
+    uint32_t shard[2] = {header.shard_id, header.num_shards};
+    os.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    os.write(reinterpret_cast<const char*>(&header.history_encoding), sizeof(header.history_encoding));
+    os.write(reinterpret_cast<const char*>(shard), sizeof(shard));
+    os.write(reinterpret_cast<const char*>(&header.key_order), sizeof(header.key_order));
+    os.write(reinterpret_cast<const char*>(&header.completed_iterations), sizeof(header.completed_iterations));
+    os.write(reinterpret_cast<const char*>(&header.map_size), sizeof(header.map_size));
+    return static_cast<bool>(os);
+}
+
+bool read_checkpoint_header(std::istream& is, CheckpointHeader& header) {
+    header = CheckpointHeader();
+    is.read(reinterpret_cast<char*>(&header.version), sizeof(header.version));
+    if (!is || header.version < CHECKPOINT_VERSION_OLDEST || header.version > CHECKPOINT_VERSION_BIN) {
+        spdlog::error("Unsupported checkpoint version {} (readable: {} to {}).", header.version, CHECKPOINT_VERSION_OLDEST, CHECKPOINT_VERSION_BIN);
+        return false;
+    }
+    if (header.version >= 5) {
+        is.read(reinterpret_cast<char*>(&header.history_encoding), sizeof(header.history_encoding));
+        if (!is || (header.history_encoding != HistoryEncoding::CHIPS && header.history_encoding != HistoryEncoding::ACTIONS)) { spdlog::error("Invalid history encoding in checkpoint."); return false; }
+    }
+    if (header.version >= 6) {
+        uint32_t shard[2];
+        is.read(reinterpret_cast<char*>(shard), sizeof(shard));
+        if (!is || shard[1] == 0 || shard[0] >= shard[1]) { spdlog::error("Invalid shard header in checkpoint."); return false; }
+        header.shard_id = shard[0];
+        header.num_shards = shard[1];
+    }
+    if (header.version >= 7) {
+        is.read(reinterpret_cast<char*>(&header.key_order), sizeof(header.key_order));
+        if (!is || (header.key_order != CheckpointKeyOrder::SORTED && header.key_order != CheckpointKeyOrder::TREE)) { spdlog::error("Invalid key order in checkpoint."); return false; }
+    }
+    is.read(reinterpret_cast<char*>(&header.completed_iterations), sizeof(header.completed_iterations));
+    if (!is || header.completed_iterations < 0) { spdlog::error("Invalid iteration count in checkpoint."); return false; }
+    is.read(reinterpret_cast<char*>(&header.map_size), sizeof(header.map_size));
+    if (!is) { spdlog::error("Failed to read map size."); return false; }
+    return true;
+}
+
+namespace {
+// Bytes of one serialized ActionSpec in a record of the given checkpoint version
+size_t action_record_bytes(uint32_t version) {
+    size_t bytes = sizeof(ActionType) + sizeof(double) + sizeof(SizingUnit);
+    if (version >= 5) bytes += sizeof(ActionSetId) + sizeof(AbstractAction);
+    return bytes;
+}
+} // anonymous namespace
+
+bool skip_node_record(std::istream& is, std::string& key, uint32_t version, size_t* record_bytes) {
+    size_t key_len;
+    is.read(reinterpret_cast<char*>(&key_len), sizeof(key_len)); if (!is) return false;
+    key.assign(key_len, '\0');
+    is.read(&key[0], key_len); if (!is) return false;
+    size_t actions_count;
+    is.read(reinterpret_cast<char*>(&actions_count), sizeof(actions_count)); if (!is) return false;
+    size_t body = actions_count * (action_record_bytes(version) + 2 * sizeof(double)) + sizeof(int);
+    is.ignore(static_cast<std::streamsize>(body));
+    if (!is || static_cast<size_t>(is.gcount()) != body) return false;
+    if (record_bytes) *record_bytes = 2 * sizeof(size_t) + key_len + body;
+    return true;
+}
+
+bool read_node_record(std::istream& is, std::string& key, std::unique_ptr<Node>& node, uint32_t version) {
+    // Read key
+    size_t key_len;
+    is.read(reinterpret_cast<char*>(&key_len), sizeof(key_len)); if (!is) { spdlog::error("Failed reading key length"); return false; }
+    key.assign(key_len, '\0');
+    is.read(&key[0], key_len); if (!is) { spdlog::error("Failed reading key data"); return false; }
+
+    // Read legal actions (ActionSpec)
+    size_t actions_count;
+    is.read(reinterpret_cast<char*>(&actions_count), sizeof(actions_count)); if (!is) { spdlog::error("Failed reading actions count for key '{}'", key); return false; }
+    std::vector<ActionSpec> legal_actions;
+    legal_actions.reserve(actions_count);
+    for (size_t j = 0; j < actions_count; ++j) {
+        ActionSpec spec;
+        is.read(reinterpret_cast<char*>(&spec.type), sizeof(spec.type));     if (!is) { spdlog::error("Failed reading action type for key '{}', action {}", key, j); return false; }
+        is.read(reinterpret_cast<char*>(&spec.value), sizeof(spec.value));   if (!is) { spdlog::error("Failed reading action value for key '{}', action {}", key, j); return false; }
+        is.read(reinterpret_cast<char*>(&spec.unit), sizeof(spec.unit));     if (!is) { spdlog::error("Failed reading action unit for key '{}', action {}", key, j); return false; }
+        if (version >= 5) { // v4 records predate the compact-history tags (left UNTAGGED)
+            is.read(reinterpret_cast<char*>(&spec.action_set), sizeof(spec.action_set)); if (!is) { spdlog::error("Failed reading action set for key '{}', action {}", key, j); return false; }
+            is.read(reinterpret_cast<char*>(&spec.abstract_action), sizeof(spec.abstract_action)); if (!is) { spdlog::error("Failed reading abstract action for key '{}', action {}", key, j); return false; }
+        }
+        legal_actions.push_back(spec);
+    }
+
+    // Create Node using loaded actions
+    node = std::make_unique<Node>(legal_actions);
+
+    // Read regret_sum data
+    if (node->regret_sum.size() != actions_count) { spdlog::error("Loaded regret size mismatch for key '{}'", key); return false; }
+    is.read(reinterpret_cast<char*>(node->regret_sum.data()), actions_count * sizeof(double)); if (!is) { spdlog::error("Failed reading regret_sum for key '{}'", key); return false; }
+
+    // Read strategy_sum data
+    if (node->strategy_sum.size() != actions_count) { spdlog::error("Loaded strategy size mismatch for key '{}'", key); return false; }
+    is.read(reinterpret_cast<char*>(node->strategy_sum.data()), actions_count * sizeof(double)); if (!is) { spdlog::error("Failed reading strategy_sum for key '{}'", key); return false; }
+
+    // Read visit_count
+    int visits;
+    is.read(reinterpret_cast<char*>(&visits), sizeof(visits)); if (!is) { spdlog::error("Failed reading visit_count for key '{}'", key); return false; }
+    node->visit_count.store(visits, std::memory_order_relaxed);
+    return true;
+}
+
+} // namespace gto_solver
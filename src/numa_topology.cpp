@@ -0,0 +1,231 @@
+#include "numa_topology.h"
+
+#include <algorithm> // For std::sort, std::unique
+#include <cerrno>
+#include <cstring>   // For std::strerror
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <pthread.h> // For pthread_setaffinity_np
+#include <sched.h>   // For sched_getaffinity, cpu_set_t
+#include <sys/syscall.h>
+#include <unistd.h>  // For syscall
+
+#include "spdlog/spdlog.h"
+
+namespace gto_solver {
+
+namespace {
+const char* kNodeSysfsDir = "/sys/devices/system/node";
+
+// Memory policy modes from <linux/mempolicy.h> (not always installed, and libnuma is not used).
+constexpr int kMpolPreferred = 1;
+constexpr int kMpolInterleave = 3;
+constexpr int kMaxMaskNodes = 64; // Node masks below are a single unsigned long
+
+std::vector<int> allowed_cpus() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+bool mbind_range(void* addr, size_t length, int mode, unsigned long mask) {
+#ifdef SYS_mbind
+    if (mask == 0) return false;
+    long rc = syscall(SYS_mbind, addr, length, mode, &mask, static_cast<unsigned long>(kMaxMaskNodes + 1), 0u);
+    return rc == 0;
+#else
+    (void)addr; (void)length; (void)mode; (void)mask;
+    return false;
+#endif
+}
+} // anonymous namespace
+
+bool parse_cpulist(const std::string& text, std::vector<int>& cpus) {
+    cpus.clear();
+    std::stringstream ss(text);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        // sysfs files end in a newline; tolerate surrounding whitespace
+        range.erase(0, range.find_first_not_of(" \t\n"));
+        range.erase(range.find_last_not_of(" \t\n") + 1);
+        if (range.empty()) continue;
+        size_t dash = range.find('-');
+        try {
+            size_t pos = 0;
+            int first = std::stoi(range.substr(0, dash), &pos);
+            if (pos != (dash == std::string::npos ? range.size() : dash) || first < 0) return false;
+            int last = first;
+            if (dash != std::string::npos) {
+                std::string tail = range.substr(dash + 1);
+                last = std::stoi(tail, &pos);
+                if (pos != tail.size() || last < first) return false;
+            }
+            for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+        } catch (...) {
+            return false;
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return true;
+}
+
+std::string format_cpulist(const std::vector<int>& cpus) {
+    std::string out;
+    for (size_t i = 0; i < cpus.size();) {
+        size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) ++j;
+        if (!out.empty()) out += ',';
+        out += std::to_string(cpus[i]);
+        if (j > i) out += '-' + std::to_string(cpus[j]);
+        i = j + 1;
+    }
+    return out;
+}
+
+NumaTopology NumaTopology::detect() {
+    NumaTopology topology;
+    std::vector<int> allowed = allowed_cpus();
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(kNodeSysfsDir, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("node", 0) != 0 || name.size() == 4) continue;
+        int id = 0;
+        try { size_t pos = 0; id = std::stoi(name.substr(4), &pos); if (pos != name.size() - 4) continue; } catch (...) { continue; }
+        std::ifstream file(entry.path() / "cpulist");
+        std::string text;
+        std::vector<int> cpus;
+        if (!file || !std::getline(file, text) || !parse_cpulist(text, cpus)) continue;
+        NumaNode node;
+        node.id = id;
+        for (int cpu : cpus) {
+            if (allowed.empty() || std::binary_search(allowed.begin(), allowed.end(), cpu)) node.cpus.push_back(cpu);
+        }
+        if (!node.cpus.empty()) topology.nodes.push_back(std::move(node)); // Memory-only nodes cannot host threads
+    }
+    std::sort(topology.nodes.begin(), topology.nodes.end(), [](const NumaNode& a, const NumaNode& b) { return a.id < b.id; });
+    if (topology.nodes.empty()) {
+        NumaNode node;
+        node.cpus = allowed;
+        if (node.cpus.empty()) node.cpus.push_back(0);
+        topology.nodes.push_back(std::move(node));
+    }
+    return topology;
+}
+
+size_t NumaTopology::num_cpus() const {
+    size_t count = 0;
+    for (const auto& node : nodes) count += node.cpus.size();
+    return count;
+}
+
+int NumaTopology::node_index_of_cpu(int cpu) const {
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (std::binary_search(nodes[i].cpus.begin(), nodes[i].cpus.end(), cpu)) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+std::string NumaTopology::describe() const {
+    std::string out = std::to_string(nodes.size()) + (nodes.size() == 1 ? " NUMA node:" : " NUMA nodes:");
+    for (const auto& node : nodes) out += " node" + std::to_string(node.id) + " [" + format_cpulist(node.cpus) + "]";
+    return out;
+}
+
+bool parse_thread_placement(const std::string& text, ThreadPlacement& placement) {
+    if (text == "none") placement = ThreadPlacement::NONE;
+    else if (text == "compact") placement = ThreadPlacement::COMPACT;
+    else if (text == "spread") placement = ThreadPlacement::SPREAD;
+    else return false;
+    return true;
+}
+
+const char* thread_placement_name(ThreadPlacement placement) {
+    switch (placement) {
+        case ThreadPlacement::COMPACT: return "compact";
+        case ThreadPlacement::SPREAD: return "spread";
+        default: return "none";
+    }
+}
+
+std::vector<int> plan_thread_cpus(const NumaTopology& topology, ThreadPlacement placement, size_t num_threads) {
+    std::vector<int> plan;
+    if (placement == ThreadPlacement::NONE || topology.num_cpus() == 0) return plan;
+    std::vector<int> order; // CPUs in the order threads should take them
+    if (placement == ThreadPlacement::COMPACT) {
+        for (const auto& node : topology.nodes) order.insert(order.end(), node.cpus.begin(), node.cpus.end());
+    } else {
+        for (size_t slot = 0; order.size() < topology.num_cpus(); ++slot) {
+            for (const auto& node : topology.nodes) {
+                if (slot < node.cpus.size()) order.push_back(node.cpus[slot]);
+            }
+        }
+    }
+    for (size_t t = 0; t < num_threads; ++t) plan.push_back(order[t % order.size()]);
+    return plan;
+}
+
+bool pin_current_thread(int cpu) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0) {
+        spdlog::warn("Could not pin thread to CPU {}: {}", cpu, std::strerror(rc));
+        return false;
+    }
+    return true;
+}
+
+int current_numa_node() {
+#ifdef SYS_getcpu
+    unsigned cpu = 0, node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) return static_cast<int>(node);
+#endif
+    return 0;
+}
+
+bool bind_memory_preferred(void* addr, size_t length, int numa_node_id) {
+    if (numa_node_id < 0 || numa_node_id >= kMaxMaskNodes) return false;
+    return mbind_range(addr, length, kMpolPreferred, 1UL << numa_node_id);
+}
+
+bool bind_memory_interleaved(void* addr, size_t length, const NumaTopology& topology) {
+    unsigned long mask = 0;
+    for (const auto& node : topology.nodes) {
+        if (node.id >= 0 && node.id < kMaxMaskNodes) mask |= 1UL << node.id;
+    }
+    return mbind_range(addr, length, kMpolInterleave, mask);
+}
+
+bool read_numastat(NumaStat& stat) {
+    stat = NumaStat();
+    bool found = false;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(kNodeSysfsDir, ec)) {
+        std::ifstream file(entry.path() / "numastat");
+        if (!file) continue;
+        found = true;
+        std::string name;
+        long long value = 0;
+        while (file >> name >> value) {
+            if (name == "numa_hit") stat.numa_hit += value;
+            else if (name == "numa_miss") stat.numa_miss += value;
+            else if (name == "numa_foreign") stat.numa_foreign += value;
+            else if (name == "interleave_hit") stat.interleave_hit += value;
+            else if (name == "local_node") stat.local_node += value;
+            else if (name == "other_node") stat.other_node += value;
+        }
+    }
+    return found;
+}
+
+} // namespace gto_solver
@@ -0,0 +1,71 @@
+#include "pot_layers.h"
+
+#include <bit> // For std::popcount, std::countr_zero
+
+namespace gto_solver {
+
+PotLayers PotLayers::from_state(const GameState& state) {
+    std::array<int, GameState::kMaxPlayers> contributions;
+    uint16_t in_hand = 0;
+    int num_players = state.get_num_players();
+    for (int i = 0; i < num_players; ++i) {
+        contributions[i] = state.get_player_contribution(i);
+        if (!state.has_player_folded(i)) in_hand |= static_cast<uint16_t>(1u << i);
+    }
+    return from_contributions(contributions.data(), in_hand, num_players);
+}
+
+PotLayers PotLayers::from_contributions(const int* contributions, uint16_t in_hand, int num_players) {
+    PotLayers pots;
+    pots.num_players = num_players;
+    pots.in_hand = in_hand;
+    std::array<double, GameState::kMaxPlayers> levels;
+    int num_levels = 0;
+    for (int i = 0; i < num_players; ++i) {
+        double contribution = static_cast<double>(contributions[i]);
+        pots.contributions[i] = contribution;
+        pots.total_pot += contribution;
+        if (!(in_hand & (1u << i))) continue;
+        // Insertion sort: at most 16 levels
+        int slot = num_levels++;
+        for (; slot > 0 && levels[slot - 1] > contribution; --slot) levels[slot] = levels[slot - 1];
+        levels[slot] = contribution;
+    }
+    double previous_level = 0.0;
+    for (int l = 0; l < num_levels; ++l) {
+        double level = levels[l];
+        if (level <= previous_level) continue; // Same level as the layer below (or nothing contributed)
+        uint16_t eligible = 0;
+        for (uint16_t remaining = in_hand; remaining != 0; remaining &= remaining - 1) {
+            int player = std::countr_zero(remaining);
+            if (pots.contributions[player] >= level) eligible |= static_cast<uint16_t>(1u << player);
+        }
+        pots.layers[pots.num_layers++] = Layer{(level - previous_level) * std::popcount(eligible), eligible};
+        previous_level = level;
+    }
+    return pots;
+}
+
+void resolve_pot_payoffs(const PotLayers& pots, const int* ranks, double* payoffs) {
+    std::array<double, GameState::kMaxPlayers> winnings{};
+    if (std::popcount(pots.in_hand) == 1) {
+        winnings[std::countr_zero(pots.in_hand)] = pots.total_pot;
+    } else {
+        for (int l = 0; l < pots.num_layers; ++l) {
+            const PotLayers::Layer& layer = pots.layers[l];
+            int best_rank = kUnrankedHand;
+            uint16_t winners = 0;
+            for (uint16_t eligible = layer.eligible; eligible != 0; eligible &= eligible - 1) {
+                int player = std::countr_zero(eligible);
+                if (ranks[player] < best_rank) { best_rank = ranks[player]; winners = 0; }
+                if (ranks[player] == best_rank) winners |= static_cast<uint16_t>(1u << player);
+            }
+            if (winners == 0) continue;
+            double share = layer.amount / std::popcount(winners);
+            for (; winners != 0; winners &= winners - 1) winnings[std::countr_zero(winners)] += share;
+        }
+    }
+    for (int i = 0; i < pots.num_players; ++i) payoffs[i] = winnings[i] - pots.contributions[i];
+}
+
+} // namespace gto_solver
@@ -0,0 +1,336 @@
+#include "regret_kernels.h"
+
+#include <algorithm> // For std::max
+#include <array>
+#include <atomic>
+#include <cmath>     // For std::isfinite
+#include <utility>   // For std::index_sequence
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define GTO_SOLVER_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace gto_solver {
+
+namespace {
+
+struct KernelTable {
+    void (*regret_matching)(const double*, double*, size_t);
+    double (*accumulate_regrets)(double*, const double*, double, double, size_t, bool);
+    void (*accumulate_strategy)(double*, const double*, double, size_t);
+    // Nodes with fewer actions use `narrow` instead: a wide register set only pays for its
+    // setup (and AVX state transitions) once there are a couple of full vectors of work.
+    size_t min_actions;
+    const KernelTable* narrow;
+};
+
+// --- Scalar (reference) ---
+
+void fill_uniform(double* strategy, size_t n) {
+    const double uniform = n > 0 ? 1.0 / n : 0.0;
+    for (size_t i = 0; i < n; ++i) strategy[i] = uniform;
+}
+
+void regret_matching_scalar(const double* regrets, double* strategy, size_t n) {
+    double positive_sum = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        strategy[i] = std::max(0.0, regrets[i]);
+        positive_sum += strategy[i];
+    }
+    if (!(positive_sum > 0.0) || !std::isfinite(positive_sum)) { fill_uniform(strategy, n); return; }
+    const double scale = 1.0 / positive_sum;
+    for (size_t i = 0; i < n; ++i) strategy[i] *= scale;
+}
+
+double accumulate_regrets_scalar(double* regret_sum, const double* action_utilities, double node_utility,
+                                 double weight, size_t n, bool floor_at_zero) {
+    double positive_delta = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        double before = regret_sum[i];
+        double after = before + weight * (action_utilities[i] - node_utility);
+        if (floor_at_zero) after = std::max(0.0, after);
+        regret_sum[i] = after;
+        positive_delta += std::max(0.0, after) - std::max(0.0, before);
+    }
+    return positive_delta;
+}
+
+void accumulate_strategy_scalar(double* strategy_sum, const double* strategy, double weight, size_t n) {
+    for (size_t i = 0; i < n; ++i) strategy_sum[i] += weight * strategy[i];
+}
+
+// --- Fixed width (n = N known at compile time) ---
+// Same per-action operations as the scalar kernels, so strategies and sums match them exactly;
+// only the loop bounds are constants. The regret delta is summed in two interleaved halves
+// (like the SSE2 kernel), which lets the compiler pair the actions up.
+
+template <size_t N>
+void regret_matching_fixed(const double* regrets, double* strategy, size_t) {
+    double positive_sum = 0.0;
+    for (size_t i = 0; i < N; ++i) {
+        strategy[i] = std::max(0.0, regrets[i]);
+        positive_sum += strategy[i];
+    }
+    if (!(positive_sum > 0.0) || !std::isfinite(positive_sum)) {
+        for (size_t i = 0; i < N; ++i) strategy[i] = 1.0 / N;
+        return;
+    }
+    const double scale = 1.0 / positive_sum;
+    for (size_t i = 0; i < N; ++i) strategy[i] *= scale;
+}
+
+template <size_t N>
+double accumulate_regrets_fixed(double* regret_sum, const double* action_utilities, double node_utility,
+                                double weight, size_t, bool floor_at_zero) {
+    double delta[2] = {0.0, 0.0}; // Even and odd actions, so the pairs can share a register
+    for (size_t i = 0; i < N; ++i) {
+        double before = regret_sum[i];
+        double after = before + weight * (action_utilities[i] - node_utility);
+        if (floor_at_zero) after = std::max(0.0, after);
+        regret_sum[i] = after;
+        delta[i % 2] += std::max(0.0, after) - std::max(0.0, before);
+    }
+    return delta[0] + delta[1];
+}
+
+template <size_t N>
+void accumulate_strategy_fixed(double* strategy_sum, const double* strategy, double weight, size_t) {
+    for (size_t i = 0; i < N; ++i) strategy_sum[i] += weight * strategy[i];
+}
+
+template <size_t... N>
+constexpr std::array<KernelTable, sizeof...(N)> make_fixed_kernels(std::index_sequence<N...>) {
+    return {KernelTable{regret_matching_fixed<N>, accumulate_regrets_fixed<N>, accumulate_strategy_fixed<N>, 0, nullptr}...};
+}
+
+// Entry n handles nodes of exactly n actions (entry 0 is the empty no-op)
+constexpr std::array<KernelTable, kMaxFixedKernelActions + 1> kFixedKernels =
+    make_fixed_kernels(std::make_index_sequence<kMaxFixedKernelActions + 1>{});
+
+#ifdef GTO_SOLVER_X86_KERNELS
+
+// --- SSE2 (2 doubles per lane) ---
+
+__attribute__((target("sse2")))
+double horizontal_sum_sse2(__m128d v) {
+    return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+__attribute__((target("sse2")))
+void regret_matching_sse2(const double* regrets, double* strategy, size_t n) {
+    const __m128d zero = _mm_setzero_pd();
+    __m128d sum = zero;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d positive = _mm_max_pd(_mm_loadu_pd(regrets + i), zero);
+        _mm_storeu_pd(strategy + i, positive);
+        sum = _mm_add_pd(sum, positive);
+    }
+    double positive_sum = horizontal_sum_sse2(sum);
+    for (; i < n; ++i) { strategy[i] = std::max(0.0, regrets[i]); positive_sum += strategy[i]; }
+    if (!(positive_sum > 0.0) || !std::isfinite(positive_sum)) { fill_uniform(strategy, n); return; }
+    const __m128d scale = _mm_set1_pd(1.0 / positive_sum);
+    for (i = 0; i + 2 <= n; i += 2) _mm_storeu_pd(strategy + i, _mm_mul_pd(_mm_loadu_pd(strategy + i), scale));
+    for (; i < n; ++i) strategy[i] *= 1.0 / positive_sum;
+}
+
+__attribute__((target("sse2")))
+double accumulate_regrets_sse2(double* regret_sum, const double* action_utilities, double node_utility,
+                               double weight, size_t n, bool floor_at_zero) {
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d w = _mm_set1_pd(weight);
+    const __m128d u = _mm_set1_pd(node_utility);
+    __m128d delta = zero;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d before = _mm_loadu_pd(regret_sum + i);
+        __m128d after = _mm_add_pd(before, _mm_mul_pd(w, _mm_sub_pd(_mm_loadu_pd(action_utilities + i), u)));
+        if (floor_at_zero) after = _mm_max_pd(after, zero);
+        _mm_storeu_pd(regret_sum + i, after);
+        delta = _mm_add_pd(delta, _mm_sub_pd(_mm_max_pd(after, zero), _mm_max_pd(before, zero)));
+    }
+    return horizontal_sum_sse2(delta) +
+           accumulate_regrets_scalar(regret_sum + i, action_utilities + i, node_utility, weight, n - i, floor_at_zero);
+}
+
+__attribute__((target("sse2")))
+void accumulate_strategy_sse2(double* strategy_sum, const double* strategy, double weight, size_t n) {
+    const __m128d w = _mm_set1_pd(weight);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(strategy_sum + i, _mm_add_pd(_mm_loadu_pd(strategy_sum + i), _mm_mul_pd(w, _mm_loadu_pd(strategy + i))));
+    }
+    accumulate_strategy_scalar(strategy_sum + i, strategy + i, weight, n - i);
+}
+
+// --- AVX2 (4 doubles per lane) ---
+// Tails are handled inside the AVX2 functions rather than by calling the scalar kernels:
+// those are compiled without VEX encoding, and mixing them with dirty upper YMM state costs
+// far more than the few elements they would process.
+
+__attribute__((target("avx2")))
+double horizontal_sum_avx2(__m256d v) {
+    __m128d low = _mm256_castpd256_pd128(v);
+    __m128d high = _mm256_extractf128_pd(v, 1);
+    __m128d pair = _mm_add_pd(low, high);
+    return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+}
+
+__attribute__((target("avx2")))
+void regret_matching_avx2(const double* regrets, double* strategy, size_t n) {
+    const __m256d zero = _mm256_setzero_pd();
+    __m256d sum = zero;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d positive = _mm256_max_pd(_mm256_loadu_pd(regrets + i), zero);
+        _mm256_storeu_pd(strategy + i, positive);
+        sum = _mm256_add_pd(sum, positive);
+    }
+    double positive_sum = horizontal_sum_avx2(sum);
+    for (; i < n; ++i) { strategy[i] = regrets[i] > 0.0 ? regrets[i] : 0.0; positive_sum += strategy[i]; }
+    const bool uniform = !(positive_sum > 0.0) || !std::isfinite(positive_sum);
+    const double scalar_scale = uniform ? 0.0 : 1.0 / positive_sum;
+    const double fill = uniform && n > 0 ? 1.0 / n : 0.0; // strategy * 0 + 1/n when uniform
+    const __m256d scale = _mm256_set1_pd(scalar_scale);
+    const __m256d offset = _mm256_set1_pd(fill);
+    for (i = 0; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(strategy + i, _mm256_add_pd(_mm256_mul_pd(_mm256_loadu_pd(strategy + i), scale), offset));
+    }
+    for (; i < n; ++i) strategy[i] = uniform ? fill : strategy[i] * scalar_scale;
+}
+
+__attribute__((target("avx2")))
+double accumulate_regrets_avx2(double* regret_sum, const double* action_utilities, double node_utility,
+                               double weight, size_t n, bool floor_at_zero) {
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d w = _mm256_set1_pd(weight);
+    const __m256d u = _mm256_set1_pd(node_utility);
+    __m256d delta = zero;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d before = _mm256_loadu_pd(regret_sum + i);
+        __m256d after = _mm256_add_pd(before, _mm256_mul_pd(w, _mm256_sub_pd(_mm256_loadu_pd(action_utilities + i), u)));
+        if (floor_at_zero) after = _mm256_max_pd(after, zero);
+        _mm256_storeu_pd(regret_sum + i, after);
+        delta = _mm256_add_pd(delta, _mm256_sub_pd(_mm256_max_pd(after, zero), _mm256_max_pd(before, zero)));
+    }
+    double positive_delta = horizontal_sum_avx2(delta);
+    for (; i < n; ++i) {
+        double before = regret_sum[i];
+        double after = before + weight * (action_utilities[i] - node_utility);
+        if (floor_at_zero && after < 0.0) after = 0.0;
+        regret_sum[i] = after;
+        positive_delta += (after > 0.0 ? after : 0.0) - (before > 0.0 ? before : 0.0);
+    }
+    return positive_delta;
+}
+
+__attribute__((target("avx2")))
+void accumulate_strategy_avx2(double* strategy_sum, const double* strategy, double weight, size_t n) {
+    const __m256d w = _mm256_set1_pd(weight);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(strategy_sum + i, _mm256_add_pd(_mm256_loadu_pd(strategy_sum + i), _mm256_mul_pd(w, _mm256_loadu_pd(strategy + i))));
+    }
+    for (; i < n; ++i) strategy_sum[i] += weight * strategy[i];
+}
+
+#endif // GTO_SOLVER_X86_KERNELS
+
+const KernelTable kScalarKernels = {regret_matching_scalar, accumulate_regrets_scalar, accumulate_strategy_scalar, 0, nullptr};
+#ifdef GTO_SOLVER_X86_KERNELS
+const KernelTable kSse2Kernels = {regret_matching_sse2, accumulate_regrets_sse2, accumulate_strategy_sse2, 0, nullptr};
+// Below 8 actions AVX2 measured slower than SSE2 (BM_RegretMatching / BM_AccumulateRegrets)
+const KernelTable kAvx2Kernels = {regret_matching_avx2, accumulate_regrets_avx2, accumulate_strategy_avx2, 8, &kSse2Kernels};
+#endif
+
+const KernelTable* table_for(KernelIsa isa) {
+    switch (isa) {
+#ifdef GTO_SOLVER_X86_KERNELS
+        case KernelIsa::AVX2: return &kAvx2Kernels;
+        case KernelIsa::SSE2: return &kSse2Kernels;
+#endif
+        default: return &kScalarKernels;
+    }
+}
+
+KernelIsa best_supported_isa() {
+#ifdef GTO_SOLVER_X86_KERNELS
+    __builtin_cpu_init(); // May run before the CPU model constructor (static initialisation)
+#endif
+    if (kernel_isa_supported(KernelIsa::AVX2)) return KernelIsa::AVX2;
+    if (kernel_isa_supported(KernelIsa::SSE2)) return KernelIsa::SSE2;
+    return KernelIsa::SCALAR;
+}
+
+// Constant-initialised to the scalar kernels so calls during static initialisation are safe;
+// upgraded to the best supported set right after.
+std::atomic<KernelIsa> g_active_isa{KernelIsa::SCALAR};
+std::atomic<const KernelTable*> g_kernels{&kScalarKernels};
+const bool g_kernels_selected = set_kernel_isa(best_supported_isa());
+std::atomic<bool> g_fixed_width{true};
+
+inline const KernelTable* kernels_for(size_t n) {
+    if (n <= kMaxFixedKernelActions && g_fixed_width.load(std::memory_order_relaxed)) return &kFixedKernels[n];
+    const KernelTable* kernels = g_kernels.load(std::memory_order_relaxed);
+    return n < kernels->min_actions ? kernels->narrow : kernels;
+}
+
+} // anonymous namespace
+
+void regret_matching(const double* regrets, double* strategy, size_t n) {
+    kernels_for(n)->regret_matching(regrets, strategy, n);
+}
+
+double accumulate_regrets(double* regret_sum, const double* action_utilities, double node_utility,
+                          double weight, size_t n, bool floor_at_zero) {
+    return kernels_for(n)->accumulate_regrets(regret_sum, action_utilities, node_utility, weight, n, floor_at_zero);
+}
+
+void accumulate_strategy(double* strategy_sum, const double* strategy, double weight, size_t n) {
+    kernels_for(n)->accumulate_strategy(strategy_sum, strategy, weight, n);
+}
+
+bool kernel_isa_supported(KernelIsa isa) {
+#ifdef GTO_SOLVER_X86_KERNELS
+    __builtin_cpu_init();
+#endif
+    switch (isa) {
+        case KernelIsa::SCALAR: return true;
+#ifdef GTO_SOLVER_X86_KERNELS
+        case KernelIsa::SSE2: return __builtin_cpu_supports("sse2");
+        case KernelIsa::AVX2: return __builtin_cpu_supports("avx2");
+#endif
+        default: return false;
+    }
+}
+
+bool fixed_width_kernels_enabled() {
+    return g_fixed_width.load(std::memory_order_relaxed);
+}
+
+void set_fixed_width_kernels(bool enabled) {
+    g_fixed_width.store(enabled, std::memory_order_relaxed);
+}
+
+KernelIsa active_kernel_isa() {
+    return g_active_isa.load(std::memory_order_relaxed);
+}
+
+bool set_kernel_isa(KernelIsa isa) {
+    if (!kernel_isa_supported(isa)) return false;
+    g_active_isa.store(isa, std::memory_order_relaxed);
+    g_kernels.store(table_for(isa), std::memory_order_relaxed);
+    return true;
+}
+
+const char* kernel_isa_name(KernelIsa isa) {
+    switch (isa) {
+        case KernelIsa::AVX2: return "avx2";
+        case KernelIsa::SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+} // namespace gto_solver
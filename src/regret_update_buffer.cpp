@@ -0,0 +1,56 @@
+#include "regret_update_buffer.h"
+#include "regret_kernels.h"
+
+#include <algorithm> // For std::sort
+#include <mutex>
+
+namespace gto_solver {
+
+void RegretUpdateBuffer::add(Node* node, const double* regret_delta, const double* strategy_delta, bool pin_node, uint32_t updates) {
+    auto found = index_.find(node);
+    size_t n = node->regret_sum.size();
+    if (found == index_.end()) {
+        size_t offset = values_.size();
+        values_.insert(values_.end(), regret_delta, regret_delta + n);
+        values_.insert(values_.end(), strategy_delta, strategy_delta + n);
+        if (pin_node) node->pin_count.fetch_add(1, std::memory_order_relaxed);
+        index_.emplace(node, entries_.size());
+        entries_.push_back(Entry{node, offset, static_cast<uint32_t>(n), updates, pin_node});
+    } else {
+        Entry& entry = entries_[found->second];
+        double* regrets = values_.data() + entry.offset;
+        double* strategy = regrets + entry.num_actions;
+        accumulate_strategy(regrets, regret_delta, 1.0, entry.num_actions);
+        accumulate_strategy(strategy, strategy_delta, 1.0, entry.num_actions);
+        entry.updates += updates;
+    }
+    pending_updates_ += updates;
+}
+
+BufferMergeStats RegretUpdateBuffer::merge(RegretFloor floor) {
+    BufferMergeStats stats;
+    stats.nodes = entries_.size();
+    stats.updates = pending_updates_;
+    std::sort(entries_.begin(), entries_.end(), [](const Entry& a, const Entry& b) { return a.node < b.node; });
+    for (const Entry& entry : entries_) {
+        Node* node = entry.node;
+        const double* regrets = values_.data() + entry.offset;
+        const double* strategy = regrets + entry.num_actions;
+        {
+            std::lock_guard<std::mutex> node_lock(node->node_mutex);
+            // regret_sum += 1.0 * (delta - 0.0)
+            stats.positive_regret_delta += accumulate_regrets(node->regret_sum.data(), regrets, 0.0, 1.0, entry.num_actions,
+                                                             floor == RegretFloor::ON);
+            accumulate_strategy(node->strategy_sum.data(), strategy, 1.0, entry.num_actions);
+        }
+        node->visit_count.fetch_add(static_cast<int>(entry.updates), std::memory_order_relaxed);
+        if (entry.pinned) node->pin_count.fetch_sub(1, std::memory_order_release);
+    }
+    index_.clear();
+    entries_.clear();
+    values_.clear(); // Capacity is kept for the next interval
+    pending_updates_ = 0;
+    return stats;
+}
+
+} // namespace gto_solver
@@ -0,0 +1,183 @@
+#include "shard_link.h"
+
+#include <chrono>
+#include <sys/socket.h> // For shutdown
+#include <unistd.h>     // For close
+
+#include "spdlog/spdlog.h"
+
+namespace gto_solver {
+
+ShardLink::~ShardLink() {
+    if (active()) {
+        syncing_ = false;
+        sync_wait_cv_.notify_all();
+        sync_thread_.join();
+    }
+    close_all();
+}
+
+bool ShardLink::start(int shard_id, std::vector<ShardEndpoint> endpoints, double sync_interval_seconds, Handlers handlers,
+                      double connect_timeout_seconds) {
+    if (shard_id < 0 || static_cast<size_t>(shard_id) >= endpoints.size()) {
+        spdlog::error("Shard id {} is outside the {} shard endpoints.", shard_id, endpoints.size());
+        return false;
+    }
+    shard_id_ = shard_id;
+    endpoints_ = std::move(endpoints);
+    sync_interval_seconds_ = sync_interval_seconds > 0.0 ? sync_interval_seconds : 0.1;
+    handlers_ = std::move(handlers);
+
+    listen_fd_ = listen_tcp(endpoints_[shard_id_].port, static_cast<int>(endpoints_.size()));
+    if (listen_fd_ < 0) return false;
+    accepting_ = true;
+    accept_thread_ = std::thread(&ShardLink::accept_loop, this);
+
+    peer_fds_.assign(endpoints_.size(), -1);
+    for (size_t shard = 0; shard < endpoints_.size(); ++shard) {
+        if (static_cast<int>(shard) == shard_id_) continue;
+        peer_fds_[shard] = connect_tcp(endpoints_[shard], connect_timeout_seconds);
+        if (peer_fds_[shard] < 0) { close_all(); return false; }
+    }
+    spdlog::info("Shard {} of {}: connected to {} peers, syncing every {} ms.", shard_id_, endpoints_.size(),
+                 endpoints_.size() - 1, static_cast<int>(sync_interval_seconds_ * 1000));
+    syncing_ = true;
+    sync_thread_ = std::thread(&ShardLink::sync_loop, this);
+    return true;
+}
+
+bool ShardLink::finish(double timeout_seconds) {
+    if (!active()) return false;
+    syncing_ = false;
+    sync_wait_cv_.notify_all();
+    sync_thread_.join();
+    sync_once(false); // Last deltas; nothing left to read afterwards
+    for (size_t shard = 0; shard < peer_fds_.size(); ++shard) {
+        if (peer_fds_[shard] >= 0 && !send_frame(peer_fds_[shard], ShardFrame::DONE, std::string())) {
+            spdlog::warn("Shard {}: lost connection to shard {} before DONE.", shard_id_, shard);
+        }
+    }
+    bool all_done;
+    {
+        std::unique_lock<std::mutex> lock(done_mutex_);
+        all_done = done_cv_.wait_for(lock, std::chrono::duration<double>(timeout_seconds),
+                                     [&] { return peers_done_ >= num_shards() - 1; });
+    }
+    if (!all_done) spdlog::error("Shard {}: only {} of {} peers finished within {} s.", shard_id_, peers_done_, num_shards() - 1, timeout_seconds);
+    close_all();
+    return all_done;
+}
+
+ShardLinkStats ShardLink::stats() const {
+    ShardLinkStats stats;
+    stats.syncs = syncs_.load();
+    stats.bytes_sent = bytes_sent_.load();
+    stats.bytes_received = bytes_received_.load();
+    stats.sync_seconds = sync_ns_.load() / 1e9;
+    return stats;
+}
+
+void ShardLink::accept_loop() {
+    while (accepting_.load()) {
+        int fd = accept_tcp(listen_fd_, 200); // Short timeout so close_all() is honoured promptly
+        if (fd < 0) continue;
+        std::lock_guard<std::mutex> lock(serve_mutex_);
+        incoming_fds_.push_back(fd);
+        serve_threads_.emplace_back(&ShardLink::serve_peer, this, fd);
+    }
+}
+
+void ShardLink::serve_peer(int fd) {
+    ShardFrame type;
+    std::string payload;
+    while (recv_frame(fd, type, payload)) {
+        bytes_received_.fetch_add(static_cast<long long>(payload.size()), std::memory_order_relaxed);
+        switch (type) {
+            case ShardFrame::UPDATE:
+                handlers_.apply_updates(payload);
+                break;
+            case ShardFrame::LOOKUP:
+                if (!send_frame(fd, ShardFrame::LOOKUP_REPLY, handlers_.answer_lookup(payload))) return;
+                break;
+            case ShardFrame::DONE: {
+                std::lock_guard<std::mutex> lock(done_mutex_);
+                ++peers_done_;
+                done_cv_.notify_all();
+                break;
+            }
+            default:
+                spdlog::error("Shard {}: unexpected frame {} from a peer; dropping the connection.", shard_id_, static_cast<int>(type));
+                return;
+        }
+    }
+}
+
+void ShardLink::sync_loop() {
+    while (syncing_.load()) {
+        {
+            std::unique_lock<std::mutex> lock(sync_wait_mutex_);
+            sync_wait_cv_.wait_for(lock, std::chrono::duration<double>(sync_interval_seconds_), [&] { return !syncing_.load(); });
+        }
+        if (!syncing_.load()) break; // finish() sends the last round itself
+        sync_once(true);
+    }
+}
+
+void ShardLink::sync_once(bool with_lookups) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::vector<std::string>> updates(endpoints_.size()), lookups(endpoints_.size());
+    handlers_.collect(updates, lookups);
+    std::vector<size_t> awaiting(endpoints_.size(), 0); // LOOKUP frames sent, one reply each
+    for (size_t shard = 0; shard < peer_fds_.size(); ++shard) {
+        int fd = peer_fds_[shard];
+        if (fd < 0) continue;
+        bool sent = true;
+        for (const std::string& payload : updates[shard]) {
+            if (!send_frame(fd, ShardFrame::UPDATE, payload)) { spdlog::warn("Shard {}: UPDATE to shard {} failed.", shard_id_, shard); sent = false; break; }
+            bytes_sent_.fetch_add(static_cast<long long>(payload.size()), std::memory_order_relaxed);
+        }
+        if (!sent || !with_lookups) continue;
+        for (const std::string& payload : lookups[shard]) {
+            if (!send_frame(fd, ShardFrame::LOOKUP, payload)) { spdlog::warn("Shard {}: LOOKUP to shard {} failed.", shard_id_, shard); break; }
+            bytes_sent_.fetch_add(static_cast<long long>(payload.size()), std::memory_order_relaxed);
+            ++awaiting[shard];
+        }
+    }
+    // Every request is out before the first reply is read, so peers answer in parallel
+    for (size_t shard = 0; shard < peer_fds_.size(); ++shard) {
+        for (size_t k = 0; k < awaiting[shard]; ++k) {
+            ShardFrame type;
+            std::string reply;
+            if (!recv_frame(peer_fds_[shard], type, reply) || type != ShardFrame::LOOKUP_REPLY) {
+                spdlog::warn("Shard {}: no LOOKUP_REPLY from shard {}.", shard_id_, shard);
+                break;
+            }
+            bytes_received_.fetch_add(static_cast<long long>(reply.size()), std::memory_order_relaxed);
+            handlers_.install_reply(reply);
+        }
+    }
+    syncs_.fetch_add(1, std::memory_order_relaxed);
+    sync_ns_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(),
+                       std::memory_order_relaxed);
+}
+
+void ShardLink::close_all() {
+    for (int& fd : peer_fds_) {
+        if (fd >= 0) { ::close(fd); fd = -1; }
+    }
+    accepting_ = false;
+    if (accept_thread_.joinable()) accept_thread_.join();
+    {
+        std::lock_guard<std::mutex> lock(serve_mutex_);
+        for (int fd : incoming_fds_) ::shutdown(fd, SHUT_RDWR); // Unblocks serve threads still reading
+    }
+    for (auto& thread : serve_threads_) {
+        if (thread.joinable()) thread.join();
+    }
+    for (int fd : incoming_fds_) ::close(fd);
+    incoming_fds_.clear();
+    serve_threads_.clear();
+    if (listen_fd_ >= 0) { ::close(listen_fd_); listen_fd_ = -1; }
+}
+
+} // namespace gto_solver
@@ -0,0 +1,186 @@
+#include "shard_transport.h"
+#include "stable_hash.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstring>      // For std::strerror
+#include <thread>
+#include <arpa/inet.h>  // For htons, ntohs
+#include <netdb.h>      // For getaddrinfo
+#include <netinet/in.h>
+#include <netinet/tcp.h> // For TCP_NODELAY
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "spdlog/spdlog.h"
+
+namespace gto_solver {
+
+namespace {
+bool send_bytes(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool recv_bytes(int fd, char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::recv(fd, data, size, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Sync frames are small and latency bound; never wait for Nagle
+void set_no_delay(int fd) {
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+} // anonymous namespace
+
+bool parse_shard_endpoints(const std::string& text, std::vector<ShardEndpoint>& endpoints) {
+    std::vector<ShardEndpoint> parsed;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t comma = text.find(',', start);
+        std::string item = text.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        size_t colon = item.rfind(':');
+        if (colon == std::string::npos || colon == 0 || colon + 1 == item.size()) return false;
+        ShardEndpoint endpoint;
+        endpoint.host = item.substr(0, colon);
+        try {
+            size_t pos = 0;
+            endpoint.port = std::stoi(item.substr(colon + 1), &pos);
+            if (pos != item.size() - colon - 1) return false;
+        } catch (...) { return false; }
+        if (endpoint.port <= 0 || endpoint.port > 65535) return false;
+        parsed.push_back(endpoint);
+        if (comma == std::string::npos) break;
+        start = comma + 1;
+    }
+    if (parsed.empty()) return false;
+    endpoints = std::move(parsed);
+    return true;
+}
+
+std::string format_shard_endpoint(const ShardEndpoint& endpoint) {
+    return endpoint.host + ":" + std::to_string(endpoint.port);
+}
+
+size_t shard_of(const std::string& key, size_t num_shards) {
+    if (num_shards <= 1) return 0;
+    return static_cast<size_t>(stable_key_hash(key) % num_shards);
+}
+
+std::string shard_checkpoint_filename(const std::string& base, int shard_id, int num_shards) {
+    return base + ".shard" + std::to_string(shard_id) + "of" + std::to_string(num_shards);
+}
+
+bool send_frame(int fd, ShardFrame type, const std::string& payload) {
+    if (payload.size() > kMaxShardFrameBytes) {
+        spdlog::error("Shard transport: refusing to send a frame of {} bytes (limit {} bytes).", payload.size(), kMaxShardFrameBytes);
+        return false;
+    }
+    char header[1 + sizeof(uint64_t)];
+    header[0] = static_cast<char>(type);
+    uint64_t length = payload.size();
+    std::memcpy(header + 1, &length, sizeof(length)); // Peers share the build; native byte order
+    return send_bytes(fd, header, sizeof(header)) && send_bytes(fd, payload.data(), payload.size());
+}
+
+bool recv_frame(int fd, ShardFrame& type, std::string& payload) {
+    char header[1 + sizeof(uint64_t)];
+    if (!recv_bytes(fd, header, sizeof(header))) return false;
+    type = static_cast<ShardFrame>(static_cast<uint8_t>(header[0]));
+    uint64_t length = 0;
+    std::memcpy(&length, header + 1, sizeof(length));
+    if (length > kMaxShardFrameBytes) {
+        spdlog::error("Shard transport: frame of {} bytes exceeds the {} byte limit; dropping the connection.", length, kMaxShardFrameBytes);
+        return false;
+    }
+    payload.resize(length);
+    return length == 0 || recv_bytes(fd, payload.data(), length);
+}
+
+void ShardPayloads::add(std::string_view record, size_t cost) {
+    if (payloads_.empty() || cost > max_bytes_ - std::min(last_cost_, max_bytes_)) {
+        payloads_.emplace_back();
+        last_cost_ = 0;
+    }
+    payloads_.back().append(record);
+    last_cost_ += cost;
+}
+
+std::vector<std::string> ShardPayloads::take() {
+    std::vector<std::string> payloads;
+    payloads.swap(payloads_);
+    last_cost_ = 0;
+    return payloads;
+}
+
+int listen_tcp(int port, int backlog, int* bound_port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) { spdlog::error("Shard transport: socket() failed: {}", std::strerror(errno)); return -1; }
+    int reuse = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY); // Shards may live on other hosts
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(fd, backlog) < 0) {
+        spdlog::error("Shard transport: cannot listen on port {}: {}", port, std::strerror(errno));
+        ::close(fd);
+        return -1;
+    }
+    if (bound_port) {
+        socklen_t len = sizeof(addr);
+        ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        *bound_port = ntohs(addr.sin_port);
+    }
+    return fd;
+}
+
+int connect_tcp(const ShardEndpoint& endpoint, double timeout_seconds) {
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* resolved = nullptr;
+    std::string port = std::to_string(endpoint.port);
+    if (::getaddrinfo(endpoint.host.c_str(), port.c_str(), &hints, &resolved) != 0 || !resolved) {
+        spdlog::error("Shard transport: cannot resolve {}", format_shard_endpoint(endpoint));
+        return -1;
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(timeout_seconds);
+    int fd = -1;
+    while (true) {
+        fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd >= 0 && ::connect(fd, resolved->ai_addr, resolved->ai_addrlen) == 0) break;
+        if (fd >= 0) { ::close(fd); fd = -1; }
+        if (std::chrono::steady_clock::now() >= deadline) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50)); // Peer not listening yet
+    }
+    ::freeaddrinfo(resolved);
+    if (fd < 0) { spdlog::error("Shard transport: could not connect to {} within {} s", format_shard_endpoint(endpoint), timeout_seconds); return -1; }
+    set_no_delay(fd);
+    return fd;
+}
+
+int accept_tcp(int listen_fd, int timeout_ms) {
+    pollfd pfd{listen_fd, POLLIN, 0};
+    if (::poll(&pfd, 1, timeout_ms) <= 0 || !(pfd.revents & POLLIN)) return -1;
+    int fd = ::accept(listen_fd, nullptr, nullptr);
+    if (fd >= 0) set_no_delay(fd);
+    return fd;
+}
+
+} // namespace gto_solver
@@ -0,0 +1,337 @@
+#include "shared_node_store.h"
+#include "node_serialization.h"
+#include "stable_hash.h"
+
+#include <algorithm> // For std::sort, std::max
+#include <cerrno>
+#include <cstring>   // For std::memcmp, std::memcpy, std::strerror
+#include <fcntl.h>   // For O_* constants
+#include <fstream>
+#include <new>       // For placement new
+#include <string_view>
+#include <sys/mman.h> // For shm_open, mmap
+#include <sys/stat.h> // For fstat
+#include <unistd.h>   // For ftruncate, close, getpid
+
+#include "spdlog/spdlog.h"
+
+namespace gto_solver {
+
+namespace {
+constexpr uint64_t kStoreMagic = 0x45524f54534f5447ull; // "GTOSTORE"
+constexpr uint32_t kStoreVersion = 1;
+constexpr size_t kBytesPerSlot = 256;   // One table slot per 256 bytes of store (~3% of it)
+constexpr double kMaxLoadFactor = 0.85; // Inserts are refused beyond this table occupancy
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<int32_t>::is_always_lock_free,
+              "Shared-memory atomics must be lock-free to work across processes");
+
+// Legal action as stored in an entry (fixed layout, no padding surprises across builds)
+struct SharedActionSpec {
+    double value;
+    int32_t type;
+    int32_t unit;
+    uint8_t action_set;
+    uint8_t abstract_action;
+    uint8_t padding[6];
+};
+
+constexpr size_t align_up(size_t n, size_t alignment) { return (n + alignment - 1) & ~(alignment - 1); }
+} // anonymous namespace
+
+struct SharedNodeStore::Header {
+    uint64_t magic;
+    uint32_t version;
+    uint8_t history_encoding;
+    uint64_t total_bytes;
+    uint64_t slot_count;                  // Power of two
+    uint64_t arena_begin;                 // Offset of the first entry
+    std::atomic<uint64_t> arena_next;     // Offset of the next free arena byte
+    std::atomic<long long> entries;
+    std::atomic<long long> refused;
+    std::atomic<long long> wasted_bytes;
+    std::atomic<long long> completed_iterations;
+};
+
+// Followed by num_actions SharedActionSpec, num_actions regret sums, num_actions strategy sums
+// and the key bytes (padded to 8).
+struct SharedNodeStore::EntryHeader {
+    uint64_t hash;
+    uint32_t key_len;
+    uint32_t num_actions;
+    std::atomic<int32_t> visits;
+    uint32_t padding;
+
+    SharedActionSpec* actions() { return reinterpret_cast<SharedActionSpec*>(this + 1); }
+    double* regrets() { return reinterpret_cast<double*>(actions() + num_actions); }
+    double* strategy() { return regrets() + num_actions; }
+    char* key() { return reinterpret_cast<char*>(strategy() + num_actions); }
+    static size_t bytes(size_t key_len, size_t num_actions) {
+        return sizeof(EntryHeader) + num_actions * (sizeof(SharedActionSpec) + 2 * sizeof(double)) + align_up(key_len, 8);
+    }
+};
+
+SharedNodeStore::~SharedNodeStore() { close(); }
+
+bool SharedNodeStore::map(int fd, size_t bytes) {
+    void* mapping = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd); // The mapping keeps the object alive
+    if (mapping == MAP_FAILED) { spdlog::error("Shared node store: mmap of {} bytes failed: {}", bytes, std::strerror(errno)); return false; }
+    base_ = static_cast<char*>(mapping);
+    size_ = bytes;
+    return true;
+}
+
+bool SharedNodeStore::create(const std::string& name, size_t bytes) {
+    close();
+    size_t slot_count = 1024;
+    while (slot_count * 2 <= bytes / kBytesPerSlot) slot_count *= 2;
+    size_t arena_begin = align_up(sizeof(Header), 64) + slot_count * sizeof(std::atomic<uint64_t>);
+    if (bytes < arena_begin + (1 << 16)) { spdlog::error("Shared node store: {} bytes is too small.", bytes); return false; }
+    int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) { spdlog::error("Shared node store: shm_open({}) failed: {}", name, std::strerror(errno)); return false; }
+    if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        spdlog::error("Shared node store: cannot size {} to {} bytes: {}", name, bytes, std::strerror(errno));
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        return false;
+    }
+    if (!map(fd, bytes)) { ::shm_unlink(name.c_str()); return false; }
+    name_ = name;
+    owner_pid_ = ::getpid();
+    // A fresh object reads as zeros: the slot table is already empty
+    Header* h = new (base_) Header();
+    h->magic = kStoreMagic;
+    h->version = kStoreVersion;
+    h->history_encoding = static_cast<uint8_t>(HistoryEncoding::CHIPS);
+    h->total_bytes = bytes;
+    h->slot_count = slot_count;
+    h->arena_begin = arena_begin;
+    h->arena_next.store(arena_begin);
+    return true;
+}
+
+bool SharedNodeStore::attach(const std::string& name) {
+    close();
+    int fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+    if (fd < 0) { spdlog::error("Shared node store: shm_open({}) failed: {}", name, std::strerror(errno)); return false; }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(Header))) {
+        spdlog::error("Shared node store: {} is not a node store.", name);
+        ::close(fd);
+        return false;
+    }
+    if (!map(fd, static_cast<size_t>(st.st_size))) return false;
+    if (header()->magic != kStoreMagic || header()->version != kStoreVersion || header()->total_bytes != size_) {
+        spdlog::error("Shared node store: {} has an unknown layout.", name);
+        close();
+        return false;
+    }
+    name_ = name;
+    owner_pid_ = 0;
+    return true;
+}
+
+void SharedNodeStore::close() {
+    if (base_) ::munmap(base_, size_);
+    // Forked children inherit the object but never unlink the creator's name
+    if (owner_pid_ != 0 && owner_pid_ == ::getpid()) ::shm_unlink(name_.c_str());
+    base_ = nullptr;
+    size_ = 0;
+    owner_pid_ = 0;
+}
+
+SharedNodeStore::Header* SharedNodeStore::header() const { return reinterpret_cast<Header*>(base_); }
+
+std::atomic<uint64_t>* SharedNodeStore::slots() const {
+    return reinterpret_cast<std::atomic<uint64_t>*>(base_ + align_up(sizeof(Header), 64));
+}
+
+SharedNodeStore::EntryHeader* SharedNodeStore::entry_at(uint64_t offset) const { return reinterpret_cast<EntryHeader*>(base_ + offset); }
+
+uint64_t SharedNodeStore::find(const std::string& key) const {
+    if (!base_) return 0;
+    uint64_t hash = stable_key_hash(key);
+    uint64_t mask = header()->slot_count - 1;
+    for (uint64_t probe = 0, slot = hash & mask; probe <= mask; ++probe, slot = (slot + 1) & mask) {
+        uint64_t offset = slots()[slot].load(std::memory_order_acquire);
+        if (offset == 0) return 0;
+        EntryHeader* entry = entry_at(offset);
+        if (entry->hash == hash && entry->key_len == key.size() && std::memcmp(entry->key(), key.data(), key.size()) == 0) return offset;
+    }
+    return 0;
+}
+
+uint64_t SharedNodeStore::find_or_insert(const std::string& key, const std::vector<ActionSpec>& legal_actions) {
+    if (!base_) return 0;
+    Header* h = header();
+    uint64_t hash = stable_key_hash(key);
+    uint64_t mask = h->slot_count - 1;
+    uint64_t mine = 0; // Our unpublished entry, built on the first empty slot we meet
+    size_t mine_bytes = EntryHeader::bytes(key.size(), legal_actions.size());
+    for (uint64_t probe = 0, slot = hash & mask; probe <= mask; ++probe, slot = (slot + 1) & mask) {
+        uint64_t offset = slots()[slot].load(std::memory_order_acquire);
+        if (offset == 0) {
+            if (mine == 0) {
+                if (h->entries.load(std::memory_order_relaxed) >= static_cast<long long>(h->slot_count * kMaxLoadFactor)) break;
+                uint64_t at = h->arena_next.fetch_add(mine_bytes, std::memory_order_relaxed);
+                if (at + mine_bytes > h->total_bytes) break;
+                EntryHeader* entry = new (base_ + at) EntryHeader();
+                entry->hash = hash;
+                entry->key_len = static_cast<uint32_t>(key.size());
+                entry->num_actions = static_cast<uint32_t>(legal_actions.size());
+                for (size_t a = 0; a < legal_actions.size(); ++a) {
+                    const ActionSpec& spec = legal_actions[a];
+                    entry->actions()[a] = SharedActionSpec{spec.value, static_cast<int32_t>(spec.type), static_cast<int32_t>(spec.unit),
+                                                           static_cast<uint8_t>(spec.action_set), static_cast<uint8_t>(spec.abstract_action), {}};
+                    entry->regrets()[a] = 0.0;
+                    entry->strategy()[a] = 0.0;
+                }
+                std::memcpy(entry->key(), key.data(), key.size());
+                mine = at;
+            }
+            uint64_t expected = 0;
+            if (slots()[slot].compare_exchange_strong(expected, mine, std::memory_order_acq_rel)) { // Publishes the entry
+                h->entries.fetch_add(1, std::memory_order_relaxed);
+                return mine;
+            }
+            offset = expected; // Another process took this slot first
+        }
+        EntryHeader* entry = entry_at(offset);
+        if (entry->hash == hash && entry->key_len == key.size() && std::memcmp(entry->key(), key.data(), key.size()) == 0) {
+            if (mine) h->wasted_bytes.fetch_add(static_cast<long long>(mine_bytes), std::memory_order_relaxed);
+            return offset;
+        }
+    }
+    if (mine) h->wasted_bytes.fetch_add(static_cast<long long>(mine_bytes), std::memory_order_relaxed);
+    h->refused.fetch_add(1, std::memory_order_relaxed);
+    return 0;
+}
+
+size_t SharedNodeStore::num_actions(uint64_t entry) const { return entry_at(entry)->num_actions; }
+
+void SharedNodeStore::load_regrets(uint64_t entry, double* regrets) const {
+    EntryHeader* e = entry_at(entry);
+    double* sums = e->regrets();
+    for (uint32_t a = 0; a < e->num_actions; ++a) regrets[a] = std::atomic_ref<double>(sums[a]).load(std::memory_order_relaxed);
+}
+
+double SharedNodeStore::add_deltas(uint64_t entry, const double* regret_delta, const double* strategy_delta, int updates, bool floor_regrets) {
+    EntryHeader* e = entry_at(entry);
+    double* regrets = e->regrets();
+    double* strategy = e->strategy();
+    double positive_delta = 0.0;
+    for (uint32_t a = 0; a < e->num_actions; ++a) {
+        std::atomic_ref<double> regret(regrets[a]);
+        double old_value = regret.load(std::memory_order_relaxed);
+        double new_value;
+        if (floor_regrets) {
+            do { new_value = std::max(0.0, old_value + regret_delta[a]); }
+            while (!regret.compare_exchange_weak(old_value, new_value, std::memory_order_relaxed));
+        } else {
+            old_value = regret.fetch_add(regret_delta[a], std::memory_order_relaxed);
+            new_value = old_value + regret_delta[a];
+        }
+        positive_delta += std::max(0.0, new_value) - std::max(0.0, old_value);
+        if (strategy_delta[a] != 0.0) std::atomic_ref<double>(strategy[a]).fetch_add(strategy_delta[a], std::memory_order_relaxed);
+    }
+    e->visits.fetch_add(updates, std::memory_order_relaxed);
+    return positive_delta;
+}
+
+void SharedNodeStore::add_completed_iterations(long long iterations) {
+    header()->completed_iterations.fetch_add(iterations, std::memory_order_relaxed);
+}
+
+long long SharedNodeStore::completed_iterations() const {
+    return base_ ? header()->completed_iterations.load(std::memory_order_relaxed) : 0;
+}
+
+HistoryEncoding SharedNodeStore::history_encoding() const { return static_cast<HistoryEncoding>(header()->history_encoding); }
+
+void SharedNodeStore::set_history_encoding(HistoryEncoding encoding) { header()->history_encoding = static_cast<uint8_t>(encoding); }
+
+bool SharedNodeStore::save_checkpoint(const std::string& filename) const {
+    if (!base_) return false;
+    // Published entries in key order (the table itself is in hash order)
+    std::vector<std::pair<std::string_view, uint64_t>> order;
+    order.reserve(static_cast<size_t>(header()->entries.load()));
+    for (uint64_t slot = 0; slot < header()->slot_count; ++slot) {
+        uint64_t offset = slots()[slot].load(std::memory_order_acquire);
+        if (offset == 0) continue;
+        EntryHeader* entry = entry_at(offset);
+        order.emplace_back(std::string_view(entry->key(), entry->key_len), offset);
+    }
+    std::sort(order.begin(), order.end());
+
+    std::ofstream ofs(filename, std::ios::binary | std::ios::trunc);
+    if (!ofs) { spdlog::error("Failed to open checkpoint file for writing: {}", filename); return false; }
+    CheckpointHeader checkpoint;
+    checkpoint.history_encoding = history_encoding();
+    checkpoint.completed_iterations = static_cast<int>(completed_iterations());
+    checkpoint.map_size = order.size();
+    if (!write_checkpoint_header(ofs, checkpoint)) return false;
+    std::vector<ActionSpec> actions;
+    std::vector<double> regrets, strategy;
+    for (const auto& [key, offset] : order) {
+        EntryHeader* entry = entry_at(offset);
+        size_t n = entry->num_actions;
+        actions.resize(n);
+        regrets.resize(n);
+        strategy.resize(n);
+        for (size_t a = 0; a < n; ++a) {
+            const SharedActionSpec& spec = entry->actions()[a];
+            actions[a].type = static_cast<ActionType>(spec.type);
+            actions[a].value = spec.value;
+            actions[a].unit = static_cast<SizingUnit>(spec.unit);
+            actions[a].action_set = static_cast<ActionSetId>(spec.action_set);
+            actions[a].abstract_action = static_cast<AbstractAction>(spec.abstract_action);
+            strategy[a] = std::atomic_ref<double>(entry->strategy()[a]).load(std::memory_order_relaxed);
+        }
+        load_regrets(offset, regrets.data());
+        if (!write_node_record(ofs, std::string(key), actions, regrets.data(), strategy.data(), entry->visits.load(std::memory_order_relaxed))) return false;
+    }
+    long long nodes_created = static_cast<long long>(order.size());
+    ofs.write(reinterpret_cast<const char*>(&nodes_created), sizeof(nodes_created));
+    ofs.close();
+    return ofs.good();
+}
+
+int SharedNodeStore::load_checkpoint(const std::string& filename) {
+    if (!base_) return -1;
+    if (header()->entries.load() != 0) { spdlog::error("Shared node store: can only load a checkpoint into an empty store."); return -1; }
+    std::ifstream ifs(filename, std::ios::binary);
+    if (!ifs) { spdlog::error("Failed to open checkpoint file for reading: {}", filename); return -1; }
+    CheckpointHeader checkpoint;
+    if (!read_checkpoint_header(ifs, checkpoint)) return -1;
+    if (checkpoint.num_shards > 1) spdlog::warn("Checkpoint holds only the infosets of shard {} of {}.", checkpoint.shard_id, checkpoint.num_shards);
+    for (size_t i = 0; i < checkpoint.map_size; ++i) {
+        std::string key;
+        std::unique_ptr<Node> node;
+        if (!read_node_record(ifs, key, node, checkpoint.version)) { spdlog::error("Failed reading checkpoint entry {}", i); return -1; }
+        uint64_t offset = find_or_insert(key, node->legal_actions);
+        if (offset == 0) { spdlog::error("Shared node store is too small for {} ({} of {} entries loaded).", filename, i, checkpoint.map_size); return -1; }
+        EntryHeader* entry = entry_at(offset);
+        std::copy(node->regret_sum.begin(), node->regret_sum.end(), entry->regrets());
+        std::copy(node->strategy_sum.begin(), node->strategy_sum.end(), entry->strategy());
+        entry->visits.store(node->visit_count.load(), std::memory_order_relaxed);
+    }
+    set_history_encoding(checkpoint.history_encoding);
+    header()->completed_iterations.store(checkpoint.completed_iterations);
+    return checkpoint.completed_iterations;
+}
+
+SharedStoreStats SharedNodeStore::stats() const {
+    SharedStoreStats s;
+    if (!base_) return s;
+    Header* h = header();
+    s.entries = h->entries.load(std::memory_order_relaxed);
+    s.slots = static_cast<long long>(h->slot_count);
+    s.used_bytes = std::min<size_t>(h->arena_next.load(std::memory_order_relaxed), h->total_bytes);
+    s.capacity_bytes = h->total_bytes;
+    s.refused = h->refused.load(std::memory_order_relaxed);
+    s.wasted_bytes = static_cast<size_t>(h->wasted_bytes.load(std::memory_order_relaxed));
+    return s;
+}
+
+} // namespace gto_solver
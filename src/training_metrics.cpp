@@ -0,0 +1,139 @@
+#include "training_metrics.h"
+
+#include <algorithm> // For std::max
+#include <fstream>
+#include <string>
+#include <unistd.h> // For sysconf
+
+#include "spdlog/spdlog.h"
+
+namespace gto_solver {
+
+namespace {
+thread_local ThreadCounters* tls_registered_counters = nullptr;
+thread_local ThreadCounters tls_scratch_counters; // Fallback for unregistered threads
+
+double seconds_between(std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b) {
+    return std::chrono::duration<double>(b - a).count();
+}
+} // anonymous namespace
+
+ThreadCounters& thread_counters() {
+    return tls_registered_counters ? *tls_registered_counters : tls_scratch_counters;
+}
+
+void TrainingMetrics::start(double interval_seconds, const std::string& csv_filename, int num_threads, long long starting_iteration) {
+    num_threads_ = std::max(1, num_threads);
+    interval_seconds_ = interval_seconds;
+    timing_enabled_ = interval_seconds > 0.0;
+    counters_.clear();
+    for (int i = 0; i < num_threads_; ++i) counters_.push_back(std::make_unique<ThreadCounters>());
+    next_slot_ = 0;
+
+    if (!csv_filename.empty()) {
+        csv_.open(csv_filename, std::ios::trunc);
+        if (!csv_) {
+            spdlog::error("Failed to open metrics CSV file for writing: {}", csv_filename);
+        } else {
+            csv_ << "label,elapsed_s,iterations,iters_per_sec,node_visits_per_sec,nodes_created_per_sec,total_nodes,"
+                    "rss_bytes,map_lock_wait_ms,node_lock_wait_ms,avg_traversal_depth,"
+                    "pct_eval,pct_abstraction,pct_key,pct_update\n";
+        }
+    }
+    run_start_ = take_snapshot(starting_iteration, 0);
+    last_report_ = run_start_;
+}
+
+void TrainingMetrics::register_current_thread() {
+    int slot = next_slot_.fetch_add(1);
+    if (slot < static_cast<int>(counters_.size())) {
+        tls_registered_counters = counters_[slot].get();
+    } else {
+        spdlog::warn("TrainingMetrics: more workers than counter slots ({}); extra worker is not tracked.", counters_.size());
+        tls_registered_counters = nullptr;
+    }
+}
+
+MetricsSnapshot TrainingMetrics::take_snapshot(long long iterations, long long total_nodes) const {
+    MetricsSnapshot s;
+    s.time = std::chrono::steady_clock::now();
+    s.iterations = iterations;
+    s.total_nodes = total_nodes;
+    for (const auto& c : counters_) {
+        s.node_visits += c->node_visits.load();
+        s.nodes_created += c->nodes_created.load();
+        s.traversals += c->traversals.load();
+        s.traversal_depth += c->traversal_depth.load();
+        s.map_lock_wait_ns += c->map_lock_wait_ns.load();
+        s.node_lock_wait_ns += c->node_lock_wait_ns.load();
+        s.eval_ns += c->eval_ns.load();
+        s.abstraction_ns += c->abstraction_ns.load();
+        s.key_ns += c->key_ns.load();
+        s.update_ns += c->update_ns.load();
+        s.positive_regret_delta += c->positive_regret_delta.load();
+        s.window_first_visits += c->window_first_visits.load();
+    }
+    return s;
+}
+
+void TrainingMetrics::maybe_report(long long iterations, long long total_nodes) {
+    if (interval_seconds_ <= 0.0) return;
+    auto now = std::chrono::steady_clock::now();
+    if (seconds_between(last_report_.time, now) < interval_seconds_) return;
+    MetricsSnapshot current = take_snapshot(iterations, total_nodes);
+    emit(last_report_, current, "interval");
+    last_report_ = current;
+}
+
+void TrainingMetrics::finish(long long iterations, long long total_nodes) {
+    MetricsSnapshot current = take_snapshot(iterations, total_nodes);
+    emit(run_start_, current, "run");
+    if (csv_.is_open()) csv_.close();
+}
+
+void TrainingMetrics::emit(const MetricsSnapshot& from, const MetricsSnapshot& to, const char* label) {
+    double elapsed = seconds_between(from.time, to.time);
+    if (elapsed <= 0.0) elapsed = 1e-9;
+    double total_since_start = seconds_between(run_start_.time, to.time);
+
+    long long iterations = to.iterations - from.iterations;
+    double iters_per_sec = iterations / elapsed;
+    double visits_per_sec = (to.node_visits - from.node_visits) / elapsed;
+    double created_per_sec = (to.nodes_created - from.nodes_created) / elapsed;
+    uint64_t traversals = to.traversals - from.traversals;
+    double avg_depth = traversals > 0 ? static_cast<double>(to.traversal_depth - from.traversal_depth) / traversals : 0.0;
+    double map_wait_ms = (to.map_lock_wait_ns - from.map_lock_wait_ns) / 1e6;
+    double node_wait_ms = (to.node_lock_wait_ns - from.node_lock_wait_ns) / 1e6;
+
+    // Phase split as a share of all worker time in the interval.
+    double thread_ns = elapsed * 1e9 * num_threads_;
+    double pct_eval = 100.0 * (to.eval_ns - from.eval_ns) / thread_ns;
+    double pct_abstraction = 100.0 * (to.abstraction_ns - from.abstraction_ns) / thread_ns;
+    double pct_key = 100.0 * (to.key_ns - from.key_ns) / thread_ns;
+    double pct_update = 100.0 * (to.update_ns - from.update_ns) / thread_ns;
+    size_t rss = resident_memory_bytes();
+
+    spdlog::info("metrics label={} elapsed_s={:.1f} iterations={} iters_per_sec={:.1f} node_visits_per_sec={:.0f} "
+                 "nodes_created_per_sec={:.0f} total_nodes={} rss_mb={:.1f} map_lock_wait_ms={:.2f} node_lock_wait_ms={:.2f} "
+                 "avg_traversal_depth={:.2f} pct_eval={:.1f} pct_abstraction={:.1f} pct_key={:.1f} pct_update={:.1f}",
+                 label, total_since_start, to.iterations, iters_per_sec, visits_per_sec, created_per_sec, to.total_nodes,
+                 rss / (1024.0 * 1024.0), map_wait_ms, node_wait_ms, avg_depth, pct_eval, pct_abstraction, pct_key, pct_update);
+
+    if (csv_.is_open()) {
+        csv_ << label << ',' << total_since_start << ',' << to.iterations << ',' << iters_per_sec << ',' << visits_per_sec << ','
+             << created_per_sec << ',' << to.total_nodes << ',' << rss << ',' << map_wait_ms << ',' << node_wait_ms << ','
+             << avg_depth << ',' << pct_eval << ',' << pct_abstraction << ',' << pct_key << ',' << pct_update << '\n';
+        csv_.flush(); // Keep the file useful if the run is killed
+    }
+}
+
+size_t TrainingMetrics::resident_memory_bytes() {
+    // /proc/self/statm: size resident shared text lib data dt (in pages)
+    std::ifstream statm("/proc/self/statm");
+    size_t size_pages = 0, resident_pages = 0;
+    if (!(statm >> size_pages >> resident_pages)) return 0;
+    long page_size = sysconf(_SC_PAGESIZE);
+    return resident_pages * static_cast<size_t>(page_size > 0 ? page_size : 4096);
+}
+
+} // namespace gto_solver
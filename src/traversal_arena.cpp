@@ -0,0 +1,76 @@
+#include "traversal_arena.h"
+
+#include <algorithm> // For std::max
+#include <cstdint>   // For uintptr_t
+#include <new>       // For ::operator new / delete with alignment
+
+namespace gto_solver {
+
+namespace {
+thread_local std::pmr::memory_resource* tls_traversal_resource = nullptr;
+
+size_t align_up(uintptr_t address, size_t alignment) {
+    return static_cast<size_t>((address + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1));
+}
+} // anonymous namespace
+
+TraversalArena::TraversalArena(size_t first_block_bytes)
+    : next_block_bytes_(std::max<size_t>(first_block_bytes, 1024)) {}
+
+TraversalArena::~TraversalArena() {
+    for (const Block& block : blocks_) ::operator delete(block.data, std::align_val_t{alignof(std::max_align_t)});
+}
+
+void TraversalArena::reset() {
+    current_ = 0;
+    offset_ = 0;
+    used_before_current_ = 0;
+}
+
+void* TraversalArena::do_allocate(size_t bytes, size_t alignment) {
+    while (current_ < blocks_.size()) {
+        Block& block = blocks_[current_];
+        uintptr_t base = reinterpret_cast<uintptr_t>(block.data);
+        size_t start = align_up(base + offset_, alignment) - base;
+        if (start + bytes <= block.size) {
+            offset_ = start + bytes;
+            high_water_bytes_ = std::max(high_water_bytes_, used_before_current_ + offset_);
+            return block.data + start;
+        }
+        if (current_ + 1 == blocks_.size()) break;
+        used_before_current_ += block.size; // Move on to the next (already reserved) block
+        ++current_;
+        offset_ = 0;
+    }
+    // Out of reserved space: take a new block, at least double the last one
+    size_t size = std::max(next_block_bytes_, bytes + alignment);
+    next_block_bytes_ = size * 2;
+    Block block{static_cast<std::byte*>(::operator new(size, std::align_val_t{alignof(std::max_align_t)})), size};
+    if (!blocks_.empty()) used_before_current_ += blocks_[current_].size;
+    blocks_.push_back(block);
+    reserved_bytes_ += size;
+    current_ = blocks_.size() - 1;
+    offset_ = 0;
+    return do_allocate(bytes, alignment);
+}
+
+void TraversalArena::do_deallocate(void* p, size_t bytes, size_t /*alignment*/) {
+    // LIFO frees (recursion unwinding) give their space back; others wait for reset()
+    if (current_ < blocks_.size() && static_cast<std::byte*>(p) + bytes == blocks_[current_].data + offset_) {
+        offset_ = static_cast<size_t>(static_cast<std::byte*>(p) - blocks_[current_].data);
+    }
+}
+
+std::pmr::memory_resource* traversal_resource() {
+    return tls_traversal_resource ? tls_traversal_resource : std::pmr::new_delete_resource();
+}
+
+TraversalArenaScope::TraversalArenaScope(TraversalArena* arena) : previous_(tls_traversal_resource) {
+    tls_traversal_resource = arena;
+}
+
+TraversalArenaScope::~TraversalArenaScope() {
+    tls_traversal_resource = previous_;
+}
+
+} // namespace gto_solver
@@ -0,0 +1,50 @@
+#include "visit_sketch.h"
+
+#include <algorithm> // For std::min
+#include <functional> // For std::hash
+
+namespace gto_solver {
+
+void VisitSketch::reset(size_t counters_per_row, size_t rows) {
+    if (counters_per_row == 0 || rows == 0) {
+        counters_.clear();
+        counters_.shrink_to_fit();
+        rows_ = mask_ = 0;
+        return;
+    }
+    size_t width = 1;
+    while (width < counters_per_row) width <<= 1;
+    rows_ = rows;
+    mask_ = width - 1;
+    counters_.assign(rows_ * width, 0);
+}
+
+// Row indices from one 64-bit hash (Kirsch-Mitzenmacher double hashing).
+size_t VisitSketch::index(uint64_t hash, size_t row) const {
+    uint64_t h1 = hash;
+    uint64_t h2 = (hash >> 32) | (hash << 32) | 1; // Odd: rows never collapse onto one stride
+    return row * (mask_ + 1) + static_cast<size_t>((h1 + row * h2) & mask_);
+}
+
+uint32_t VisitSketch::add(const std::string& key) {
+    if (!enabled()) return 0;
+    uint64_t hash = std::hash<std::string>{}(key);
+    uint32_t smallest = 255;
+    for (size_t row = 0; row < rows_; ++row) smallest = std::min<uint32_t>(smallest, counters_[index(hash, row)]);
+    if (smallest == 255) return smallest; // Saturated
+    for (size_t row = 0; row < rows_; ++row) {
+        uint8_t& counter = counters_[index(hash, row)];
+        if (counter == smallest) counter = static_cast<uint8_t>(smallest + 1);
+    }
+    return smallest + 1;
+}
+
+uint32_t VisitSketch::estimate(const std::string& key) const {
+    if (!enabled()) return 0;
+    uint64_t hash = std::hash<std::string>{}(key);
+    uint32_t smallest = 255;
+    for (size_t row = 0; row < rows_; ++row) smallest = std::min<uint32_t>(smallest, counters_[index(hash, row)]);
+    return smallest;
+}
+
+} // namespace gto_solver
@@ -125,5 +125,39 @@ TEST(ActionAbstractionTest, PostflopBetActions) {
     EXPECT_EQ(actions.size(), 7);
 }
 
+TEST(ActionAbstractionTest, CompactHistoryIgnoresAnte) {
+    // HU limp / check, then a half-pot flop bet: 2 chips without ante, 3 with one
+    ActionAbstraction action_abstraction;
+    auto take = [&](GameState& state, ActionType type, double value = 0.0) {
+        std::vector<ActionSpec> specs = action_abstraction.get_possible_action_specs(state);
+        auto it = std::find_if(specs.begin(), specs.end(), [&](const ActionSpec& spec) {
+            return spec.type == type && std::abs(spec.value - value) < 1e-5;
+        });
+        ASSERT_NE(it, specs.end());
+        EXPECT_NE(it->action_set, ActionSetId::UNTAGGED);
+        Action action;
+        action.type = type == ActionType::CALL ? Action::Type::CALL : type == ActionType::CHECK ? Action::Type::CHECK : Action::Type::BET;
+        action.player_index = state.get_current_player();
+        if (type == ActionType::BET) action.amount = action_abstraction.get_action_amount(*it, state);
+        action.action_set = it->action_set;
+        action.abstract_action = it->abstract_action;
+        state.apply_action(action);
+    };
+    std::vector<std::string> chip_histories, compact_histories;
+    for (int ante : {0, 1}) {
+        GameState state(2, 100, ante, 0);
+        take(state, ActionType::CALL);
+        take(state, ActionType::CHECK);
+        state.deal_community_cards({"As", "Kd", "7h"});
+        take(state, ActionType::BET, 50);
+        chip_histories.push_back(state.get_history_string());
+        compact_histories.push_back(state.get_compact_history());
+    }
+    EXPECT_NE(chip_histories[0], chip_histories[1]);
+    EXPECT_EQ(compact_histories[0], compact_histories[1]);
+    EXPECT_EQ(compact_histories[0].size(), 3u); // One byte per action
+    EXPECT_EQ(describe_compact_history(compact_histories[0]), "call/check/bet_50pct/");
+    EXPECT_EQ(describe_compact_history(compact_histories[0], true), "hu_open:call/hu_vs_limp:check/postflop_unopened:bet_50pct/");
+}
 
 } // namespace gto_solver
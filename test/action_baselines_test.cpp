@@ -0,0 +1,68 @@
+#include "gtest/gtest.h"
+#include "action_baselines.h"
+
+#include <random>
+#include <vector>
+
+namespace gto_solver {
+
+TEST(ActionBaselinesTest, CorrectsTheSampledValueWithLearnedValues) {
+    ActionBaselines baselines;
+    EXPECT_FALSE(baselines.enabled());
+    const double strategy[] = {0.5, 0.5};
+    EXPECT_DOUBLE_EQ(baselines.estimate(1, strategy, 2, 0, 4.0), 4.0); // Disabled: plain estimate
+
+    baselines.reset(16);
+    ASSERT_TRUE(baselines.enabled());
+    const uint64_t key = ActionBaselines::key_hash("P1:AcKd|0|0----------|", 0);
+    EXPECT_NE(key, ActionBaselines::key_hash("P1:AcKd|0|0----------|", 2)); // Values are per traversing player
+    // b(a) = (n_a * mean_a + 4 * mean) / (n_a + 4), read before the sample is folded in
+    EXPECT_DOUBLE_EQ(baselines.estimate(key, strategy, 2, 0, 4.0), 4.0);        // Nothing learned yet
+    EXPECT_NEAR(baselines.estimate(key, strategy, 2, 1, 2.0), 2.0, 1e-12);      // b = {4, 4}: 2 - 4 + 4
+    EXPECT_NEAR(baselines.estimate(key, strategy, 2, 0, 6.0), 5.8, 1e-12);      // b = {3.2, 2.8}: 6 - 3.2 + 3
+    EXPECT_NEAR(baselines.estimate(key, strategy, 2, 1, 2.0), 2.0 - 3.6 + 0.5 * 26.0 / 6.0 + 0.5 * 3.6, 1e-12); // b = {26/6, 3.6}
+    EXPECT_EQ(baselines.estimates(), 4);
+    EXPECT_EQ(baselines.corrected(), 3);
+
+    // Too wide for a slot: plain estimate, nothing stored
+    std::vector<double> wide(ActionBaselines::kMaxActions + 1, 1.0 / (ActionBaselines::kMaxActions + 1));
+    EXPECT_DOUBLE_EQ(baselines.estimate(key, wide.data(), wide.size(), 0, -7.0), -7.0);
+
+    baselines.reset(0);
+    EXPECT_FALSE(baselines.enabled());
+    EXPECT_EQ(baselines.memory_bytes(), 0u);
+}
+
+TEST(ActionBaselinesTest, KeepsTheMeanAndCutsTheVariance) {
+    // Action values are fixed means plus a little noise: the plain estimate varies with the
+    // sampled action, the corrected one only with the noise once the baselines have been learned
+    const double strategy[] = {0.2, 0.3, 0.5};
+    const double means[] = {-3.0, 1.0, 4.0};
+    const double expected = 0.2 * -3.0 + 0.3 * 1.0 + 0.5 * 4.0;
+    ActionBaselines baselines;
+    baselines.reset(64);
+    const uint64_t key = ActionBaselines::key_hash("P2:7h7s|1|3AhKd2c--|c", 1);
+    std::mt19937 rng(5);
+    std::discrete_distribution<size_t> sampler(std::begin(strategy), std::end(strategy));
+    std::normal_distribution<double> noise(0.0, 0.1);
+
+    double plain_sum = 0.0, plain_squares = 0.0, corrected_sum = 0.0, corrected_squares = 0.0;
+    const int samples = 20000;
+    for (int i = 0; i < samples; ++i) {
+        size_t action = sampler(rng);
+        double value = means[action] + noise(rng);
+        double corrected = baselines.estimate(key, strategy, 3, action, value);
+        plain_sum += value;
+        plain_squares += value * value;
+        corrected_sum += corrected;
+        corrected_squares += corrected * corrected;
+    }
+    double plain_mean = plain_sum / samples, corrected_mean = corrected_sum / samples;
+    double plain_variance = plain_squares / samples - plain_mean * plain_mean;
+    double corrected_variance = corrected_squares / samples - corrected_mean * corrected_mean;
+    EXPECT_NEAR(plain_mean, expected, 0.05);
+    EXPECT_NEAR(corrected_mean, expected, 0.05);
+    EXPECT_LT(corrected_variance, 0.05 * plain_variance);
+}
+
+} // namespace gto_solver
@@ -4,6 +4,16 @@
 #include "info_set.h"   // Corrected include (needed for example)
 #include <vector>       // Include vector
 #include <numeric>      // Include numeric for std::accumulate
+#include <algorithm>
+#include <cstdio>       // For std::remove
+#include <fstream>
+#include <memory_resource>
+#include <mutex>
+#include <random>
+#include <sys/wait.h>   // For waitpid
+#include <unistd.h>     // For fork, close
+#include "node_serialization.h"
+#include "shard_transport.h"
 
 // Helper function defined in cfr_engine.cpp - need to either move it to header or redeclare/copy here for testing
 // For simplicity, let's assume it's accessible or copy its logic.
@@ -31,6 +41,172 @@ std::vector<double> get_strategy_from_regrets_test(const std::vector<double>& re
 
 namespace gto_solver {
 
+// Runs single traversals of an engine on hand-built spots, for what a whole train() run cannot
+// show: the exact deltas one pass leaves and the node each lookup resolves to.
+class CFREngineTestPeer {
+public:
+    explicit CFREngineTestPeer(CFREngine& engine) : engine_(engine) {}
+
+    Node* node(const std::string& key) {
+        std::lock_guard<std::mutex> lock(engine_.node_map_mutex_);
+        auto it = engine_.node_map_.find(key);
+        return it == engine_.node_map_.end() ? nullptr : it->second.get();
+    }
+
+    std::vector<std::string> keys() {
+        std::lock_guard<std::mutex> lock(engine_.node_map_mutex_);
+        std::vector<std::string> keys;
+        for (const auto& [key, node] : engine_.node_map_) keys.push_back(key);
+        return keys;
+    }
+
+    // cfr_plus_recursive for traversing_player from a state whose hands are the front of deck
+    double traverse(const GameState& state, std::vector<Card>& deck, int traversing_player, unsigned seed = 1) {
+        std::pmr::vector<double> reach(state.get_num_players(), 1.0);
+        int card_idx = 2 * state.get_num_players();
+        std::mt19937 rng(seed);
+        return engine_.cfr_plus_recursive(state, traversing_player, reach, deck, card_idx, rng, 0, CFREngine::TrieLink{});
+    }
+
+    // cfr_batch_recursive with one lane per state (decks[b] holds the hands of states[b] in front)
+    std::vector<double> traverse_batch(const std::vector<GameState>& states, const std::vector<std::vector<Card>>& decks,
+                                       int traversing_player, unsigned seed = 1) {
+        std::pmr::vector<CFREngine::TraversalLane> lanes;
+        for (size_t b = 0; b < states.size(); ++b) {
+            lanes.push_back({states[b], &decks[b], 2 * states[b].get_num_players(),
+                             std::pmr::vector<double>(states[b].get_num_players(), 1.0)});
+        }
+        std::mt19937 rng(seed);
+        std::pmr::vector<double> utilities = engine_.cfr_batch_recursive(lanes, traversing_player, rng, 0);
+        return std::vector<double>(utilities.begin(), utilities.end());
+    }
+
+    // cfr_interleaved for traversing_player with one strand per state, resumed round-robin as
+    // train() does; strand b draws from its own rng seeded with seeds[b]. Returns how many
+    // strands were parked (not done) after their first resume.
+    int traverse_interleaved(const std::vector<GameState>& states, const std::vector<std::vector<Card>>& decks,
+                             int traversing_player, const std::vector<unsigned>& seeds) {
+        std::vector<std::unique_ptr<TraversalStrand>> strands;
+        std::vector<std::mt19937> rngs(seeds.begin(), seeds.end());
+        std::vector<std::pmr::vector<double>> reach;
+        for (size_t b = 0; b < states.size(); ++b) reach.emplace_back(states[b].get_num_players(), 1.0);
+        for (size_t b = 0; b < states.size(); ++b) {
+            strands.push_back(std::make_unique<TraversalStrand>());
+            TraversalStrand& strand = *strands.back();
+            strand.start([&] {
+                return engine_.cfr_interleaved(strand, states[b], traversing_player, reach[b], decks[b],
+                                               2 * states[b].get_num_players(), rngs[b], 0);
+            });
+        }
+        int parked = 0;
+        for (bool first = true, active = true; active; first = false) {
+            active = false;
+            for (auto& strand : strands) {
+                if (strand->done()) continue;
+                strand->resume();
+                active = true;
+                if (first && !strand->done()) ++parked;
+            }
+        }
+        for (auto& strand : strands) strand->finish();
+        return parked;
+    }
+
+    // Stores the node player's decision at state would look up, with the engine's menu unless
+    // actions are given
+    Node* create_node(const GameState& state, int player, std::vector<ActionSpec> actions = {}) {
+        std::string key = InfoSet(state, player, engine_.history_encoding_).get_key();
+        if (actions.empty()) actions = engine_.action_abstraction_.get_possible_action_specs(state);
+        std::lock_guard<std::mutex> lock(engine_.node_map_mutex_);
+        return engine_.find_or_create_node_locked(key, actions, 0, thread_counters());
+    }
+
+    using Link = CFREngine::TrieLink;
+    using Decision = CFREngine::DecisionLookup;
+
+    bool lookup(const GameState& state, const Link& link, Decision& decision) {
+        return engine_.lookup_decision(state, state.get_current_player(), 0, false, link, decision, thread_counters());
+    }
+
+    bool advance(GameState& state, const Decision& decision, size_t slot, const std::vector<Card>& deck, Link& child) {
+        int card_idx = 2 * state.get_num_players();
+        return engine_.advance_decision(state, decision, slot, state.get_current_player(), deck, card_idx, child, thread_counters());
+    }
+
+    void enable_baselines(size_t slots) { engine_.baselines_.reset(slots); }
+    const ActionBaselines& baselines() const { return engine_.baselines_; }
+
+    size_t trie_entries() const { return engine_.trie_.entries(); }
+    size_t trie_hits() const { return engine_.trie_.hits(); }
+
+    // One cfr_simultaneous_recursive pass; utilities gets every player's sampled value
+    double traverse_simultaneous(const GameState& state, std::vector<Card>& deck, unsigned seed, std::vector<double>& utilities) {
+        std::pmr::vector<double> reach(state.get_num_players(), 1.0);
+        int card_idx = 2 * state.get_num_players();
+        std::mt19937 rng(seed);
+        utilities.assign(state.get_num_players(), 0.0);
+        return engine_.cfr_simultaneous_recursive(state, reach, 1.0, deck, card_idx, rng, 0, utilities.data(), CFREngine::TrieLink{});
+    }
+
+private:
+    CFREngine& engine_;
+};
+
+namespace {
+// Short six-max run with the periodic metrics off; the caller asserts what its mode changes.
+TrainingSnapshot train_quietly(CFREngine& engine, int iterations, TrainingOptions options, int threads = 1,
+                               const std::string& save_filename = "") {
+    options.metrics_interval_seconds = 0.0;
+    EXPECT_NO_THROW(engine.train(iterations, 6, 100, 0, threads, save_filename, 0, "", options));
+    return engine.get_training_snapshot();
+}
+
+// One deal as train() makes it: button on seat 0, sorted hands in seat order at the front of
+// the deck, the board cards after them.
+struct Deal {
+    GameState state;
+    std::vector<Card> deck;
+};
+
+Deal make_deal(std::vector<std::vector<Card>> hands) {
+    Deal deal{GameState(static_cast<int>(hands.size()), 100, 0, 0), {}};
+    for (auto& hand : hands) {
+        std::sort(hand.begin(), hand.end());
+        deal.deck.insert(deal.deck.end(), hand.begin(), hand.end());
+    }
+    for (char rank : std::string("AKQJT98765432")) {
+        for (char suit : std::string("shdc")) {
+            Card card{rank, suit};
+            if (std::find(deal.deck.begin(), deal.deck.end(), card) == deal.deck.end()) deal.deck.push_back(card);
+        }
+    }
+    deal.state.deal_hands(hands);
+    return deal;
+}
+
+void expect_same_node(const Node* actual, const Node* expected) {
+    ASSERT_NE(actual, nullptr);
+    ASSERT_NE(expected, nullptr);
+    ASSERT_EQ(actual->regret_sum.size(), expected->regret_sum.size());
+    for (size_t a = 0; a < expected->regret_sum.size(); ++a) {
+        EXPECT_DOUBLE_EQ(actual->regret_sum[a], expected->regret_sum[a]);
+        EXPECT_DOUBLE_EQ(actual->strategy_sum[a], expected->strategy_sum[a]);
+    }
+    EXPECT_EQ(actual->visit_count.load(), expected->visit_count.load());
+}
+
+// Same infosets with the same sums and visit counts
+void expect_same_tree(CFREngineTestPeer& actual, CFREngineTestPeer& expected) {
+    std::vector<std::string> keys = expected.keys();
+    ASSERT_FALSE(keys.empty());
+    EXPECT_EQ(actual.keys(), keys);
+    for (const std::string& key : keys) {
+        SCOPED_TRACE(key);
+        expect_same_node(actual.node(key), expected.node(key));
+    }
+}
+} // anonymous namespace
+
 TEST(CFREngineTest, TrainRunsSmokeTest) { // Renamed test
     CFREngine engine;
     // Run a small number of iterations with default HU parameters
@@ -50,6 +226,452 @@ TEST(CFREngineTest, TrainRunsSmokeTest) { // Renamed test
     // EXPECT_FALSE(strategy.empty()); // Check if strategy was generated
 }
 
+TEST(CFREngineTest, TrainingSnapshotReflectsRun) {
+    CFREngine engine;
+    engine.train(10, 2, 100, 0, 1);
+    TrainingSnapshot snapshot = engine.get_training_snapshot();
+    EXPECT_EQ(snapshot.iterations_completed, 10);
+    EXPECT_EQ(snapshot.target_iterations, 10);
+    EXPECT_EQ(snapshot.threads, 1);
+    EXPECT_FALSE(snapshot.has_exploitability);
+
+    engine.report_exploitability(12.5);
+    snapshot = engine.get_training_snapshot();
+    EXPECT_TRUE(snapshot.has_exploitability);
+    EXPECT_DOUBLE_EQ(snapshot.exploitability, 12.5);
+}
+
+TEST(CFREngineTest, MemoryBudgetCapsNodeStorage) {
+    CFREngine engine;
+    TrainingOptions options;
+    options.metrics_interval_seconds = 0.0;
+    options.max_memory_bytes = 64 * 1024; // A few hundred nodes at most
+    ASSERT_NO_THROW(engine.train(50, 6, 100, 0, 1, "", 0, "", options));
+    TrainingSnapshot snapshot = engine.get_training_snapshot();
+    EXPECT_EQ(snapshot.iterations_completed, 50);
+    EXPECT_GT(snapshot.nodes, 0);
+    EXPECT_LE(snapshot.node_store_bytes, options.max_memory_bytes);
+    EXPECT_EQ(snapshot.memory_budget_bytes, options.max_memory_bytes);
+}
+
+TEST(CFREngineTest, BufferedUpdatesReachTheNodes) {
+    CFREngine engine;
+    TrainingOptions options;
+    options.metrics_interval_seconds = 0.0;
+    options.update_buffer_interval = 10;
+    options.convergence_interval = 50; // Reports read the merged regrets
+    ASSERT_NO_THROW(engine.train(100, 6, 100, 0, 2, "", 0, "", options));
+    TrainingSnapshot snapshot = engine.get_training_snapshot();
+    EXPECT_EQ(snapshot.iterations_completed, 100);
+    EXPECT_GT(snapshot.nodes, 0);
+    ASSERT_TRUE(snapshot.has_convergence);
+    EXPECT_GT(snapshot.mean_positive_regret, 0.0);
+    EXPECT_EQ(snapshot.scratch_heap_allocations, 0); // Traversal temporaries stay in the warmed-up arenas
+}
+
+TEST(CFREngineTest, DeferredMaterialisationStoresFewerNodes) {
+    TrainingOptions options;
+    options.metrics_interval_seconds = 0.0;
+    CFREngine eager;
+    eager.train(60, 6, 100, 0, 1, "", 0, "", options);
+    long long eager_nodes = eager.get_training_snapshot().nodes;
+
+    options.materialize_after_visits = 2;
+    CFREngine deferred;
+    ASSERT_NO_THROW(deferred.train(60, 6, 100, 0, 1, "", 0, "", options));
+    TrainingSnapshot snapshot = deferred.get_training_snapshot();
+    EXPECT_EQ(snapshot.iterations_completed, 60);
+    EXPECT_GT(snapshot.nodes, 0);
+    EXPECT_LT(snapshot.nodes, eager_nodes); // Opponent-only infosets seen once have no node
+
+    // Batched lanes defer the same way
+    options.traversal_batch_size = 4;
+    CFREngine batched;
+    ASSERT_NO_THROW(batched.train(60, 6, 100, 0, 1, "", 0, "", options));
+    EXPECT_LT(batched.get_training_snapshot().nodes, eager_nodes);
+}
+
+TEST(CFREngineTest, BatchedTraversalTrainsAndCheckpoints) {
+    // One lane: the batched path makes the scalar path's draws and leaves its deltas
+    Deal deal = make_deal({{"Kd", "Kh"}, {"2d", "7c"}, {"Js", "Qs"}, {"Ac", "As"}, {"5d", "5h"}, {"8h", "9h"}});
+    CFREngine batched, scalar;
+    CFREngineTestPeer batch_peer(batched), scalar_peer(scalar);
+    std::vector<double> lane_utilities = batch_peer.traverse_batch({deal.state}, {deal.deck}, 3);
+    ASSERT_EQ(lane_utilities.size(), 1u);
+    EXPECT_DOUBLE_EQ(lane_utilities[0], scalar_peer.traverse(deal.state, deal.deck, 3));
+    expect_same_tree(batch_peer, scalar_peer);
+
+    // Lanes dealing seat 3 the same hand share its node and update it once per lane
+    std::vector<Deal> deals = {deal,
+                               make_deal({{"2d", "7c"}, {"Kd", "Kh"}, {"5d", "5h"}, {"Ac", "As"}, {"8h", "9h"}, {"Js", "Qs"}}),
+                               make_deal({{"Td", "Th"}, {"3c", "3d"}, {"6s", "7s"}, {"Ac", "As"}, {"Ad", "Kc"}, {"4h", "5s"}}),
+                               make_deal({{"Kd", "Kh"}, {"2d", "7c"}, {"Js", "Qs"}, {"8h", "9h"}, {"5d", "5h"}, {"Ac", "As"}})};
+    std::vector<GameState> states;
+    std::vector<std::vector<Card>> decks;
+    for (const Deal& d : deals) {
+        states.push_back(d.state);
+        decks.push_back(d.deck);
+    }
+    CFREngine lanes;
+    CFREngineTestPeer lanes_peer(lanes);
+    lanes_peer.traverse_batch(states, decks, 3);
+    Node* shared = lanes_peer.node(InfoSet(states[0], 3).get_key());
+    ASSERT_NE(shared, nullptr);
+    EXPECT_EQ(shared->visit_count.load(), 3);
+    for (double sum : shared->strategy_sum) EXPECT_DOUBLE_EQ(sum, 3.0 / shared->strategy_sum.size()); // Uniform, reach 1
+    Node* own = lanes_peer.node(InfoSet(states[3], 3).get_key());
+    ASSERT_NE(own, nullptr);
+    EXPECT_EQ(own->visit_count.load(), 1);
+
+    // A stored node with as many actions but other sizes (another abstraction) is left untouched
+    CFREngine resized;
+    CFREngineTestPeer resized_peer(resized);
+    std::vector<ActionSpec> menu = ActionAbstraction().get_possible_action_specs(deal.state);
+    ASSERT_GE(menu.size(), 2u);
+    menu.back().value += 1.0;
+    Node* other_sizes = resized_peer.create_node(deal.state, 3, menu);
+    ASSERT_NE(other_sizes, nullptr);
+    resized_peer.traverse_batch({deal.state}, {deal.deck}, 3);
+    EXPECT_EQ(other_sizes->visit_count.load(), 0);
+    for (size_t a = 0; a < menu.size(); ++a) {
+        EXPECT_EQ(other_sizes->regret_sum[a], 0.0);
+        EXPECT_EQ(other_sizes->strategy_sum[a], 0.0);
+    }
+
+    // A whole run with a partial last batch (60 = 7 x 8 + 4) checkpoints every node
+    const std::string checkpoint = "cfr_engine_batch_test.bin";
+    TrainingOptions options;
+    options.traversal_batch_size = 8;
+    options.convergence_interval = 30;
+    CFREngine engine;
+    TrainingSnapshot snapshot = train_quietly(engine, 60, options, 1, checkpoint);
+    EXPECT_EQ(snapshot.iterations_completed, 60);
+    EXPECT_EQ(snapshot.scratch_heap_allocations, 0); // Lanes, reach and per-frame arrays stay in the arena
+    CFREngine reloaded;
+    EXPECT_EQ(reloaded.load_checkpoint(checkpoint), 60);
+    CFREngineTestPeer reloaded_peer(reloaded), engine_peer(engine);
+    EXPECT_EQ(reloaded_peer.keys(), engine_peer.keys());
+    std::remove(checkpoint.c_str());
+}
+
+TEST(CFREngineTest, InterleavedTraversalTrains) {
+    // Strands over deals that share no infoset leave exactly the nodes of the scalar
+    // traversals with the same draws, although their frames run interleaved
+    std::vector<std::vector<Card>> hands = {{"Kd", "Kh"}, {"2d", "7c"}, {"Js", "Qs"}, {"Ac", "As"}, {"5d", "5h"}, {"8h", "9h"}};
+    std::vector<GameState> states;
+    std::vector<std::vector<Card>> decks;
+    for (int rotation = 0; rotation < 3; ++rotation) { // Every seat holds a different hand in every deal
+        Deal deal = make_deal(hands);
+        states.push_back(deal.state);
+        decks.push_back(deal.deck);
+        std::rotate(hands.begin(), hands.begin() + 1, hands.end());
+    }
+    const std::vector<unsigned> seeds = {11, 12, 13};
+    CFREngine interleaved, scalar;
+    CFREngineTestPeer interleaved_peer(interleaved), scalar_peer(scalar);
+    EXPECT_EQ(interleaved_peer.traverse_interleaved(states, decks, 3, seeds), 3); // Each yields at its root
+    for (size_t b = 0; b < states.size(); ++b) scalar_peer.traverse(states[b], decks[b], 3, seeds[b]);
+    expect_same_tree(interleaved_peer, scalar_peer);
+
+    // A whole run; its last step runs 2 of the 4 strands
+    TrainingOptions options;
+    options.interleaved_traversals = 4;
+    options.convergence_interval = 30;
+    CFREngine engine;
+    TrainingSnapshot snapshot = train_quietly(engine, 62, options);
+    EXPECT_EQ(snapshot.iterations_completed, 62);
+    EXPECT_EQ(snapshot.scratch_heap_allocations, 0); // Coroutine frames stay in the strand arenas
+}
+
+TEST(CFREngineTest, SimultaneousUpdatesTrainEveryPlayerInOnePass) {
+    // Seat 3 raises and the next three fold; the blinds are seeded to fold as well
+    Deal deal = make_deal({{"Kd", "Kh"}, {"2d", "7c"}, {"Js", "Qs"}, {"Ac", "As"}, {"5d", "5h"}, {"8h", "9h"}});
+    GameState spot = deal.state;
+    spot.apply_action({Action::Type::RAISE, 6, 3});
+    for (int seat : {4, 5, 0}) spot.apply_action({Action::Type::FOLD, 0, seat});
+    ASSERT_EQ(spot.get_current_player(), 1);
+    const double sb_blind = spot.get_bet_this_round(1);
+    const double bb_blind = spot.get_bet_this_round(2);
+    GameState bb_spot = spot;
+    bb_spot.apply_action({Action::Type::FOLD, 0, 1});
+
+    // One pass that samples both folds, i.e. the whole line, updates both seats' nodes
+    for (unsigned seed = 1; seed <= 200; ++seed) {
+        CFREngine engine;
+        CFREngineTestPeer peer(engine);
+        Node* nodes[2] = {peer.create_node(spot, 1), peer.create_node(bb_spot, 2)};
+        size_t folds[2];
+        double sampling[2]; // 0.6 exploration mixed with the pure fold
+        for (int i = 0; i < 2; ++i) {
+            ASSERT_NE(nodes[i], nullptr);
+            const auto& actions = nodes[i]->legal_actions;
+            auto fold = std::find_if(actions.begin(), actions.end(), [](const ActionSpec& a) { return a.type == ActionType::FOLD; });
+            ASSERT_NE(fold, actions.end());
+            folds[i] = fold - actions.begin();
+            nodes[i]->regret_sum[folds[i]] = 1.0;
+            sampling[i] = 0.6 / actions.size() + 0.4;
+        }
+        std::vector<double> utilities;
+        if (peer.traverse_simultaneous(spot, deal.deck, seed, utilities) != 1.0) continue; // Left the fold line
+
+        const double q = sampling[0] * sampling[1];
+        EXPECT_DOUBLE_EQ(utilities[1], -sb_blind / q);
+        EXPECT_DOUBLE_EQ(utilities[2], -bb_blind / q);
+        EXPECT_DOUBLE_EQ(utilities[3], (sb_blind + bb_blind) / q);
+        const double lost[2] = {sb_blind, bb_blind};
+        const double reached[2] = {1.0, 1.0 / sampling[0]}; // Own reach over the probability of sampling the node
+        for (int i = 0; i < 2; ++i) {
+            SCOPED_TRACE(i);
+            EXPECT_EQ(nodes[i]->visit_count.load(), 1);
+            for (size_t a = 0; a < nodes[i]->regret_sum.size(); ++a) {
+                // Not folding would have saved the blind the sampled line lost
+                EXPECT_DOUBLE_EQ(nodes[i]->regret_sum[a], a == folds[i] ? 1.0 : lost[i] / q);
+                EXPECT_DOUBLE_EQ(nodes[i]->strategy_sum[a], a == folds[i] ? reached[i] : 0.0);
+            }
+        }
+        // A whole run takes one sampled line per deal, so it stores fewer nodes than per-player traversals
+        TrainingOptions options;
+        CFREngine per_player;
+        train_quietly(per_player, 60, options);
+        options.simultaneous_updates = true;
+        CFREngine simultaneous;
+        EXPECT_LT(train_quietly(simultaneous, 60, options).nodes, per_player.get_training_snapshot().nodes);
+        return;
+    }
+    FAIL() << "No seed sampled the fold line";
+}
+
+TEST(CFREngineTest, InfosetTrieTrainsBothTraversals) {
+    // Through the trie a decision resolves to the node and key of the key path, at the root
+    // (button seat 0) and one decision below it
+    Deal deal = make_deal({{"Kd", "Kh"}, {"2d", "7c"}, {"Js", "Qs"}, {"Ac", "As"}, {"5d", "5h"}, {"8h", "9h"}});
+    CFREngine engine;
+    CFREngineTestPeer peer(engine);
+    GameState state = deal.state;
+    CFREngineTestPeer::Link link{true, nullptr, 0};
+    for (int level = 0; level < 2; ++level) {
+        SCOPED_TRACE(level);
+        CFREngineTestPeer::Decision miss, hit, by_key;
+        ASSERT_TRUE(peer.lookup(state, link, miss)); // Builds the key and caches the node
+        ASSERT_TRUE(peer.lookup(state, link, hit));
+        ASSERT_TRUE(peer.lookup(state, CFREngineTestPeer::Link{}, by_key));
+        EXPECT_FALSE(hit.info_set.has_value()); // Followed the pointer without building a key
+        EXPECT_EQ(peer.trie_entries(), level + 1u);
+        EXPECT_EQ(peer.trie_hits(), level + 1u);
+        ASSERT_NE(by_key.node, nullptr);
+        EXPECT_EQ(miss.node, by_key.node);
+        EXPECT_EQ(hit.node, by_key.node);
+        EXPECT_EQ(*hit.key, InfoSet(state, state.get_current_player()).get_key());
+        EXPECT_EQ(peer.node(*hit.key), hit.node);
+        // Fold, the first slot, keeps the hand going with the next seat
+        ASSERT_EQ(hit.node->legal_actions[0].type, ActionType::FOLD);
+        CFREngineTestPeer::Link child;
+        ASSERT_TRUE(peer.advance(state, hit, 0, deal.deck, child));
+        EXPECT_TRUE(child.active);
+        link = child;
+    }
+
+    // A stored node with another menu (a tree built with other sizes) keeps the key path
+    CFREngine loaded;
+    CFREngineTestPeer loaded_peer(loaded);
+    Node* other_menu = loaded_peer.create_node(deal.state, 3, {ActionSpec{ActionType::FOLD}});
+    ASSERT_NE(other_menu, nullptr);
+    for (int lookup = 0; lookup < 2; ++lookup) {
+        CFREngineTestPeer::Decision decision;
+        ASSERT_TRUE(loaded_peer.lookup(deal.state, CFREngineTestPeer::Link{true, nullptr, 0}, decision));
+        EXPECT_EQ(decision.node, other_menu);
+        EXPECT_TRUE(decision.info_set.has_value());
+        EXPECT_EQ(decision.actions->size(), 1u);
+    }
+    EXPECT_EQ(loaded_peer.trie_entries(), 0u);
+    EXPECT_EQ(loaded_peer.trie_hits(), 0u);
+
+    // Whole runs follow the pointers in both traversals; two workers share the trie
+    TrainingOptions options;
+    options.infoset_trie = true;
+    CFREngine trained;
+    TrainingSnapshot snapshot = train_quietly(trained, 60, options, 2);
+    EXPECT_TRUE(snapshot.has_trie);
+    EXPECT_GT(snapshot.trie_entries, 0);
+    EXPECT_GT(snapshot.trie_hits, 0);
+
+    // One sampled line per deal only meets a cached hand again in a later deal
+    options.simultaneous_updates = true;
+    CFREngine sampled;
+    snapshot = train_quietly(sampled, 1000, options);
+    EXPECT_TRUE(snapshot.has_trie);
+    EXPECT_GT(snapshot.trie_entries, 0);
+    EXPECT_GT(snapshot.trie_hits, 0);
+}
+
+TEST(CFREngineTest, ActionBaselinesTrainExternalSampling) {
+    // Traversing one deal twice with the same seed samples the same opponent decisions (only the
+    // traverser's regrets move), so the second pass corrects every estimate with the values
+    // the first one stored, in the scalar and the interleaved path alike
+    Deal deal = make_deal({{"Kd", "Kh"}, {"2d", "7c"}, {"Js", "Qs"}, {"Ac", "As"}, {"5d", "5h"}, {"8h", "9h"}});
+    CFREngine scalar, interleaved;
+    CFREngineTestPeer scalar_peer(scalar), interleaved_peer(interleaved);
+    scalar_peer.enable_baselines(1 << 12);
+    interleaved_peer.enable_baselines(1 << 12);
+    scalar_peer.traverse(deal.state, deal.deck, 4, 7);
+    interleaved_peer.traverse_interleaved({deal.state}, {deal.deck}, 4, {7});
+    const long long first_pass = scalar_peer.baselines().estimates();
+    EXPECT_GT(first_pass, 0);
+    EXPECT_EQ(scalar_peer.baselines().corrected(), 0);
+    EXPECT_EQ(interleaved_peer.baselines().estimates(), first_pass);
+    EXPECT_EQ(interleaved_peer.baselines().corrected(), 0);
+    scalar_peer.traverse(deal.state, deal.deck, 4, 7);
+    interleaved_peer.traverse_interleaved({deal.state}, {deal.deck}, 4, {7});
+    for (CFREngineTestPeer* peer : {&scalar_peer, &interleaved_peer}) {
+        EXPECT_EQ(peer->baselines().estimates(), 2 * first_pass);
+        EXPECT_EQ(peer->baselines().corrected(), first_pass);
+    }
+
+    // Whole runs report what went through the table
+    auto expect_estimated = [](const TrainingSnapshot& snapshot) {
+        EXPECT_TRUE(snapshot.has_baselines);
+        EXPECT_GT(snapshot.baseline_estimates, 0);
+        EXPECT_LE(snapshot.baseline_corrected, snapshot.baseline_estimates);
+    };
+    TrainingOptions options;
+    options.action_baselines = true;
+    CFREngine engine;
+    expect_estimated(train_quietly(engine, 60, options, 2));
+    options.interleaved_traversals = 4;
+    CFREngine strands;
+    expect_estimated(train_quietly(strands, 60, options));
+    CFREngine plain;
+    EXPECT_FALSE(train_quietly(plain, 10, TrainingOptions{}).has_baselines);
+}
+
+TEST(CFREngineTest, CompactHistoryKeysSurviveCheckpoint) {
+    const std::string checkpoint = "cfr_engine_compact_history_test.bin";
+    CFREngine engine;
+    TrainingOptions options;
+    options.metrics_interval_seconds = 0.0;
+    options.history_encoding = HistoryEncoding::ACTIONS;
+    ASSERT_NO_THROW(engine.train(40, 6, 100, 0, 1, checkpoint, 0, "", options));
+    EXPECT_EQ(engine.history_encoding(), HistoryEncoding::ACTIONS);
+    EXPECT_GT(engine.get_training_snapshot().nodes, 0);
+
+    // The checkpoint's encoding wins over the options of the run that resumes it
+    CFREngine resumed;
+    TrainingOptions resume_options;
+    resume_options.metrics_interval_seconds = 0.0;
+    ASSERT_NO_THROW(resumed.train(60, 6, 100, 0, 1, "", 0, checkpoint, resume_options));
+    EXPECT_EQ(resumed.history_encoding(), HistoryEncoding::ACTIONS);
+    EXPECT_EQ(resumed.get_training_snapshot().iterations_completed, 60);
+    std::remove(checkpoint.c_str());
+}
+
+TEST(CFREngineTest, ShardedTrainingOverLoopbackSavesOwnedKeys) {
+    // Two free loopback ports for the two shard processes
+    std::vector<ShardEndpoint> endpoints;
+    for (int shard = 0; shard < 2; ++shard) {
+        int port = 0;
+        int fd = listen_tcp(0, 1, &port);
+        ASSERT_GE(fd, 0);
+        ::close(fd);
+        endpoints.push_back(ShardEndpoint{"127.0.0.1", port});
+    }
+    const std::string checkpoint = "cfr_engine_shard_test.bin";
+    auto run_shard = [&](int shard_id) {
+        CFREngine engine;
+        TrainingOptions options;
+        options.metrics_interval_seconds = 0.0;
+        options.shard_endpoints = endpoints;
+        options.shard_id = shard_id;
+        options.shard_sync_seconds = 0.02;
+        engine.train(40, 6, 100, 0, 1, checkpoint, 0, "", options);
+    };
+    pid_t child = ::fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        run_shard(1);
+        ::_exit(0);
+    }
+    run_shard(0);
+    int status = 0;
+    ASSERT_EQ(::waitpid(child, &status, 0), child);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    // Each shard file holds only (and some of) the keys its shard owns
+    for (int shard = 0; shard < 2; ++shard) {
+        std::string filename = shard_checkpoint_filename(checkpoint, shard, 2);
+        std::ifstream ifs(filename, std::ios::binary);
+        ASSERT_TRUE(ifs) << filename;
+        CheckpointHeader header;
+        ASSERT_TRUE(read_checkpoint_header(ifs, header));
+        EXPECT_EQ(header.shard_id, static_cast<uint32_t>(shard));
+        EXPECT_EQ(header.num_shards, 2u);
+        EXPECT_EQ(header.completed_iterations, 40);
+        EXPECT_GT(header.map_size, 0u);
+        for (size_t i = 0; i < header.map_size; ++i) {
+            std::string key;
+            std::unique_ptr<Node> node;
+            ASSERT_TRUE(read_node_record(ifs, key, node));
+            EXPECT_EQ(shard_of(key, 2), static_cast<size_t>(shard)) << key;
+        }
+        ifs.close();
+        std::remove(filename.c_str());
+    }
+}
+
+TEST(CFREngineTest, ForkedWorkersTrainOneSharedStore) {
+    SharedNodeStore store;
+    ASSERT_TRUE(store.create("/gto_solver_engine_test_" + std::to_string(::getpid()), 64 << 20));
+    store.set_history_encoding(HistoryEncoding::ACTIONS);
+    std::vector<pid_t> children;
+    for (int worker = 0; worker < 2; ++worker) {
+        pid_t pid = ::fork();
+        ASSERT_GE(pid, 0);
+        if (pid == 0) {
+            CFREngine engine;
+            TrainingOptions options;
+            options.metrics_interval_seconds = 0.0;
+            options.shared_store = &store;
+            engine.train(30, 6, 100, 0, 1, "", 0, "", options);
+            ::_exit(engine.history_encoding() == HistoryEncoding::ACTIONS ? 0 : 1);
+        }
+        children.push_back(pid);
+    }
+    for (pid_t pid : children) {
+        int status = 0;
+        ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+        EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+    EXPECT_EQ(store.completed_iterations(), 60);
+    EXPECT_GT(store.stats().entries, 0);
+    EXPECT_EQ(store.stats().refused, 0);
+
+    // The parent's checkpoint of the store is an ordinary engine checkpoint
+    const std::string checkpoint = "cfr_engine_shared_store_test.bin";
+    ASSERT_TRUE(store.save_checkpoint(checkpoint));
+    CFREngine engine;
+    EXPECT_EQ(engine.load_checkpoint(checkpoint), 60);
+    EXPECT_EQ(engine.history_encoding(), HistoryEncoding::ACTIONS);
+    std::remove(checkpoint.c_str());
+}
+
+TEST(CFREngineTest, SpillsColdNodesAndSavesBothTiers) {
+    const std::string checkpoint = "cfr_engine_spill_test.bin";
+    CFREngine engine;
+    TrainingOptions options;
+    options.metrics_interval_seconds = 0.0;
+    options.max_memory_bytes = 64 * 1024;
+    options.spill_filename = "cfr_engine_spill_test.spill";
+    ASSERT_NO_THROW(engine.train(200, 6, 100, 0, 1, checkpoint, 0, "", options));
+    TrainingSnapshot snapshot = engine.get_training_snapshot();
+    EXPECT_TRUE(snapshot.has_cold_tier);
+    EXPECT_GT(snapshot.cold_evicted, 0);
+    EXPECT_LE(snapshot.node_store_bytes, options.max_memory_bytes);
+
+    // The final checkpoint merges RAM and disk; loading it must see every node
+    CFREngine reloaded;
+    EXPECT_EQ(reloaded.load_checkpoint(checkpoint), 200);
+    std::remove(checkpoint.c_str());
+}
+
 TEST(CFREngineTest, GetStrategyFromRegrets) {
     // Test case 1: All positive regrets
     std::vector<double> regrets1 = {10.0, 20.0, 30.0};
@@ -0,0 +1,104 @@
+#include "gtest/gtest.h"
+#include "checkpoint_compact.h"
+#include "checkpoint_merge.h"
+#include "node_serialization.h"
+
+#include <algorithm> // For std::is_sorted
+#include <cstdio> // For std::remove
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace gto_solver {
+
+namespace {
+struct TestRecord {
+    std::string key;
+    int visits;
+    double regret;
+};
+
+void write_checkpoint(const std::string& path, const std::vector<TestRecord>& records) {
+    std::ofstream os(path, std::ios::binary | std::ios::trunc);
+    CheckpointHeader header;
+    header.completed_iterations = 77;
+    header.map_size = records.size();
+    ASSERT_TRUE(write_checkpoint_header(os, header));
+    std::vector<ActionSpec> actions = {ActionSpec{ActionType::FOLD}, ActionSpec{ActionType::CALL}};
+    for (const TestRecord& record : records) {
+        double regrets[2] = {record.regret, -1.0}, strategy[2] = {1.0, 1.0};
+        ASSERT_TRUE(write_node_record(os, record.key, actions, regrets, strategy, record.visits));
+    }
+    long long nodes_created = static_cast<long long>(records.size());
+    os.write(reinterpret_cast<const char*>(&nodes_created), sizeof(nodes_created));
+}
+
+std::vector<std::string> read_keys(const std::string& path, CheckpointHeader& header) {
+    std::ifstream is(path, std::ios::binary);
+    EXPECT_TRUE(read_checkpoint_header(is, header));
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < header.map_size; ++i) {
+        std::string key;
+        std::unique_ptr<Node> node;
+        EXPECT_TRUE(read_node_record(is, key, node));
+        keys.push_back(key);
+    }
+    return keys;
+}
+} // anonymous namespace
+
+TEST(CheckpointCompactTest, TreeOrderIsDepthFirstOverActions) {
+    // String order would put "r20/" between "r2/" and its extension "r2/c/"
+    EXPECT_TRUE(compare_tree_order("P0:AcAd|0|0----------|r2/", "P0:AcAd|0|0----------|r2/c/", HistoryEncoding::CHIPS));
+    EXPECT_TRUE(compare_tree_order("P1:2c2d|0|0----------|r2/c/", "P0:AcAd|0|0----------|r20/", HistoryEncoding::CHIPS));
+    EXPECT_FALSE(compare_tree_order("P0:AcAd|0|0----------|r20/", "P1:2c2d|0|0----------|r2/c/", HistoryEncoding::CHIPS));
+    // Same public node: board, then street, then seat / hand
+    EXPECT_TRUE(compare_tree_order("P5:KcKd|1|3AcKd2h----|c/", "P0:AcAd|1|3AcKd3h----|c/", HistoryEncoding::CHIPS));
+    EXPECT_TRUE(compare_tree_order("P0:AcAd|0|0----------|c/", "P1:AcAd|0|0----------|c/", HistoryEncoding::CHIPS));
+    // Compact histories: one byte per action, and '|' bytes stay in the history
+    EXPECT_TRUE(compare_tree_order("P0:AcAd|0|0----------|a|", "P0:AcAd|0|0----------|a|b", HistoryEncoding::ACTIONS));
+    EXPECT_TRUE(compare_tree_order("P0:AcAd|0|0----------|", "P0:AcAd|0|0----------|a", HistoryEncoding::ACTIONS));
+}
+
+TEST(CheckpointCompactTest, PrunesAndReordersRecords) {
+    write_checkpoint("compact_test_in.bin", {
+        {"P0:AcAd|0|0----------|", 50, 3.0},
+        {"P0:AcAd|0|0----------|r2/", 20, 3.0},
+        {"P0:AcAd|0|0----------|r2/c/", 1, 3.0},     // Too few visits
+        {"P0:AcAd|0|0----------|r20/", 30, 0.5},     // Too little regret mass
+        {"P1:KcKd|0|0----------|r2/c/", 10, 2.0},
+    });
+    CheckpointCompactOptions options;
+    options.min_visits = 5;
+    options.min_regret_mass = 1.0;
+    CheckpointCompactStats stats;
+    ASSERT_TRUE(compact_checkpoint("compact_test_in.bin", "compact_test_out.bin", options, &stats));
+    EXPECT_EQ(stats.records_read, 5u);
+    EXPECT_EQ(stats.records_written, 3u);
+    EXPECT_EQ(stats.pruned_visits, 1u);
+    EXPECT_EQ(stats.pruned_regret, 1u);
+    EXPECT_LT(stats.bytes_written, stats.bytes_read);
+
+    CheckpointHeader header;
+    std::vector<std::string> keys = read_keys("compact_test_out.bin", header);
+    EXPECT_EQ(header.key_order, CheckpointKeyOrder::TREE);
+    EXPECT_EQ(header.completed_iterations, 77);
+    EXPECT_EQ(keys, (std::vector<std::string>{"P0:AcAd|0|0----------|", "P0:AcAd|0|0----------|r2/", "P1:KcKd|0|0----------|r2/c/"}));
+
+    // Merge needs sorted keys: tree-ordered checkpoints are refused until re-sorted
+    CheckpointMergeOptions merge_options;
+    merge_options.inputs = {"compact_test_out.bin"};
+    EXPECT_FALSE(merge_checkpoints(merge_options, "compact_test_merged.bin"));
+    options = CheckpointCompactOptions();
+    options.key_order = CheckpointKeyOrder::SORTED;
+    ASSERT_TRUE(compact_checkpoint("compact_test_out.bin", "compact_test_sorted.bin", options));
+    keys = read_keys("compact_test_sorted.bin", header);
+    EXPECT_EQ(header.key_order, CheckpointKeyOrder::SORTED);
+    EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+    merge_options.inputs = {"compact_test_sorted.bin"};
+    EXPECT_TRUE(merge_checkpoints(merge_options, "compact_test_merged.bin"));
+
+    for (const char* path : {"compact_test_in.bin", "compact_test_out.bin", "compact_test_sorted.bin", "compact_test_merged.bin"}) std::remove(path);
+}
+
+} // namespace gto_solver
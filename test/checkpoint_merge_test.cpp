@@ -0,0 +1,181 @@
+#include "gtest/gtest.h"
+#include "checkpoint_merge.h"
+#include "node_serialization.h"
+
+#include <cstdio>  // For std::remove
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace gto_solver {
+
+namespace {
+struct TestRecord {
+    std::vector<double> regrets;
+    std::vector<double> strategy;
+    int visits = 0;
+};
+
+std::vector<ActionSpec> fold_call() {
+    ActionSpec fold{ActionType::FOLD};
+    ActionSpec call{ActionType::CALL};
+    fold.action_set = call.action_set = ActionSetId::VS_OPEN;
+    fold.abstract_action = AbstractAction::FOLD;
+    call.abstract_action = AbstractAction::CALL;
+    return {fold, call};
+}
+
+void write_checkpoint(const std::string& path, const std::map<std::string, TestRecord>& records, int iterations) {
+    std::ofstream os(path, std::ios::binary | std::ios::trunc);
+    CheckpointHeader header;
+    header.completed_iterations = iterations;
+    header.map_size = records.size();
+    ASSERT_TRUE(write_checkpoint_header(os, header));
+    for (const auto& [key, record] : records) {
+        ASSERT_TRUE(write_node_record(os, key, fold_call(), record.regrets.data(), record.strategy.data(), record.visits));
+    }
+    long long nodes_created = static_cast<long long>(records.size());
+    os.write(reinterpret_cast<const char*>(&nodes_created), sizeof(nodes_created));
+}
+
+// Version 4 layout: no history encoding / shard fields, no compact-history tags
+void write_v4_checkpoint(const std::string& path, const std::map<std::string, TestRecord>& records, int iterations) {
+    std::ofstream os(path, std::ios::binary | std::ios::trunc);
+    uint32_t version = 4;
+    size_t map_size = records.size();
+    os.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    os.write(reinterpret_cast<const char*>(&iterations), sizeof(iterations));
+    os.write(reinterpret_cast<const char*>(&map_size), sizeof(map_size));
+    for (const auto& [key, record] : records) {
+        size_t key_len = key.size(), count = 2;
+        os.write(reinterpret_cast<const char*>(&key_len), sizeof(key_len));
+        os.write(key.data(), key_len);
+        os.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        for (const ActionSpec& spec : fold_call()) {
+            os.write(reinterpret_cast<const char*>(&spec.type), sizeof(spec.type));
+            os.write(reinterpret_cast<const char*>(&spec.value), sizeof(spec.value));
+            os.write(reinterpret_cast<const char*>(&spec.unit), sizeof(spec.unit));
+        }
+        os.write(reinterpret_cast<const char*>(record.regrets.data()), 2 * sizeof(double));
+        os.write(reinterpret_cast<const char*>(record.strategy.data()), 2 * sizeof(double));
+        os.write(reinterpret_cast<const char*>(&record.visits), sizeof(record.visits));
+    }
+    long long nodes_created = static_cast<long long>(map_size);
+    os.write(reinterpret_cast<const char*>(&nodes_created), sizeof(nodes_created));
+}
+
+CheckpointHeader read_checkpoint(const std::string& path, std::map<std::string, std::unique_ptr<Node>>& nodes) {
+    std::ifstream is(path, std::ios::binary);
+    CheckpointHeader header;
+    EXPECT_TRUE(read_checkpoint_header(is, header));
+    std::string previous;
+    for (size_t i = 0; i < header.map_size; ++i) {
+        std::string key;
+        std::unique_ptr<Node> node;
+        EXPECT_TRUE(read_node_record(is, key, node));
+        EXPECT_LT(previous, key); // Output stays sorted
+        previous = key;
+        nodes[key] = std::move(node);
+    }
+    long long nodes_created = 0;
+    is.read(reinterpret_cast<char*>(&nodes_created), sizeof(nodes_created));
+    EXPECT_EQ(nodes_created, static_cast<long long>(header.map_size));
+    return header;
+}
+} // anonymous namespace
+
+TEST(CheckpointMergeTest, SumsOverlappingKeysAndUpgradesOldInputs) {
+    write_checkpoint("merge_test_a.bin", {{"k1", {{1, -2}, {3, 4}, 5}}, {"k2", {{1, 1}, {1, 1}, 1}}}, 100);
+    write_v4_checkpoint("merge_test_b.bin", {{"k2", {{2, 3}, {5, 7}, 2}}, {"k3", {{9, 9}, {9, 9}, 9}}}, 50);
+
+    CheckpointMergeOptions options;
+    options.inputs = {"merge_test_a.bin", "merge_test_b.bin"};
+    CheckpointMergeStats stats;
+    ASSERT_TRUE(merge_checkpoints(options, "merge_test_out.bin", &stats));
+    EXPECT_EQ(stats.records_read, 4u);
+    EXPECT_EQ(stats.keys_written, 3u);
+
+    std::map<std::string, std::unique_ptr<Node>> nodes;
+    CheckpointHeader header = read_checkpoint("merge_test_out.bin", nodes);
+    EXPECT_EQ(header.version, CHECKPOINT_VERSION_BIN);
+    EXPECT_EQ(header.completed_iterations, 150);
+    ASSERT_EQ(nodes.size(), 3u);
+    EXPECT_EQ(nodes["k2"]->regret_sum, (std::vector<double>{3, 4}));
+    EXPECT_EQ(nodes["k2"]->strategy_sum, (std::vector<double>{6, 8}));
+    EXPECT_EQ(nodes["k2"]->visit_count.load(), 3);
+    EXPECT_EQ(nodes["k1"]->regret_sum, (std::vector<double>{1, -2}));
+    // v4 records only come with untagged specs; the tagged copy of the key wins
+    EXPECT_EQ(nodes["k2"]->legal_actions[1].abstract_action, AbstractAction::CALL);
+    EXPECT_EQ(nodes["k3"]->legal_actions[1].action_set, ActionSetId::UNTAGGED);
+
+    for (const char* path : {"merge_test_a.bin", "merge_test_b.bin", "merge_test_out.bin"}) std::remove(path);
+}
+
+TEST(CheckpointMergeTest, WeightedAverage) {
+    write_checkpoint("merge_test_a.bin", {{"k", {{4, 0}, {8, 0}, 10}}}, 100);
+    write_checkpoint("merge_test_b.bin", {{"k", {{0, 4}, {0, 8}, 20}}}, 200);
+    CheckpointMergeOptions options;
+    options.inputs = {"merge_test_a.bin", "merge_test_b.bin"};
+    options.weights = {3, 1};
+    options.mode = MergeMode::AVERAGE;
+    ASSERT_TRUE(merge_checkpoints(options, "merge_test_out.bin"));
+    std::map<std::string, std::unique_ptr<Node>> nodes;
+    CheckpointHeader header = read_checkpoint("merge_test_out.bin", nodes);
+    EXPECT_EQ(header.completed_iterations, 125);
+    EXPECT_EQ(nodes["k"]->regret_sum, (std::vector<double>{3, 1}));
+    EXPECT_EQ(nodes["k"]->strategy_sum, (std::vector<double>{6, 2}));
+    EXPECT_EQ(nodes["k"]->visit_count.load(), 13); // 12.5 rounded
+
+    options.weights = {1};
+    EXPECT_FALSE(merge_checkpoints(options, "merge_test_out.bin")); // One weight per input
+    for (const char* path : {"merge_test_a.bin", "merge_test_b.bin", "merge_test_out.bin"}) std::remove(path);
+}
+
+TEST(CheckpointMergeTest, PartitionedMergeMatchesSequentialMerge) {
+    // Enough records for several sparse-index entries per input
+    std::map<std::string, TestRecord> a, b, c;
+    for (int i = 0; i < 30000; ++i) {
+        std::string key = "P" + std::to_string(i % 6) + "|" + std::to_string(i * 7919 % 100003);
+        TestRecord record{{double(i), -double(i)}, {1.0, 2.0}, 1};
+        if (i % 2 == 0) a[key] = record;
+        if (i % 3 == 0) b[key] = record;
+        if (i % 5 != 0) c[key] = record;
+    }
+    write_checkpoint("merge_test_a.bin", a, 10);
+    write_checkpoint("merge_test_b.bin", b, 20);
+    write_checkpoint("merge_test_c.bin", c, 30);
+
+    CheckpointMergeOptions options;
+    options.inputs = {"merge_test_a.bin", "merge_test_b.bin", "merge_test_c.bin"};
+    ASSERT_TRUE(merge_checkpoints(options, "merge_test_seq.bin"));
+    options.partitions = 4;
+    CheckpointMergeStats stats;
+    ASSERT_TRUE(merge_checkpoints(options, "merge_test_par.bin", &stats));
+    EXPECT_EQ(stats.keys_written, 28000u); // Odd, non-multiple of 3, multiple of 5: in no input
+    EXPECT_EQ(stats.records_read, a.size() + b.size() + c.size());
+
+    std::ifstream seq("merge_test_seq.bin", std::ios::binary), par("merge_test_par.bin", std::ios::binary);
+    std::string seq_bytes((std::istreambuf_iterator<char>(seq)), std::istreambuf_iterator<char>());
+    std::string par_bytes((std::istreambuf_iterator<char>(par)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(seq_bytes, par_bytes);
+    for (const char* path : {"merge_test_a.bin", "merge_test_b.bin", "merge_test_c.bin", "merge_test_seq.bin", "merge_test_par.bin"}) std::remove(path);
+}
+
+TEST(CheckpointMergeTest, RejectsUnsortedInput) {
+    std::ofstream os("merge_test_a.bin", std::ios::binary | std::ios::trunc);
+    CheckpointHeader header;
+    header.map_size = 2;
+    write_checkpoint_header(os, header);
+    TestRecord record{{0, 0}, {0, 0}, 0};
+    for (const char* key : {"b", "a"}) write_node_record(os, key, fold_call(), record.regrets.data(), record.strategy.data(), 0);
+    os.close();
+    CheckpointMergeOptions options;
+    options.inputs = {"merge_test_a.bin"};
+    EXPECT_FALSE(merge_checkpoints(options, "merge_test_out.bin"));
+    std::ifstream out("merge_test_out.bin");
+    EXPECT_FALSE(out.good()); // No partial output left behind
+    std::remove("merge_test_a.bin");
+}
+
+} // namespace gto_solver
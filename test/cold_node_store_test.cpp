@@ -0,0 +1,107 @@
+#include "gtest/gtest.h"
+#include "cold_node_store.h"
+#include "node_serialization.h"
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace gto_solver {
+
+namespace {
+std::unique_ptr<Node> make_node(double regret, int visits) {
+    std::vector<ActionSpec> actions = {{ActionType::FOLD}, {ActionType::CALL}, {ActionType::RAISE, 2.5, SizingUnit::MULTIPLIER_X}};
+    auto node = std::make_unique<Node>(actions);
+    node->regret_sum = {regret, -regret, 0.5};
+    node->strategy_sum = {1.0, 2.0, 3.0};
+    node->visit_count = visits;
+    return node;
+}
+} // anonymous namespace
+
+TEST(NodeSerializationTest, RoundTripsARecord) {
+    std::stringstream ss;
+    auto node = make_node(1.5, 7);
+    ASSERT_TRUE(write_node_record(ss, "P0:AcKd|0|0----------|", *node));
+    std::string key;
+    std::unique_ptr<Node> loaded;
+    ASSERT_TRUE(read_node_record(ss, key, loaded));
+    EXPECT_EQ(key, "P0:AcKd|0|0----------|");
+    EXPECT_EQ(loaded->regret_sum, node->regret_sum);
+    EXPECT_EQ(loaded->strategy_sum, node->strategy_sum);
+    EXPECT_EQ(loaded->visit_count.load(), 7);
+    ASSERT_EQ(loaded->legal_actions.size(), 3u);
+    EXPECT_EQ(loaded->legal_actions[2].type, ActionType::RAISE);
+    EXPECT_DOUBLE_EQ(loaded->legal_actions[2].value, 2.5);
+}
+
+TEST(NodeSerializationTest, RoundTripsAWideNode) {
+    // More actions than a Node holds inline: the values live on the heap
+    std::vector<ActionSpec> actions(ActionValues::kInlineActions + 3, ActionSpec{ActionType::RAISE, 1.0, SizingUnit::MULTIPLIER_X});
+    Node node(actions);
+    for (size_t a = 0; a < actions.size(); ++a) node.regret_sum[a] = node.strategy_sum[a] = 0.5 * a;
+    std::stringstream ss;
+    ASSERT_TRUE(write_node_record(ss, "wide", node));
+    std::string key;
+    std::unique_ptr<Node> loaded;
+    ASSERT_TRUE(read_node_record(ss, key, loaded));
+    EXPECT_EQ(loaded->regret_sum, node.regret_sum);
+    EXPECT_EQ(loaded->strategy_sum, node.strategy_sum);
+
+    ActionValues narrow = {1.0, 2.0};
+    narrow = loaded->regret_sum; // Inline -> heap and back
+    EXPECT_EQ(narrow, node.regret_sum);
+    narrow = {3.0};
+    EXPECT_EQ(narrow, std::vector<double>{3.0});
+}
+
+TEST(ColdNodeStoreTest, EvictTakeAndPeek) {
+    ColdNodeStore store;
+    ASSERT_TRUE(store.open("cold_node_store_test.spill"));
+    store.stage("P0:AcKd|a", make_node(1.0, 1));
+    store.stage("P0:AcKd|b", make_node(2.0, 2));
+    store.stage("P1:2c2d|a", make_node(3.0, 3));
+    EXPECT_EQ(store.size(), 3u);
+    EXPECT_EQ(store.flush_staged(), 3u);
+    EXPECT_EQ(store.size(), 3u);
+
+    auto peeked = store.peek("P0:AcKd|b");
+    ASSERT_NE(peeked, nullptr);
+    EXPECT_DOUBLE_EQ(peeked->regret_sum[0], 2.0);
+    EXPECT_EQ(store.size(), 3u); // Peek leaves the node cold
+
+    auto taken = store.take("P1:2c2d|a");
+    ASSERT_NE(taken, nullptr);
+    EXPECT_EQ(taken->visit_count.load(), 3);
+    EXPECT_EQ(store.take("P1:2c2d|a"), nullptr); // Only one owner
+    EXPECT_EQ(store.size(), 2u);
+
+    std::vector<std::string> keys = store.sorted_keys();
+    EXPECT_EQ(keys, (std::vector<std::string>{"P0:AcKd|a", "P0:AcKd|b"}));
+
+    ColdStoreStats stats = store.stats();
+    EXPECT_EQ(stats.evicted, 3);
+    EXPECT_EQ(stats.faults, 1);
+    EXPECT_GT(stats.bytes_written, 0);
+    store.close();
+    EXPECT_EQ(store.size(), 0u);
+}
+
+TEST(ColdNodeStoreTest, PrefixPrefetchStagesMatchingNodesOnly) {
+    ColdNodeStore store;
+    ASSERT_TRUE(store.open("cold_node_store_prefix_test.spill"));
+    store.stage("P0:AcKd|x", make_node(1.0, 1));
+    store.stage("P0:AcKd|y", make_node(1.0, 1));
+    store.stage("P0:AcKh|x", make_node(1.0, 1));
+    store.flush_staged();
+
+    std::vector<std::string> staged;
+    EXPECT_EQ(store.stage_prefix("P0:AcKd|", 10, staged), 2u);
+    EXPECT_EQ(staged, (std::vector<std::string>{"P0:AcKd|x", "P0:AcKd|y"}));
+    EXPECT_EQ(store.size(), 3u); // Staged nodes are still cold until taken
+    EXPECT_NE(store.take("P0:AcKd|x", false), nullptr);
+    EXPECT_EQ(store.stats().faults, 0);
+}
+
+} // namespace gto_solver
@@ -0,0 +1,56 @@
+#include "gtest/gtest.h"
+#include "convergence_tracker.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace gto_solver {
+
+TEST(ConvergenceTrackerTest, DisabledByDefault) {
+    ConvergenceTracker tracker;
+    tracker.start(0, {}, 0.0, 0.0, 0);
+    EXPECT_FALSE(tracker.enabled());
+    EXPECT_FALSE(tracker.report_due(1000));
+}
+
+TEST(ConvergenceTrackerTest, ReportsRegretVisitsAndStrategyDelta) {
+    ConvergenceTracker tracker;
+    tracker.start(10, {"A", "B", "Missing"}, 0.0, 4.0, 0);
+    EXPECT_FALSE(tracker.report_due(9));
+    EXPECT_TRUE(tracker.report_due(10));
+    EXPECT_EQ(tracker.current_window(), 1u);
+
+    std::map<std::string, std::vector<double>> strategies = {{"A", {0.5, 0.5}}, {"B", {1.0, 0.0}}};
+    auto lookup = [&](const std::string& key) {
+        auto it = strategies.find(key);
+        return it == strategies.end() ? std::vector<double>() : it->second;
+    };
+
+    // First window: nothing to compare against yet
+    ConvergenceReport first = tracker.report(10, 4, 4.0, 2, lookup);
+    EXPECT_DOUBLE_EQ(first.mean_positive_regret, 2.0); // (4 + 4) / 4 nodes
+    EXPECT_DOUBLE_EQ(first.visited_fraction, 0.5);
+    EXPECT_EQ(first.watched_compared, 0);
+    EXPECT_EQ(tracker.current_window(), 2u);
+    EXPECT_FALSE(tracker.report_due(15));
+
+    strategies["A"] = {0.75, 0.25};
+    ConvergenceReport second = tracker.report(20, 4, 4.0, 3, lookup);
+    EXPECT_EQ(second.watched_compared, 2);
+    EXPECT_DOUBLE_EQ(second.max_strategy_delta, 0.5);  // |0.25| + |0.25|
+    EXPECT_DOUBLE_EQ(second.mean_strategy_delta, 0.25); // (0.5 + 0) / 2
+    EXPECT_DOUBLE_EQ(second.visited_fraction, 0.25);    // One new first visit out of 4 nodes
+    EXPECT_FALSE(second.converged);                     // Auto-stop disabled
+    EXPECT_TRUE(tracker.has_report());
+}
+
+TEST(ConvergenceTrackerTest, AutoStopWhenDeltaBelowThreshold) {
+    ConvergenceTracker tracker;
+    tracker.start(1, {"A"}, 0.01, 0.0, 0);
+    auto lookup = [](const std::string&) { return std::vector<double>{0.3, 0.7}; };
+    EXPECT_FALSE(tracker.report(1, 1, 0.0, 1, lookup).converged); // Needs a previous window
+    EXPECT_TRUE(tracker.report(2, 1, 0.0, 1, lookup).converged);
+}
+
+} // namespace gto_solver
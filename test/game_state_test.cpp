@@ -3,6 +3,7 @@
 #include <vector>       // Include vector
 #include <numeric>      // Include numeric for std::accumulate
 #include <algorithm>    // Include algorithm for std::sort, std::find
+#include <stdexcept>    // For std::invalid_argument
 
 namespace gto_solver {
 
@@ -222,4 +223,35 @@ TEST(GameStateMultiwayTest, PostflopCheckAroundEndsRound3Way) {
 }
 
 
+TEST(GameStateMultiwayTest, TurnOrderSkipsFoldedSeats6Way) {
+    // 6 players, 100 stack, button pos 5: P0=SB, P1=BB, P2=UTG
+    GameState state_6way(6, 100, 0, 5);
+    EXPECT_EQ(state_6way.get_current_player(), 2);
+    auto act = [&](Action::Type type, int player, int amount = 0) {
+        Action action; action.type = type; action.player_index = player; action.amount = amount;
+        state_6way.apply_action(action);
+    };
+    act(Action::Type::FOLD, 2);
+    act(Action::Type::CALL, 3);
+    act(Action::Type::FOLD, 4);
+    act(Action::Type::RAISE, 5, 6);
+    act(Action::Type::FOLD, 0);
+    act(Action::Type::CALL, 1);
+    // Wraps past the folded UTG back to the limper
+    EXPECT_EQ(state_6way.get_current_player(), 3);
+    act(Action::Type::CALL, 3);
+
+    ASSERT_EQ(state_6way.get_current_street(), Street::FLOP);
+    EXPECT_EQ(state_6way.get_current_player(), 1); // SB folded: BB opens the flop
+    EXPECT_EQ(state_6way.get_num_active_players(), 3);
+    EXPECT_EQ(state_6way.get_effective_stack(1), 94);
+    EXPECT_TRUE(state_6way.has_player_folded(4));
+    EXPECT_FALSE(state_6way.is_terminal());
+}
+
+TEST(GameStateMultiwayTest, RejectsMoreSeatsThanTheBitmasksHold) {
+    EXPECT_NO_THROW(GameState(GameState::kMaxPlayers, 100, 0, 0));
+    EXPECT_THROW(GameState(GameState::kMaxPlayers + 1, 100, 0, 0), std::invalid_argument);
+}
+
 } // namespace gto_solver
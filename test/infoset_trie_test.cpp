@@ -0,0 +1,73 @@
+#include "gtest/gtest.h"
+#include "infoset_trie.h"
+
+#include <string>
+#include <vector>
+
+namespace gto_solver {
+
+TEST(InfosetTrieTest, FollowsEdgesToTheSameVertices) {
+    InfosetTrie trie;
+    InfosetTrie::Vertex* root = trie.root(2);
+    EXPECT_EQ(trie.root(2), root);
+    EXPECT_NE(trie.root(3), root); // One tree per button seat
+
+    const int flop[] = {12, 40, 3};
+    const int same_flop_reordered[] = {3, 12, 40};
+    const int other_flop[] = {12, 40, 4};
+    InfosetTrie::Vertex* call = trie.child(root, trie_edge_code(1, nullptr, 0));
+    InfosetTrie::Vertex* flop_vertex = trie.child(call, trie_edge_code(1, flop, 3));
+    EXPECT_EQ(trie.child(call, trie_edge_code(1, same_flop_reordered, 3)), flop_vertex); // Boards are sets
+    EXPECT_NE(trie.child(call, trie_edge_code(1, other_flop, 3)), flop_vertex);
+    EXPECT_NE(trie.child(root, trie_edge_code(2, nullptr, 0)), call);
+
+    // Vertices keep their address however many are added after them
+    for (size_t slot = 0; slot < 200; ++slot) trie.child(flop_vertex, trie_edge_code(slot % 8, &other_flop[slot % 3], 1));
+    EXPECT_EQ(trie.child(trie.root(2), trie_edge_code(1, nullptr, 0)), call);
+    EXPECT_EQ(trie.vertices(), 6u + 24u); // Edge = (slot mod 8, card mod 3): 24 distinct
+}
+
+TEST(InfosetTrieTest, CachesOneEntryPerHand) {
+    InfosetTrie trie;
+    InfosetTrie::Vertex* vertex = trie.root(0);
+    std::vector<std::string> keys = {"P0:AcAd|0|0----------|", "P0:2c7d|0|0----------|"};
+    Node* aces = reinterpret_cast<Node*>(0x1000); // Only compared, never dereferenced
+    Node* trash = reinterpret_cast<Node*>(0x2000);
+
+    EXPECT_EQ(trie.find(vertex, trie_hand_code(48, 49)), nullptr);
+    trie.insert(vertex, trie_hand_code(49, 48), {aces, &keys[0]});
+    trie.insert(vertex, trie_hand_code(0, 21), {trash, &keys[1]});
+    for (int hand = 0; hand < 1000; ++hand) trie.insert(trie.child(vertex, 7), hand, {trash, &keys[1]}); // Forces regrowth elsewhere
+
+    const InfosetTrie::Entry* entry = trie.find(vertex, trie_hand_code(48, 49)); // Card order does not matter
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->node, aces);
+    EXPECT_EQ(*entry->key, keys[0]);
+    entry = trie.find(vertex, trie_hand_code(21, 0));
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->node, trash);
+    EXPECT_EQ(trie.entries(), 1002u);
+    EXPECT_EQ(trie.hits(), 2u);
+    EXPECT_EQ(trie.misses(), 1u);
+
+    trie.clear();
+    EXPECT_EQ(trie.vertices(), 0u);
+    EXPECT_EQ(trie.entries(), 0u);
+    EXPECT_EQ(trie.find(trie.root(0), trie_hand_code(48, 49)), nullptr);
+}
+
+TEST(InfosetTrieTest, KeepsTheFirstActionMenu) {
+    InfosetTrie trie;
+    InfosetTrie::Vertex* vertex = trie.root(0);
+    EXPECT_FALSE(vertex->has_actions());
+    trie.set_actions(vertex, {ActionSpec{ActionType::FOLD}, ActionSpec{ActionType::CALL}, ActionSpec{ActionType::RAISE, 3.0}}, {-1, 1});
+    ASSERT_TRUE(vertex->has_actions());
+    ASSERT_EQ(vertex->actions().size(), 3u);
+    EXPECT_EQ(vertex->amounts(), (std::vector<int>{-1, 1, -1})); // Missing amounts read as none
+
+    trie.set_actions(vertex, {ActionSpec{ActionType::CHECK}}, {0}); // Another worker's identical menu
+    EXPECT_EQ(vertex->actions().size(), 3u);
+    EXPECT_GT(trie.memory_bytes(), 0u);
+}
+
+} // namespace gto_solver
@@ -0,0 +1,46 @@
+#include "gtest/gtest.h"
+#include "memory_budget.h"
+
+#include <string>
+
+namespace gto_solver {
+
+TEST(MemoryBudgetTest, ParsesSizes) {
+    size_t bytes = 0;
+    EXPECT_TRUE(parse_memory_size("1048576", bytes));
+    EXPECT_EQ(bytes, 1048576u);
+    EXPECT_TRUE(parse_memory_size("512M", bytes));
+    EXPECT_EQ(bytes, 512u * 1024 * 1024);
+    EXPECT_TRUE(parse_memory_size("8GB", bytes));
+    EXPECT_EQ(bytes, 8ull * 1024 * 1024 * 1024);
+    EXPECT_TRUE(parse_memory_size("1.5k", bytes));
+    EXPECT_EQ(bytes, 1536u);
+    EXPECT_FALSE(parse_memory_size("", bytes));
+    EXPECT_FALSE(parse_memory_size("lots", bytes));
+    EXPECT_FALSE(parse_memory_size("8X", bytes));
+    EXPECT_FALSE(parse_memory_size("-1G", bytes));
+}
+
+TEST(MemoryBudgetTest, EstimatesGrowWithActionsAndKeyLength) {
+    EXPECT_GT(estimate_node_bytes(6), estimate_node_bytes(2));
+    EXPECT_EQ(estimate_key_bytes("short"), 0u); // Fits the inline string buffer
+    EXPECT_GT(estimate_key_bytes(std::string(64, 'k')), 64u);
+}
+
+TEST(MemoryBudgetTest, RefusesAllocationsOverTheLimit) {
+    MemoryBudget budget;
+    budget.start(1000, 600, 100, 0.0);
+    EXPECT_TRUE(budget.limited());
+    EXPECT_EQ(budget.used_bytes(), 700u);
+    EXPECT_TRUE(budget.can_allocate(300));
+    budget.charge(250, 50);
+    EXPECT_FALSE(budget.exhausted());
+    EXPECT_FALSE(budget.can_allocate(1));
+    EXPECT_TRUE(budget.exhausted());
+
+    MemoryBudget unlimited;
+    unlimited.start(0, 0, 0, 0.0);
+    EXPECT_TRUE(unlimited.can_allocate(size_t(1) << 40));
+}
+
+} // namespace gto_solver
@@ -0,0 +1,78 @@
+#include "gtest/gtest.h"
+#include "metrics_server.h"
+
+#include <string>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace gto_solver {
+
+namespace {
+// Sends a raw HTTP request to 127.0.0.1:port and returns the full response.
+std::string http_get(int port, const std::string& path) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return "";
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) { ::close(fd); return ""; }
+    std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    ::send(fd, request.data(), request.size(), 0);
+    std::string response;
+    char buffer[1024];
+    ssize_t n;
+    while ((n = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) response.append(buffer, n);
+    ::close(fd);
+    return response;
+}
+} // anonymous namespace
+
+TEST(MetricsServerTest, FormatsPrometheusText) {
+    TrainingSnapshot snapshot;
+    snapshot.iterations_completed = 1234;
+    snapshot.nodes = 42;
+    std::string text = format_prometheus_metrics(snapshot);
+    EXPECT_NE(text.find("# TYPE gto_training_iterations_completed counter\n"), std::string::npos);
+    EXPECT_NE(text.find("gto_training_iterations_completed 1234\n"), std::string::npos);
+    EXPECT_NE(text.find("gto_training_nodes 42\n"), std::string::npos);
+    // Exploitability is only exported once an estimate exists
+    EXPECT_EQ(text.find("gto_exploitability"), std::string::npos);
+    EXPECT_EQ(text.find("gto_infoset_trie"), std::string::npos);
+    EXPECT_EQ(text.find("gto_action_baseline"), std::string::npos);
+
+    snapshot.has_exploitability = true;
+    snapshot.exploitability = 0.5;
+    EXPECT_NE(format_prometheus_metrics(snapshot).find("gto_exploitability 0.5\n"), std::string::npos);
+    snapshot.has_trie = true;
+    snapshot.trie_hits = 7;
+    EXPECT_NE(format_prometheus_metrics(snapshot).find("gto_infoset_trie_hits_total 7\n"), std::string::npos);
+    snapshot.has_baselines = true;
+    snapshot.baseline_corrected = 3;
+    EXPECT_NE(format_prometheus_metrics(snapshot).find("gto_action_baseline_corrected_total 3\n"), std::string::npos);
+}
+
+TEST(MetricsServerTest, ServesMetricsOnLocalhost) {
+    MetricsServer server;
+    long long iterations = 7;
+    ASSERT_TRUE(server.start(0, [&]() {
+        TrainingSnapshot s;
+        s.iterations_completed = iterations;
+        return s;
+    }));
+    ASSERT_GT(server.port(), 0);
+
+    std::string response = http_get(server.port(), "/metrics");
+    EXPECT_EQ(response.rfind("HTTP/1.1 200 OK", 0), 0u);
+    EXPECT_NE(response.find("text/plain; version=0.0.4"), std::string::npos);
+    EXPECT_NE(response.find("gto_training_iterations_completed 7\n"), std::string::npos);
+
+    EXPECT_EQ(http_get(server.port(), "/nope").rfind("HTTP/1.1 404", 0), 0u);
+
+    server.stop();
+    EXPECT_FALSE(server.is_running());
+}
+
+} // namespace gto_solver
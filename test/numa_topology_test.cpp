@@ -0,0 +1,113 @@
+#include "gtest/gtest.h"
+#include "numa_topology.h"
+#include "node_arena.h"
+
+#include <set>
+#include <vector>
+
+namespace gto_solver {
+
+namespace {
+NumaTopology two_socket_topology() {
+    NumaTopology topology;
+    topology.nodes.push_back(NumaNode{0, {0, 1, 2, 3}});
+    topology.nodes.push_back(NumaNode{1, {4, 5, 6, 7}});
+    return topology;
+}
+} // anonymous namespace
+
+TEST(NumaTopologyTest, ParsesAndFormatsCpulists) {
+    std::vector<int> cpus;
+    ASSERT_TRUE(parse_cpulist("0-3,8-11\n", cpus));
+    EXPECT_EQ(cpus, (std::vector<int>{0, 1, 2, 3, 8, 9, 10, 11}));
+    EXPECT_EQ(format_cpulist(cpus), "0-3,8-11");
+    ASSERT_TRUE(parse_cpulist("5", cpus));
+    EXPECT_EQ(cpus, (std::vector<int>{5}));
+    ASSERT_TRUE(parse_cpulist("", cpus)); // Memory-only nodes have an empty list
+    EXPECT_TRUE(cpus.empty());
+    EXPECT_FALSE(parse_cpulist("3-1", cpus));
+    EXPECT_FALSE(parse_cpulist("a-b", cpus));
+    EXPECT_FALSE(parse_cpulist("1-2x", cpus));
+
+    NumaTopology detected = NumaTopology::detect();
+    EXPECT_GE(detected.num_nodes(), 1u);
+    EXPECT_GE(detected.num_cpus(), 1u);
+}
+
+TEST(NumaTopologyTest, PlansCompactAndSpreadPlacement) {
+    NumaTopology topology = two_socket_topology();
+    EXPECT_TRUE(plan_thread_cpus(topology, ThreadPlacement::NONE, 4).empty());
+    EXPECT_EQ(plan_thread_cpus(topology, ThreadPlacement::COMPACT, 5), (std::vector<int>{0, 1, 2, 3, 4}));
+    EXPECT_EQ(plan_thread_cpus(topology, ThreadPlacement::SPREAD, 4), (std::vector<int>{0, 4, 1, 5}));
+    // More threads than CPUs wrap around
+    std::vector<int> wrapped = plan_thread_cpus(topology, ThreadPlacement::SPREAD, 10);
+    EXPECT_EQ(wrapped[8], 0);
+    EXPECT_EQ(topology.node_index_of_cpu(6), 1);
+    EXPECT_EQ(topology.node_index_of_cpu(42), -1);
+
+    ThreadPlacement placement = ThreadPlacement::NONE;
+    EXPECT_TRUE(parse_thread_placement("spread", placement));
+    EXPECT_EQ(placement, ThreadPlacement::SPREAD);
+    EXPECT_FALSE(parse_thread_placement("scatter", placement));
+}
+
+TEST(NodeArenaTest, PoolsAndReusesSlots) {
+    struct Payload { double values[8]; };
+    NodeArena& arena = NodeArena::instance();
+    arena.configure(NumaTopology::detect(), true);
+
+    std::set<void*> first_round;
+    for (int i = 0; i < 100; ++i) first_round.insert(arena.allocate(sizeof(Payload)));
+    EXPECT_EQ(first_round.size(), 100u);
+    long long live = 0;
+    for (const auto& pool : arena.stats()) live += pool.live_slots;
+    EXPECT_GE(live, 100);
+    for (void* p : first_round) NodeArena::deallocate(p);
+
+    // Freed slots are handed out again before new chunk space is used
+    void* reused = arena.allocate(sizeof(Payload));
+    EXPECT_TRUE(first_round.count(reused));
+    NodeArena::deallocate(reused);
+
+    // Slots from an enabled arena can still be freed after it is disabled
+    void* pooled = arena.allocate(sizeof(Payload));
+    arena.configure(NumaTopology(), false);
+    void* heap = arena.allocate(sizeof(Payload));
+    NodeArena::deallocate(pooled);
+    NodeArena::deallocate(heap);
+}
+
+TEST(NodeArenaTest, HugePagesFallBackGracefully) {
+    HugePagePolicy policy = HugePagePolicy::OFF;
+    EXPECT_TRUE(parse_huge_page_policy("explicit", policy));
+    EXPECT_EQ(policy, HugePagePolicy::EXPLICIT);
+    EXPECT_FALSE(parse_huge_page_policy("1g", policy));
+
+    // Whatever the kernel offers, explicit requests end up on some backing and allocations work
+    struct Payload { double values[8]; };
+    NodeArena& arena = NodeArena::instance();
+    PageBacking backing = arena.configure(NumaTopology::detect(), true, HugePagePolicy::EXPLICIT);
+    EXPECT_EQ(arena.page_backing(), backing);
+    std::vector<void*> slots;
+    for (int i = 0; i < 20000; ++i) { // Over 1 MB, so a 2 MB chunk is mapped even if an earlier test left space
+        slots.push_back(arena.allocate(sizeof(Payload)));
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(slots.back()) % 16, 0u);
+        static_cast<Payload*>(slots.back())->values[7] = i; // Touch the page
+    }
+    bool found_chunk = false;
+    for (const auto& pool : arena.stats()) {
+        if (pool.chunks == 0) continue;
+        found_chunk = true;
+        EXPECT_EQ(pool.chunk_bytes, size_t{2} << 20);
+        if (backing == PageBacking::SMALL_PAGES) {
+            EXPECT_EQ(pool.huge_chunks, 0);
+        }
+    }
+    EXPECT_TRUE(found_chunk);
+    for (void* p : slots) NodeArena::deallocate(p);
+
+    EXPECT_EQ(arena.configure(NumaTopology::detect(), true, HugePagePolicy::OFF), PageBacking::SMALL_PAGES);
+    arena.configure(NumaTopology(), false);
+}
+
+} // namespace gto_solver
@@ -0,0 +1,48 @@
+#include "gtest/gtest.h"
+#include "pot_layers.h"
+
+namespace gto_solver {
+
+TEST(PotLayersTest, SplitsSidePotsByContributionLevel) {
+    // P0 all-in for 10, P1 for 30, P2 and P3 put in 50; P3 folded
+    const int contributions[4] = {10, 30, 50, 50};
+    PotLayers pots = PotLayers::from_contributions(contributions, 0b0111, 4);
+    ASSERT_EQ(pots.num_layers, 3);
+    EXPECT_DOUBLE_EQ(pots.layers[0].amount, 30.0); // 10 from each of P0, P1, P2
+    EXPECT_EQ(pots.layers[0].eligible, 0b0111);
+    EXPECT_DOUBLE_EQ(pots.layers[1].amount, 40.0);
+    EXPECT_EQ(pots.layers[1].eligible, 0b0110);
+    EXPECT_DOUBLE_EQ(pots.layers[2].amount, 20.0);
+    EXPECT_EQ(pots.layers[2].eligible, 0b0100);
+    EXPECT_DOUBLE_EQ(pots.total_pot, 140.0);
+
+    // P0 has the best hand, P1 and P2 tie behind it
+    const int ranks[4] = {5, 100, 100, kUnrankedHand};
+    double payoffs[4];
+    resolve_pot_payoffs(pots, ranks, payoffs);
+    EXPECT_DOUBLE_EQ(payoffs[0], 30.0 - 10.0);
+    EXPECT_DOUBLE_EQ(payoffs[1], 20.0 - 30.0);
+    EXPECT_DOUBLE_EQ(payoffs[2], 20.0 + 20.0 - 50.0);
+    EXPECT_DOUBLE_EQ(payoffs[3], -50.0);
+}
+
+TEST(PotLayersTest, LastPlayerInHandTakesEverything) {
+    GameState state(3, 100, 0, 0); // P1=SB, P2=BB, P0 first to act
+    Action fold; fold.type = Action::Type::FOLD;
+    fold.player_index = 0;
+    state.apply_action(fold);
+    fold.player_index = 1;
+    state.apply_action(fold);
+    ASSERT_TRUE(state.is_terminal());
+
+    PotLayers pots = PotLayers::from_state(state);
+    EXPECT_EQ(pots.in_hand, 0b100);
+    const int ranks[3] = {kUnrankedHand, kUnrankedHand, kUnrankedHand};
+    double payoffs[3];
+    resolve_pot_payoffs(pots, ranks, payoffs);
+    EXPECT_DOUBLE_EQ(payoffs[0], 0.0);
+    EXPECT_DOUBLE_EQ(payoffs[1], -1.0);
+    EXPECT_DOUBLE_EQ(payoffs[2], 1.0); // Wins the small blind's dead money
+}
+
+} // namespace gto_solver
@@ -0,0 +1,119 @@
+#include "gtest/gtest.h"
+#include "regret_kernels.h"
+
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace gto_solver {
+
+namespace {
+// Restores the startup kernel set when a test forces another one
+struct IsaGuard {
+    KernelIsa saved = active_kernel_isa();
+    bool saved_fixed_width = fixed_width_kernels_enabled();
+    ~IsaGuard() { set_kernel_isa(saved); set_fixed_width_kernels(saved_fixed_width); }
+};
+
+std::vector<double> random_values(std::mt19937& rng, size_t n) {
+    std::uniform_real_distribution<double> dist(-5.0, 5.0);
+    std::vector<double> values(n);
+    for (double& v : values) v = dist(rng);
+    return values;
+}
+} // anonymous namespace
+
+TEST(RegretKernelsTest, EveryIsaMatchesTheScalarKernels) {
+    IsaGuard guard;
+    set_fixed_width_kernels(false); // Small nodes would not reach the instruction-set kernels
+    std::mt19937 rng(7);
+    for (size_t n : {1u, 2u, 3u, 5u, 6u, 8u, 13u, 32u}) { // Covers the vector tails
+        std::vector<double> regrets = random_values(rng, n);
+        std::vector<double> utilities = random_values(rng, n);
+        for (bool floor : {false, true}) {
+            ASSERT_TRUE(set_kernel_isa(KernelIsa::SCALAR));
+            std::vector<double> expected_strategy(n), expected_sum = regrets, expected_strategy_sum(n, 1.0);
+            regret_matching(regrets.data(), expected_strategy.data(), n);
+            double expected_delta = accumulate_regrets(expected_sum.data(), utilities.data(), 0.25, 0.5, n, floor);
+            accumulate_strategy(expected_strategy_sum.data(), expected_strategy.data(), 0.75, n);
+
+            for (KernelIsa isa : {KernelIsa::SSE2, KernelIsa::AVX2}) {
+                if (!set_kernel_isa(isa)) continue; // CPU lacks it
+                SCOPED_TRACE(kernel_isa_name(isa));
+                std::vector<double> strategy(n), sum = regrets, strategy_sum(n, 1.0);
+                regret_matching(regrets.data(), strategy.data(), n);
+                double delta = accumulate_regrets(sum.data(), utilities.data(), 0.25, 0.5, n, floor);
+                accumulate_strategy(strategy_sum.data(), strategy.data(), 0.75, n);
+                for (size_t i = 0; i < n; ++i) {
+                    EXPECT_NEAR(strategy[i], expected_strategy[i], 1e-12);
+                    EXPECT_DOUBLE_EQ(sum[i], expected_sum[i]);
+                    EXPECT_NEAR(strategy_sum[i], expected_strategy_sum[i], 1e-12);
+                }
+                EXPECT_NEAR(delta, expected_delta, 1e-9);
+            }
+        }
+    }
+}
+
+TEST(RegretKernelsTest, FixedWidthKernelsMatchTheScalarKernels) {
+    IsaGuard guard;
+    ASSERT_TRUE(set_kernel_isa(KernelIsa::SCALAR));
+    std::mt19937 rng(11);
+    for (size_t n = 1; n <= kMaxFixedKernelActions + 1; ++n) { // The last width is past the table
+        SCOPED_TRACE(n);
+        std::vector<double> regrets = random_values(rng, n);
+        std::vector<double> utilities = random_values(rng, n);
+        for (bool floor : {false, true}) {
+            set_fixed_width_kernels(false);
+            std::vector<double> expected_strategy(n), expected_sum = regrets, expected_strategy_sum(n, 1.0);
+            regret_matching(regrets.data(), expected_strategy.data(), n);
+            double expected_delta = accumulate_regrets(expected_sum.data(), utilities.data(), 0.25, 0.5, n, floor);
+            accumulate_strategy(expected_strategy_sum.data(), expected_strategy.data(), 0.75, n);
+
+            set_fixed_width_kernels(true);
+            std::vector<double> strategy(n), sum = regrets, strategy_sum(n, 1.0);
+            regret_matching(regrets.data(), strategy.data(), n);
+            double delta = accumulate_regrets(sum.data(), utilities.data(), 0.25, 0.5, n, floor);
+            accumulate_strategy(strategy_sum.data(), strategy.data(), 0.75, n);
+            EXPECT_EQ(strategy, expected_strategy);
+            EXPECT_EQ(sum, expected_sum);
+            EXPECT_EQ(strategy_sum, expected_strategy_sum);
+            EXPECT_NEAR(delta, expected_delta, 1e-12); // Summed in another order
+        }
+    }
+
+    // The uniform fallback at a fixed width
+    std::vector<double> strategy(4);
+    const double negative[] = {-1.0, 0.0, -3.0, -0.5};
+    regret_matching(negative, strategy.data(), 4);
+    EXPECT_EQ(strategy, std::vector<double>(4, 0.25));
+}
+
+TEST(RegretKernelsTest, HandlesUniformFallbackAndFlooring) {
+    std::vector<double> strategy(3);
+    const double negative[] = {-1.0, 0.0, -3.0};
+    regret_matching(negative, strategy.data(), 3);
+    for (double p : strategy) EXPECT_DOUBLE_EQ(p, 1.0 / 3.0);
+
+    // Non-finite regrets must not leak NaN into the strategy
+    const double infinite[] = {std::numeric_limits<double>::infinity(), 1.0, std::numeric_limits<double>::infinity()};
+    regret_matching(infinite, strategy.data(), 3);
+    EXPECT_NEAR(std::accumulate(strategy.begin(), strategy.end(), 0.0), 1.0, 1e-12);
+    for (double p : strategy) EXPECT_TRUE(std::isfinite(p));
+
+    const double skewed[] = {3.0, -1.0, 1.0};
+    regret_matching(skewed, strategy.data(), 3);
+    EXPECT_DOUBLE_EQ(strategy[0], 0.75);
+    EXPECT_DOUBLE_EQ(strategy[1], 0.0);
+
+    // regret += 2 * (u - 1): {1, 0.5, -1} + {2, -4, 0} -> {3, -3.5, -1}, floored {3, 0, 0}
+    std::vector<double> regrets = {1.0, 0.5, -1.0};
+    const double utilities[] = {2.0, -1.0, 1.0};
+    double delta = accumulate_regrets(regrets.data(), utilities, 1.0, 2.0, 3, true);
+    EXPECT_EQ(regrets, (std::vector<double>{3.0, 0.0, 0.0}));
+    EXPECT_DOUBLE_EQ(delta, 1.5); // Positive part went 1.5 -> 3
+}
+
+} // namespace gto_solver
@@ -0,0 +1,62 @@
+#include "gtest/gtest.h"
+#include "regret_update_buffer.h"
+
+#include <memory>
+#include <vector>
+
+namespace gto_solver {
+
+TEST(RegretUpdateBufferTest, AccumulatesAndMergesDeltas) {
+    auto node = std::make_unique<Node>(size_t{3});
+    node->regret_sum = {1.0, -2.0, 0.5};
+    RegretUpdateBuffer buffer;
+
+    const double regret_a[] = {0.5, 1.0, -1.0};
+    const double strategy_a[] = {0.2, 0.3, 0.5};
+    const double regret_b[] = {-2.0, 0.5, 0.0};
+    const double strategy_b[] = {0.1, 0.1, 0.8};
+    buffer.add(node.get(), regret_a, strategy_a, false);
+    buffer.add(node.get(), regret_b, strategy_b, false);
+    EXPECT_EQ(buffer.pending_nodes(), 1u);
+    EXPECT_EQ(buffer.pending_updates(), 2u);
+    // Nothing reaches the node before the merge
+    EXPECT_DOUBLE_EQ(node->regret_sum[0], 1.0);
+    EXPECT_EQ(node->visit_count.load(), 0);
+
+    BufferMergeStats stats = buffer.merge();
+    EXPECT_EQ(stats.nodes, 1u);
+    EXPECT_EQ(stats.updates, 2u);
+    EXPECT_DOUBLE_EQ(node->regret_sum[0], -0.5);
+    EXPECT_DOUBLE_EQ(node->regret_sum[1], -0.5);
+    EXPECT_DOUBLE_EQ(node->regret_sum[2], -0.5);
+    EXPECT_DOUBLE_EQ(node->strategy_sum[2], 1.3);
+    EXPECT_EQ(node->visit_count.load(), 2);
+    EXPECT_DOUBLE_EQ(stats.positive_regret_delta, -1.5); // max(0, .) went 1.5 -> 0
+    EXPECT_TRUE(buffer.empty());
+
+    // CFR+ floor: merged sums are clamped at zero
+    buffer.add(node.get(), regret_a, strategy_a, false);
+    buffer.merge(RegretFloor::ON);
+    EXPECT_DOUBLE_EQ(node->regret_sum[0], 0.0);
+    EXPECT_DOUBLE_EQ(node->regret_sum[1], 0.5);
+    EXPECT_DOUBLE_EQ(node->regret_sum[2], 0.0);
+}
+
+TEST(RegretUpdateBufferTest, PinsNodesUntilMerged) {
+    std::vector<std::unique_ptr<Node>> nodes;
+    for (int i = 0; i < 4; ++i) nodes.push_back(std::make_unique<Node>(size_t{2}));
+    RegretUpdateBuffer buffer;
+    const double delta[] = {1.0, 1.0};
+    for (int round = 0; round < 3; ++round) {
+        for (auto& node : nodes) buffer.add(node.get(), delta, delta, true);
+    }
+    for (auto& node : nodes) EXPECT_EQ(node->pin_count.load(), 1); // One pin per buffered node
+    buffer.merge();
+    for (auto& node : nodes) {
+        EXPECT_EQ(node->pin_count.load(), 0);
+        EXPECT_DOUBLE_EQ(node->regret_sum[1], 3.0);
+        EXPECT_EQ(node->visit_count.load(), 3);
+    }
+}
+
+} // namespace gto_solver
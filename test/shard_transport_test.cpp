@@ -0,0 +1,150 @@
+#include "gtest/gtest.h"
+#include "shard_transport.h"
+
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace gto_solver {
+
+TEST(ShardTransportTest, ParsesEndpointLists) {
+    std::vector<ShardEndpoint> endpoints;
+    ASSERT_TRUE(parse_shard_endpoints("127.0.0.1:7001,solver-b:7002", endpoints));
+    ASSERT_EQ(endpoints.size(), 2u);
+    EXPECT_EQ(endpoints[0].host, "127.0.0.1");
+    EXPECT_EQ(endpoints[0].port, 7001);
+    EXPECT_EQ(format_shard_endpoint(endpoints[1]), "solver-b:7002");
+
+    EXPECT_FALSE(parse_shard_endpoints("", endpoints));
+    EXPECT_FALSE(parse_shard_endpoints("127.0.0.1", endpoints));
+    EXPECT_FALSE(parse_shard_endpoints("127.0.0.1:70x1", endpoints));
+    EXPECT_FALSE(parse_shard_endpoints("127.0.0.1:7001,", endpoints));
+    EXPECT_FALSE(parse_shard_endpoints(":7001", endpoints));
+    EXPECT_FALSE(parse_shard_endpoints("host:70000", endpoints));
+    EXPECT_EQ(endpoints.size(), 2u); // Left untouched on failure
+}
+
+TEST(ShardTransportTest, ShardOfIsStableAndSpreadsKeys) {
+    EXPECT_EQ(shard_of("anything", 1), 0u);
+    // Pinned values: the partition must not change between builds or hosts
+    EXPECT_EQ(shard_of("", 7), 14695981039346656037ull % 7);
+    EXPECT_EQ(shard_of("a", 1000), 12638187200555641996ull % 1000);
+
+    std::vector<int> counts(4, 0);
+    for (int i = 0; i < 4000; ++i) counts[shard_of("P" + std::to_string(i % 6) + "|AsKd|" + std::to_string(i), 4)]++;
+    for (int count : counts) {
+        EXPECT_GT(count, 800);
+        EXPECT_LT(count, 1200);
+    }
+    EXPECT_EQ(shard_checkpoint_filename("run.bin", 1, 3), "run.bin.shard1of3");
+}
+
+TEST(ShardTransportTest, FramesRoundTripOverASocket) {
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    std::string big(200000, 'x'); // Larger than one socket buffer: exercises partial writes
+    big[12345] = '\0';
+    std::thread writer([&] {
+        EXPECT_TRUE(send_frame(fds[0], ShardFrame::UPDATE, big));
+        EXPECT_TRUE(send_frame(fds[0], ShardFrame::DONE, std::string()));
+    });
+    ShardFrame type;
+    std::string payload;
+    ASSERT_TRUE(recv_frame(fds[1], type, payload));
+    EXPECT_EQ(type, ShardFrame::UPDATE);
+    EXPECT_EQ(payload, big);
+    ASSERT_TRUE(recv_frame(fds[1], type, payload));
+    EXPECT_EQ(type, ShardFrame::DONE);
+    EXPECT_TRUE(payload.empty());
+    writer.join();
+    ::close(fds[0]);
+    EXPECT_FALSE(recv_frame(fds[1], type, payload)); // Peer closed
+    ::close(fds[1]);
+}
+
+TEST(ShardTransportTest, RefusesOversizedFrames) {
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    // A header claiming more than the limit is refused before anything is allocated
+    char header[1 + sizeof(uint64_t)];
+    header[0] = static_cast<char>(ShardFrame::UPDATE);
+    uint64_t length = kMaxShardFrameBytes + 1;
+    std::memcpy(header + 1, &length, sizeof(length));
+    ASSERT_EQ(::send(fds[0], header, sizeof(header), 0), static_cast<ssize_t>(sizeof(header)));
+    ShardFrame type;
+    std::string payload;
+    EXPECT_FALSE(recv_frame(fds[1], type, payload));
+    EXPECT_TRUE(payload.empty());
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+TEST(ShardTransportTest, SplitsPayloadsIntoFramesAtRecordBoundaries) {
+    // Ten 20-byte delta records against a 64-byte limit: three records per frame
+    ShardPayloads updates(64);
+    std::string all_records;
+    for (int i = 0; i < 10; ++i) {
+        std::string record(20, static_cast<char>('a' + i));
+        updates.add(record);
+        all_records += record;
+    }
+    std::vector<std::string> frames = updates.take();
+    ASSERT_EQ(frames.size(), 4u);
+    EXPECT_TRUE(updates.empty());
+
+    // More than one frame's worth goes out as several frames and arrives whole
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    std::thread writer([&] {
+        for (const std::string& frame : frames) EXPECT_TRUE(send_frame(fds[0], ShardFrame::UPDATE, frame));
+    });
+    std::string received;
+    for (size_t k = 0; k < frames.size(); ++k) {
+        ShardFrame type;
+        std::string payload;
+        ASSERT_TRUE(recv_frame(fds[1], type, payload));
+        EXPECT_EQ(type, ShardFrame::UPDATE);
+        EXPECT_LE(payload.size(), 64u);
+        EXPECT_EQ(payload.size() % 20, 0u); // Whole records only
+        received += payload;
+    }
+    writer.join();
+    EXPECT_EQ(received, all_records);
+    ::close(fds[0]);
+    ::close(fds[1]);
+
+    // A LOOKUP is charged the size of its answer; a record over the limit travels alone
+    ShardPayloads lookups(64);
+    lookups.add("k1", 40);
+    lookups.add("k2", 40);
+    lookups.add("k3", 10);
+    lookups.add("big", 100);
+    lookups.add("k4", 10);
+    EXPECT_EQ(lookups.take(), (std::vector<std::string>{"k1", "k2k3", "big", "k4"}));
+}
+
+TEST(ShardTransportTest, ConnectsOverLoopback) {
+    int port = 0;
+    int listen_fd = listen_tcp(0, 1, &port);
+    ASSERT_GE(listen_fd, 0);
+    ASSERT_GT(port, 0);
+    int client = connect_tcp(ShardEndpoint{"127.0.0.1", port}, 5.0);
+    ASSERT_GE(client, 0);
+    int server = accept_tcp(listen_fd, 5000);
+    ASSERT_GE(server, 0);
+    ASSERT_TRUE(send_frame(client, ShardFrame::LOOKUP, "key"));
+    ShardFrame type;
+    std::string payload;
+    ASSERT_TRUE(recv_frame(server, type, payload));
+    EXPECT_EQ(type, ShardFrame::LOOKUP);
+    EXPECT_EQ(payload, "key");
+    EXPECT_EQ(accept_tcp(listen_fd, 10), -1); // Nobody else is connecting
+    ::close(client);
+    ::close(server);
+    ::close(listen_fd);
+}
+
+} // namespace gto_solver
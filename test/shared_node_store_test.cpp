@@ -0,0 +1,141 @@
+#include "gtest/gtest.h"
+#include "shared_node_store.h"
+#include "node_serialization.h"
+
+#include <cstdio>     // For std::remove
+#include <fstream>
+#include <string>
+#include <sys/wait.h> // For waitpid
+#include <unistd.h>   // For fork, getpid, _exit
+#include <vector>
+
+namespace gto_solver {
+
+namespace {
+std::vector<ActionSpec> fold_call() {
+    ActionSpec fold{ActionType::FOLD};
+    ActionSpec call{ActionType::CALL};
+    fold.action_set = call.action_set = ActionSetId::VS_OPEN;
+    fold.abstract_action = AbstractAction::FOLD;
+    call.abstract_action = AbstractAction::CALL;
+    return {fold, call};
+}
+
+std::string store_name(const char* test) { return "/gto_solver_test_" + std::string(test) + "_" + std::to_string(::getpid()); }
+} // anonymous namespace
+
+TEST(SharedNodeStoreTest, InsertFindAndAttach) {
+    SharedNodeStore store;
+    ASSERT_TRUE(store.create(store_name("insert"), 1 << 20));
+    EXPECT_EQ(store.find("P0|AA"), 0u);
+    uint64_t entry = store.find_or_insert("P0|AA", fold_call());
+    ASSERT_NE(entry, 0u);
+    EXPECT_EQ(store.find_or_insert("P0|AA", fold_call()), entry);
+    EXPECT_EQ(store.num_actions(entry), 2u);
+
+    double regrets[2] = {1.0, -3.0}, strategy[2] = {0.5, 0.5};
+    EXPECT_DOUBLE_EQ(store.add_deltas(entry, regrets, strategy, 1, false), 1.0);
+    EXPECT_DOUBLE_EQ(store.add_deltas(entry, regrets, strategy, 1, true), 1.0); // {2, 0} after flooring
+
+    // A second mapping (at another address) sees the same entry
+    SharedNodeStore other;
+    ASSERT_TRUE(other.attach(store.name()));
+    uint64_t same = other.find("P0|AA");
+    ASSERT_EQ(same, entry);
+    double loaded[2];
+    other.load_regrets(same, loaded);
+    EXPECT_DOUBLE_EQ(loaded[0], 2.0);
+    EXPECT_DOUBLE_EQ(loaded[1], 0.0);
+    EXPECT_EQ(other.stats().entries, 1);
+}
+
+TEST(SharedNodeStoreTest, ConcurrentUpdatesFromForkedProcesses) {
+    SharedNodeStore store;
+    ASSERT_TRUE(store.create(store_name("fork"), 8 << 20));
+    constexpr int kWorkers = 4, kKeys = 500, kRounds = 20;
+    std::vector<pid_t> children;
+    for (int w = 0; w < kWorkers; ++w) {
+        pid_t pid = ::fork();
+        ASSERT_GE(pid, 0);
+        if (pid == 0) {
+            // Every worker inserts every key (racing on the inserts) and adds 1 per round
+            double ones[2] = {1.0, 1.0};
+            for (int round = 0; round < kRounds; ++round) {
+                for (int k = 0; k < kKeys; ++k) {
+                    uint64_t entry = store.find_or_insert("K" + std::to_string((k + w * 37) % kKeys), fold_call());
+                    if (entry == 0) ::_exit(1);
+                    store.add_deltas(entry, ones, ones, 1, false);
+                }
+                store.add_completed_iterations(1);
+            }
+            ::_exit(0); // Skips the destructor: the creator keeps the name
+        }
+        children.push_back(pid);
+    }
+    for (pid_t pid : children) {
+        int status = 0;
+        ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+        EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+    EXPECT_EQ(store.stats().entries, kKeys);
+    EXPECT_EQ(store.completed_iterations(), kWorkers * kRounds);
+    for (int k = 0; k < kKeys; ++k) {
+        uint64_t entry = store.find("K" + std::to_string(k));
+        ASSERT_NE(entry, 0u);
+        double regrets[2];
+        store.load_regrets(entry, regrets);
+        EXPECT_DOUBLE_EQ(regrets[0], kWorkers * kRounds);
+    }
+}
+
+TEST(SharedNodeStoreTest, CheckpointRoundTrip) {
+    SharedNodeStore store;
+    ASSERT_TRUE(store.create(store_name("save"), 1 << 20));
+    store.set_history_encoding(HistoryEncoding::ACTIONS);
+    double regrets[2] = {4.0, -1.0}, strategy[2] = {2.0, 3.0};
+    for (const char* key : {"b", "a", "c"}) store.add_deltas(store.find_or_insert(key, fold_call()), regrets, strategy, 5, false);
+    store.add_completed_iterations(42);
+    ASSERT_TRUE(store.save_checkpoint("shared_store_test.bin"));
+
+    // Sorted, current-version records the engine and merge command can read
+    std::ifstream is("shared_store_test.bin", std::ios::binary);
+    CheckpointHeader header;
+    ASSERT_TRUE(read_checkpoint_header(is, header));
+    EXPECT_EQ(header.version, CHECKPOINT_VERSION_BIN);
+    EXPECT_EQ(header.completed_iterations, 42);
+    EXPECT_EQ(header.history_encoding, HistoryEncoding::ACTIONS);
+    ASSERT_EQ(header.map_size, 3u);
+    std::string key;
+    std::unique_ptr<Node> node;
+    ASSERT_TRUE(read_node_record(is, key, node));
+    EXPECT_EQ(key, "a");
+    EXPECT_EQ(node->strategy_sum, (std::vector<double>{2.0, 3.0}));
+    EXPECT_EQ(node->visit_count.load(), 5);
+    EXPECT_EQ(node->legal_actions[1].abstract_action, AbstractAction::CALL);
+    is.close();
+
+    SharedNodeStore copy;
+    ASSERT_TRUE(copy.create(store_name("load"), 1 << 20));
+    EXPECT_EQ(copy.load_checkpoint("shared_store_test.bin"), 42);
+    EXPECT_EQ(copy.history_encoding(), HistoryEncoding::ACTIONS);
+    double loaded[2];
+    copy.load_regrets(copy.find("c"), loaded);
+    EXPECT_DOUBLE_EQ(loaded[1], -1.0);
+    EXPECT_EQ(copy.load_checkpoint("shared_store_test.bin"), -1); // Only into an empty store
+    std::remove("shared_store_test.bin");
+}
+
+TEST(SharedNodeStoreTest, RefusesInsertsWhenFull) {
+    SharedNodeStore store;
+    ASSERT_TRUE(store.create(store_name("full"), 1 << 18));
+    size_t inserted = 0;
+    while (store.find_or_insert("P3|" + std::to_string(inserted) + std::string(40, 'x'), fold_call()) != 0) ++inserted;
+    SharedStoreStats stats = store.stats();
+    EXPECT_GT(inserted, 100u);
+    EXPECT_EQ(stats.entries, static_cast<long long>(inserted));
+    EXPECT_EQ(stats.refused, 1);
+    EXPECT_LE(stats.used_bytes, stats.capacity_bytes);
+    EXPECT_NE(store.find("P3|0" + std::string(40, 'x')), 0u); // Earlier entries stay readable
+}
+
+} // namespace gto_solver
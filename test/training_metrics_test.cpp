@@ -0,0 +1,55 @@
+#include "gtest/gtest.h"
+#include "training_metrics.h"
+
+#include <cstdio>   // For std::remove
+#include <fstream>
+#include <string>
+#include <thread>
+
+namespace gto_solver {
+
+TEST(TrainingMetricsTest, UnregisteredThreadUsesScratchCounters) {
+    // Must not crash or touch another thread's counters when called outside train().
+    ThreadCounters& counters = thread_counters();
+    uint64_t before = counters.node_visits.load();
+    counters.node_visits.add(3);
+    EXPECT_EQ(counters.node_visits.load(), before + 3);
+}
+
+TEST(TrainingMetricsTest, RegisteredThreadsAreSummedIntoCsvReport) {
+    const std::string csv_file = "training_metrics_test.csv";
+    TrainingMetrics metrics;
+    metrics.start(0.0, csv_file, 2, 0); // No periodic reports, only the final one
+
+    auto worker = [&](uint64_t visits) {
+        metrics.register_current_thread();
+        thread_counters().node_visits.add(visits);
+        thread_counters().traversals.add(1);
+        thread_counters().traversal_depth.add(4);
+    };
+    std::thread t1(worker, 10);
+    std::thread t2(worker, 20);
+    t1.join();
+    t2.join();
+
+    metrics.finish(5, 7);
+
+    std::ifstream ifs(csv_file);
+    ASSERT_TRUE(ifs.is_open());
+    std::string header, row;
+    std::getline(ifs, header);
+    std::getline(ifs, row);
+    EXPECT_EQ(header.rfind("label,elapsed_s,iterations,", 0), 0u);
+    EXPECT_EQ(row.rfind("run,", 0), 0u);
+    // iterations and total_nodes columns
+    EXPECT_NE(row.find(",5,"), std::string::npos);
+    EXPECT_NE(row.find(",7,"), std::string::npos);
+    ifs.close();
+    std::remove(csv_file.c_str());
+}
+
+TEST(TrainingMetricsTest, ResidentMemoryIsReported) {
+    EXPECT_GT(TrainingMetrics::resident_memory_bytes(), 0u);
+}
+
+} // namespace gto_solver
@@ -0,0 +1,60 @@
+#include "gtest/gtest.h"
+#include "traversal_arena.h"
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace gto_solver {
+
+TEST(TraversalArenaTest, RewindsLifoFreesAndReusesBlocksAfterReset) {
+    TraversalArena arena(4096);
+    void* first = arena.allocate(256, 8);
+    void* second = arena.allocate(128, 64);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(second) % 64, 0u);
+    arena.deallocate(second, 128, 64);
+    void* again = arena.allocate(128, 64); // The freed top of the stack is handed out again
+    EXPECT_EQ(again, second);
+    arena.deallocate(again, 128, 64);
+    arena.deallocate(first, 256, 8);
+    EXPECT_EQ(arena.heap_blocks(), 1u);
+
+    // Larger than the remaining space: a new, bigger block
+    void* big = arena.allocate(8192, 8);
+    EXPECT_NE(big, nullptr);
+    EXPECT_EQ(arena.heap_blocks(), 2u);
+    EXPECT_GE(arena.high_water_bytes(), 8192u);
+
+    // After warm-up, the same allocation pattern never goes back to the heap
+    size_t warm_blocks = arena.heap_blocks();
+    for (int round = 0; round < 100; ++round) {
+        arena.reset();
+        void* small_block = arena.allocate(256, 8);
+        void* big_block = arena.allocate(8192, 8);
+        EXPECT_NE(small_block, big_block);
+        arena.deallocate(big_block, 8192, 8);
+        arena.deallocate(small_block, 256, 8);
+    }
+    EXPECT_EQ(arena.heap_blocks(), warm_blocks);
+}
+
+TEST(TraversalArenaTest, BacksPmrContainersOnTheInstallingThread) {
+    EXPECT_EQ(traversal_resource(), std::pmr::new_delete_resource());
+    TraversalArena arena;
+    {
+        TraversalArenaScope scope(&arena);
+        EXPECT_EQ(traversal_resource(), &arena);
+        for (int round = 0; round < 10; ++round) {
+            arena.reset();
+            std::pmr::vector<double> strategy(6, 1.0 / 6, traversal_resource());
+            std::pmr::vector<double> reach(strategy, traversal_resource());
+            reach[0] *= 0.5;
+            EXPECT_DOUBLE_EQ(strategy[0], 1.0 / 6);
+            EXPECT_EQ(reach.get_allocator().resource(), &arena);
+        }
+        EXPECT_EQ(arena.heap_blocks(), 1u);
+    }
+    EXPECT_EQ(traversal_resource(), std::pmr::new_delete_resource());
+}
+
+} // namespace gto_solver
@@ -0,0 +1,44 @@
+#include "gtest/gtest.h"
+#include "visit_sketch.h"
+
+#include <string>
+
+namespace gto_solver {
+
+TEST(VisitSketchTest, CountsVisitsPerKey) {
+    VisitSketch sketch;
+    EXPECT_FALSE(sketch.enabled());
+    EXPECT_EQ(sketch.add("P0|AA"), 0u); // Disabled sketches count nothing
+
+    sketch.reset(1 << 12);
+    ASSERT_TRUE(sketch.enabled());
+    EXPECT_EQ(sketch.memory_bytes(), 4u << 12);
+    EXPECT_EQ(sketch.add("P0|AA"), 1u);
+    EXPECT_EQ(sketch.add("P0|AA"), 2u);
+    EXPECT_EQ(sketch.add("P1|KK"), 1u);
+    EXPECT_EQ(sketch.estimate("P0|AA"), 2u);
+    EXPECT_EQ(sketch.estimate("P2|QQ"), 0u);
+}
+
+TEST(VisitSketchTest, NeverUndercountsAndSaturates) {
+    VisitSketch sketch;
+    sketch.reset(256); // Far more keys than counters: collisions are certain
+    for (int round = 1; round <= 3; ++round) {
+        for (int k = 0; k < 2000; ++k) sketch.add("K" + std::to_string(k));
+        for (int k = 0; k < 2000; k += 97) EXPECT_GE(sketch.estimate("K" + std::to_string(k)), static_cast<uint32_t>(round));
+    }
+    for (int i = 0; i < 400; ++i) sketch.add("hot");
+    EXPECT_EQ(sketch.estimate("hot"), 255u);
+    EXPECT_EQ(sketch.add("hot"), 255u);
+}
+
+TEST(VisitSketchTest, ConservativeUpdateKeepsRareKeysLow) {
+    VisitSketch sketch;
+    sketch.reset(1 << 16);
+    for (int k = 0; k < 5000; ++k) sketch.add("K" + std::to_string(k));
+    int overcounted = 0;
+    for (int k = 0; k < 5000; ++k) overcounted += sketch.estimate("K" + std::to_string(k)) > 1;
+    EXPECT_LT(overcounted, 10); // 5000 keys in 64K counters per row rarely collide in all rows
+}
+
+} // namespace gto_solver